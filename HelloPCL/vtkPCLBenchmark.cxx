@@ -0,0 +1,577 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkPCLBenchmark.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkPCLBenchmark.h"
+
+#include <vtk/vtkObjectFactory.h>
+
+#include <pcl/pcl/common/profiling.h>
+#include <pcl/pcl/common/transforms.h>
+#include <pcl/pcl/filters/voxel_grid.h>
+#include <pcl/pcl/search/kdtree.h>
+#include <pcl/pcl/search/organized.h>
+#include <pcl/pcl/search/octree.h>
+#include <pcl/pcl/features/normal_3d.h>
+#include <pcl/pcl/features/normal_3d_omp.h>
+#include <pcl/pcl/features/fpfh_omp.h>
+#include <pcl/pcl/sample_consensus/method_types.h>
+#include <pcl/pcl/sample_consensus/model_types.h>
+#include <pcl/pcl/segmentation/sac_segmentation.h>
+#include <pcl/pcl/segmentation/extract_clusters.h>
+#include <pcl/pcl/registration/icp.h>
+#include <pcl/pcl/registration/ndt.h>
+
+// Compile the benchmarked algorithms from this tree rather than linking the
+// prebuilt library, so that the numbers reflect the current sources
+#include <pcl/pcl/filters/impl/voxel_grid.hpp>
+#include <pcl/pcl/kdtree/impl/kdtree_flann.hpp>
+#include <pcl/pcl/search/impl/organized.hpp>
+#include <pcl/pcl/octree/octree_impl.h>
+#include <pcl/pcl/features/impl/normal_3d.hpp>
+#include <pcl/pcl/features/impl/normal_3d_omp.hpp>
+#include <pcl/pcl/features/impl/fpfh.hpp>
+#include <pcl/pcl/features/impl/fpfh_omp.hpp>
+#include <pcl/pcl/sample_consensus/impl/ransac.hpp>
+#include <pcl/pcl/sample_consensus/impl/sac_model_plane.hpp>
+#include <pcl/pcl/segmentation/impl/sac_segmentation.hpp>
+#include <pcl/pcl/segmentation/impl/extract_clusters.hpp>
+
+#include <boost/random/mersenne_twister.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------
+namespace {
+
+typedef pcl::PointCloud<pcl::PointXYZ> CloudType;
+
+// Mean distance between neighboring points of the unorganized clouds, in
+// meters. The clouds grow in area, so that all sizes have the same density.
+const double PointSpacing = 0.01;
+
+// Number of query points of the search cases.
+const vtkIdType NumberOfQueries = 10000;
+
+//----------------------------------------------------------------------------
+double Uniform(boost::mt19937& generator)
+{
+  return generator() / 4294967296.0;
+}
+
+//----------------------------------------------------------------------------
+// A terrain of 1m tiles at four different heights with a small ripple. The
+// height steps separate the tiles into Euclidean clusters and the largest
+// plane holds about a quarter of the points.
+CloudType::Ptr NewUnorganizedCloud(vtkIdType numberOfPoints)
+{
+  boost::mt19937 generator(12345u);
+  const double side = PointSpacing * std::sqrt(static_cast<double>(numberOfPoints));
+
+  CloudType::Ptr cloud(new CloudType);
+  cloud->points.resize(numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+    const double x = Uniform(generator) * side;
+    const double y = Uniform(generator) * side;
+    const int tile = static_cast<int>(x) % 2 + 2 * (static_cast<int>(y) % 2);
+    pcl::PointXYZ& point = cloud->points[i];
+    point.x = static_cast<float>(x);
+    point.y = static_cast<float>(y);
+    point.z = static_cast<float>(0.3 * tile + 0.005 * std::sin(10.0 * x) * std::cos(10.0 * y)
+                                 + 0.001 * (Uniform(generator) - 0.5));
+    }
+  cloud->width = static_cast<uint32_t>(numberOfPoints);
+  cloud->height = 1;
+  cloud->is_dense = true;
+  return cloud;
+}
+
+//----------------------------------------------------------------------------
+// A 4:3 depth image of a stepped wall two meters in front of a pinhole
+// camera with a 53 degree horizontal field of view.
+CloudType::Ptr NewOrganizedCloud(vtkIdType numberOfPoints)
+{
+  boost::mt19937 generator(12345u);
+  const int width = std::max(1, static_cast<int>(std::sqrt(numberOfPoints * 4.0 / 3.0)));
+  const int height = std::max(1, static_cast<int>(numberOfPoints / width));
+  const double focalLength = width;
+
+  CloudType::Ptr cloud(new CloudType);
+  cloud->points.resize(static_cast<size_t>(width) * height);
+  for (int v = 0; v < height; ++v)
+    {
+    for (int u = 0; u < width; ++u)
+      {
+      const int step = (u * 4 / width) % 2 + (v * 3 / height) % 2;
+      const double depth = 2.0 + 0.3 * step + 0.01 * std::sin(u * 0.05) + 0.001 * (Uniform(generator) - 0.5);
+      pcl::PointXYZ& point = cloud->points[static_cast<size_t>(v) * width + u];
+      point.x = static_cast<float>((u - 0.5 * width) * depth / focalLength);
+      point.y = static_cast<float>((v - 0.5 * height) * depth / focalLength);
+      point.z = static_cast<float>(depth);
+      }
+    }
+  cloud->width = width;
+  cloud->height = height;
+  cloud->is_dense = true;
+  return cloud;
+}
+
+//----------------------------------------------------------------------------
+// One algorithm under test. Setup() prepares everything that is not timed,
+// Execute() is the timed part and processes GetNumberOfItems() points or
+// queries.
+class BenchmarkCase
+{
+public:
+  BenchmarkCase(const char* name, vtkIdType maximumNumberOfPoints)
+    : Name(name), MaximumNumberOfPoints(maximumNumberOfPoints), NumberOfItems(0) {}
+  virtual ~BenchmarkCase() {}
+
+  const char* GetName() const { return this->Name; }
+  vtkIdType GetNumberOfItems() const { return this->NumberOfItems; }
+
+  virtual bool Supports(const CloudType& cloud) const
+  {
+    return static_cast<vtkIdType>(cloud.size()) <= this->MaximumNumberOfPoints;
+  }
+
+  virtual void Setup(CloudType::ConstPtr cloud, int numberOfThreads)
+  {
+    this->Cloud = cloud;
+    this->NumberOfThreads = numberOfThreads;
+    this->NumberOfItems = static_cast<vtkIdType>(cloud->size());
+  }
+
+  virtual void Execute() = 0;
+
+protected:
+  const char* Name;
+  vtkIdType MaximumNumberOfPoints;
+  vtkIdType NumberOfItems;
+  int NumberOfThreads;
+  CloudType::ConstPtr Cloud;
+};
+
+//----------------------------------------------------------------------------
+class VoxelGridCase : public BenchmarkCase
+{
+public:
+  VoxelGridCase() : BenchmarkCase("voxel_grid", VTK_LARGE_ID) {}
+
+  virtual void Execute()
+  {
+    pcl::VoxelGrid<pcl::PointXYZ> voxelGrid;
+    voxelGrid.setInputCloud(this->Cloud);
+    voxelGrid.setLeafSize(0.05f, 0.05f, 0.05f);
+    voxelGrid.filter(this->Output);
+  }
+
+private:
+  CloudType Output;
+};
+
+//----------------------------------------------------------------------------
+// Builds the search structure of the cloud.
+class SearchBuildCase : public BenchmarkCase
+{
+public:
+  SearchBuildCase(const char* name, pcl::search::Search<pcl::PointXYZ>::Ptr search)
+    : BenchmarkCase(name, VTK_LARGE_ID), Search(search) {}
+
+  virtual void Execute()
+  {
+    this->Search->setInputCloud(this->Cloud);
+  }
+
+protected:
+  pcl::search::Search<pcl::PointXYZ>::Ptr Search;
+};
+
+//----------------------------------------------------------------------------
+// Finds the 16 nearest neighbors of NumberOfQueries points spread over the
+// cloud, with the search structure built in Setup().
+class SearchCase : public BenchmarkCase
+{
+public:
+  SearchCase(const char* name, pcl::search::Search<pcl::PointXYZ>::Ptr search, bool organizedOnly)
+    : BenchmarkCase(name, VTK_LARGE_ID), Search(search), OrganizedOnly(organizedOnly) {}
+
+  virtual bool Supports(const CloudType& cloud) const
+  {
+    return BenchmarkCase::Supports(cloud) && (cloud.isOrganized() || !this->OrganizedOnly);
+  }
+
+  virtual void Setup(CloudType::ConstPtr cloud, int numberOfThreads)
+  {
+    BenchmarkCase::Setup(cloud, numberOfThreads);
+    this->Search->setInputCloud(cloud);
+    const vtkIdType numberOfPoints = static_cast<vtkIdType>(cloud->size());
+    this->NumberOfItems = std::min(numberOfPoints, NumberOfQueries);
+    this->Queries.resize(this->NumberOfItems);
+    for (vtkIdType i = 0; i < this->NumberOfItems; ++i)
+      {
+      this->Queries[i] = static_cast<int>(i * numberOfPoints / this->NumberOfItems);
+      }
+  }
+
+  virtual void Execute()
+  {
+    std::vector<int> indices;
+    std::vector<float> distances;
+    for (size_t i = 0; i < this->Queries.size(); ++i)
+      {
+      this->Search->nearestKSearch(this->Queries[i], 16, indices, distances);
+      }
+  }
+
+private:
+  pcl::search::Search<pcl::PointXYZ>::Ptr Search;
+  bool OrganizedOnly;
+  std::vector<int> Queries;
+};
+
+//----------------------------------------------------------------------------
+class NormalEstimationCase : public BenchmarkCase
+{
+public:
+  NormalEstimationCase(const char* name, bool useOpenMP)
+    : BenchmarkCase(name, 10000000), UseOpenMP(useOpenMP) {}
+
+  virtual void Setup(CloudType::ConstPtr cloud, int numberOfThreads)
+  {
+    BenchmarkCase::Setup(cloud, numberOfThreads);
+    this->Tree.reset(new pcl::search::KdTree<pcl::PointXYZ>);
+    this->Tree->setInputCloud(cloud);
+  }
+
+  virtual void Execute()
+  {
+    if (this->UseOpenMP)
+      {
+      pcl::NormalEstimationOMP<pcl::PointXYZ, pcl::Normal> estimation(this->NumberOfThreads);
+      this->Compute(estimation);
+      }
+    else
+      {
+      pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal> estimation;
+      this->Compute(estimation);
+      }
+  }
+
+private:
+  void Compute(pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal>& estimation)
+  {
+    estimation.setInputCloud(this->Cloud);
+    estimation.setSearchMethod(this->Tree);
+    estimation.setKSearch(16);
+    estimation.compute(this->Normals);
+  }
+
+  bool UseOpenMP;
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr Tree;
+  pcl::PointCloud<pcl::Normal> Normals;
+};
+
+//----------------------------------------------------------------------------
+class FPFHCase : public BenchmarkCase
+{
+public:
+  FPFHCase() : BenchmarkCase("fpfh_omp", 1000000) {}
+
+  virtual void Setup(CloudType::ConstPtr cloud, int numberOfThreads)
+  {
+    BenchmarkCase::Setup(cloud, numberOfThreads);
+    this->Tree.reset(new pcl::search::KdTree<pcl::PointXYZ>);
+    this->Tree->setInputCloud(cloud);
+    this->Normals.reset(new pcl::PointCloud<pcl::Normal>);
+    pcl::NormalEstimationOMP<pcl::PointXYZ, pcl::Normal> estimation(numberOfThreads);
+    estimation.setInputCloud(cloud);
+    estimation.setSearchMethod(this->Tree);
+    estimation.setKSearch(16);
+    estimation.compute(*this->Normals);
+  }
+
+  virtual void Execute()
+  {
+    pcl::FPFHEstimationOMP<pcl::PointXYZ, pcl::Normal, pcl::FPFHSignature33> estimation(this->NumberOfThreads);
+    estimation.setInputCloud(this->Cloud);
+    estimation.setInputNormals(this->Normals);
+    estimation.setSearchMethod(this->Tree);
+    estimation.setKSearch(16);
+    estimation.compute(this->Features);
+  }
+
+private:
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr Tree;
+  pcl::PointCloud<pcl::Normal>::Ptr Normals;
+  pcl::PointCloud<pcl::FPFHSignature33> Features;
+};
+
+//----------------------------------------------------------------------------
+class SACSegmentationCase : public BenchmarkCase
+{
+public:
+  SACSegmentationCase() : BenchmarkCase("sac_segmentation_plane", VTK_LARGE_ID) {}
+
+  virtual void Execute()
+  {
+    pcl::SACSegmentation<pcl::PointXYZ> segmentation;
+    segmentation.setModelType(pcl::SACMODEL_PLANE);
+    segmentation.setMethodType(pcl::SAC_RANSAC);
+    segmentation.setDistanceThreshold(0.01);
+    segmentation.setMaxIterations(200);
+    segmentation.setInputCloud(this->Cloud);
+    segmentation.segment(this->Inliers, this->Coefficients);
+  }
+
+private:
+  pcl::PointIndices Inliers;
+  pcl::ModelCoefficients Coefficients;
+};
+
+//----------------------------------------------------------------------------
+class EuclideanClusterCase : public BenchmarkCase
+{
+public:
+  EuclideanClusterCase() : BenchmarkCase("euclidean_cluster_extraction", 1000000) {}
+
+  virtual void Setup(CloudType::ConstPtr cloud, int numberOfThreads)
+  {
+    BenchmarkCase::Setup(cloud, numberOfThreads);
+    this->Tree.reset(new pcl::search::KdTree<pcl::PointXYZ>);
+    this->Tree->setInputCloud(cloud);
+  }
+
+  virtual void Execute()
+  {
+    pcl::EuclideanClusterExtraction<pcl::PointXYZ> extraction;
+    extraction.setClusterTolerance(0.03);
+    extraction.setMinClusterSize(100);
+    extraction.setSearchMethod(this->Tree);
+    extraction.setInputCloud(this->Cloud);
+    this->Clusters.clear();
+    extraction.extract(this->Clusters);
+  }
+
+private:
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr Tree;
+  std::vector<pcl::PointIndices> Clusters;
+};
+
+//----------------------------------------------------------------------------
+// Aligns the cloud with a copy of itself, moved by 2 degrees around the
+// vertical axis and 2cm sideways.
+class RegistrationCase : public BenchmarkCase
+{
+public:
+  RegistrationCase(const char* name, bool useNDT)
+    : BenchmarkCase(name, 100000), UseNDT(useNDT) {}
+
+  virtual void Setup(CloudType::ConstPtr cloud, int numberOfThreads)
+  {
+    BenchmarkCase::Setup(cloud, numberOfThreads);
+    Eigen::Affine3f transform = Eigen::Affine3f::Identity();
+    transform.rotate(Eigen::AngleAxisf(0.035f, Eigen::Vector3f::UnitZ()));
+    transform.translation() << 0.02f, 0.0f, 0.0f;
+    this->Source.reset(new CloudType);
+    pcl::transformPointCloud(*cloud, *this->Source, transform);
+  }
+
+  virtual void Execute()
+  {
+    if (this->UseNDT)
+      {
+      pcl::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ> ndt;
+      ndt.setResolution(0.5f);
+      ndt.setStepSize(0.1);
+      ndt.setTransformationEpsilon(1e-4);
+      this->Align(ndt);
+      }
+    else
+      {
+      pcl::IterativeClosestPoint<pcl::PointXYZ, pcl::PointXYZ> icp;
+      icp.setMaxCorrespondenceDistance(0.1);
+      icp.setTransformationEpsilon(1e-8);
+      this->Align(icp);
+      }
+  }
+
+private:
+  void Align(pcl::Registration<pcl::PointXYZ, pcl::PointXYZ>& registration)
+  {
+    registration.setMaximumIterations(20);
+    registration.setInputCloud(this->Source);
+    registration.setInputTarget(this->Cloud);
+    registration.align(this->Output);
+  }
+
+  bool UseNDT;
+  CloudType::Ptr Source;
+  CloudType Output;
+};
+
+//----------------------------------------------------------------------------
+std::vector<BenchmarkCase*> NewBenchmarkCases()
+{
+  std::vector<BenchmarkCase*> cases;
+  cases.push_back(new VoxelGridCase);
+  cases.push_back(new SearchBuildCase("kdtree_flann_build",
+    pcl::search::Search<pcl::PointXYZ>::Ptr(new pcl::search::KdTree<pcl::PointXYZ>(false))));
+  cases.push_back(new SearchCase("kdtree_flann_knn",
+    pcl::search::Search<pcl::PointXYZ>::Ptr(new pcl::search::KdTree<pcl::PointXYZ>(false)), false));
+  cases.push_back(new SearchBuildCase("octree_build",
+    pcl::search::Search<pcl::PointXYZ>::Ptr(new pcl::search::Octree<pcl::PointXYZ>(0.05))));
+  cases.push_back(new SearchCase("octree_knn",
+    pcl::search::Search<pcl::PointXYZ>::Ptr(new pcl::search::Octree<pcl::PointXYZ>(0.05)), false));
+  cases.push_back(new SearchCase("organized_neighbor_knn",
+    pcl::search::Search<pcl::PointXYZ>::Ptr(new pcl::search::OrganizedNeighbor<pcl::PointXYZ>(false)), true));
+  cases.push_back(new NormalEstimationCase("normal_estimation", false));
+  cases.push_back(new NormalEstimationCase("normal_estimation_omp", true));
+  cases.push_back(new FPFHCase);
+  cases.push_back(new SACSegmentationCase);
+  cases.push_back(new EuclideanClusterCase);
+  cases.push_back(new RegistrationCase("icp", false));
+  cases.push_back(new RegistrationCase("ndt", true));
+  return cases;
+}
+
+//----------------------------------------------------------------------------
+// Nearest rank percentile of sorted values.
+double Percentile(const std::vector<double>& sortedValues, double percent)
+{
+  size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * sortedValues.size()));
+  rank = std::min(std::max(rank, static_cast<size_t>(1)), sortedValues.size());
+  return sortedValues[rank - 1];
+}
+
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkPCLBenchmark);
+
+//----------------------------------------------------------------------------
+vtkPCLBenchmark::vtkPCLBenchmark()
+{
+  this->MinimumNumberOfPoints = 10000;
+  this->MaximumNumberOfPoints = 1000000;
+  this->NumberOfRepetitions = 5;
+  this->NumberOfThreads = 1;
+}
+
+//----------------------------------------------------------------------------
+vtkPCLBenchmark::~vtkPCLBenchmark()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkPCLBenchmark::Run(ostream& os)
+{
+  pcl::ProfilingRegistry& registry = pcl::ProfilingRegistry::getInstance();
+  const bool profilingEnabled = registry.isEnabled();
+  registry.clear();
+  registry.setEnabled(true);
+
+  std::vector<vtkIdType> sizes;
+  for (vtkIdType size = this->MinimumNumberOfPoints; size > 0 && size < this->MaximumNumberOfPoints; size *= 10)
+    {
+    sizes.push_back(size);
+    }
+  sizes.push_back(this->MaximumNumberOfPoints);
+
+  const int repetitions = std::max(1, this->NumberOfRepetitions);
+  bool first = true;
+  os << "{\n\"threads\": " << this->NumberOfThreads << ",\n\"benchmarks\": [";
+
+  for (size_t s = 0; s < sizes.size(); ++s)
+    {
+    for (int organized = 1; organized >= 0; --organized)
+      {
+      CloudType::ConstPtr cloud = organized ? NewOrganizedCloud(sizes[s]) : NewUnorganizedCloud(sizes[s]);
+      std::vector<BenchmarkCase*> cases = NewBenchmarkCases();
+
+      for (size_t c = 0; c < cases.size(); ++c)
+        {
+        BenchmarkCase* benchmarkCase = cases[c];
+        if (!benchmarkCase->Supports(*cloud))
+          {
+          continue;
+          }
+        benchmarkCase->Setup(cloud, this->NumberOfThreads);
+
+        std::ostringstream profileName;
+        profileName << benchmarkCase->GetName() << "/" << cloud->size() << (organized ? "/organized" : "");
+
+        std::vector<double> latencies(repetitions);
+        for (int r = 0; r < repetitions; ++r)
+          {
+          const size_t startMemory = pcl::ProfilingRegistry::getPeakMemory();
+          const double start = pcl::ProfilingRegistry::getMonotonicTime();
+          benchmarkCase->Execute();
+          latencies[r] = pcl::ProfilingRegistry::getMonotonicTime() - start;
+
+          // The profile reports the same measurement as the benchmarks array
+          pcl::ProfilingRecord sample;
+          sample.name = profileName.str();
+          sample.total_time = sample.max_time = latencies[r];
+          sample.points_in = cloud->size();
+          sample.points_out = benchmarkCase->GetNumberOfItems();
+          const size_t endMemory = pcl::ProfilingRegistry::getPeakMemory();
+          sample.peak_memory_growth = endMemory > startMemory ? endMemory - startMemory : 0;
+          registry.record(sample);
+          }
+        std::sort(latencies.begin(), latencies.end());
+        const double median = Percentile(latencies, 50.0);
+
+        os << (first ? "\n" : ",\n")
+           << "  {\"name\": \"" << benchmarkCase->GetName() << "\""
+           << ", \"points\": " << cloud->size()
+           << ", \"organized\": " << (organized ? "true" : "false")
+           << ", \"items\": " << benchmarkCase->GetNumberOfItems()
+           << ", \"repetitions\": " << repetitions
+           << ", \"latency_ms\": {\"min\": " << latencies.front()
+           << ", \"p50\": " << median
+           << ", \"max\": " << latencies.back() << "}"
+           << ", \"items_per_second\": " << (median > 0.0 ? benchmarkCase->GetNumberOfItems() * 1000.0 / median : 0.0)
+           << ", \"peak_rss_bytes\": " << pcl::ProfilingRegistry::getPeakMemory() << "}";
+        os.flush();
+        first = false;
+        }
+
+      for (size_t c = 0; c < cases.size(); ++c)
+        {
+        delete cases[c];
+        }
+      }
+    }
+
+  os << "\n],\n\"profile\": ";
+  registry.writeJSON(os);
+  os << "}\n";
+
+  registry.setEnabled(profilingEnabled);
+}
+
+//----------------------------------------------------------------------------
+void vtkPCLBenchmark::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+  os << indent << "MinimumNumberOfPoints: " << this->MinimumNumberOfPoints << endl;
+  os << indent << "MaximumNumberOfPoints: " << this->MaximumNumberOfPoints << endl;
+  os << indent << "NumberOfRepetitions: " << this->NumberOfRepetitions << endl;
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << endl;
+}
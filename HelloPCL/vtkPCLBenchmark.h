@@ -0,0 +1,83 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkPCLBenchmark.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkPCLBenchmark - benchmark suite for the pointcloud library routines
+// .SECTION Description
+// Runs deterministic synthetic clouds through filtering, neighbor search,
+// feature estimation, segmentation and registration, and writes the results
+// as JSON. Cloud sizes start at MinimumNumberOfPoints and grow by a factor of
+// ten up to MaximumNumberOfPoints, where the last step may be smaller
+// (10k, 100k, 1M, 10M, 50M with the largest maximum). Every size is run as an
+// organized depth image and as an unorganized cloud.
+//
+// Every case is timed NumberOfRepetitions times on a monotonic clock and
+// reports the minimum, median and maximum latency, the throughput in points
+// per second at the median latency and the peak resident set size of the
+// process. Higher percentiles are left out, with a handful of repetitions
+// they would only repeat the maximum. Expensive cases (FPFH,
+// clustering, ICP, NDT) are skipped for clouds larger than their own limit.
+
+#ifndef __vtkPCLBenchmark_h
+#define __vtkPCLBenchmark_h
+
+#include <vtk/vtkObject.h>
+
+
+class vtkPCLBenchmark : public vtkObject
+{
+public:
+  vtkTypeMacro(vtkPCLBenchmark, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  static vtkPCLBenchmark *New();
+
+  // Description:
+  // Number of points of the smallest and of the largest clouds.
+  vtkSetMacro(MinimumNumberOfPoints, vtkIdType);
+  vtkGetMacro(MinimumNumberOfPoints, vtkIdType);
+  vtkSetMacro(MaximumNumberOfPoints, vtkIdType);
+  vtkGetMacro(MaximumNumberOfPoints, vtkIdType);
+
+  // Description:
+  // Number of timed runs of every case.
+  vtkSetMacro(NumberOfRepetitions, int);
+  vtkGetMacro(NumberOfRepetitions, int);
+
+  // Description:
+  // Number of threads of the OpenMP algorithms.
+  vtkSetMacro(NumberOfThreads, int);
+  vtkGetMacro(NumberOfThreads, int);
+
+  // Description:
+  // Run all cases and write the results to os as a JSON object with a
+  // "benchmarks" array, followed by the pcl::ProfilingRegistry records of
+  // the run in "profile", one per case, cloud size and layout.
+  void Run(ostream& os);
+
+protected:
+
+  vtkIdType MinimumNumberOfPoints;
+  vtkIdType MaximumNumberOfPoints;
+  int NumberOfRepetitions;
+  int NumberOfThreads;
+
+  vtkPCLBenchmark();
+  virtual ~vtkPCLBenchmark();
+
+private:
+  vtkPCLBenchmark(const vtkPCLBenchmark&);  // Not implemented.
+  void operator=(const vtkPCLBenchmark&);  // Not implemented.
+};
+
+#endif
@@ -28,6 +28,10 @@
 #include <vtk/vtkPointData.h>
 
 #include <pcl/pcl/io/pcd_io.h>
+#include <pcl/pcl/search/kdtree.h>
+#include <pcl/pcl/features/normal_3d_omp.h>
+#include <pcl/pcl/features/normal_3d_batch.h>
+#include <pcl/pcl/features/impl/normal_3d_batch.hpp>
 
 #include <cassert>
 
@@ -347,6 +351,72 @@ void vtkPCLConversions::PerformPointCloudConversionBenchmark(vtkPolyData* polyDa
             << kilobytes*1024 / numberOfPoints << " bytes per point." << std::endl;
 }
 
+//----------------------------------------------------------------------------
+void vtkPCLConversions::PerformNormalEstimationBenchmark(vtkPolyData* polyData,
+  int numberOfThreads, int numberOfNeighbors)
+{
+  if (!polyData)
+    {
+    return;
+    }
+
+  double start;
+  double elapsed;
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = PointCloudFromPolyData(polyData);
+  const size_t numberOfPoints = cloud->size();
+  std::cout << "Number of input points: " << numberOfPoints << ", threads: "
+            << numberOfThreads << ", neighbors: " << numberOfNeighbors << std::endl;
+
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr tree(new pcl::search::KdTree<pcl::PointXYZ>);
+  tree->setInputCloud(cloud);
+
+  pcl::PointCloud<pcl::Normal> ompNormals;
+  pcl::NormalEstimationOMP<pcl::PointXYZ, pcl::Normal> ompEstimation(numberOfThreads);
+  ompEstimation.setInputCloud(cloud);
+  ompEstimation.setSearchMethod(tree);
+  ompEstimation.setKSearch(numberOfNeighbors);
+
+  start = vtkTimerLog::GetUniversalTime();
+  ompEstimation.compute(ompNormals);
+  elapsed = vtkTimerLog::GetUniversalTime() - start;
+
+  std::cout << "NormalEstimationOMP took " << elapsed << " seconds. "
+            << numberOfPoints / elapsed << " points per second." << std::endl;
+
+  pcl::PointCloud<pcl::Normal> batchNormals;
+  pcl::NormalEstimationBatch<pcl::PointXYZ, pcl::Normal> batchEstimation(numberOfThreads);
+  batchEstimation.setInputCloud(cloud);
+  batchEstimation.setSearchMethod(tree);
+  batchEstimation.setKSearch(numberOfNeighbors);
+
+  start = vtkTimerLog::GetUniversalTime();
+  batchEstimation.compute(batchNormals);
+  elapsed = vtkTimerLog::GetUniversalTime() - start;
+
+  std::cout << "NormalEstimationBatch took " << elapsed << " seconds. "
+            << numberOfPoints / elapsed << " points per second." << std::endl;
+
+  // Both estimators orient towards the same viewpoint, so the normals should
+  // agree up to floating point rounding or nearly degenerate neighborhoods.
+  size_t numberOfDeviations = 0;
+  for (size_t i = 0; i < numberOfPoints; ++i)
+    {
+    const pcl::Normal& a = ompNormals.points[i];
+    const pcl::Normal& b = batchNormals.points[i];
+    if (!pcl_isfinite(a.normal_x) || !pcl_isfinite(b.normal_x))
+      {
+      continue;
+      }
+    if (a.normal_x*b.normal_x + a.normal_y*b.normal_y + a.normal_z*b.normal_z < 0.999f)
+      {
+      ++numberOfDeviations;
+      }
+    }
+
+  std::cout << numberOfDeviations << " normals deviate by more than 2.5 degrees." << std::endl;
+}
+
 //----------------------------------------------------------------------------
 namespace {
 
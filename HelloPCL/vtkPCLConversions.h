@@ -65,6 +65,12 @@ public:
 
   static void PerformPointCloudConversionBenchmark(vtkPolyData* polyData);
 
+  // Description:
+  // Compares normal estimation throughput of NormalEstimationOMP and the
+  // batched normal kernel at the same number of threads.
+  static void PerformNormalEstimationBenchmark(vtkPolyData* polyData,
+    int numberOfThreads = 1, int numberOfNeighbors = 16);
+
 protected:
 
   vtkPCLConversions();
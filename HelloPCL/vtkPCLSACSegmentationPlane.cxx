@@ -17,6 +17,8 @@
 
 #include <vtk/vtkPolyData.h>
 #include <vtk/vtkPointData.h>
+#include <vtk/vtkFieldData.h>
+#include <vtk/vtkDoubleArray.h>
 #include <vtk/vtkInformation.h>
 #include <vtk/vtkInformationVector.h>
 #include <vtk/vtkObjectFactory.h>
@@ -28,6 +30,7 @@
 #include <pcl/pcl/sample_consensus/method_types.h>
 #include <pcl/pcl/sample_consensus/model_types.h>
 #include <pcl/pcl/segmentation/sac_segmentation.h>
+#include <pcl/pcl/segmentation/impl/sac_segmentation.hpp>
 
 //----------------------------------------------------------------------------
 namespace {
@@ -52,16 +55,16 @@ void ComputeSACSegmentationLine(pcl::PointCloud<pcl::PointXYZ>::ConstPtr cloud,
   seg.segment(*inliers, *modelCoefficients);
 }
 
-void ComputeSACSegmentationPlane(pcl::PointCloud<pcl::PointXYZ>::ConstPtr cloud,
-                                  double distanceThreshold,
-                                  int maxIterations,
-                                  pcl::ModelCoefficients::Ptr &modelCoefficients,
-                                  pcl::PointIndices::Ptr &inliers)
+void ComputeSACSegmentationPlanes(pcl::PointCloud<pcl::PointXYZ>::ConstPtr cloud,
+                                   double distanceThreshold,
+                                   int maxIterations,
+                                   int maxPlanes,
+                                   int minInliers,
+                                   std::vector<pcl::ModelCoefficients> &modelCoefficients,
+                                   std::vector<pcl::PointIndices> &inliers)
 {
 
   pcl::SACSegmentation<pcl::PointXYZ> seg;
-  inliers = pcl::PointIndices::Ptr(new pcl::PointIndices);
-  modelCoefficients = pcl::ModelCoefficients::Ptr(new pcl::ModelCoefficients);
 
   seg.setOptimizeCoefficients (true);
   seg.setModelType(pcl::SACMODEL_PLANE);
@@ -70,21 +73,21 @@ void ComputeSACSegmentationPlane(pcl::PointCloud<pcl::PointXYZ>::ConstPtr cloud,
   seg.setDistanceThreshold(distanceThreshold);
 
   seg.setInputCloud(cloud);
-  seg.segment(*inliers, *modelCoefficients);
+  seg.segment(maxPlanes, minInliers, inliers, modelCoefficients);
 }
 
-void ComputeSACSegmentationPerpendicularPlane(pcl::PointCloud<pcl::PointXYZ>::ConstPtr cloud,
+void ComputeSACSegmentationPerpendicularPlanes(pcl::PointCloud<pcl::PointXYZ>::ConstPtr cloud,
                                   double distanceThreshold,
                                   const Eigen::Vector3f& perpendicularAxis,
                                   double angleEpsilon,
                                   int maxIterations,
-                                  pcl::ModelCoefficients::Ptr &modelCoefficients,
-                                  pcl::PointIndices::Ptr &inliers)
+                                  int maxPlanes,
+                                  int minInliers,
+                                  std::vector<pcl::ModelCoefficients> &modelCoefficients,
+                                  std::vector<pcl::PointIndices> &inliers)
 {
 
   pcl::SACSegmentation<pcl::PointXYZ> seg;
-  inliers = pcl::PointIndices::Ptr(new pcl::PointIndices);
-  modelCoefficients = pcl::ModelCoefficients::Ptr(new pcl::ModelCoefficients);
 
   seg.setOptimizeCoefficients (true);
   seg.setModelType(pcl::SACMODEL_PERPENDICULAR_PLANE);
@@ -95,7 +98,7 @@ void ComputeSACSegmentationPerpendicularPlane(pcl::PointCloud<pcl::PointXYZ>::Co
   seg.setEpsAngle(angleEpsilon);
 
   seg.setInputCloud(cloud);
-  seg.segment(*inliers, *modelCoefficients);
+  seg.segment(maxPlanes, minInliers, inliers, modelCoefficients);
 }
 
 }
@@ -109,6 +112,9 @@ vtkPCLSACSegmentationPlane::vtkPCLSACSegmentationPlane()
 {
   this->DistanceThreshold = 0.05;
   this->MaxIterations = 200;
+  this->MaxNumberOfPlanes = 1;
+  this->MinPlaneInliers = 0;
+  this->NumberOfPlanes = 0;
 
   this->PlaneCoefficients[0] = 0.0;
   this->PlaneCoefficients[1] = 0.0;
@@ -143,13 +149,13 @@ int vtkPCLSACSegmentationPlane::RequestData(
   vtkPolyData *output = vtkPolyData::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
   // perform plane model fit
-  pcl::PointIndices::Ptr inlierIndices;
-  pcl::ModelCoefficients::Ptr modelCoefficients;
+  std::vector<pcl::PointIndices> inlierIndices;
+  std::vector<pcl::ModelCoefficients> modelCoefficients;
   pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = vtkPCLConversions::PointCloudFromPolyData(input);
 
   if (this->PerpendicularConstraintEnabled)
     {
-    ComputeSACSegmentationPerpendicularPlane(
+    ComputeSACSegmentationPerpendicularPlanes(
                                 cloud,
                                 this->DistanceThreshold,
                                 Eigen::Vector3f(this->PerpendicularAxis[0],
@@ -157,22 +163,38 @@ int vtkPCLSACSegmentationPlane::RequestData(
                                                 this->PerpendicularAxis[2]),
                                 this->AngleEpsilon,
                                 this->MaxIterations,
+                                this->MaxNumberOfPlanes,
+                                this->MinPlaneInliers,
                                 modelCoefficients,
                                 inlierIndices);
     }
   else
     {
-    ComputeSACSegmentationPlane(cloud,
-                                this->DistanceThreshold,
-                                this->MaxIterations,
-                                modelCoefficients,
-                                inlierIndices);
+    ComputeSACSegmentationPlanes(cloud,
+                                 this->DistanceThreshold,
+                                 this->MaxIterations,
+                                 this->MaxNumberOfPlanes,
+                                 this->MinPlaneInliers,
+                                 modelCoefficients,
+                                 inlierIndices);
     }
+  this->NumberOfPlanes = static_cast<int>(modelCoefficients.size());
 
   // store plane coefficients
-  for (size_t i = 0; i < modelCoefficients->values.size(); ++i)
+  vtkSmartPointer<vtkDoubleArray> allCoefficients = vtkSmartPointer<vtkDoubleArray>::New();
+  allCoefficients->SetName("ransac_plane_coefficients");
+  allCoefficients->SetNumberOfComponents(4);
+  allCoefficients->SetNumberOfTuples(this->NumberOfPlanes);
+  for (int plane = 0; plane < this->NumberOfPlanes; ++plane)
+    {
+    for (int i = 0; i < 4; ++i)
+      {
+      allCoefficients->SetComponent(plane, i, modelCoefficients[plane].values[i]);
+      }
+    }
+  for (int i = 0; i < 4; ++i)
     {
-    this->PlaneCoefficients[i] = modelCoefficients->values[i];
+    this->PlaneCoefficients[i] = this->NumberOfPlanes ? modelCoefficients[0].values[i] : 0.0;
     }
 
   // compute origin and normal
@@ -190,11 +212,12 @@ int vtkPCLSACSegmentationPlane::RequestData(
   plane->GetNormal(this->PlaneNormal);
 
 
-  // pass thru input add labels
+  // pass thru input add labels, the inliers of plane i are labeled i + 1
   vtkSmartPointer<vtkIntArray> labels = vtkPCLConversions::NewLabelsArray(inlierIndices, input->GetNumberOfPoints());
   labels->SetName("ransac_labels");
   output->ShallowCopy(input);
   output->GetPointData()->AddArray(labels);
+  output->GetFieldData()->AddArray(allCoefficients);
 
   return 1;
 }
@@ -36,6 +36,23 @@ public:
   vtkSetMacro(MaxIterations, int);
   vtkGetMacro(MaxIterations, int);
 
+  // Description:
+  // Maximum number of planes that are extracted one after another, each
+  // from the points that are left by the planes before it. Default is 1.
+  vtkSetMacro(MaxNumberOfPlanes, int);
+  vtkGetMacro(MaxNumberOfPlanes, int);
+
+  // Description:
+  // Extraction stops at the first plane with fewer inliers. Default is 0.
+  vtkSetMacro(MinPlaneInliers, int);
+  vtkGetMacro(MinPlaneInliers, int);
+
+  // Description:
+  // Number of planes found by the last update. The coefficients of all of
+  // them are stored in the "ransac_plane_coefficients" field data array of
+  // the output, the ones below describe the first plane.
+  vtkGetMacro(NumberOfPlanes, int);
+
   vtkGetVector4Macro(PlaneCoefficients, double);
   vtkGetVector3Macro(PlaneOrigin, double);
   vtkGetVector3Macro(PlaneNormal, double);
@@ -53,6 +70,9 @@ protected:
 
   double DistanceThreshold;
   int MaxIterations;
+  int MaxNumberOfPlanes;
+  int MinPlaneInliers;
+  int NumberOfPlanes;
 
   bool PerpendicularConstraintEnabled;
   double PerpendicularAxis[3];
@@ -0,0 +1,112 @@
+//
+//  FPFHEstimationOMPTests.mm
+//  HelloPCLTests
+//
+
+#import <XCTest/XCTest.h>
+
+#include <pcl/pcl/point_types.h>
+#include <pcl/pcl/search/kdtree.h>
+#include <pcl/pcl/features/fpfh_omp.h>
+#include <pcl/pcl/features/impl/fpfh.hpp>
+#include <pcl/pcl/features/impl/fpfh_omp.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+  typedef pcl::PointCloud<pcl::FPFHSignature33> FPFHCloud;
+
+  // Sample a smooth height field together with its analytic normals
+  void
+  fillSurface (pcl::PointCloud<pcl::PointXYZ> &cloud, pcl::PointCloud<pcl::Normal> &normals, unsigned side)
+  {
+    for (unsigned r = 0; r < side; ++r)
+      for (unsigned c = 0; c < side; ++c)
+      {
+        const float u = 0.02f * static_cast<float> (c), v = 0.02f * static_cast<float> (r);
+        pcl::PointXYZ p;
+        p.x = u;
+        p.y = v;
+        p.z = 0.1f * sinf (4.0f * u) * cosf (3.0f * v);
+
+        const Eigen::Vector3f n = Eigen::Vector3f (-0.4f * cosf (4.0f * u) * cosf (3.0f * v),
+                                                   0.3f * sinf (4.0f * u) * sinf (3.0f * v), 1.0f).normalized ();
+        pcl::Normal normal;
+        normal.normal_x = n[0];
+        normal.normal_y = n[1];
+        normal.normal_z = n[2];
+        cloud.push_back (p);
+        normals.push_back (normal);
+      }
+  }
+
+  // Largest difference between two sets of signatures
+  double
+  maxSignatureError (const FPFHCloud &a, const FPFHCloud &b)
+  {
+    if (a.size () != b.size ())
+      return (1e9);
+    double max_error = 0.0;
+    for (size_t i = 0; i < a.size (); ++i)
+      for (int d = 0; d < 33; ++d)
+        max_error = std::max (max_error, static_cast<double> (std::abs (a.points[i].histogram[d] - b.points[i].histogram[d])));
+    return (max_error);
+  }
+}
+
+@interface FPFHEstimationOMPTests : XCTestCase
+
+@end
+
+@implementation FPFHEstimationOMPTests
+
+- (void)testPermutedIndicesOverTheWholeSurface
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::PointCloud<pcl::Normal>::Ptr normals (new pcl::PointCloud<pcl::Normal>);
+  fillSurface (*cloud, *normals, 60);
+
+  // every surface point exactly once, but not in surface order
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int> (cloud->size ()));
+  for (size_t i = 0; i < indices->size (); ++i)
+    (*indices)[i] = static_cast<int> (indices->size () - 1 - i);
+  std::swap ((*indices)[0], (*indices)[indices->size () / 2]);
+
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr tree (new pcl::search::KdTree<pcl::PointXYZ>);
+
+  pcl::FPFHEstimation<pcl::PointXYZ, pcl::Normal, pcl::FPFHSignature33> fpfh;
+  fpfh.setInputCloud (cloud);
+  fpfh.setInputNormals (normals);
+  fpfh.setIndices (indices);
+  fpfh.setSearchMethod (tree);
+  fpfh.setKSearch (16);
+
+  pcl::FPFHEstimationOMP<pcl::PointXYZ, pcl::Normal, pcl::FPFHSignature33> fpfh_omp (2);
+  fpfh_omp.setInputCloud (cloud);
+  fpfh_omp.setInputNormals (normals);
+  fpfh_omp.setIndices (indices);
+  fpfh_omp.setSearchMethod (tree);
+  fpfh_omp.setKSearch (16);
+
+  FPFHCloud expected, permuted;
+  fpfh.compute (expected);
+  fpfh_omp.compute (permuted);
+  XCTAssertTrue (maxSignatureError (expected, permuted) < 1e-3);
+
+  // the identity shortcut still applies when no indices are given
+  FPFHCloud expected_all, all;
+  fpfh.setIndices (boost::shared_ptr<std::vector<int> > ());
+  fpfh.compute (expected_all);
+  pcl::FPFHEstimationOMP<pcl::PointXYZ, pcl::Normal, pcl::FPFHSignature33> fpfh_omp_all (2);
+  fpfh_omp_all.setInputCloud (cloud);
+  fpfh_omp_all.setInputNormals (normals);
+  fpfh_omp_all.setSearchMethod (tree);
+  fpfh_omp_all.setKSearch (16);
+  fpfh_omp_all.compute (all);
+  XCTAssertTrue (maxSignatureError (expected_all, all) < 1e-3);
+}
+
+@end
@@ -0,0 +1,246 @@
+//
+//  IntegralImage2DTests.mm
+//  HelloPCLTests
+//
+
+#import <XCTest/XCTest.h>
+
+#include <pcl/pcl/common/eigen.h>
+#include <pcl/pcl/point_types.h>
+#include <pcl/pcl/features/integral_image2D.h>
+#include <pcl/pcl/features/integral_image_normal.h>
+#include <pcl/pcl/features/impl/integral_image_normal.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+  // Fill a width x height frame of xyz elements with a smooth surface
+  void
+  fillFrame (std::vector<float> &frame, unsigned width, unsigned height)
+  {
+    frame.resize (width * height * 3);
+    for (unsigned r = 0; r < height; ++r)
+      for (unsigned c = 0; c < width; ++c)
+      {
+        float *p = &frame[(r * width + c) * 3];
+        p[2] = 1.5f + 0.3f * sinf (c * 0.05f) * cosf (r * 0.07f);
+        p[0] = (static_cast<float> (c) - 0.5f * width) * p[2] / 525.0f;
+        p[1] = (static_cast<float> (r) - 0.5f * height) * p[2] / 525.0f;
+      }
+  }
+
+  // Largest absolute coefficient of a vector valued or scalar sum
+  template <typename Derived> double
+  maxAbs (const Eigen::MatrixBase<Derived> &value)
+  {
+    return (static_cast<double> (value.cwiseAbs ().maxCoeff ()));
+  }
+
+  double
+  maxAbs (double value)
+  {
+    return (std::abs (value));
+  }
+
+  // Largest first and second order difference over all 5x5 windows between a streamed and a rebuilt image
+  template <unsigned Dimension> double
+  maxWindowError (const pcl::IntegralImage2D<float, Dimension> &streamed,
+                  const pcl::IntegralImage2D<float, Dimension> &rebuilt, unsigned width, unsigned height)
+  {
+    double max_error = 0.0;
+    for (unsigned y = 0; y + 5 <= height; ++y)
+      for (unsigned x = 0; x + 5 <= width; ++x)
+      {
+        max_error = std::max (max_error, maxAbs (streamed.getFirstOrderSum (x, y, 5, 5) - rebuilt.getFirstOrderSum (x, y, 5, 5)));
+        max_error = std::max (max_error, maxAbs (streamed.getSecondOrderSum (x, y, 5, 5) - rebuilt.getSecondOrderSum (x, y, 5, 5)));
+        if (streamed.getFiniteElementsCount (x, y, 5, 5) != rebuilt.getFiniteElementsCount (x, y, 5, 5))
+          max_error = std::max (max_error, 1.0);
+      }
+    return (max_error);
+  }
+
+  // Move the elements of the given rows of a frame towards the camera
+  void
+  moveRows (std::vector<float> &frame, unsigned width, unsigned first_row, unsigned nr_rows, float offset)
+  {
+    for (unsigned r = first_row; r < first_row + nr_rows; ++r)
+      for (unsigned c = 0; c < width; ++c)
+        frame[(r * width + c) * 3 + 2] -= offset;
+  }
+
+  // Copy a frame into an organized cloud
+  void
+  frameToCloud (const std::vector<float> &frame, unsigned width, unsigned height, pcl::PointCloud<pcl::PointXYZ> &cloud)
+  {
+    cloud.resize (width * height);
+    cloud.width = width;
+    cloud.height = height;
+    for (size_t i = 0; i < cloud.size (); ++i)
+      cloud.points[i].getVector3fMap () = Eigen::Vector3f (frame[i * 3], frame[i * 3 + 1], frame[i * 3 + 2]);
+  }
+
+  // Largest difference between two sets of normals, infinite if they disagree on which normals are valid
+  double
+  maxNormalError (const pcl::PointCloud<pcl::Normal> &a, const pcl::PointCloud<pcl::Normal> &b)
+  {
+    if (a.size () != b.size ())
+      return (std::numeric_limits<double>::infinity ());
+    double max_error = 0.0;
+    for (size_t i = 0; i < a.size (); ++i)
+    {
+      const bool finite = pcl_isfinite (a.points[i].normal_x);
+      if (finite != pcl_isfinite (b.points[i].normal_x))
+        return (std::numeric_limits<double>::infinity ());
+      if (finite)
+        max_error = std::max (max_error, static_cast<double> ((a.points[i].getNormalVector3fMap () - b.points[i].getNormalVector3fMap ()).cwiseAbs ().maxCoeff ()));
+    }
+    return (max_error);
+  }
+}
+
+@interface IntegralImage2DTests : XCTestCase
+
+@end
+
+@implementation IntegralImage2DTests
+
+- (void)testUpdateInputWithTransposedFrameSize
+{
+  const unsigned width = 97, height = 61;
+  std::vector<float> frame;
+
+  pcl::IntegralImage2D<float, 3> streamed (true), rebuilt (true);
+  pcl::IntegralImage2D<float, 1> streamed_depth (true), rebuilt_depth (true);
+
+  // the same buffer read as width x height, then as height x width: no element changes, only the shape
+  fillFrame (frame, width, height);
+  streamed.updateInput (&frame[0], width, height, 3, width * 3);
+  streamed_depth.updateInput (&frame[2], width, height, 3, width * 3);
+
+  streamed.updateInput (&frame[0], height, width, 3, height * 3);
+  streamed_depth.updateInput (&frame[2], height, width, 3, height * 3);
+  rebuilt.setInput (&frame[0], height, width, 3, height * 3);
+  rebuilt_depth.setInput (&frame[2], height, width, 3, height * 3);
+
+  XCTAssertTrue (maxWindowError (streamed, rebuilt, height, width) < 1e-6);
+  XCTAssertTrue (maxWindowError (streamed_depth, rebuilt_depth, height, width) < 1e-6);
+}
+
+- (void)testUpdateInputRecomputesOnlyTheChangedRows
+{
+  const unsigned width = 97, height = 61;
+  std::vector<float> frame;
+  fillFrame (frame, width, height);
+
+  pcl::IntegralImage2D<float, 3> streamed (true), rebuilt (true);
+  pcl::IntegralImage2D<float, 1> streamed_depth (true), rebuilt_depth (true);
+  XCTAssertEqual (streamed.updateInput (&frame[0], width, height, 3, width * 3), height);
+  XCTAssertEqual (streamed_depth.updateInput (&frame[2], width, height, 3, width * 3), height);
+
+  // an unchanged frame recomputes nothing
+  XCTAssertEqual (streamed.updateInput (&frame[0], width, height, 3, width * 3), 0u);
+
+  // two bands of moved rows, one of them turning an element non-finite
+  moveRows (frame, width, 10, 3, 0.05f);
+  moveRows (frame, width, 40, 1, 0.02f);
+  frame[(41 * width + 7) * 3 + 2] = std::numeric_limits<float>::quiet_NaN ();
+  XCTAssertEqual (streamed.updateInput (&frame[0], width, height, 3, width * 3), 5u);
+  XCTAssertEqual (streamed_depth.updateInput (&frame[2], width, height, 3, width * 3), 5u);
+
+  rebuilt.setInput (&frame[0], width, height, 3, width * 3);
+  rebuilt_depth.setInput (&frame[2], width, height, 3, width * 3);
+  XCTAssertTrue (maxWindowError (streamed, rebuilt, width, height) < 1e-6);
+  XCTAssertTrue (maxWindowError (streamed_depth, rebuilt_depth, width, height) < 1e-6);
+}
+
+- (void)testUpdateInputHonoursTheChangeThreshold
+{
+  const unsigned width = 97, height = 61;
+  std::vector<float> reference, frame;
+  fillFrame (reference, width, height);
+  frame = reference;
+
+  pcl::IntegralImage2D<float, 3> streamed (true), rebuilt (true);
+  streamed.setChangeThreshold (1e-3f);
+  streamed.updateInput (&frame[0], width, height, 3, width * 3);
+
+  // changes below the threshold keep the sums of the reference frame
+  moveRows (frame, width, 20, 4, 5e-4f);
+  XCTAssertEqual (streamed.updateInput (&frame[0], width, height, 3, width * 3), 0u);
+  rebuilt.setInput (&reference[0], width, height, 3, width * 3);
+  XCTAssertTrue (maxWindowError (streamed, rebuilt, width, height) < 1e-6);
+
+  // a change above the threshold recomputes its row from the current frame
+  moveRows (frame, width, 30, 1, 5e-3f);
+  XCTAssertEqual (streamed.updateInput (&frame[0], width, height, 3, width * 3), 1u);
+  for (unsigned c = 0; c < width; ++c)
+    reference[(30 * width + c) * 3 + 2] = frame[(30 * width + c) * 3 + 2];
+  rebuilt.setInput (&reference[0], width, height, 3, width * 3);
+  XCTAssertTrue (maxWindowError (streamed, rebuilt, width, height) < 1e-6);
+}
+
+- (void)testFixedPointSecondOrderSums
+{
+  const unsigned width = 97, height = 61;
+  const double resolution = 1e-5;
+  std::vector<float> frame;
+  fillFrame (frame, width, height);
+
+  pcl::IntegralImage2D<float, 3> streamed (true), fixed (true), rebuilt (true);
+  streamed.setSecondOrderFixedPoint (true, resolution);
+  fixed.setSecondOrderFixedPoint (true, resolution);
+  streamed.updateInput (&frame[0], width, height, 3, width * 3);
+
+  moveRows (frame, width, 5, 2, 0.03f);
+  XCTAssertEqual (streamed.updateInput (&frame[0], width, height, 3, width * 3), 2u);
+  fixed.setInput (&frame[0], width, height, 3, width * 3);
+  rebuilt.setInput (&frame[0], width, height, 3, width * 3);
+
+  // the row updates of the wrapped around fixed point sums are exact
+  XCTAssertTrue (maxWindowError (streamed, fixed, width, height) < 1e-9);
+  // every element of a 5x5 window is rounded to half the resolution at most
+  XCTAssertTrue (maxWindowError (streamed, rebuilt, width, height) < 25 * 0.5 * resolution + 1e-6);
+}
+
+- (void)testStreamedNormalsMatchARebuild
+{
+  const unsigned width = 80, height = 60;
+  std::vector<float> frame;
+  fillFrame (frame, width, height);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr first (new pcl::PointCloud<pcl::PointXYZ>), second (new pcl::PointCloud<pcl::PointXYZ>);
+  frameToCloud (frame, width, height, *first);
+  moveRows (frame, width, 25, 3, 0.01f);
+  frameToCloud (frame, width, height, *second);
+
+  const pcl::IntegralImageNormalEstimation<pcl::PointXYZ, pcl::Normal>::NormalEstimationMethod methods[] = {
+    pcl::IntegralImageNormalEstimation<pcl::PointXYZ, pcl::Normal>::COVARIANCE_MATRIX,
+    pcl::IntegralImageNormalEstimation<pcl::PointXYZ, pcl::Normal>::AVERAGE_3D_GRADIENT,
+    pcl::IntegralImageNormalEstimation<pcl::PointXYZ, pcl::Normal>::AVERAGE_DEPTH_CHANGE };
+  for (int m = 0; m < 3; ++m)
+  {
+    pcl::IntegralImageNormalEstimation<pcl::PointXYZ, pcl::Normal> streamed, rebuilt;
+    streamed.setNormalEstimationMethod (methods[m]);
+    rebuilt.setNormalEstimationMethod (methods[m]);
+    streamed.setNormalSmoothingSize (5.0f);
+    rebuilt.setNormalSmoothingSize (5.0f);
+
+    pcl::IntegralImageNormalStream stream;
+    pcl::PointCloud<pcl::Normal> streamed_normals, rebuilt_normals;
+    streamed.setInputCloud (first, stream);
+    streamed.compute (streamed_normals);
+    streamed.setInputCloud (second, stream);
+    streamed.compute (streamed_normals);
+    // only the moved rows, and for the gradients the rows next to them, are recomputed
+    XCTAssertTrue (stream.updated_rows > 0 && stream.updated_rows < height);
+
+    rebuilt.setInputCloud (second);
+    rebuilt.compute (rebuilt_normals);
+    XCTAssertTrue (maxNormalError (streamed_normals, rebuilt_normals) < 1e-4);
+  }
+}
+
+@end
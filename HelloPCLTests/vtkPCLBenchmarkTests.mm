@@ -0,0 +1,64 @@
+//
+//  vtkPCLBenchmarkTests.mm
+//  HelloPCLTests
+//
+
+#import <XCTest/XCTest.h>
+
+#include "../HelloPCL/vtkPCLBenchmark.h"
+
+#include <vtk/vtkSmartPointer.h>
+
+#include <sstream>
+#include <string>
+
+@interface vtkPCLBenchmarkTests : XCTestCase
+
+@end
+
+@implementation vtkPCLBenchmarkTests
+
+// Runs the benchmark suite and writes its JSON report to pcl_benchmark.json
+// in the temporary directory of the test host. The run is limited to the
+// smallest clouds unless the PCL_BENCHMARK_MAXIMUM_POINTS environment variable
+// of the test scheme asks for more, PCL_BENCHMARK_THREADS sets the number of
+// threads.
+- (void)testRunWritesJSONReport
+{
+  NSDictionary *environment = [[NSProcessInfo processInfo] environment];
+  NSString *maximumPoints = [environment objectForKey:@"PCL_BENCHMARK_MAXIMUM_POINTS"];
+  NSString *threads = [environment objectForKey:@"PCL_BENCHMARK_THREADS"];
+
+  vtkSmartPointer<vtkPCLBenchmark> benchmark = vtkSmartPointer<vtkPCLBenchmark>::New();
+  if (maximumPoints)
+    {
+    benchmark->SetMaximumNumberOfPoints([maximumPoints longLongValue]);
+    }
+  else
+    {
+    benchmark->SetMaximumNumberOfPoints(benchmark->GetMinimumNumberOfPoints());
+    benchmark->SetNumberOfRepetitions(3);
+    }
+  if (threads)
+    {
+    benchmark->SetNumberOfThreads([threads intValue]);
+    }
+
+  std::ostringstream report;
+  benchmark->Run(report);
+  const std::string json = report.str();
+
+  NSData *data = [NSData dataWithBytes:json.data() length:json.size()];
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"pcl_benchmark.json"];
+  XCTAssertTrue([data writeToFile:path atomically:YES]);
+  NSLog(@"Benchmark report written to %@", path);
+
+  NSError *error = nil;
+  id object = [NSJSONSerialization JSONObjectWithData:data options:0 error:&error];
+  XCTAssertNil(error);
+  XCTAssertTrue([object isKindOfClass:[NSDictionary class]]);
+  XCTAssertTrue([[object objectForKey:@"benchmarks"] count] > 0);
+  XCTAssertTrue([[object objectForKey:@"profile"] count] > 0);
+}
+
+@end
@@ -37,6 +37,7 @@
 #define PCL_COMMON_CENTROID_H_
 
 #include <pcl/pcl/point_cloud.h>
+#include <pcl/pcl/point_cloud_soa.h>
 #include <pcl/pcl/point_traits.h>
 #include <pcl/pcl/PointIndices.h>
 
@@ -53,25 +54,43 @@ namespace pcl
     * \brief Compute the 3D (X-Y-Z) centroid of a set of points and return it as a 3D vector.
     * \param[in] cloud the input point cloud
     * \param[out] centroid the output centroid
+    * \param[in] nr_threads the number of threads used for clouds of more than a few hundred points
+    * \return number of valid point used to determine the centroid. In case of dense point clouds, this is the same as the size of input cloud.
+    * \note if return value is 0, the centroid is not valid: it is not changed for an empty input and set to NaN
+    * when none of the points is finite.
+    * \ingroup common
+    */
+  template <typename PointT> inline unsigned int
+  compute3DCentroid (const pcl::PointCloud<PointT> &cloud, Eigen::Vector4f &centroid,
+                     unsigned int nr_threads = 1);
+
+  /**
+    * \brief Compute the 3D (X-Y-Z) centroid of a structure of arrays cloud, four points at a time.
+    * The lanes are summed in single precision over chunks of points and the chunks in double precision.
+    * \param[in] cloud the input point cloud
+    * \param[out] centroid the output centroid
     * \return number of valid point used to determine the centroid. In case of dense point clouds, this is the same as the size of input cloud.
     * \note if return value is 0, the centroid is not changed, thus not valid.
     * \ingroup common
     */
   template <typename PointT> inline unsigned int
-  compute3DCentroid (const pcl::PointCloud<PointT> &cloud, Eigen::Vector4f &centroid);
+  compute3DCentroid (const pcl::PointCloudSoA<PointT> &cloud, Eigen::Vector4f &centroid);
 
   /** \brief Compute the 3D (X-Y-Z) centroid of a set of points using their indices and
     * return it as a 3D vector.
     * \param[in] cloud the input point cloud
     * \param[in] indices the point cloud indices that need to be used
     * \param[out] centroid the output centroid
+    * \param[in] nr_threads the number of threads used for clouds of more than a few hundred points
     * \return number of valid point used to determine the centroid. In case of dense point clouds, this is the same as the size of input cloud.
-    * \note if return value is 0, the centroid is not changed, thus not valid.
+    * \note if return value is 0, the centroid is not valid: it is not changed for an empty input and set to NaN
+    * when none of the points is finite.
     * \ingroup common
     */
   template <typename PointT> inline unsigned int
   compute3DCentroid (const pcl::PointCloud<PointT> &cloud,
-                     const std::vector<int> &indices, Eigen::Vector4f &centroid);
+                     const std::vector<int> &indices, Eigen::Vector4f &centroid,
+                     unsigned int nr_threads = 1);
 
   /** \brief Compute the 3D (X-Y-Z) centroid of a set of points using their indices and
     * return it as a 3D vector.
@@ -79,7 +98,8 @@ namespace pcl
     * \param[in] indices the point cloud indices that need to be used
     * \param[out] centroid the output centroid
     * \return number of valid point used to determine the centroid. In case of dense point clouds, this is the same as the size of input cloud.
-    * \note if return value is 0, the centroid is not changed, thus not valid.
+    * \note if return value is 0, the centroid is not valid: it is not changed for an empty input and set to NaN
+    * when none of the points is finite.
     * \ingroup common
     */
   template <typename PointT> inline unsigned int
@@ -205,10 +225,13 @@ namespace pcl
     * Normalized means that every entry has been divided by the number of entries in indices.
     * For small number of points, or if you want explicitely the sample-variance, scale the covariance matrix
     * with n / (n-1), where n is the number of points used to calculate the covariance matrix and is returned by this function.
-    * \note This method is theoretically exact. However using float for internal calculations reduces the accuracy but increases the efficiency.
+    * \note The points are summed in float over chunks of a few hundred points, relative to a point of the chunk, and
+    * the chunks are merged in double with Welford's update, which keeps the result accurate for large clouds far from
+    * the origin.
     * \param[in] cloud the input point cloud
     * \param[out] covariance_matrix the resultant 3x3 covariance matrix
     * \param[out] centroid the centroid of the set of points in the cloud
+    * \param[in] nr_threads the number of threads used for clouds of more than a few hundred points
     * \return number of valid point used to determine the covariance matrix.
     * In case of dense point clouds, this is the same as the size of input cloud.
     * \ingroup common
@@ -216,17 +239,21 @@ namespace pcl
   template <typename PointT> inline unsigned int
   computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
                                   Eigen::Matrix3f &covariance_matrix,
-                                  Eigen::Vector4f &centroid);
+                                  Eigen::Vector4f &centroid,
+                                  unsigned int nr_threads = 1);
 
   /** \brief Compute the normalized 3x3 covariance matrix and the centroid of a given set of points in a single loop.
     * Normalized means that every entry has been divided by the number of entries in indices.
     * For small number of points, or if you want explicitely the sample-variance, scale the covariance matrix
     * with n / (n-1), where n is the number of points used to calculate the covariance matrix and is returned by this function.
-    * \note This method is theoretically exact. However using float for internal calculations reduces the accuracy but increases the efficiency.
+    * \note The points are summed in float over chunks of a few hundred points, relative to a point of the chunk, and
+    * the chunks are merged in double with Welford's update, which keeps the result accurate for large clouds far from
+    * the origin.
     * \param[in] cloud the input point cloud
     * \param[in] indices subset of points given by their indices
     * \param[out] covariance_matrix the resultant 3x3 covariance matrix
     * \param[out] centroid the centroid of the set of points in the cloud
+    * \param[in] nr_threads the number of threads used for clouds of more than a few hundred points
     * \return number of valid point used to determine the covariance matrix.
     * In case of dense point clouds, this is the same as the size of input cloud.
     * \ingroup common
@@ -235,13 +262,16 @@ namespace pcl
   computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
                                   const std::vector<int> &indices,
                                   Eigen::Matrix3f &covariance_matrix,
-                                  Eigen::Vector4f &centroid);
+                                  Eigen::Vector4f &centroid,
+                                  unsigned int nr_threads = 1);
 
   /** \brief Compute the normalized 3x3 covariance matrix and the centroid of a given set of points in a single loop.
     * Normalized means that every entry has been divided by the number of entries in indices.
     * For small number of points, or if you want explicitely the sample-variance, scale the covariance matrix
     * with n / (n-1), where n is the number of points used to calculate the covariance matrix and is returned by this function.
-    * \note This method is theoretically exact. However using float for internal calculations reduces the accuracy but increases the efficiency.
+    * \note The points are summed in float over chunks of a few hundred points, relative to a point of the chunk, and
+    * the chunks are merged in double with Welford's update, which keeps the result accurate for large clouds far from
+    * the origin.
     * \param[in] cloud the input point cloud
     * \param[in] indices subset of points given by their indices
     * \param[out] centroid the centroid of the set of points in the cloud
@@ -263,6 +293,7 @@ namespace pcl
     * \param[in] cloud the input point cloud
     * \param[out] covariance_matrix the resultant 3x3 covariance matrix
     * \param[out] centroid the centroid of the set of points in the cloud
+    * \param[in] nr_threads the number of threads used for clouds of more than a few hundred points
     * \return number of valid point used to determine the covariance matrix.
     * In case of dense point clouds, this is the same as the size of input cloud.
     * \ingroup common
@@ -270,7 +301,8 @@ namespace pcl
   template <typename PointT> inline unsigned int
   computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
                                   Eigen::Matrix3d &covariance_matrix,
-                                  Eigen::Vector4d &centroid);
+                                  Eigen::Vector4d &centroid,
+                                  unsigned int nr_threads = 1);
 
   /** \brief Compute the normalized 3x3 covariance matrix and the centroid of a given set of points in a single loop.
     * Normalized means that every entry has been divided by the number of entries in indices.
@@ -280,6 +312,7 @@ namespace pcl
     * \param[in] indices subset of points given by their indices
     * \param[out] covariance_matrix the resultant 3x3 covariance matrix
     * \param[out] centroid the centroid of the set of points in the cloud
+    * \param[in] nr_threads the number of threads used for clouds of more than a few hundred points
     * \return number of valid point used to determine the covariance matrix.
     * In case of dense point clouds, this is the same as the size of input cloud.
     * \ingroup common
@@ -288,7 +321,8 @@ namespace pcl
   computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
                                   const std::vector<int> &indices,
                                   Eigen::Matrix3d &covariance_matrix,
-                                  Eigen::Vector4d &centroid);
+                                  Eigen::Vector4d &centroid,
+                                  unsigned int nr_threads = 1);
 
   /** \brief Compute the normalized 3x3 covariance matrix and the centroid of a given set of points in a single loop.
     * Normalized means that every entry has been divided by the number of entries in indices.
@@ -50,6 +50,9 @@
 /*@{*/
 namespace pcl
 {
+  // Forward declaration, see pcl/point_cloud_soa.h. The point types include this header, so it can't be included here.
+  template <typename PointT> class PointCloudSoA;
+
   /** \brief Compute the smallest angle between two vectors in the [ 0, PI ) interval in 3D.
     * \param v1 the first 3D vector (represented as a \a Eigen::Vector4f)
     * \param v2 the second 3D vector (represented as a \a Eigen::Vector4f)
@@ -79,6 +82,18 @@ namespace pcl
   getPointsInBox (const pcl::PointCloud<PointT> &cloud, Eigen::Vector4f &min_pt,
                   Eigen::Vector4f &max_pt, std::vector<int> &indices);
 
+  /** \brief Get a set of points of a structure of arrays cloud residing in a box given its bounds, testing four
+    * points at a time
+    * \param cloud the point cloud
+    * \param min_pt the minimum bounds
+    * \param max_pt the maximum bounds
+    * \param indices the resultant set of point indices residing in the box
+    * \ingroup common
+    */
+  template <typename PointT> inline void 
+  getPointsInBox (const pcl::PointCloudSoA<PointT> &cloud, const Eigen::Vector4f &min_pt,
+                  const Eigen::Vector4f &max_pt, std::vector<int> &indices);
+
   /** \brief Get the point at maximum distance from a given point and a given pointcloud
     * \param cloud the point cloud data message
     * \param pivot_pt the point from where to compute the distance
@@ -103,31 +118,37 @@ namespace pcl
     * \param cloud the point cloud data message
     * \param min_pt the resultant minimum bounds
     * \param max_pt the resultant maximum bounds
+    * \param nr_threads the number of threads to use
     * \ingroup common
     */
   template <typename PointT> inline void 
-  getMinMax3D (const pcl::PointCloud<PointT> &cloud, PointT &min_pt, PointT &max_pt);
+  getMinMax3D (const pcl::PointCloud<PointT> &cloud, PointT &min_pt, PointT &max_pt,
+               unsigned int nr_threads = 1);
   
   /** \brief Get the minimum and maximum values on each of the 3 (x-y-z) dimensions in a given pointcloud
     * \param cloud the point cloud data message
     * \param min_pt the resultant minimum bounds
     * \param max_pt the resultant maximum bounds
+    * \param nr_threads the number of threads to use
     * \ingroup common
     */
   template <typename PointT> inline void 
   getMinMax3D (const pcl::PointCloud<PointT> &cloud, 
-               Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt);
+               Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt,
+               unsigned int nr_threads = 1);
 
   /** \brief Get the minimum and maximum values on each of the 3 (x-y-z) dimensions in a given pointcloud
     * \param cloud the point cloud data message
     * \param indices the vector of point indices to use from \a cloud
     * \param min_pt the resultant minimum bounds
     * \param max_pt the resultant maximum bounds
+    * \param nr_threads the number of threads to use
     * \ingroup common
     */
   template <typename PointT> inline void 
   getMinMax3D (const pcl::PointCloud<PointT> &cloud, const std::vector<int> &indices, 
-               Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt);
+               Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt,
+               unsigned int nr_threads = 1);
 
   /** \brief Get the minimum and maximum values on each of the 3 (x-y-z) dimensions in a given pointcloud
     * \param cloud the point cloud data message
@@ -166,6 +166,62 @@ namespace pcl
     return (std::sqrt (max_dist));
   }
 
+  /** \brief Obtain the maximum segment in a structure of arrays cloud, comparing four points at a time, and return
+    * the minimum and maximum points.
+    * \param[in] cloud the point cloud dataset
+    * \param[out] pmin the coordinates of the "minimum" point in \a cloud (one end of the segment)
+    * \param[out] pmax the coordinates of the "maximum" point in \a cloud (the other end of the segment)
+    * \return the length of segment length
+    * \ingroup common
+    */
+  template <typename PointT> double inline
+  getMaxSegment (const pcl::PointCloudSoA<PointT> &cloud, 
+                 PointT &pmin, PointT &pmax)
+  {
+    const float *x = cloud.getX (), *y = cloud.getY (), *z = cloud.getZ ();
+    const size_t n = cloud.size ();
+    double max_dist = std::numeric_limits<double>::min ();
+    int i_min = -1, i_max = -1;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+      // Find the largest distance of the row in four lanes over the whole blocks after i, then the remaining points
+      const size_t first_block = (i + 3) & ~static_cast<size_t> (3), end_block = n & ~static_cast<size_t> (3);
+      const Eigen::Array4f px (Eigen::Array4f::Constant (x[i])), py (Eigen::Array4f::Constant (y[i])),
+                           pz (Eigen::Array4f::Constant (z[i]));
+      Eigen::Array4f row_max (Eigen::Array4f::Zero ());
+      for (size_t j = first_block; j < end_block; j += 4)
+        row_max = row_max.max ((Eigen::Map<const Eigen::Array4f, Eigen::Aligned> (x + j) - px).square () +
+                               (Eigen::Map<const Eigen::Array4f, Eigen::Aligned> (y + j) - py).square () +
+                               (Eigen::Map<const Eigen::Array4f, Eigen::Aligned> (z + j) - pz).square ());
+      float row_dist = first_block < end_block ? row_max.maxCoeff () : 0.0f;
+      for (size_t j = i; j < std::min (first_block, n); ++j)
+        row_dist = std::max (row_dist, (x[i] - x[j]) * (x[i] - x[j]) + (y[i] - y[j]) * (y[i] - y[j]) + (z[i] - z[j]) * (z[i] - z[j]));
+      for (size_t j = std::max (first_block, end_block); j < n; ++j)
+        row_dist = std::max (row_dist, (x[i] - x[j]) * (x[i] - x[j]) + (y[i] - y[j]) * (y[i] - y[j]) + (z[i] - z[j]) * (z[i] - z[j]));
+      if (row_dist <= max_dist)
+        continue;
+
+      // The row holds a longer segment: find its first end point in order
+      for (size_t j = i; j < n; ++j)
+      {
+        double dist = (x[i] - x[j]) * (x[i] - x[j]) + (y[i] - y[j]) * (y[i] - y[j]) + (z[i] - z[j]) * (z[i] - z[j]);
+        if (dist <= max_dist)
+          continue;
+        max_dist = dist;
+        i_min = static_cast<int> (i);
+        i_max = static_cast<int> (j);
+      }
+    }
+
+    if (i_min == -1 || i_max == -1)
+      return (max_dist = std::numeric_limits<double>::min ());
+
+    cloud.getPoint (i_min, pmin);
+    cloud.getPoint (i_max, pmax);
+    return (std::sqrt (max_dist));
+  }
+
   /** \brief Calculate the squared euclidean distance between the two given points.
     * \param[in] p1 the first point
     * \param[in] p2 the second point
@@ -386,6 +386,102 @@ namespace pcl
       eigenvector = vec3 / Eigen::internal::sqrt (len3);
   }
 
+  /** \brief determine the smallest eigenvalue and its corresponding eigenvector of four symmetric positive semi
+    * definite 3x3 matrices at once, one matrix per lane. Each lane yields the same result as
+    * eigen33 (mat, eigenvalue, eigenvector).
+    * \param[in] c00 the (0,0) entries of the matrices
+    * \param[in] c01 the (0,1) entries of the matrices
+    * \param[in] c02 the (0,2) entries of the matrices
+    * \param[in] c11 the (1,1) entries of the matrices
+    * \param[in] c12 the (1,2) entries of the matrices
+    * \param[in] c22 the (2,2) entries of the matrices
+    * \param[out] eigenvalue the smallest eigenvalue of every matrix
+    * \param[out] nx the X components of the corresponding eigenvectors
+    * \param[out] ny the Y components of the corresponding eigenvectors
+    * \param[out] nz the Z components of the corresponding eigenvectors
+    * \ingroup common
+    */
+  inline void
+  eigen33 (const Eigen::Array4f &c00, const Eigen::Array4f &c01, const Eigen::Array4f &c02,
+           const Eigen::Array4f &c11, const Eigen::Array4f &c12, const Eigen::Array4f &c22,
+           Eigen::Array4f &eigenvalue, Eigen::Array4f &nx, Eigen::Array4f &ny, Eigen::Array4f &nz)
+  {
+    const Eigen::Array4f zero = Eigen::Array4f::Zero ();
+    const Eigen::Array4f one = Eigen::Array4f::Ones ();
+
+    // Scale the matrices so their entries are in [-1,1]
+    Eigen::Array4f scale = c00.abs ().max (c01.abs ()).max (c02.abs ()).max (c11.abs ()).max (c12.abs ()).max (c22.abs ());
+    scale = (scale <= Eigen::Array4f::Constant (std::numeric_limits<float>::min ())).select (one, scale);
+
+    const Eigen::Array4f m00 = c00 / scale, m01 = c01 / scale, m02 = c02 / scale;
+    const Eigen::Array4f m11 = c11 / scale, m12 = c12 / scale, m22 = c22 / scale;
+
+    // The characteristic equation is x^3 - c2*x^2 + c1*x - c0 = 0, see pcl::computeRoots
+    const Eigen::Array4f c0 = m00 * m11 * m22 + 2.0f * m01 * m02 * m12
+                            - m00 * m12 * m12 - m11 * m02 * m02 - m22 * m01 * m01;
+    const Eigen::Array4f c1 = m00 * m11 - m01 * m01 + m00 * m22 - m02 * m02 + m11 * m22 - m12 * m12;
+    const Eigen::Array4f c2 = m00 + m11 + m22;
+
+    const float s_inv3 = 1.0f / 3.0f;
+    const float s_sqrt3 = std::sqrt (3.0f);
+    const Eigen::Array4f c2_over_3 = c2 * s_inv3;
+    const Eigen::Array4f a_over_3 = ((c1 - c2 * c2_over_3) * s_inv3).min (zero);
+    const Eigen::Array4f half_b = 0.5f * (c0 + c2_over_3 * (2.0f * c2_over_3 * c2_over_3 - c1));
+    const Eigen::Array4f q = (half_b * half_b + a_over_3 * a_over_3 * a_over_3).min (zero);
+
+    // The packet sqrt of Eigen flushes arguments below epsilon to zero, which would destroy the small
+    // discriminants of nearly degenerate matrices, hence square roots and atan2 are taken per lane
+    Eigen::Array4f rho, theta;
+    for (int l = 0; l < 4; ++l)
+    {
+      rho[l] = std::sqrt (-a_over_3[l]);
+      theta[l] = std::atan2 (std::sqrt (-q[l]), half_b[l]) * s_inv3;
+    }
+    const Eigen::Array4f cos_theta = theta.cos ();
+    const Eigen::Array4f sin_theta = theta.sin ();
+
+    const Eigen::Array4f r0 = c2_over_3 + 2.0f * rho * cos_theta;
+    const Eigen::Array4f r1 = c2_over_3 - rho * (cos_theta + s_sqrt3 * sin_theta);
+    const Eigen::Array4f r2 = c2_over_3 - rho * (cos_theta - s_sqrt3 * sin_theta);
+    const Eigen::Array4f r_min = r0.min (r1).min (r2);
+
+    // A vanishing determinant or a non-positive root means the smallest eigenvalue of the (positive
+    // semi-definite) matrix is zero, as in the quadratic fallback of pcl::computeRoots
+    const Eigen::Array4f lambda = (c0.abs () < Eigen::Array4f::Constant (Eigen::NumTraits<float>::epsilon ()) ||
+                                   r_min <= zero).select (zero, r_min);
+    eigenvalue = lambda * scale;
+
+    // The eigenvector is the largest cross product of two rows of (M - lambda * I)
+    const Eigen::Array4f d00 = m00 - lambda, d11 = m11 - lambda, d22 = m22 - lambda;
+
+    const Eigen::Array4f v1x = m01 * m12 - m02 * d11;
+    const Eigen::Array4f v1y = m02 * m01 - d00 * m12;
+    const Eigen::Array4f v1z = d00 * d11 - m01 * m01;
+
+    const Eigen::Array4f v2x = m01 * d22 - m02 * m12;
+    const Eigen::Array4f v2y = m02 * m02 - d00 * d22;
+    const Eigen::Array4f v2z = d00 * m12 - m01 * m02;
+
+    const Eigen::Array4f v3x = d11 * d22 - m12 * m12;
+    const Eigen::Array4f v3y = m12 * m02 - m01 * d22;
+    const Eigen::Array4f v3z = m01 * m12 - d11 * m02;
+
+    const Eigen::Array4f len1 = v1x * v1x + v1y * v1y + v1z * v1z;
+    const Eigen::Array4f len2 = v2x * v2x + v2y * v2y + v2z * v2z;
+    const Eigen::Array4f len3 = v3x * v3x + v3y * v3y + v3z * v3z;
+
+    const Eigen::Array<bool, 4, 1> use1 = (len1 >= len2) && (len1 >= len3);
+    const Eigen::Array<bool, 4, 1> use2 = (len2 >= len3);
+
+    const Eigen::Array4f len = use1.select (len1, use2.select (len2, len3));
+    Eigen::Array4f inv_len;
+    for (int l = 0; l < 4; ++l)
+      inv_len[l] = 1.0f / std::sqrt (len[l]);
+    nx = use1.select (v1x, use2.select (v2x, v3x)) * inv_len;
+    ny = use1.select (v1y, use2.select (v2y, v3y)) * inv_len;
+    nz = use1.select (v1z, use2.select (v2z, v3z)) * inv_len;
+  }
+
   /** \brief determines the eigenvalues of the symmetric positive semi definite input matrix
     * \param[in] mat symmetric positive semi definite input matrix
     * \param[out] evals resulting eigenvalues in ascending order
@@ -40,83 +40,261 @@
 
 #include <pcl/pcl/ros/conversions.h>
 #include <boost/mpl/size.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+#include <limits>
 
-/////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointT> inline unsigned int
-pcl::compute3DCentroid (const pcl::PointCloud<PointT> &cloud, Eigen::Vector4f &centroid)
+namespace pcl
 {
-  if (cloud.points.empty ())
-    return (0);
-
-  // Initialize to 0
-  centroid.setZero ();
-  // For each point in the cloud
-  // If the data is dense, we don't need to check for NaN
-  if (cloud.is_dense)
+  namespace detail
   {
-    for (size_t i = 0; i < cloud.points.size (); ++i)
-      centroid += cloud.points[i].getVector4fMap ();
-    centroid[3] = 0;
-    centroid /= static_cast<float> (cloud.points.size ());
+    /** \brief Number of points whose moments are summed in float before they are merged in double. */
+    const size_t moments_chunk_size = 256;
 
-    return (static_cast<unsigned int> (cloud.points.size ()));
-  }
-  // NaN or Inf values could exist => check for them
-  else
-  {
-    unsigned cp = 0;
-    for (size_t i = 0; i < cloud.points.size (); ++i)
+    /** \brief Mean and scatter matrix (sum of the outer products of the deviations from the mean) of a set of points. */
+    struct PointMoments
     {
-      // Check if the point is invalid
-      if (!isFinite (cloud [i]))
-        continue;
+      PointMoments ()
+        : count (0)
+        , mean (Eigen::Vector3d::Zero ())
+        , scatter (Eigen::Matrix3d::Zero ())
+      {
+      }
+
+      /** \brief Add the moments of another, disjoint set of points (the parallel form of Welford's update by Chan et al.).
+        * \param[in] other the moments to add
+        */
+      inline void
+      merge (const PointMoments &other)
+      {
+        if (other.count == 0)
+          return;
+        if (count == 0)
+        {
+          *this = other;
+          return;
+        }
+        const double n_a = static_cast<double> (count), n_b = static_cast<double> (other.count);
+        const Eigen::Vector3d delta = other.mean - mean;
+        scatter += other.scatter + (n_a * n_b / (n_a + n_b)) * delta * delta.transpose ();
+        mean += delta * (n_b / (n_a + n_b));
+        count += other.count;
+      }
+
+      size_t count;
+      Eigen::Vector3d mean;
+      Eigen::Matrix3d scatter;
+    };
+
+    /** \brief Compute the moments of the points indices[begin] .. indices[end - 1] of a cloud. The sums are taken in
+      * float over packed points, relative to the first valid point of the range so that they do not cancel out for
+      * points far from the origin.
+      * \param[in] cloud the input point cloud
+      * \param[in] indices a random access iterator over the point indices
+      * \param[in] begin the first position in indices
+      * \param[in] end the position after the last one in indices
+      */
+    template <bool Scatter, typename PointT, typename IteratorT> PointMoments
+    computeChunkMoments (const pcl::PointCloud<PointT> &cloud, IteratorT indices, size_t begin, size_t end)
+    {
+      PointMoments moments;
+      size_t i = begin;
+      if (!cloud.is_dense)
+        while (i < end && !isFinite (cloud.points[indices[i]]))
+          ++i;
+      if (i == end)
+        return (moments);
+
+      const Eigen::Array4f shift = cloud.points[indices[i]].getArray4fMap ();
+      Eigen::Array4f s (Eigen::Array4f::Zero ()), sx (s), sy (s), sz (s);
+      size_t count = 0;
+      // If the data is dense, we don't need to check for NaN
+      if (cloud.is_dense)
+      {
+        for (; i < end; ++i)
+        {
+          const Eigen::Array4f d = cloud.points[indices[i]].getArray4fMap () - shift;
+          s += d;
+          if (Scatter)
+          {
+            sx += d * d[0];
+            sy += d * d[1];
+            sz += d * d[2];
+          }
+        }
+        count = end - begin;
+      }
+      // NaN or Inf values could exist => check for them
+      else
+      {
+        for (; i < end; ++i)
+        {
+          const PointT &p = cloud.points[indices[i]];
+          if (!isFinite (p))
+            continue;
+          const Eigen::Array4f d = p.getArray4fMap () - shift;
+          s += d;
+          if (Scatter)
+          {
+            sx += d * d[0];
+            sy += d * d[1];
+            sz += d * d[2];
+          }
+          ++count;
+        }
+      }
+
+      const double n = static_cast<double> (count);
+      const Eigen::Vector3d s1 (s[0], s[1], s[2]);
+      moments.count = count;
+      moments.mean = Eigen::Vector3d (shift[0], shift[1], shift[2]) + s1 / n;
+      if (Scatter)
+      {
+        moments.scatter << sx[0], sx[1], sx[2],
+                           sy[0], sy[1], sy[2],
+                           sz[0], sz[1], sz[2];
+        moments.scatter -= s1 * s1.transpose () / n;
+      }
+      return (moments);
+    }
 
-      centroid += cloud[i].getVector4fMap ();
-      ++cp;
+    /** \brief Compute the moments of the points indices[0] .. indices[nr_points - 1] of a cloud. The chunks are
+      * processed in parallel and merged pairwise in a fixed order, so the result does not depend on the number of threads.
+      * \param[in] cloud the input point cloud
+      * \param[in] indices a random access iterator over the point indices
+      * \param[in] nr_points the number of indices
+      * \param[in] nr_threads the number of threads to use
+      */
+    template <bool Scatter, typename PointT, typename IteratorT> PointMoments
+    computeMoments (const pcl::PointCloud<PointT> &cloud, IteratorT indices, size_t nr_points, unsigned int nr_threads)
+    {
+      const int nr_chunks = static_cast<int> ((nr_points + moments_chunk_size - 1) / moments_chunk_size);
+      if (nr_chunks <= 1)
+        return (computeChunkMoments<Scatter> (cloud, indices, 0, nr_points));
+
+      std::vector<PointMoments> chunks (nr_chunks);
+#pragma omp parallel for num_threads (nr_threads) schedule (static) if (nr_threads > 1)
+      for (int c = 0; c < nr_chunks; ++c)
+        chunks[c] = computeChunkMoments<Scatter> (cloud, indices, c * moments_chunk_size,
+                                                  std::min ((c + 1) * moments_chunk_size, nr_points));
+
+      for (int step = 1; step < nr_chunks; step *= 2)
+        for (int c = 0; c + step < nr_chunks; c += 2 * step)
+          chunks[c].merge (chunks[c + step]);
+      return (chunks[0]);
     }
-    centroid[3] = 0;
-    centroid /= static_cast<float> (cp);
 
-    return (cp);
+    /** \brief Write the centroid and the normalized covariance matrix of a set of points.
+      * \return the number of points
+      */
+    template <typename Scalar> inline unsigned int
+    getMeanAndCovarianceMatrix (const PointMoments &moments,
+                                Eigen::Matrix<Scalar, 3, 3> &covariance_matrix,
+                                Eigen::Matrix<Scalar, 4, 1> &centroid)
+    {
+      if (moments.count != 0)
+      {
+        centroid.template head<3> () = moments.mean.cast<Scalar> ();
+        centroid[3] = 0;
+        covariance_matrix = (moments.scatter / static_cast<double> (moments.count)).cast<Scalar> ();
+      }
+      return (static_cast<unsigned int> (moments.count));
+    }
+  } // namespace detail
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> inline unsigned int
+pcl::compute3DCentroid (const pcl::PointCloud<PointT> &cloud, Eigen::Vector4f &centroid,
+                        unsigned int nr_threads)
+{
+  const detail::PointMoments moments = detail::computeMoments<false> (
+      cloud, boost::counting_iterator<int> (0), cloud.points.size (), nr_threads);
+  if (moments.count != 0)
+  {
+    centroid.head<3> () = moments.mean.cast<float> ();
+    centroid[3] = 0;
   }
+  // Only invalid points, the average over zero points is undefined
+  else if (!cloud.points.empty ())
+    centroid.setConstant (std::numeric_limits<float>::quiet_NaN ());
+  return (static_cast<unsigned int> (moments.count));
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> inline unsigned int
-pcl::compute3DCentroid (const pcl::PointCloud<PointT> &cloud, const std::vector<int> &indices,
-                        Eigen::Vector4f &centroid)
+pcl::compute3DCentroid (const pcl::PointCloudSoA<PointT> &cloud, Eigen::Vector4f &centroid)
 {
-  if (indices.empty ())
+  const size_t chunk_size = 1024;
+  const size_t nr_points = cloud.size ();
+  const size_t nr_blocks = nr_points / 4 * 4;
+  const float *x = cloud.getX (), *y = cloud.getY (), *z = cloud.getZ ();
+
+  Eigen::Vector3d sum (Eigen::Vector3d::Zero ());
+  size_t cp = 0;
+  for (size_t chunk = 0; chunk < nr_blocks; chunk += chunk_size)
+  {
+    const size_t chunk_end = std::min (chunk + chunk_size, nr_blocks);
+    Eigen::Array4f sx (Eigen::Array4f::Zero ()), sy (Eigen::Array4f::Zero ()), sz (Eigen::Array4f::Zero ());
+    // If the data is dense, we don't need to check for NaN
+    if (cloud.is_dense)
+    {
+      for (size_t i = chunk; i < chunk_end; i += 4)
+      {
+        sx += Eigen::Map<const Eigen::Array4f, Eigen::Aligned> (x + i);
+        sy += Eigen::Map<const Eigen::Array4f, Eigen::Aligned> (y + i);
+        sz += Eigen::Map<const Eigen::Array4f, Eigen::Aligned> (z + i);
+      }
+      cp += chunk_end - chunk;
+    }
+    // NaN or Inf values could exist => mask them, x - x is 0 only for finite values
+    else
+    {
+      Eigen::Array4f sc (Eigen::Array4f::Zero ());
+      for (size_t i = chunk; i < chunk_end; i += 4)
+      {
+        Eigen::Map<const Eigen::Array4f, Eigen::Aligned> px (x + i), py (y + i), pz (z + i);
+        const Eigen::Array4f check = (px - px) + (py - py) + (pz - pz);
+        sx += (check == 0.0f).select (px, 0.0f);
+        sy += (check == 0.0f).select (py, 0.0f);
+        sz += (check == 0.0f).select (pz, 0.0f);
+        sc += (check == 0.0f).select (Eigen::Array4f::Ones (), 0.0f);
+      }
+      cp += static_cast<size_t> (sc.sum ());
+    }
+    sum += Eigen::Vector3d (sx.sum (), sy.sum (), sz.sum ());
+  }
+  for (size_t i = nr_blocks; i < nr_points; ++i)
+  {
+    if (!cloud.is_dense && (!pcl_isfinite (x[i]) || !pcl_isfinite (y[i]) || !pcl_isfinite (z[i])))
+      continue;
+    sum += Eigen::Vector3d (x[i], y[i], z[i]);
+    ++cp;
+  }
+
+  if (cp == 0)
     return (0);
+  sum /= static_cast<double> (cp);
+  centroid = Eigen::Vector4f (static_cast<float> (sum[0]), static_cast<float> (sum[1]), static_cast<float> (sum[2]), 0.0f);
+  return (static_cast<unsigned int> (cp));
+}
 
-  // Initialize to 0
-  centroid.setZero ();
-  // If the data is dense, we don't need to check for NaN
-  if (cloud.is_dense)
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> inline unsigned int
+pcl::compute3DCentroid (const pcl::PointCloud<PointT> &cloud, const std::vector<int> &indices,
+                        Eigen::Vector4f &centroid, unsigned int nr_threads)
+{
+  const detail::PointMoments moments = detail::computeMoments<false> (
+      cloud, indices.begin (), indices.size (), nr_threads);
+  if (moments.count != 0)
   {
-    for (size_t i = 0; i < indices.size (); ++i)
-      centroid += cloud.points[indices[i]].getVector4fMap ();
+    centroid.head<3> () = moments.mean.cast<float> ();
     centroid[3] = 0;
-    centroid /= static_cast<float> (indices.size ());
-    return (static_cast<unsigned int> (indices.size ()));
-  }
-  // NaN or Inf values could exist => check for them
-  else
-  {
-    unsigned cp = 0;
-    for (size_t i = 0; i < indices.size (); ++i)
-    {
-      // Check if the point is invalid
-      if (!isFinite (cloud [indices[i]]))
-        continue;
-
-      centroid += cloud[indices[i]].getVector4fMap ();
-      ++cp;
-    }
-    centroid[3] = 0.0f;
-    centroid /= static_cast<float> (cp);
-    return (cp);
   }
+  // Only invalid points, the average over zero points is undefined
+  else if (!indices.empty ())
+    centroid.setConstant (std::numeric_limits<float>::quiet_NaN ());
+  return (static_cast<unsigned int> (moments.count));
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -542,132 +720,25 @@ pcl::computeCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
 template <typename PointT> inline unsigned int
 pcl::computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
                                      Eigen::Matrix3f &covariance_matrix,
-                                     Eigen::Vector4f &centroid)
+                                     Eigen::Vector4f &centroid,
+                                     unsigned int nr_threads)
 {
-  // create the buffer on the stack which is much faster than using cloud.points[indices[i]] and centroid as a buffer
-  Eigen::Matrix<float, 1, 9, Eigen::RowMajor> accu = Eigen::Matrix<float, 1, 9, Eigen::RowMajor>::Zero ();
-  size_t point_count;
-  if (cloud.is_dense)
-  {
-    point_count = cloud.size ();
-    // For each point in the cloud
-    for (size_t i = 0; i < point_count; ++i)
-    {
-      accu [0] += cloud[i].x * cloud[i].x;
-      accu [1] += cloud[i].x * cloud[i].y;
-      accu [2] += cloud[i].x * cloud[i].z;
-      accu [3] += cloud[i].y * cloud[i].y; // 4
-      accu [4] += cloud[i].y * cloud[i].z; // 5
-      accu [5] += cloud[i].z * cloud[i].z; // 8
-      accu [6] += cloud[i].x;
-      accu [7] += cloud[i].y;
-      accu [8] += cloud[i].z;
-    }
-  }
-  else
-  {
-    point_count = 0;
-    for (size_t i = 0; i < cloud.points.size (); ++i)
-    {
-      if (!isFinite (cloud[i]))
-        continue;
-
-      accu [0] += cloud[i].x * cloud[i].x;
-      accu [1] += cloud[i].x * cloud[i].y;
-      accu [2] += cloud[i].x * cloud[i].z;
-      accu [3] += cloud[i].y * cloud[i].y;
-      accu [4] += cloud[i].y * cloud[i].z;
-      accu [5] += cloud[i].z * cloud[i].z;
-      accu [6] += cloud[i].x;
-      accu [7] += cloud[i].y;
-      accu [8] += cloud[i].z;
-      ++point_count;
-    }
-  }
-  accu /= static_cast<float> (point_count);
-  if (point_count != 0)
-  {
-    //centroid.head<3> () = accu.tail<3> ();    -- does not compile with Clang 3.0
-    centroid[0] = accu[6]; centroid[1] = accu[7]; centroid[2] = accu[8];
-    centroid[3] = 0;
-    covariance_matrix.coeffRef (0) = accu [0] - accu [6] * accu [6];
-    covariance_matrix.coeffRef (1) = accu [1] - accu [6] * accu [7];
-    covariance_matrix.coeffRef (2) = accu [2] - accu [6] * accu [8];
-    covariance_matrix.coeffRef (4) = accu [3] - accu [7] * accu [7];
-    covariance_matrix.coeffRef (5) = accu [4] - accu [7] * accu [8];
-    covariance_matrix.coeffRef (8) = accu [5] - accu [8] * accu [8];
-    covariance_matrix.coeffRef (3) = covariance_matrix.coeff (1);
-    covariance_matrix.coeffRef (6) = covariance_matrix.coeff (2);
-    covariance_matrix.coeffRef (7) = covariance_matrix.coeff (5);
-  }
-  return (static_cast<unsigned int> (point_count));
+  return (detail::getMeanAndCovarianceMatrix (
+      detail::computeMoments<true> (cloud, boost::counting_iterator<int> (0), cloud.points.size (), nr_threads),
+      covariance_matrix, centroid));
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> inline unsigned int
 pcl::computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
-                                const std::vector<int> &indices,
-                                Eigen::Matrix3f &covariance_matrix,
-                                Eigen::Vector4f &centroid)
+                                     const std::vector<int> &indices,
+                                     Eigen::Matrix3f &covariance_matrix,
+                                     Eigen::Vector4f &centroid,
+                                     unsigned int nr_threads)
 {
-  // create the buffer on the stack which is much faster than using cloud.points[indices[i]] and centroid as a buffer
-  Eigen::Matrix<float, 1, 9, Eigen::RowMajor> accu = Eigen::Matrix<float, 1, 9, Eigen::RowMajor>::Zero ();
-  size_t point_count;
-  if (cloud.is_dense)
-  {
-    point_count = indices.size ();
-    for (std::vector<int>::const_iterator iIt = indices.begin (); iIt != indices.end (); ++iIt)
-    {
-      //const PointT& point = cloud[*iIt];
-      accu [0] += cloud[*iIt].x * cloud[*iIt].x;
-      accu [1] += cloud[*iIt].x * cloud[*iIt].y;
-      accu [2] += cloud[*iIt].x * cloud[*iIt].z;
-      accu [3] += cloud[*iIt].y * cloud[*iIt].y;
-      accu [4] += cloud[*iIt].y * cloud[*iIt].z;
-      accu [5] += cloud[*iIt].z * cloud[*iIt].z;
-      accu [6] += cloud[*iIt].x;
-      accu [7] += cloud[*iIt].y;
-      accu [8] += cloud[*iIt].z;
-    }
-  }
-  else
-  {
-    point_count = 0;
-    for (std::vector<int>::const_iterator iIt = indices.begin (); iIt != indices.end (); ++iIt)
-    {
-      if (!isFinite (cloud[*iIt]))
-        continue;
-
-      ++point_count;
-      accu [0] += cloud[*iIt].x * cloud[*iIt].x;
-      accu [1] += cloud[*iIt].x * cloud[*iIt].y;
-      accu [2] += cloud[*iIt].x * cloud[*iIt].z;
-      accu [3] += cloud[*iIt].y * cloud[*iIt].y; // 4
-      accu [4] += cloud[*iIt].y * cloud[*iIt].z; // 5
-      accu [5] += cloud[*iIt].z * cloud[*iIt].z; // 8
-      accu [6] += cloud[*iIt].x;
-      accu [7] += cloud[*iIt].y;
-      accu [8] += cloud[*iIt].z;
-    }
-  }
-
-  accu /= static_cast<float> (point_count);
-  //Eigen::Vector3f vec = accu.tail<3> ();
-  //centroid.head<3> () = vec;//= accu.tail<3> ();
-  //centroid.head<3> () = accu.tail<3> ();    -- does not compile with Clang 3.0
-  centroid[0] = accu[6]; centroid[1] = accu[7]; centroid[2] = accu[8];
-  centroid[3] = 0;
-  covariance_matrix.coeffRef (0) = accu [0] - accu [6] * accu [6];
-  covariance_matrix.coeffRef (1) = accu [1] - accu [6] * accu [7];
-  covariance_matrix.coeffRef (2) = accu [2] - accu [6] * accu [8];
-  covariance_matrix.coeffRef (4) = accu [3] - accu [7] * accu [7];
-  covariance_matrix.coeffRef (5) = accu [4] - accu [7] * accu [8];
-  covariance_matrix.coeffRef (8) = accu [5] - accu [8] * accu [8];
-  covariance_matrix.coeffRef (3) = covariance_matrix.coeff (1);
-  covariance_matrix.coeffRef (6) = covariance_matrix.coeff (2);
-  covariance_matrix.coeffRef (7) = covariance_matrix.coeff (5);
-
-  return (static_cast<unsigned int> (point_count));
+  return (detail::getMeanAndCovarianceMatrix (
+      detail::computeMoments<true> (cloud, indices.begin (), indices.size (), nr_threads),
+      covariance_matrix, centroid));
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -684,132 +755,25 @@ pcl::computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
 template <typename PointT> inline unsigned int
 pcl::computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
                                      Eigen::Matrix3d &covariance_matrix,
-                                     Eigen::Vector4d &centroid)
+                                     Eigen::Vector4d &centroid,
+                                     unsigned int nr_threads)
 {
-  // create the buffer on the stack which is much faster than using cloud.points[indices[i]] and centroid as a buffer
-  Eigen::Matrix<double, 1, 9, Eigen::RowMajor> accu = Eigen::Matrix<double, 1, 9, Eigen::RowMajor>::Zero ();
-  unsigned int point_count;
-  if (cloud.is_dense)
-  {
-    point_count = cloud.size ();
-    // For each point in the cloud
-    for (size_t i = 0; i < point_count; ++i)
-    {
-      accu [0] += cloud[i].x * cloud[i].x;
-      accu [1] += cloud[i].x * cloud[i].y;
-      accu [2] += cloud[i].x * cloud[i].z;
-      accu [3] += cloud[i].y * cloud[i].y;
-      accu [4] += cloud[i].y * cloud[i].z;
-      accu [5] += cloud[i].z * cloud[i].z;
-      accu [6] += cloud[i].x;
-      accu [7] += cloud[i].y;
-      accu [8] += cloud[i].z;
-    }
-  }
-  else
-  {
-    point_count = 0;
-    for (size_t i = 0; i < cloud.points.size (); ++i)
-    {
-      if (!isFinite (cloud[i]))
-        continue;
-
-      accu [0] += cloud[i].x * cloud[i].x;
-      accu [1] += cloud[i].x * cloud[i].y;
-      accu [2] += cloud[i].x * cloud[i].z;
-      accu [3] += cloud[i].y * cloud[i].y;
-      accu [4] += cloud[i].y * cloud[i].z;
-      accu [5] += cloud[i].z * cloud[i].z;
-      accu [6] += cloud[i].x;
-      accu [7] += cloud[i].y;
-      accu [8] += cloud[i].z;
-      ++point_count;
-    }
-  }
-
-  if (point_count != 0)
-  {
-    accu /= static_cast<double> (point_count);
-    centroid.head<3> () = accu.tail<3> ();
-    centroid[3] = 0;
-    covariance_matrix.coeffRef (0) = accu [0] - accu [6] * accu [6];
-    covariance_matrix.coeffRef (1) = accu [1] - accu [6] * accu [7];
-    covariance_matrix.coeffRef (2) = accu [2] - accu [6] * accu [8];
-    covariance_matrix.coeffRef (4) = accu [3] - accu [7] * accu [7];
-    covariance_matrix.coeffRef (5) = accu [4] - accu [7] * accu [8];
-    covariance_matrix.coeffRef (8) = accu [5] - accu [8] * accu [8];
-    covariance_matrix.coeffRef (3) = covariance_matrix.coeff (1);
-    covariance_matrix.coeffRef (6) = covariance_matrix.coeff (2);
-    covariance_matrix.coeffRef (7) = covariance_matrix.coeff (5);
-  }
-  return (point_count);
+  return (detail::getMeanAndCovarianceMatrix (
+      detail::computeMoments<true> (cloud, boost::counting_iterator<int> (0), cloud.points.size (), nr_threads),
+      covariance_matrix, centroid));
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> inline unsigned int
 pcl::computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
-                                const std::vector<int> &indices,
-                                Eigen::Matrix3d &covariance_matrix,
-                                Eigen::Vector4d &centroid)
+                                     const std::vector<int> &indices,
+                                     Eigen::Matrix3d &covariance_matrix,
+                                     Eigen::Vector4d &centroid,
+                                     unsigned int nr_threads)
 {
-  // create the buffer on the stack which is much faster than using cloud.points[indices[i]] and centroid as a buffer
-  Eigen::Matrix<double, 1, 9, Eigen::RowMajor> accu = Eigen::Matrix<double, 1, 9, Eigen::RowMajor>::Zero ();
-  unsigned point_count;
-  if (cloud.is_dense)
-  {
-    point_count = indices.size ();
-    for (std::vector<int>::const_iterator iIt = indices.begin (); iIt != indices.end (); ++iIt)
-    {
-      //const PointT& point = cloud[*iIt];
-      accu [0] += cloud[*iIt].x * cloud[*iIt].x;
-      accu [1] += cloud[*iIt].x * cloud[*iIt].y;
-      accu [2] += cloud[*iIt].x * cloud[*iIt].z;
-      accu [3] += cloud[*iIt].y * cloud[*iIt].y;
-      accu [4] += cloud[*iIt].y * cloud[*iIt].z;
-      accu [5] += cloud[*iIt].z * cloud[*iIt].z;
-      accu [6] += cloud[*iIt].x;
-      accu [7] += cloud[*iIt].y;
-      accu [8] += cloud[*iIt].z;
-    }
-  }
-  else
-  {
-    point_count = 0;
-    for (std::vector<int>::const_iterator iIt = indices.begin (); iIt != indices.end (); ++iIt)
-    {
-      if (!isFinite (cloud[*iIt]))
-        continue;
-
-      ++point_count;
-      accu [0] += cloud[*iIt].x * cloud[*iIt].x;
-      accu [1] += cloud[*iIt].x * cloud[*iIt].y;
-      accu [2] += cloud[*iIt].x * cloud[*iIt].z;
-      accu [3] += cloud[*iIt].y * cloud[*iIt].y; // 4
-      accu [4] += cloud[*iIt].y * cloud[*iIt].z; // 5
-      accu [5] += cloud[*iIt].z * cloud[*iIt].z; // 8
-      accu [6] += cloud[*iIt].x;
-      accu [7] += cloud[*iIt].y;
-      accu [8] += cloud[*iIt].z;
-    }
-  }
-
-  if (point_count != 0)
-  {
-    accu /= static_cast<double> (point_count);
-    Eigen::Vector3f vec = accu.tail<3> ();
-    centroid.head<3> () = vec;//= accu.tail<3> ();
-    centroid[3] = 0;
-    covariance_matrix.coeffRef (0) = accu [0] - accu [6] * accu [6];
-    covariance_matrix.coeffRef (1) = accu [1] - accu [6] * accu [7];
-    covariance_matrix.coeffRef (2) = accu [2] - accu [6] * accu [8];
-    covariance_matrix.coeffRef (4) = accu [3] - accu [7] * accu [7];
-    covariance_matrix.coeffRef (5) = accu [4] - accu [7] * accu [8];
-    covariance_matrix.coeffRef (8) = accu [5] - accu [8] * accu [8];
-    covariance_matrix.coeffRef (3) = covariance_matrix.coeff (1);
-    covariance_matrix.coeffRef (6) = covariance_matrix.coeff (2);
-    covariance_matrix.coeffRef (7) = covariance_matrix.coeff (5);
-  }
-  return (point_count);
+  return (detail::getMeanAndCovarianceMatrix (
+      detail::computeMoments<true> (cloud, indices.begin (), indices.size (), nr_threads),
+      covariance_matrix, centroid));
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
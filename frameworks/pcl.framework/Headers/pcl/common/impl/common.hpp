@@ -39,6 +39,71 @@
 #define PCL_COMMON_IMPL_H_
 
 #include <pcl/pcl/point_types.h>
+#include <boost/iterator/counting_iterator.hpp>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Get the bounds of the points indices[0] .. indices[nr_points - 1] of a cloud. Every thread keeps its
+      * own bounds, which are combined at the end.
+      * \param[in] cloud the input point cloud
+      * \param[in] indices a random access iterator over the point indices
+      * \param[in] nr_points the number of indices
+      * \param[out] min_p the resultant minimum bounds
+      * \param[out] max_p the resultant maximum bounds
+      * \param[in] nr_threads the number of threads to use
+      */
+    template <typename PointT, typename IteratorT> void
+    getMinMax3D (const pcl::PointCloud<PointT> &cloud, IteratorT indices, size_t nr_points,
+                 Eigen::Array4f &min_p, Eigen::Array4f &max_p, unsigned int nr_threads)
+    {
+      min_p.setConstant (FLT_MAX);
+      max_p.setConstant (-FLT_MAX);
+
+      const int n = static_cast<int> (nr_points);
+#pragma omp parallel num_threads (nr_threads) if (nr_threads > 1 && n > 4096)
+      {
+        Eigen::Array4f thread_min, thread_max;
+        thread_min.setConstant (FLT_MAX);
+        thread_max.setConstant (-FLT_MAX);
+
+        // If the data is dense, we don't need to check for NaN
+        if (cloud.is_dense)
+        {
+#pragma omp for schedule (static)
+          for (int i = 0; i < n; ++i)
+          {
+            pcl::Array4fMapConst pt = cloud.points[indices[i]].getArray4fMap ();
+            thread_min = thread_min.min (pt);
+            thread_max = thread_max.max (pt);
+          }
+        }
+        // NaN or Inf values could exist => check for them
+        else
+        {
+#pragma omp for schedule (static)
+          for (int i = 0; i < n; ++i)
+          {
+            const PointT &p = cloud.points[indices[i]];
+            if (!pcl_isfinite (p.x) || !pcl_isfinite (p.y) || !pcl_isfinite (p.z))
+              continue;
+            pcl::Array4fMapConst pt = p.getArray4fMap ();
+            thread_min = thread_min.min (pt);
+            thread_max = thread_max.max (pt);
+          }
+        }
+
+#pragma omp critical
+        {
+          min_p = min_p.min (thread_min);
+          max_p = max_p.max (thread_max);
+        }
+      }
+    }
+  } // namespace detail
+}
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 inline double
@@ -110,6 +175,39 @@ pcl::getPointsInBox (const pcl::PointCloud<PointT> &cloud,
   indices.resize (l);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> inline void
+pcl::getPointsInBox (const pcl::PointCloudSoA<PointT> &cloud, 
+                     const Eigen::Vector4f &min_pt, const Eigen::Vector4f &max_pt,
+                     std::vector<int> &indices)
+{
+  const size_t nr_points = cloud.size ();
+  const float *x = cloud.getX (), *y = cloud.getY (), *z = cloud.getZ ();
+  indices.resize (nr_points);
+  int l = 0;
+
+  // The smallest distance of a point to the box faces is not negative inside the box. The channels are padded
+  // to whole blocks of four.
+  for (size_t i = 0; i < nr_points; i += 4)
+  {
+    Eigen::Map<const Eigen::Array4f, Eigen::Aligned> px (x + i), py (y + i), pz (z + i);
+    const Eigen::Array4f inside = (px - min_pt[0]).min (max_pt[0] - px).min (
+                                  (py - min_pt[1]).min (max_pt[1] - py)).min (
+                                  (pz - min_pt[2]).min (max_pt[2] - pz));
+    const size_t nr_lanes = std::min (nr_points - i, static_cast<size_t> (4));
+    for (size_t k = 0; k < nr_lanes; ++k)
+    {
+      if (!(inside[k] >= 0.0f))
+        continue;
+      // NaN or Inf values could exist => check for them
+      if (!cloud.is_dense && (!pcl_isfinite (x[i + k]) || !pcl_isfinite (y[i + k]) || !pcl_isfinite (z[i + k])))
+        continue;
+      indices[l++] = static_cast<int> (i + k);
+    }
+  }
+  indices.resize (l);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> inline void
 pcl::getMaxDistance (const pcl::PointCloud<PointT> &cloud, const Eigen::Vector4f &pivot_pt, Eigen::Vector4f &max_pt)
@@ -202,74 +300,22 @@ pcl::getMaxDistance (const pcl::PointCloud<PointT> &cloud, const std::vector<int
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> inline void
-pcl::getMinMax3D (const pcl::PointCloud<PointT> &cloud, PointT &min_pt, PointT &max_pt)
+pcl::getMinMax3D (const pcl::PointCloud<PointT> &cloud, PointT &min_pt, PointT &max_pt,
+                  unsigned int nr_threads)
 {
   Eigen::Array4f min_p, max_p;
-  min_p.setConstant (FLT_MAX);
-  max_p.setConstant (-FLT_MAX);
-
-  // If the data is dense, we don't need to check for NaN
-  if (cloud.is_dense)
-  {
-    for (size_t i = 0; i < cloud.points.size (); ++i)
-    {
-      pcl::Array4fMapConst pt = cloud.points[i].getArray4fMap ();
-      min_p = min_p.min (pt);
-      max_p = max_p.max (pt);
-    }
-  }
-  // NaN or Inf values could exist => check for them
-  else
-  {
-    for (size_t i = 0; i < cloud.points.size (); ++i)
-    {
-      // Check if the point is invalid
-      if (!pcl_isfinite (cloud.points[i].x) || 
-          !pcl_isfinite (cloud.points[i].y) || 
-          !pcl_isfinite (cloud.points[i].z))
-        continue;
-      pcl::Array4fMapConst pt = cloud.points[i].getArray4fMap ();
-      min_p = min_p.min (pt);
-      max_p = max_p.max (pt);
-    }
-  }
+  detail::getMinMax3D (cloud, boost::counting_iterator<int> (0), cloud.points.size (), min_p, max_p, nr_threads);
   min_pt.x = min_p[0]; min_pt.y = min_p[1]; min_pt.z = min_p[2];
   max_pt.x = max_p[0]; max_pt.y = max_p[1]; max_pt.z = max_p[2];
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> inline void
-pcl::getMinMax3D (const pcl::PointCloud<PointT> &cloud, Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt)
+pcl::getMinMax3D (const pcl::PointCloud<PointT> &cloud, Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt,
+                  unsigned int nr_threads)
 {
   Eigen::Array4f min_p, max_p;
-  min_p.setConstant (FLT_MAX);
-  max_p.setConstant (-FLT_MAX);
-
-  // If the data is dense, we don't need to check for NaN
-  if (cloud.is_dense)
-  {
-    for (size_t i = 0; i < cloud.points.size (); ++i)
-    {
-      pcl::Array4fMapConst pt = cloud.points[i].getArray4fMap ();
-      min_p = min_p.min (pt);
-      max_p = max_p.max (pt);
-    }
-  }
-  // NaN or Inf values could exist => check for them
-  else
-  {
-    for (size_t i = 0; i < cloud.points.size (); ++i)
-    {
-      // Check if the point is invalid
-      if (!pcl_isfinite (cloud.points[i].x) || 
-          !pcl_isfinite (cloud.points[i].y) || 
-          !pcl_isfinite (cloud.points[i].z))
-        continue;
-      pcl::Array4fMapConst pt = cloud.points[i].getArray4fMap ();
-      min_p = min_p.min (pt);
-      max_p = max_p.max (pt);
-    }
-  }
+  detail::getMinMax3D (cloud, boost::counting_iterator<int> (0), cloud.points.size (), min_p, max_p, nr_threads);
   min_pt = min_p;
   max_pt = max_p;
 }
@@ -280,72 +326,18 @@ template <typename PointT> inline void
 pcl::getMinMax3D (const pcl::PointCloud<PointT> &cloud, const pcl::PointIndices &indices,
                   Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt)
 {
-  Eigen::Array4f min_p, max_p;
-  min_p.setConstant (FLT_MAX);
-  max_p.setConstant (-FLT_MAX);
-
-  // If the data is dense, we don't need to check for NaN
-  if (cloud.is_dense)
-  {
-    for (size_t i = 0; i < indices.indices.size (); ++i)
-    {
-      pcl::Array4fMapConst pt = cloud.points[indices.indices[i]].getArray4fMap ();
-      min_p = min_p.min (pt);
-      max_p = max_p.max (pt);
-    }
-  }
-  // NaN or Inf values could exist => check for them
-  else
-  {
-    for (size_t i = 0; i < indices.indices.size (); ++i)
-    {
-      // Check if the point is invalid
-      if (!pcl_isfinite (cloud.points[indices.indices[i]].x) || 
-          !pcl_isfinite (cloud.points[indices.indices[i]].y) || 
-          !pcl_isfinite (cloud.points[indices.indices[i]].z))
-        continue;
-      pcl::Array4fMapConst pt = cloud.points[indices.indices[i]].getArray4fMap ();
-      min_p = min_p.min (pt);
-      max_p = max_p.max (pt);
-    }
-  }
-  min_pt = min_p;
-  max_pt = max_p;
+  getMinMax3D (cloud, indices.indices, min_pt, max_pt);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> inline void
 pcl::getMinMax3D (const pcl::PointCloud<PointT> &cloud, const std::vector<int> &indices,
-                  Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt)
+                  Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt, unsigned int nr_threads)
 {
-  min_pt.setConstant (FLT_MAX);
-  max_pt.setConstant (-FLT_MAX);
-
-  // If the data is dense, we don't need to check for NaN
-  if (cloud.is_dense)
-  {
-    for (size_t i = 0; i < indices.size (); ++i)
-    {
-      pcl::Array4fMapConst pt = cloud.points[indices[i]].getArray4fMap ();
-      min_pt = min_pt.array ().min (pt);
-      max_pt = max_pt.array ().max (pt);
-    }
-  }
-  // NaN or Inf values could exist => check for them
-  else
-  {
-    for (size_t i = 0; i < indices.size (); ++i)
-    {
-      // Check if the point is invalid
-      if (!pcl_isfinite (cloud.points[indices[i]].x) || 
-          !pcl_isfinite (cloud.points[indices[i]].y) || 
-          !pcl_isfinite (cloud.points[indices[i]].z))
-        continue;
-      pcl::Array4fMapConst pt = cloud.points[indices[i]].getArray4fMap ();
-      min_pt = min_pt.array ().min (pt);
-      max_pt = max_pt.array ().max (pt);
-    }
-  }
+  Eigen::Array4f min_p, max_p;
+  detail::getMinMax3D (cloud, indices.begin (), indices.size (), min_p, max_p, nr_threads);
+  min_pt = min_p;
+  max_pt = max_p;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
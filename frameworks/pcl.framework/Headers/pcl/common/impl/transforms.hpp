@@ -34,227 +34,393 @@
  *
  */
 
-//////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointT> void
-pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
-                          pcl::PointCloud<PointT> &cloud_out,
-                          const Eigen::Affine3f &transform)
+namespace pcl
 {
-  if (&cloud_in != &cloud_out)
+  namespace detail
   {
-    // Note: could be replaced by cloud_out = cloud_in
-    cloud_out.header   = cloud_in.header;
-    cloud_out.is_dense = cloud_in.is_dense;
-    cloud_out.width    = cloud_in.width;
-    cloud_out.height   = cloud_in.height;
-    cloud_out.points.reserve (cloud_out.points.size ());
-    cloud_out.points.assign (cloud_in.points.begin (), cloud_in.points.end ());
-  }
+    /** \brief Transforms the packed data[4] (and data_n[4]) of single points with four wide Eigen operations.
+      * Only the upper 3x4 block of the matrix is used. The fourth component of every vector is kept as is.
+      */
+    struct Transformer
+    {
+      /** \brief Constructor. Normals are rotated by the upper left 3x3 block of the matrix.
+        * \param[in] matrix the transformation
+        */
+      Transformer (const Eigen::Matrix4f &matrix)
+        : c0 (matrix (0, 0), matrix (1, 0), matrix (2, 0), 0.0f)
+        , c1 (matrix (0, 1), matrix (1, 1), matrix (2, 1), 0.0f)
+        , c2 (matrix (0, 2), matrix (1, 2), matrix (2, 2), 0.0f)
+        , c3 (matrix (0, 3), matrix (1, 3), matrix (2, 3), 0.0f)
+        , r0 (c0), r1 (c1), r2 (c2)
+        , w (0.0f, 0.0f, 0.0f, 1.0f)
+      {
+      }
 
-  if (cloud_in.is_dense)
-  {
-    // If the dataset is dense, simply transform it!
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-      cloud_out.points[i].getVector3fMap () = transform * 
-                                              cloud_in.points[i].getVector3fMap ();
-  }
-  else
-  {
-    // Dataset might contain NaNs and Infs, so check for them first,
-    // otherwise we get errors during the multiplication (?)
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
+      /** \brief Constructor with a separate rotation for the normals.
+        * \param[in] matrix the transformation
+        * \param[in] rotation the rotation of the normals
+        */
+      Transformer (const Eigen::Matrix4f &matrix, const Eigen::Matrix3f &rotation)
+        : c0 (matrix (0, 0), matrix (1, 0), matrix (2, 0), 0.0f)
+        , c1 (matrix (0, 1), matrix (1, 1), matrix (2, 1), 0.0f)
+        , c2 (matrix (0, 2), matrix (1, 2), matrix (2, 2), 0.0f)
+        , c3 (matrix (0, 3), matrix (1, 3), matrix (2, 3), 0.0f)
+        , r0 (rotation (0, 0), rotation (1, 0), rotation (2, 0), 0.0f)
+        , r1 (rotation (0, 1), rotation (1, 1), rotation (2, 1), 0.0f)
+        , r2 (rotation (0, 2), rotation (1, 2), rotation (2, 2), 0.0f)
+        , w (0.0f, 0.0f, 0.0f, 1.0f)
+      {
+      }
+
+      /** \brief Rotate and translate a 4 float vector.
+        * \param[in] src the source vector, 16 byte aligned
+        * \param[out] tgt the target vector, 16 byte aligned (can be equal to src)
+        */
+      inline void
+      se3 (const float *src, float *tgt) const
+      {
+        const Eigen::Vector4f p = Eigen::Map<const Eigen::Vector4f, Eigen::Aligned> (src);
+        Eigen::Map<Eigen::Vector4f, Eigen::Aligned> out (tgt);
+        out = c0 * p[0] + c1 * p[1] + c2 * p[2] + c3 + p.cwiseProduct (w);
+      }
+
+      /** \brief Rotate a 4 float vector by the rotation of the normals.
+        * \param[in] src the source vector, 16 byte aligned
+        * \param[out] tgt the target vector, 16 byte aligned (can be equal to src)
+        */
+      inline void
+      so3 (const float *src, float *tgt) const
+      {
+        const Eigen::Vector4f n = Eigen::Map<const Eigen::Vector4f, Eigen::Aligned> (src);
+        Eigen::Map<Eigen::Vector4f, Eigen::Aligned> out (tgt);
+        out = r0 * n[0] + r1 * n[1] + r2 * n[2] + n.cwiseProduct (w);
+      }
+
+      Eigen::Vector4f c0, c1, c2, c3, r0, r1, r2, w;
+
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+
+    /** \brief Transforms the coordinates of points, and their normals if Normals is set. */
+    template <bool Normals>
+    struct TransformedFields
+    {
+      /** \brief Transform the coordinates of a point. The other fields of tgt are not changed.
+        * \param[in] tf the transformation
+        * \param[in] src the source point
+        * \param[out] tgt the target point (can be equal to src)
+        */
+      template <typename PointT> static inline void
+      apply (const Transformer &tf, const PointT &src, PointT &tgt)
+      {
+        tf.se3 (src.data, tgt.data);
+      }
+
+      /** \brief Copy the coordinates of a point unchanged. */
+      template <typename PointT> static inline void
+      copy (const PointT &src, PointT &tgt)
+      {
+        tgt.getVector4fMap () = src.getVector4fMap ();
+      }
+    };
+
+    template <>
+    struct TransformedFields<true>
+    {
+      template <typename PointT> static inline void
+      apply (const Transformer &tf, const PointT &src, PointT &tgt)
+      {
+        tf.se3 (src.data, tgt.data);
+        tf.so3 (src.data_n, tgt.data_n);
+      }
+
+      template <typename PointT> static inline void
+      copy (const PointT &src, PointT &tgt)
+      {
+        tgt.getVector4fMap () = src.getVector4fMap ();
+        tgt.getNormalVector4fMap () = src.getNormalVector4fMap ();
+      }
+    };
+
+    /** \brief Copy the header of cloud_in to cloud_out and size its points, copying them if copy_all_fields is set. */
+    template <typename PointT> inline void
+    prepareTransformedCloud (const pcl::PointCloud<PointT> &cloud_in, pcl::PointCloud<PointT> &cloud_out,
+                             bool copy_all_fields)
     {
-      if (!pcl_isfinite (cloud_in.points[i].x) || 
-          !pcl_isfinite (cloud_in.points[i].y) || 
-          !pcl_isfinite (cloud_in.points[i].z))
-        continue;
-      cloud_out.points[i].getVector3fMap () = transform * 
-                                              cloud_in.points[i].getVector3fMap ();
+      if (&cloud_in == &cloud_out)
+        return;
+      cloud_out.header   = cloud_in.header;
+      cloud_out.is_dense = cloud_in.is_dense;
+      cloud_out.width    = cloud_in.width;
+      cloud_out.height   = cloud_in.height;
+      if (copy_all_fields)
+        cloud_out.points.assign (cloud_in.points.begin (), cloud_in.points.end ());
+      else
+        cloud_out.points.resize (cloud_in.points.size ());
     }
-  }
+
+    /** \brief Shared implementation of transformPointCloud and transformPointCloudWithNormals. */
+    template <typename PointT, bool Normals> void
+    transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, pcl::PointCloud<PointT> &cloud_out,
+                         const Transformer &tf, bool copy_all_fields)
+    {
+      prepareTransformedCloud (cloud_in, cloud_out, copy_all_fields);
+
+      const size_t nr_points = cloud_in.points.size ();
+      // If the dataset is dense, simply transform it!
+      if (cloud_in.is_dense)
+      {
+        for (size_t i = 0; i < nr_points; ++i)
+          TransformedFields<Normals>::apply (tf, cloud_in.points[i], cloud_out.points[i]);
+      }
+      // Dataset might contain NaNs and Infs, leave those points as they are
+      else
+      {
+        for (size_t i = 0; i < nr_points; ++i)
+        {
+          const PointT &p = cloud_in.points[i];
+          if (!pcl_isfinite (p.x) || !pcl_isfinite (p.y) || !pcl_isfinite (p.z))
+          {
+            if (!copy_all_fields)
+              TransformedFields<Normals>::copy (p, cloud_out.points[i]);
+            continue;
+          }
+          TransformedFields<Normals>::apply (tf, p, cloud_out.points[i]);
+        }
+      }
+    }
+
+    /** \brief Shared implementation of the indexed transformPointCloud and transformPointCloudWithNormals. */
+    template <typename PointT, bool Normals> void
+    transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, const std::vector<int> &indices,
+                         pcl::PointCloud<PointT> &cloud_out, const Transformer &tf, bool copy_all_fields)
+    {
+      const size_t npts = indices.size ();
+      cloud_out.is_dense = cloud_in.is_dense;
+      cloud_out.header   = cloud_in.header;
+      cloud_out.width    = static_cast<uint32_t> (npts);
+      cloud_out.height   = 1;
+      // Does not reallocate if cloud_out already holds npts points
+      cloud_out.points.resize (npts);
+
+      for (size_t i = 0; i < npts; ++i)
+      {
+        const PointT &p = cloud_in.points[indices[i]];
+        if (copy_all_fields)
+          cloud_out.points[i] = p;
+        if (!cloud_in.is_dense && (!pcl_isfinite (p.x) || !pcl_isfinite (p.y) || !pcl_isfinite (p.z)))
+        {
+          if (!copy_all_fields)
+            TransformedFields<Normals>::copy (p, cloud_out.points[i]);
+          continue;
+        }
+        TransformedFields<Normals>::apply (tf, p, cloud_out.points[i]);
+      }
+    }
+
+    /** \brief Shared implementation of the batched transformPointCloud and transformPointCloudWithNormals. */
+    template <typename PointT, bool Normals> void
+    transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
+                         const std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f> > &transforms,
+                         std::vector<typename pcl::PointCloud<PointT>::Ptr> &clouds_out, bool copy_all_fields)
+    {
+      const size_t nr_poses = transforms.size ();
+      if (clouds_out.size () < nr_poses)
+        clouds_out.resize (nr_poses);
+
+      std::vector<Transformer, Eigen::aligned_allocator<Transformer> > tfs;
+      tfs.reserve (nr_poses);
+      for (size_t k = 0; k < nr_poses; ++k)
+      {
+        if (!clouds_out[k])
+          clouds_out[k].reset (new pcl::PointCloud<PointT>);
+        prepareTransformedCloud (cloud_in, *clouds_out[k], copy_all_fields);
+        if (Normals)
+          tfs.push_back (Transformer (transforms[k].matrix (), transforms[k].rotation ()));
+        else
+          tfs.push_back (Transformer (transforms[k].matrix ()));
+      }
+
+      // Apply all poses to one block of points before moving on, so that every point is read from memory once
+      const size_t block_size = 256;
+      const size_t nr_points = cloud_in.points.size ();
+      unsigned char valid[block_size];
+      for (size_t begin = 0; begin < nr_points; begin += block_size)
+      {
+        const size_t end = std::min (begin + block_size, nr_points);
+        if (!cloud_in.is_dense)
+        {
+          for (size_t i = begin; i < end; ++i)
+          {
+            const PointT &p = cloud_in.points[i];
+            valid[i - begin] = pcl_isfinite (p.x) && pcl_isfinite (p.y) && pcl_isfinite (p.z);
+          }
+        }
+
+        for (size_t k = 0; k < nr_poses; ++k)
+        {
+          const Transformer &tf = tfs[k];
+          pcl::PointCloud<PointT> &cloud_out = *clouds_out[k];
+          if (cloud_in.is_dense)
+          {
+            for (size_t i = begin; i < end; ++i)
+              TransformedFields<Normals>::apply (tf, cloud_in.points[i], cloud_out.points[i]);
+          }
+          else
+          {
+            for (size_t i = begin; i < end; ++i)
+            {
+              if (valid[i - begin])
+                TransformedFields<Normals>::apply (tf, cloud_in.points[i], cloud_out.points[i]);
+              else if (!copy_all_fields)
+                TransformedFields<Normals>::copy (cloud_in.points[i], cloud_out.points[i]);
+            }
+          }
+        }
+      }
+    }
+  } // namespace detail
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
-                          const std::vector<int> &indices, 
+pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
                           pcl::PointCloud<PointT> &cloud_out,
-                          const Eigen::Affine3f &transform)
+                          const Eigen::Affine3f &transform,
+                          bool copy_all_fields)
 {
-  size_t npts = indices.size ();
-  // In order to transform the data, we need to remove NaNs
-  cloud_out.is_dense = cloud_in.is_dense;
-  cloud_out.header   = cloud_in.header;
-  cloud_out.width    = npts;
-  cloud_out.height   = 1;
-  cloud_out.points.resize (npts);
-
-  if (cloud_in.is_dense)
-  {
-    // If the dataset is dense, simply transform it!
-    for (size_t i = 0; i < npts; ++i)
-    {
-      // Copy fields first, then transform xyz data
-      cloud_out.points[i] = cloud_in.points[indices[i]]; 
-      cloud_out.points[i].getVector3fMap () = transform*cloud_out.points[i].getVector3fMap ();
-    }
-  }
-  else
-  {
-    // Dataset might contain NaNs and Infs, so check for them first,
-    // otherwise we get errors during the multiplication (?)
-    for (size_t i = 0; i < npts; ++i)
-    {
-      if (!pcl_isfinite (cloud_in.points[indices[i]].x) || 
-          !pcl_isfinite (cloud_in.points[indices[i]].y) || 
-          !pcl_isfinite (cloud_in.points[indices[i]].z))
-        continue;
-      cloud_out.points[i] = cloud_in.points[indices[i]]; 
-      cloud_out.points[i].getVector3fMap () = transform*cloud_out.points[i].getVector3fMap ();
-    }
-  }
+  const detail::Transformer tf (transform.matrix ());
+  detail::transformPointCloud<PointT, false> (cloud_in, cloud_out, tf, copy_all_fields);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in, 
-                                     pcl::PointCloud<PointT> &cloud_out,
-                                     const Eigen::Affine3f &transform)
+pcl::transformPointCloud (pcl::PointCloud<PointT> &cloud, const Eigen::Affine3f &transform)
+{
+  const detail::Transformer tf (transform.matrix ());
+  detail::transformPointCloud<PointT, false> (cloud, cloud, tf, true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::transformPointCloud (const pcl::PointCloudSoA<PointT> &cloud_in, 
+                          pcl::PointCloudSoA<PointT> &cloud_out,
+                          const Eigen::Affine3f &transform)
 {
   if (&cloud_in != &cloud_out)
-  {
-    // Note: could be replaced by cloud_out = cloud_in
-    cloud_out.header   = cloud_in.header;
-    cloud_out.width    = cloud_in.width;
-    cloud_out.height   = cloud_in.height;
-    cloud_out.is_dense = cloud_in.is_dense;
-    cloud_out.points.reserve (cloud_out.points.size ());
-    cloud_out.points.assign (cloud_in.points.begin (), cloud_in.points.end ());
-  }
+    cloud_out = cloud_in;
+
+  float *x = cloud_out.getX (), *y = cloud_out.getY (), *z = cloud_out.getZ ();
+  const Eigen::Matrix4f &m = transform.matrix ();
 
-  // If the data is dense, we don't need to check for NaN
-  if (cloud_in.is_dense)
+  // The channels are padded to whole blocks of four, so the last block can be transformed as well
+  for (size_t i = 0; i < cloud_out.size (); i += 4)
   {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
+    Eigen::Map<Eigen::Array4f, Eigen::Aligned> px (x + i), py (y + i), pz (z + i);
+    const Eigen::Array4f ox (px), oy (py), oz (pz);
+    const Eigen::Array4f tx = m (0, 0) * ox + m (0, 1) * oy + m (0, 2) * oz + m (0, 3);
+    const Eigen::Array4f ty = m (1, 0) * ox + m (1, 1) * oy + m (1, 2) * oz + m (1, 3);
+    const Eigen::Array4f tz = m (2, 0) * ox + m (2, 1) * oy + m (2, 2) * oz + m (2, 3);
+    if (cloud_out.is_dense)
     {
-      cloud_out.points[i].getVector3fMap() = transform * 
-                                             cloud_in.points[i].getVector3fMap ();
-
-      // Rotate normals
-      cloud_out.points[i].getNormalVector3fMap() = transform.rotation () * 
-                                                   cloud_in.points[i].getNormalVector3fMap ();
+      px = tx;
+      py = ty;
+      pz = tz;
     }
-  }
-  // Dataset might contain NaNs and Infs, so check for them first.
-  else
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
+    else
     {
-      if (!pcl_isfinite (cloud_in.points[i].x) || 
-          !pcl_isfinite (cloud_in.points[i].y) || 
-          !pcl_isfinite (cloud_in.points[i].z))
-        continue;
-      cloud_out.points[i].getVector3fMap() = transform * 
-                                             cloud_in.points[i].getVector3fMap ();
-
-      // Rotate normals
-      cloud_out.points[i].getNormalVector3fMap() = transform.rotation () * 
-                                                   cloud_in.points[i].getNormalVector3fMap ();
+      // Leave NaNs and Infs untouched, x - x is 0 only for finite values
+      const Eigen::Array4f check = (ox - ox) + (oy - oy) + (oz - oz);
+      px = (check == 0.0f).select (tx, ox);
+      py = (check == 0.0f).select (ty, oy);
+      pz = (check == 0.0f).select (tz, oz);
     }
   }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
+pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
+                          const std::vector<int> &indices,
                           pcl::PointCloud<PointT> &cloud_out,
-                          const Eigen::Matrix4f &transform)
+                          const Eigen::Affine3f &transform,
+                          bool copy_all_fields)
 {
-  if (&cloud_in != &cloud_out)
-  {
-    // Note: could be replaced by cloud_out = cloud_in
-    cloud_out.header   = cloud_in.header;
-    cloud_out.width    = cloud_in.width;
-    cloud_out.height   = cloud_in.height;
-    cloud_out.is_dense = cloud_in.is_dense;
-    cloud_out.points.reserve (cloud_out.points.size ());
-    cloud_out.points.assign (cloud_in.points.begin (), cloud_in.points.end ());
-  }
+  const detail::Transformer tf (transform.matrix ());
+  detail::transformPointCloud<PointT, false> (cloud_in, indices, cloud_out, tf, copy_all_fields);
+}
 
-  Eigen::Matrix3f rot   = transform.block<3, 3> (0, 0);
-  Eigen::Vector3f trans = transform.block<3, 1> (0, 3);
-  // If the data is dense, we don't need to check for NaN
-  if (cloud_in.is_dense)
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-      cloud_out.points[i].getVector3fMap () = rot * 
-                                              cloud_in.points[i].getVector3fMap () + trans;
-  }
-  // Dataset might contain NaNs and Infs, so check for them first.
-  else
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      if (!pcl_isfinite (cloud_in.points[i].x) || 
-          !pcl_isfinite (cloud_in.points[i].y) || 
-          !pcl_isfinite (cloud_in.points[i].z))
-        continue;
-      cloud_out.points[i].getVector3fMap () = rot * 
-                                              cloud_in.points[i].getVector3fMap () + trans;
-    }
-  }
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
+                          const std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f> > &transforms,
+                          std::vector<typename pcl::PointCloud<PointT>::Ptr> &clouds_out,
+                          bool copy_all_fields)
+{
+  detail::transformPointCloud<PointT, false> (cloud_in, transforms, clouds_out, copy_all_fields);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in, 
+pcl::transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
                                      pcl::PointCloud<PointT> &cloud_out,
-                                     const Eigen::Matrix4f &transform)
+                                     const Eigen::Affine3f &transform,
+                                     bool copy_all_fields)
 {
-  if (&cloud_in != &cloud_out)
-  {
-    // Note: could be replaced by cloud_out = cloud_in
-    cloud_out.header   = cloud_in.header;
-    cloud_out.width    = cloud_in.width;
-    cloud_out.height   = cloud_in.height;
-    cloud_out.is_dense = cloud_in.is_dense;
-    cloud_out.points.reserve (cloud_out.points.size ());
-    cloud_out.points.assign (cloud_in.points.begin (), cloud_in.points.end ());
-  }
+  const detail::Transformer tf (transform.matrix (), transform.rotation ());
+  detail::transformPointCloud<PointT, true> (cloud_in, cloud_out, tf, copy_all_fields);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::transformPointCloudWithNormals (pcl::PointCloud<PointT> &cloud, const Eigen::Affine3f &transform)
+{
+  const detail::Transformer tf (transform.matrix (), transform.rotation ());
+  detail::transformPointCloud<PointT, true> (cloud, cloud, tf, true);
+}
 
-  Eigen::Matrix3f rot   = transform.block<3, 3> (0, 0);
-  Eigen::Vector3f trans = transform.block<3, 1> (0, 3);
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
+                                     const std::vector<int> &indices,
+                                     pcl::PointCloud<PointT> &cloud_out,
+                                     const Eigen::Affine3f &transform,
+                                     bool copy_all_fields)
+{
+  const detail::Transformer tf (transform.matrix (), transform.rotation ());
+  detail::transformPointCloud<PointT, true> (cloud_in, indices, cloud_out, tf, copy_all_fields);
+}
 
-  // If the data is dense, we don't need to check for NaN
-  if (cloud_in.is_dense)
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      cloud_out.points[i].getVector3fMap () = rot * 
-                                              cloud_in.points[i].getVector3fMap () + trans;
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
+                                     const std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f> > &transforms,
+                                     std::vector<typename pcl::PointCloud<PointT>::Ptr> &clouds_out,
+                                     bool copy_all_fields)
+{
+  detail::transformPointCloud<PointT, true> (cloud_in, transforms, clouds_out, copy_all_fields);
+}
 
-      // Rotate normals
-      cloud_out.points[i].getNormalVector3fMap() = rot * 
-                                                   cloud_in.points[i].getNormalVector3fMap ();
-    }
-  }
-  // Dataset might contain NaNs and Infs, so check for them first.
-  else
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      if (!pcl_isfinite (cloud_in.points[i].x) || 
-          !pcl_isfinite (cloud_in.points[i].y) || 
-          !pcl_isfinite (cloud_in.points[i].z))
-        continue;
-      cloud_out.points[i].getVector3fMap () = rot * 
-                                              cloud_in.points[i].getVector3fMap () + trans;
-
-      // Rotate normals
-      cloud_out.points[i].getNormalVector3fMap() = rot * 
-                                                   cloud_in.points[i].getNormalVector3fMap ();
-    }
-  }
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
+                          pcl::PointCloud<PointT> &cloud_out,
+                          const Eigen::Matrix4f &transform,
+                          bool copy_all_fields)
+{
+  const detail::Transformer tf (transform);
+  detail::transformPointCloud<PointT, false> (cloud_in, cloud_out, tf, copy_all_fields);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
+                                     pcl::PointCloud<PointT> &cloud_out,
+                                     const Eigen::Matrix4f &transform,
+                                     bool copy_all_fields)
+{
+  const detail::Transformer tf (transform);
+  detail::transformPointCloud<PointT, true> (cloud_in, cloud_out, tf, copy_all_fields);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,369 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#ifndef PCL_COMMON_PROFILING_H_
+#define PCL_COMMON_PROFILING_H_
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#if defined __APPLE__
+#  include <mach/mach_time.h>
+#elif defined _WIN32
+#  include <windows.h>
+#else
+#  include <time.h>
+#endif
+#ifndef _WIN32
+#  include <sys/resource.h>
+#endif
+
+/**
+  * \file pcl/common/profiling.h
+  * Define a registry that collects named timing and memory statistics, and a scope timer that feeds it
+  * \ingroup common
+  */
+
+/*@{*/
+namespace pcl
+{
+  /** \brief Accumulated statistics of all computations recorded under one name, see ProfilingRegistry.
+    * \ingroup common
+    */
+  struct ProfilingRecord
+  {
+    ProfilingRecord ()
+      : name ()
+      , calls (0)
+      , total_time (0.0)
+      , max_time (0.0)
+      , points_in (0)
+      , points_out (0)
+      , peak_memory_growth (0)
+    {
+    }
+
+    /** \brief The name the computations were recorded under (e.g. "VoxelGrid"). */
+    std::string name;
+
+    /** \brief The number of recorded computations. */
+    unsigned int calls;
+
+    /** \brief The time spent in all computations, in milliseconds. */
+    double total_time;
+
+    /** \brief The time of the slowest computation, in milliseconds. */
+    double max_time;
+
+    /** \brief The number of input points over all computations, as reported by the caller. */
+    size_t points_in;
+
+    /** \brief The number of output points over all computations, as reported by the caller. */
+    size_t points_out;
+
+    /** \brief The largest growth of the peak resident set size of the process during one computation, in bytes. */
+    size_t peak_memory_growth;
+  };
+
+  /** \brief Thread safe registry of named computations.
+    *
+    * Nothing in the library reports to the registry by itself. Callers frame the computations they want to measure
+    * with a ScopedProfile, which records them under the name it is given once profiling is enabled. The records are
+    * accumulated per name and can be written as JSON or CSV:
+    *
+    * \code
+    * pcl::ProfilingRegistry::getInstance ().setEnabled (true);
+    * {
+    *   pcl::ScopedProfile profile ("VoxelGrid", cloud->points.size ());
+    *   grid.filter (*cloud_filtered);
+    *   profile.setPointsOut (cloud_filtered->points.size ());
+    * }
+    * pcl::ProfilingRegistry::getInstance ().writeCSV (std::cerr);
+    * \endcode
+    *
+    * \note The memory figure is process wide, so computations running at the same time attribute each other's
+    * allocations. It only grows when the process reaches a new peak.
+    * \ingroup common
+    */
+  class ProfilingRegistry
+  {
+    public:
+      /** \brief Get the registry of the process. */
+      static ProfilingRegistry&
+      getInstance ()
+      {
+        static ProfilingRegistry registry;
+        return (registry);
+      }
+
+      /** \brief Enable or disable the recording of computations.
+        * \param[in] enabled true to record computations
+        */
+      inline void
+      setEnabled (bool enabled)
+      {
+        enabled_ = enabled;
+      }
+
+      /** \brief Check whether computations are recorded. */
+      inline bool
+      isEnabled () const
+      {
+        return (enabled_);
+      }
+
+      /** \brief Add one computation to the record of its name.
+        * \param[in] sample the statistics of the computation, with \a calls ignored
+        */
+      void
+      record (const ProfilingRecord& sample)
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        ProfilingRecord& record = records_[sample.name];
+        if (record.calls == 0)
+          record.name = sample.name;
+        ++record.calls;
+        record.total_time += sample.total_time;
+        if (sample.max_time > record.max_time)
+          record.max_time = sample.max_time;
+        record.points_in += sample.points_in;
+        record.points_out += sample.points_out;
+        if (sample.peak_memory_growth > record.peak_memory_growth)
+          record.peak_memory_growth = sample.peak_memory_growth;
+      }
+
+      /** \brief Get a copy of all records, ordered by name. */
+      std::vector<ProfilingRecord>
+      getRecords () const
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        std::vector<ProfilingRecord> records;
+        records.reserve (records_.size ());
+        for (RecordMap::const_iterator it = records_.begin (); it != records_.end (); ++it)
+          records.push_back (it->second);
+        return (records);
+      }
+
+      /** \brief Remove all records. */
+      void
+      clear ()
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        records_.clear ();
+      }
+
+      /** \brief Write all records as a JSON array of objects.
+        * \param[out] os the output stream
+        */
+      void
+      writeJSON (std::ostream& os) const
+      {
+        std::vector<ProfilingRecord> records = getRecords ();
+        os << "[";
+        for (size_t i = 0; i < records.size (); ++i)
+        {
+          const ProfilingRecord& r = records[i];
+          os << (i == 0 ? "\n" : ",\n")
+             << "  {\"name\": \"" << escape (r.name) << "\""
+             << ", \"calls\": " << r.calls
+             << ", \"total_time_ms\": " << r.total_time << ", \"max_time_ms\": " << r.max_time
+             << ", \"points_in\": " << r.points_in << ", \"points_out\": " << r.points_out
+             << ", \"peak_memory_growth\": " << r.peak_memory_growth << "}";
+        }
+        os << "\n]\n";
+      }
+
+      /** \brief Write all records as CSV, with a header line.
+        * \param[out] os the output stream
+        */
+      void
+      writeCSV (std::ostream& os) const
+      {
+        std::vector<ProfilingRecord> records = getRecords ();
+        os << "name,calls,total_time_ms,max_time_ms,points_in,points_out,peak_memory_growth\n";
+        for (size_t i = 0; i < records.size (); ++i)
+        {
+          const ProfilingRecord& r = records[i];
+          os << "\"" << escape (r.name) << "\"," << r.calls << ","
+             << r.total_time << "," << r.max_time << "," << r.points_in << "," << r.points_out << ","
+             << r.peak_memory_growth << "\n";
+        }
+      }
+
+      /** \brief Get the time of a monotonic clock in milliseconds. Only differences of two values are meaningful. */
+      static double
+      getMonotonicTime ()
+      {
+#if defined __APPLE__
+        static mach_timebase_info_data_t timebase;
+        if (timebase.denom == 0)
+          mach_timebase_info (&timebase);
+        return (static_cast<double> (mach_absolute_time ()) * timebase.numer / timebase.denom * 1.0e-6);
+#elif defined _WIN32
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency (&frequency);
+        QueryPerformanceCounter (&counter);
+        return (static_cast<double> (counter.QuadPart) * 1000.0 / static_cast<double> (frequency.QuadPart));
+#else
+        struct timespec now;
+        clock_gettime (CLOCK_MONOTONIC, &now);
+        return (static_cast<double> (now.tv_sec) * 1000.0 + static_cast<double> (now.tv_nsec) * 1.0e-6);
+#endif
+      }
+
+      /** \brief Get the peak resident set size of the process in bytes, 0 if it is not available. */
+      static size_t
+      getPeakMemory ()
+      {
+#ifndef _WIN32
+        struct rusage usage;
+        if (getrusage (RUSAGE_SELF, &usage) != 0)
+          return (0);
+#  ifdef __APPLE__
+        return (static_cast<size_t> (usage.ru_maxrss));
+#  else
+        return (static_cast<size_t> (usage.ru_maxrss) * 1024);
+#  endif
+#else
+        return (0);
+#endif
+      }
+
+    private:
+      typedef std::map<std::string, ProfilingRecord> RecordMap;
+
+      ProfilingRegistry () : enabled_ (false), records_ (), mutex_ () {}
+
+      ProfilingRegistry (const ProfilingRegistry&);
+
+      ProfilingRegistry&
+      operator = (const ProfilingRegistry&);
+
+      /** \brief Escape the quotes and backslashes of a name. */
+      static std::string
+      escape (const std::string& s)
+      {
+        std::string result;
+        for (size_t i = 0; i < s.size (); ++i)
+        {
+          if (s[i] == '"' || s[i] == '\\')
+            result += '\\';
+          result += s[i];
+        }
+        return (result);
+      }
+
+      volatile bool enabled_;
+      RecordMap records_;
+      mutable boost::mutex mutex_;
+  };
+
+  /** \brief Measure the time spent in a scope on a monotonic clock and add it to the ProfilingRegistry under a name.
+    * Does nothing if the registry is disabled when the scope is entered.
+    * \ingroup common
+    */
+  class ScopedProfile
+  {
+    public:
+      /** \brief Start measuring.
+        * \param[in] name the name of the record the computation is added to
+        * \param[in] points_in the number of input points of the computation
+        */
+      explicit ScopedProfile (const std::string& name, size_t points_in = 0)
+        : active_ (ProfilingRegistry::getInstance ().isEnabled ())
+        , name_ ()
+        , points_in_ (points_in)
+        , points_out_ (0)
+        , start_memory_ (0)
+        , start_time_ (0.0)
+      {
+        if (!active_)
+          return;
+        name_ = name;
+        start_memory_ = ProfilingRegistry::getPeakMemory ();
+        start_time_ = ProfilingRegistry::getMonotonicTime ();
+      }
+
+      /** \brief Stop measuring and add the computation to the registry. */
+      ~ScopedProfile ()
+      {
+        if (!active_)
+          return;
+        double end_time = ProfilingRegistry::getMonotonicTime ();
+
+        ProfilingRecord sample;
+        sample.name = name_;
+        sample.total_time = sample.max_time = end_time - start_time_;
+        sample.points_in = points_in_;
+        sample.points_out = points_out_;
+        size_t end_memory = ProfilingRegistry::getPeakMemory ();
+        sample.peak_memory_growth = end_memory > start_memory_ ? end_memory - start_memory_ : 0;
+        ProfilingRegistry::getInstance ().record (sample);
+      }
+
+      /** \brief Set the number of output points of the computation.
+        * \param[in] points_out the number of output points
+        */
+      inline void
+      setPointsOut (size_t points_out)
+      {
+        points_out_ = points_out;
+      }
+
+    private:
+      ScopedProfile (const ScopedProfile&);
+
+      ScopedProfile&
+      operator = (const ScopedProfile&);
+
+      bool active_;
+      std::string name_;
+      size_t points_in_;
+      size_t points_out_;
+      size_t start_memory_;
+      double start_time_;
+  };
+}  // end namespace
+/*@}*/
+
+#endif  //#ifndef PCL_COMMON_PROFILING_H_
@@ -37,6 +37,7 @@
 #define PCL_TRANSFORMS_H_
 
 #include <pcl/pcl/point_cloud.h>
+#include <pcl/pcl/point_cloud_soa.h>
 #include <pcl/pcl/point_types.h>
 #include <pcl/pcl/common/centroid.h>
 #include <pcl/pcl/common/eigen.h>
@@ -47,12 +48,23 @@ namespace pcl
     * \param cloud_in the input point cloud
     * \param cloud_out the resultant output point cloud
     * \param transform an affine transformation (typically a rigid transformation)
+    * \param copy_all_fields if false, only x, y and z are written to cloud_out, all other fields keep their values
     * \note Can be used with cloud_in equal to cloud_out
     * \ingroup common
     */
   template <typename PointT> void 
   transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
                        pcl::PointCloud<PointT> &cloud_out, 
+                       const Eigen::Affine3f &transform,
+                       bool copy_all_fields = true);
+
+  /** \brief Apply an affine transform defined by an Eigen Transform in place
+    * \param cloud the point cloud to transform
+    * \param transform an affine transformation (typically a rigid transformation)
+    * \ingroup common
+    */
+  template <typename PointT> void 
+  transformPointCloud (pcl::PointCloud<PointT> &cloud, 
                        const Eigen::Affine3f &transform);
 
   /** \brief Apply an affine transform defined by an Eigen Transform
@@ -60,6 +72,9 @@ namespace pcl
     * \param indices the set of point indices to use from the input point cloud
     * \param cloud_out the resultant output point cloud
     * \param transform an affine transformation (typically a rigid transformation)
+    * \param copy_all_fields if false, only x, y and z are written to cloud_out, all other fields keep their values.
+    * Together with a cloud_out that already holds indices.size () points, this transforms a subset of the input into a
+    * preallocated cloud without any allocation.
     * \note Can be used with cloud_in equal to cloud_out
     * \ingroup common
     */
@@ -67,42 +82,115 @@ namespace pcl
   transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
                        const std::vector<int> &indices, 
                        pcl::PointCloud<PointT> &cloud_out, 
+                       const Eigen::Affine3f &transform,
+                       bool copy_all_fields = true);
+
+  /** \brief Apply several affine transforms to the same point cloud, e.g. to score particles or pose hypotheses.
+    * The points are processed in blocks that stay in the cache while all transforms are applied to them.
+    * \param cloud_in the input point cloud
+    * \param transforms the affine transformations (typically rigid transformations)
+    * \param clouds_out one resultant output point cloud per transform. The vector is grown to transforms.size () if
+    * it is smaller and empty pointers are allocated; extra entries are not touched.
+    * \param copy_all_fields if false, only x, y and z are written to the output clouds
+    * \note cloud_in must not be one of the output clouds
+    * \ingroup common
+    */
+  template <typename PointT> void 
+  transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
+                       const std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f> > &transforms,
+                       std::vector<typename pcl::PointCloud<PointT>::Ptr> &clouds_out,
+                       bool copy_all_fields = true);
+
+  /** \brief Apply an affine transform defined by an Eigen Transform to the x, y and z channels of a structure of
+    * arrays cloud, four points at a time. All other channels are copied.
+    * \param cloud_in the input point cloud
+    * \param cloud_out the resultant output point cloud
+    * \param transform an affine transformation (typically a rigid transformation)
+    * \note Can be used with cloud_in equal to cloud_out
+    * \ingroup common
+    */
+  template <typename PointT> void 
+  transformPointCloud (const pcl::PointCloudSoA<PointT> &cloud_in, 
+                       pcl::PointCloudSoA<PointT> &cloud_out, 
                        const Eigen::Affine3f &transform);
 
-  /** \brief Transform a point cloud and rotate its normals using an Eigen transform.
+  /** \brief Transform a point cloud and rotate its normals using an Eigen transform. The normals are rotated by
+    * transform.rotation (), also in the in-place, indexed and batched overloads.
     * \param cloud_in the input point cloud
     * \param cloud_out the resultant output point cloud
     * \param transform an affine transformation (typically a rigid transformation)
+    * \param copy_all_fields if false, only the coordinates and normals are written to cloud_out
     * \note Can be used with cloud_in equal to cloud_out
     */
   template <typename PointT> void 
   transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in, 
                                   pcl::PointCloud<PointT> &cloud_out, 
+                                  const Eigen::Affine3f &transform,
+                                  bool copy_all_fields = true);
+
+  /** \brief Transform a point cloud and rotate its normals in place using an Eigen transform.
+    * \param cloud the point cloud to transform
+    * \param transform an affine transformation (typically a rigid transformation)
+    */
+  template <typename PointT> void 
+  transformPointCloudWithNormals (pcl::PointCloud<PointT> &cloud, 
                                   const Eigen::Affine3f &transform);
 
+  /** \brief Transform a subset of a point cloud and rotate its normals using an Eigen transform.
+    * \param cloud_in the input point cloud
+    * \param indices the set of point indices to use from the input point cloud
+    * \param cloud_out the resultant output point cloud
+    * \param transform an affine transformation (typically a rigid transformation)
+    * \param copy_all_fields if false, only the coordinates and normals are written to cloud_out
+    */
+  template <typename PointT> void 
+  transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in, 
+                                  const std::vector<int> &indices, 
+                                  pcl::PointCloud<PointT> &cloud_out, 
+                                  const Eigen::Affine3f &transform,
+                                  bool copy_all_fields = true);
+
+  /** \brief Apply several transforms to the same point cloud and rotate its normals, see the batched
+    * transformPointCloud ().
+    * \param cloud_in the input point cloud
+    * \param transforms the affine transformations (typically rigid transformations)
+    * \param clouds_out one resultant output point cloud per transform
+    * \param copy_all_fields if false, only the coordinates and normals are written to the output clouds
+    */
+  template <typename PointT> void 
+  transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in, 
+                                  const std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f> > &transforms,
+                                  std::vector<typename pcl::PointCloud<PointT>::Ptr> &clouds_out,
+                                  bool copy_all_fields = true);
+
   /** \brief Apply an affine transform defined by an Eigen Transform
     * \param cloud_in the input point cloud
     * \param cloud_out the resultant output point cloud
     * \param transform an affine transformation (typically a rigid transformation)
+    * \param copy_all_fields if false, only x, y and z are written to cloud_out, all other fields keep their values
     * \note Can be used with cloud_in equal to cloud_out
     * \ingroup common
     */
   template <typename PointT> void 
   transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
                        pcl::PointCloud<PointT> &cloud_out, 
-                       const Eigen::Matrix4f &transform);
+                       const Eigen::Matrix4f &transform,
+                       bool copy_all_fields = true);
 
-  /** \brief Transform a point cloud and rotate its normals using an Eigen transform.
+  /** \brief Transform a point cloud and rotate its normals using an Eigen transform. The normals are multiplied by
+    * the upper left 3x3 block of the matrix.
     * \param cloud_in the input point cloud
     * \param cloud_out the resultant output point cloud
     * \param transform an affine transformation (typically a rigid transformation)
+    * \param copy_all_fields if false, only the coordinates and normals are written to cloud_out
     * \note Can be used with cloud_in equal to cloud_out
     * \ingroup common
     */
   template <typename PointT> void 
   transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in, 
                                   pcl::PointCloud<PointT> &cloud_out, 
-                                  const Eigen::Matrix4f &transform);
+                                  const Eigen::Matrix4f &transform,
+                                  bool copy_all_fields = true);
 
   /** \brief Apply a rigid transform defined by a 3D offset and a quaternion
     * \param cloud_in the input point cloud
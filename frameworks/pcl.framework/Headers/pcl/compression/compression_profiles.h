@@ -62,10 +62,26 @@ namespace pcl
       HIGH_RES_OFFLINE_COMPRESSION_WITHOUT_COLOR,
       HIGH_RES_OFFLINE_COMPRESSION_WITH_COLOR,
 
+      LOW_RES_ONLINE_RANS_COMPRESSION_WITHOUT_COLOR,
+      LOW_RES_ONLINE_RANS_COMPRESSION_WITH_COLOR,
+
+      MED_RES_ONLINE_RANS_COMPRESSION_WITHOUT_COLOR,
+      MED_RES_ONLINE_RANS_COMPRESSION_WITH_COLOR,
+
+      HIGH_RES_ONLINE_RANS_COMPRESSION_WITHOUT_COLOR,
+      HIGH_RES_ONLINE_RANS_COMPRESSION_WITH_COLOR,
+
       COMPRESSION_PROFILE_COUNT,
       MANUAL_CONFIGURATION
     };
 
+    // entropy coding backend
+    enum entropyCoding_Method_e
+    {
+      STATIC_RANGE_CODING,
+      INTERLEAVED_RANS_CODING
+    };
+
     // compression configuration profile
     struct configurationProfile_t
     {
@@ -75,6 +91,7 @@ namespace pcl
       unsigned int iFrameRate;
       const unsigned char colorBitResolution;
       bool doColorEncoding;
+      entropyCoding_Method_e entropyCodingMethod;
     };
 
     // predefined configuration parameters
@@ -86,7 +103,8 @@ namespace pcl
        true, /* doVoxelGridDownDownSampling = */
        50, /* iFrameRate = */
        4, /* colorBitResolution = */
-       false /* doColorEncoding = */
+       false, /* doColorEncoding = */
+       STATIC_RANGE_CODING /* entropyCodingMethod = */
     }, {
     // PROFILE: LOW_RES_ONLINE_COMPRESSION_WITH_COLOR
         0.01, /* pointResolution = */
@@ -94,7 +112,8 @@ namespace pcl
         true, /* doVoxelGridDownDownSampling = */
         50, /* iFrameRate = */
         4, /* colorBitResolution = */
-        true /* doColorEncoding = */
+        true, /* doColorEncoding = */
+        STATIC_RANGE_CODING /* entropyCodingMethod = */
     }, {
     // PROFILE: MED_RES_ONLINE_COMPRESSION_WITHOUT_COLOR
         0.005, /* pointResolution = */
@@ -102,7 +121,8 @@ namespace pcl
         false, /* doVoxelGridDownDownSampling = */
         40, /* iFrameRate = */
         5, /* colorBitResolution = */
-        false /* doColorEncoding = */
+        false, /* doColorEncoding = */
+        STATIC_RANGE_CODING /* entropyCodingMethod = */
     }, {
     // PROFILE: MED_RES_ONLINE_COMPRESSION_WITH_COLOR
         0.005, /* pointResolution = */
@@ -110,7 +130,8 @@ namespace pcl
         false, /* doVoxelGridDownDownSampling = */
         40, /* iFrameRate = */
         5, /* colorBitResolution = */
-        true /* doColorEncoding = */
+        true, /* doColorEncoding = */
+        STATIC_RANGE_CODING /* entropyCodingMethod = */
     }, {
     // PROFILE: HIGH_RES_ONLINE_COMPRESSION_WITHOUT_COLOR
         0.0001, /* pointResolution = */
@@ -118,7 +139,8 @@ namespace pcl
         false, /* doVoxelGridDownDownSampling = */
         30, /* iFrameRate = */
         7, /* colorBitResolution = */
-        false /* doColorEncoding = */
+        false, /* doColorEncoding = */
+        STATIC_RANGE_CODING /* entropyCodingMethod = */
     }, {
     // PROFILE: HIGH_RES_ONLINE_COMPRESSION_WITH_COLOR
         0.0001, /* pointResolution = */
@@ -126,7 +148,8 @@ namespace pcl
         false, /* doVoxelGridDownDownSampling = */
         30, /* iFrameRate = */
         7, /* colorBitResolution = */
-        true /* doColorEncoding = */
+        true, /* doColorEncoding = */
+        STATIC_RANGE_CODING /* entropyCodingMethod = */
     }, {
     // PROFILE: LOW_RES_OFFLINE_COMPRESSION_WITHOUT_COLOR
         0.01, /* pointResolution = */
@@ -134,7 +157,8 @@ namespace pcl
         true, /* doVoxelGridDownDownSampling = */
         100, /* iFrameRate = */
         4, /* colorBitResolution = */
-        false /* doColorEncoding = */
+        false, /* doColorEncoding = */
+        STATIC_RANGE_CODING /* entropyCodingMethod = */
     }, {
     // PROFILE: LOW_RES_OFFLINE_COMPRESSION_WITH_COLOR
         0.01, /* pointResolution = */
@@ -142,7 +166,8 @@ namespace pcl
         true, /* doVoxelGridDownDownSampling = */
         100, /* iFrameRate = */
         4, /* colorBitResolution = */
-        true /* doColorEncoding = */
+        true, /* doColorEncoding = */
+        STATIC_RANGE_CODING /* entropyCodingMethod = */
     }, {
     // PROFILE: MED_RES_OFFLINE_COMPRESSION_WITHOUT_COLOR
         0.005, /* pointResolution = */
@@ -150,7 +175,8 @@ namespace pcl
         true, /* doVoxelGridDownDownSampling = */
         100, /* iFrameRate = */
         5, /* colorBitResolution = */
-        false /* doColorEncoding = */
+        false, /* doColorEncoding = */
+        STATIC_RANGE_CODING /* entropyCodingMethod = */
     }, {
     // PROFILE: MED_RES_OFFLINE_COMPRESSION_WITH_COLOR
         0.005, /* pointResolution = */
@@ -158,7 +184,8 @@ namespace pcl
         false, /* doVoxelGridDownDownSampling = */
         100, /* iFrameRate = */
         5, /* colorBitResolution = */
-        true /* doColorEncoding = */
+        true, /* doColorEncoding = */
+        STATIC_RANGE_CODING /* entropyCodingMethod = */
     }, {
     // PROFILE: HIGH_RES_OFFLINE_COMPRESSION_WITHOUT_COLOR
         0.0001, /* pointResolution = */
@@ -166,7 +193,8 @@ namespace pcl
         true, /* doVoxelGridDownDownSampling = */
         100, /* iFrameRate = */
         8, /* colorBitResolution = */
-        false /* doColorEncoding = */
+        false, /* doColorEncoding = */
+        STATIC_RANGE_CODING /* entropyCodingMethod = */
     }, {
     // PROFILE: HIGH_RES_OFFLINE_COMPRESSION_WITH_COLOR
         0.0001, /* pointResolution = */
@@ -174,7 +202,62 @@ namespace pcl
         false, /* doVoxelGridDownDownSampling = */
         100, /* iFrameRate = */
         8, /* colorBitResolution = */
-        true /* doColorEncoding = */
+        true, /* doColorEncoding = */
+        STATIC_RANGE_CODING /* entropyCodingMethod = */
+    }, {
+    // PROFILE: LOW_RES_ONLINE_RANS_COMPRESSION_WITHOUT_COLOR
+        0.01, /* pointResolution = */
+        0.01, /* octreeResolution = */
+        true, /* doVoxelGridDownDownSampling = */
+        50, /* iFrameRate = */
+        4, /* colorBitResolution = */
+        false, /* doColorEncoding = */
+        INTERLEAVED_RANS_CODING /* entropyCodingMethod = */
+    }, {
+    // PROFILE: LOW_RES_ONLINE_RANS_COMPRESSION_WITH_COLOR
+        0.01, /* pointResolution = */
+        0.01, /* octreeResolution = */
+        true, /* doVoxelGridDownDownSampling = */
+        50, /* iFrameRate = */
+        4, /* colorBitResolution = */
+        true, /* doColorEncoding = */
+        INTERLEAVED_RANS_CODING /* entropyCodingMethod = */
+    }, {
+    // PROFILE: MED_RES_ONLINE_RANS_COMPRESSION_WITHOUT_COLOR
+        0.005, /* pointResolution = */
+        0.01, /* octreeResolution = */
+        false, /* doVoxelGridDownDownSampling = */
+        40, /* iFrameRate = */
+        5, /* colorBitResolution = */
+        false, /* doColorEncoding = */
+        INTERLEAVED_RANS_CODING /* entropyCodingMethod = */
+    }, {
+    // PROFILE: MED_RES_ONLINE_RANS_COMPRESSION_WITH_COLOR
+        0.005, /* pointResolution = */
+        0.01, /* octreeResolution = */
+        false, /* doVoxelGridDownDownSampling = */
+        40, /* iFrameRate = */
+        5, /* colorBitResolution = */
+        true, /* doColorEncoding = */
+        INTERLEAVED_RANS_CODING /* entropyCodingMethod = */
+    }, {
+    // PROFILE: HIGH_RES_ONLINE_RANS_COMPRESSION_WITHOUT_COLOR
+        0.0001, /* pointResolution = */
+        0.01, /* octreeResolution = */
+        false, /* doVoxelGridDownDownSampling = */
+        30, /* iFrameRate = */
+        7, /* colorBitResolution = */
+        false, /* doColorEncoding = */
+        INTERLEAVED_RANS_CODING /* entropyCodingMethod = */
+    }, {
+    // PROFILE: HIGH_RES_ONLINE_RANS_COMPRESSION_WITH_COLOR
+        0.0001, /* pointResolution = */
+        0.01, /* octreeResolution = */
+        false, /* doVoxelGridDownDownSampling = */
+        30, /* iFrameRate = */
+        7, /* colorBitResolution = */
+        true, /* doColorEncoding = */
+        INTERLEAVED_RANS_CODING /* entropyCodingMethod = */
     }};
 
   }
@@ -0,0 +1,317 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_COMPRESSION_ENTROPY_RANS_CODER_H_
+#define PCL_COMPRESSION_ENTROPY_RANS_CODER_H_
+
+#include <iostream>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+namespace pcl
+{
+  using boost::uint8_t;
+  using boost::uint16_t;
+  using boost::uint32_t;
+  using boost::uint64_t;
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief @b InterleavedRansCoder compression class
+   *  \note This class provides static entropy coding based on range asymmetric numeral systems (rANS) with four
+   *  \note interleaved coder states. In contrast to StaticRangeCoder it encodes into and decodes from caller-provided
+   *  \note byte buffers; the stream methods are thin adaptors that issue a single write/read per block.
+   *  \note Symbol frequencies are quantized to 12 bit, encoding uses reciprocal multiplication instead of divisions
+   *  \note and decoding uses a direct slot-to-symbol lookup table.
+   *  \note Integer vectors are split into byte planes which are coded independently; all-zero planes cost nothing.
+   *  \note Blocks are self-delimiting: each one stores its own symbol count and frequency table.
+   */
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  class InterleavedRansCoder
+  {
+    public:
+      /** \brief Constructor. */
+      InterleavedRansCoder () : streamBuffer_ (), planeBuffer_ ()
+      {
+      }
+
+      /** \brief Empty deconstructor. */
+      virtual
+      ~InterleavedRansCoder ()
+      {
+      }
+
+      /** \brief Largest symbol count of a block accepted by the decoder. Longer blocks are treated as corrupt. */
+      static const uint32_t MAX_SYMBOL_COUNT = 1u << 26;
+
+      /** \brief Upper bound of the encoded size of a char vector
+        * \param[in] symbolCount_arg amount of input symbols
+        * \return maximum amount of bytes written by encodeCharVectorToBuffer
+        */
+      static std::size_t
+      getMaxEncodedCharVectorSize (std::size_t symbolCount_arg)
+      {
+        // block header + frequency table + payload length + 2 bytes per symbol worst case + coder state flush
+        return (BLOCK_HEADER_SIZE + 32 + 2 * 256 + 4 + 2 * symbolCount_arg + 4 * STATE_COUNT);
+      }
+
+      /** \brief Upper bound of the encoded size of an integer vector
+        * \param[in] symbolCount_arg amount of input integers
+        * \return maximum amount of bytes written by encodeIntVectorToBuffer
+        */
+      static std::size_t
+      getMaxEncodedIntVectorSize (std::size_t symbolCount_arg)
+      {
+        return (BLOCK_HEADER_SIZE + sizeof (uint32_t) * getMaxEncodedCharVectorSize (symbolCount_arg));
+      }
+
+      /** \brief Encode char vector to a preallocated byte buffer
+        * \param[in] inputByteVector_arg input vector
+        * \param[out] outputBuffer_arg output buffer receiving the compressed block
+        * \param[in] bufferSize_arg capacity of the output buffer, see getMaxEncodedCharVectorSize ()
+        * \return amount of bytes written to the buffer, 0 if the buffer is too small
+        */
+      unsigned long
+      encodeCharVectorToBuffer (const std::vector<char>& inputByteVector_arg, char* outputBuffer_arg,
+                                std::size_t bufferSize_arg);
+
+      /** \brief Decode a compressed block to output vector
+        * \param[in] inputBuffer_arg buffer pointing at the beginning of a compressed block
+        * \param[in] bufferSize_arg amount of valid bytes in the input buffer
+        * \param[out] outputByteVector_arg decompressed output vector (resized to the encoded symbol count)
+        * \return amount of bytes consumed from the buffer, 0 if the block is truncated or corrupt
+        */
+      unsigned long
+      decodeBufferToCharVector (const char* inputBuffer_arg, std::size_t bufferSize_arg,
+                                std::vector<char>& outputByteVector_arg);
+
+      /** \brief Encode integer vector to a preallocated byte buffer
+        * \param[in] inputIntVector_arg input vector
+        * \param[out] outputBuffer_arg output buffer receiving the compressed block
+        * \param[in] bufferSize_arg capacity of the output buffer, see getMaxEncodedIntVectorSize ()
+        * \return amount of bytes written to the buffer, 0 if the buffer is too small
+        */
+      unsigned long
+      encodeIntVectorToBuffer (const std::vector<unsigned int>& inputIntVector_arg, char* outputBuffer_arg,
+                               std::size_t bufferSize_arg);
+
+      /** \brief Decode a compressed block to output integer vector
+        * \param[in] inputBuffer_arg buffer pointing at the beginning of a compressed block
+        * \param[in] bufferSize_arg amount of valid bytes in the input buffer
+        * \param[out] outputIntVector_arg decompressed output vector (resized to the encoded symbol count)
+        * \return amount of bytes consumed from the buffer, 0 if the block is truncated or corrupt
+        */
+      unsigned long
+      decodeBufferToIntVector (const char* inputBuffer_arg, std::size_t bufferSize_arg,
+                               std::vector<unsigned int>& outputIntVector_arg);
+
+      /** \brief Encode char vector to output stream using a single stream write
+        * \param[in] inputByteVector_arg input vector
+        * \param[out] outputByteStream_arg output stream containing compressed data
+        * \return amount of bytes written to output stream
+        */
+      unsigned long
+      encodeCharVectorToStream (const std::vector<char>& inputByteVector_arg, std::ostream& outputByteStream_arg);
+
+      /** \brief Decode char stream to output vector
+        * \param[in] inputByteStream_arg input stream of compressed data
+        * \param[out] outputByteVector_arg decompressed output vector
+        * \return amount of bytes read from input stream, 0 if the block is truncated or corrupt
+        */
+      unsigned long
+      decodeStreamToCharVector (std::istream& inputByteStream_arg, std::vector<char>& outputByteVector_arg);
+
+      /** \brief Encode integer vector to output stream using a single stream write
+        * \param[in] inputIntVector_arg input vector
+        * \param[out] outputByteStream_arg output stream containing compressed data
+        * \return amount of bytes written to output stream
+        */
+      unsigned long
+      encodeIntVectorToStream (const std::vector<unsigned int>& inputIntVector_arg, std::ostream& outputByteStream_arg);
+
+      /** \brief Decode stream to output integer vector
+        * \param[in] inputByteStream_arg input stream of compressed data
+        * \param[out] outputIntVector_arg decompressed output vector
+        * \return amount of bytes read from input stream, 0 if the block is truncated or corrupt
+        */
+      unsigned long
+      decodeStreamToIntVector (std::istream& inputByteStream_arg, std::vector<unsigned int>& outputIntVector_arg);
+
+    protected:
+      /** \brief Encoder symbol description; replaces the division of the rANS update by a multiplication. */
+      struct EncoderSymbol
+      {
+        uint32_t xMax;
+        uint32_t rcpFreq;
+        uint32_t bias;
+        uint16_t cmplFreq;
+        uint16_t rcpShift;
+      };
+
+      /** \brief Block modes */
+      enum
+      {
+        BLOCK_EMPTY = 0,
+        BLOCK_SINGLE_SYMBOL = 1,
+        BLOCK_RANS = 2
+      };
+
+      /** \brief Constants of the coder: 12 bit probability resolution, byte-wise renormalization. */
+      enum
+      {
+        STATE_COUNT = 4,
+        SCALE_BITS = 12,
+        SCALE = 1 << SCALE_BITS,
+        BLOCK_HEADER_SIZE = 5
+      };
+
+      /** \brief Lower bound of the normalization interval of a coder state. */
+      static const uint32_t RANS_L = 1u << 23;
+
+      /** \brief Count symbol occurrences using four sub-histograms to break store-to-load dependencies.
+        * \param[in] input_arg input symbols
+        * \param[in] len_arg amount of input symbols
+        */
+      void
+      computeHistogram (const uint8_t* input_arg, std::size_t len_arg);
+
+      /** \brief Quantize histogram_ to frequencies summing up to SCALE, keeping every present symbol nonzero.
+        * \param[in] total_arg amount of counted symbols
+        */
+      void
+      normalizeFrequencies (uint32_t total_arg);
+
+      /** \brief Encode a byte sequence into a block
+        * \param[in] input_arg input symbols
+        * \param[in] len_arg amount of input symbols
+        * \param[out] output_arg output buffer
+        * \param[in] bufferSize_arg capacity of output buffer
+        * \return amount of bytes written, 0 if the buffer is too small
+        */
+      std::size_t
+      encodeBlock (const uint8_t* input_arg, std::size_t len_arg, uint8_t* output_arg, std::size_t bufferSize_arg);
+
+      /** \brief Decode a block into a byte sequence
+        * \param[in] input_arg input buffer
+        * \param[in] bufferSize_arg amount of valid bytes in input buffer
+        * \param[out] output_arg output symbols, resized to the encoded symbol count
+        * \return amount of bytes consumed, 0 if the block is truncated or corrupt
+        */
+      std::size_t
+      decodeBlock (const uint8_t* input_arg, std::size_t bufferSize_arg, std::vector<char>& output_arg);
+
+      /** \brief Write little endian 32 bit value */
+      static inline void
+      writeUInt32 (uint8_t* ptr_arg, uint32_t value_arg)
+      {
+        ptr_arg[0] = static_cast<uint8_t> (value_arg);
+        ptr_arg[1] = static_cast<uint8_t> (value_arg >> 8);
+        ptr_arg[2] = static_cast<uint8_t> (value_arg >> 16);
+        ptr_arg[3] = static_cast<uint8_t> (value_arg >> 24);
+      }
+
+      /** \brief Read little endian 32 bit value */
+      static inline uint32_t
+      readUInt32 (const uint8_t* ptr_arg)
+      {
+        return (static_cast<uint32_t> (ptr_arg[0]) | (static_cast<uint32_t> (ptr_arg[1]) << 8) |
+                (static_cast<uint32_t> (ptr_arg[2]) << 16) | (static_cast<uint32_t> (ptr_arg[3]) << 24));
+      }
+
+      /** \brief Encode one symbol, emitting renormalization bytes backwards from ptr_arg
+        * \param[in,out] state_arg coder state
+        * \param[in,out] ptr_arg write pointer (moves towards the buffer start)
+        * \param[in] sym_arg encoder symbol description
+        */
+      static inline void
+      encodeSymbol (uint32_t& state_arg, uint8_t*& ptr_arg, const EncoderSymbol& sym_arg)
+      {
+        uint32_t x = state_arg;
+        while (x >= sym_arg.xMax)
+        {
+          *--ptr_arg = static_cast<uint8_t> (x & 0xff);
+          x >>= 8;
+        }
+        uint32_t q = static_cast<uint32_t> ((static_cast<uint64_t> (x) * sym_arg.rcpFreq) >> 32) >> sym_arg.rcpShift;
+        state_arg = x + sym_arg.bias + q * sym_arg.cmplFreq;
+      }
+
+      /** \brief Decode one symbol and renormalize
+        * \param[in,out] state_arg coder state
+        * \param[in,out] ptr_arg read pointer
+        * \param[in] end_arg end of readable input
+        * \return decoded symbol
+        */
+      inline uint8_t
+      decodeSymbol (uint32_t& state_arg, const uint8_t*& ptr_arg, const uint8_t* end_arg) const
+      {
+        const uint32_t slot = state_arg & (SCALE - 1);
+        const uint8_t symbol = slotSymbol_[slot];
+        uint32_t x = freq_[symbol] * (state_arg >> SCALE_BITS) + slot - start_[symbol];
+        while (x < RANS_L && ptr_arg < end_arg)
+          x = (x << 8) | *ptr_arg++;
+        state_arg = x;
+        return (symbol);
+      }
+
+    private:
+      /** \brief Symbol histogram */
+      uint32_t histogram_[256];
+
+      /** \brief Sub-histograms used while counting */
+      uint32_t subHistograms_[4][256];
+
+      /** \brief Quantized symbol frequencies */
+      uint32_t freq_[256];
+
+      /** \brief Cumulative quantized symbol frequencies */
+      uint32_t start_[256];
+
+      /** \brief Encoder symbol table */
+      EncoderSymbol encSymbols_[256];
+
+      /** \brief Decoder slot-to-symbol lookup table */
+      uint8_t slotSymbol_[SCALE];
+
+      /** \brief Reusable buffer backing the stream adaptors. */
+      std::vector<char> streamBuffer_;
+
+      /** \brief Reusable buffer holding one byte plane of an integer vector. */
+      std::vector<char> planeBuffer_;
+  };
+}
+
+#endif
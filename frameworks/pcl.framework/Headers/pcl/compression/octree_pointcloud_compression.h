@@ -42,6 +42,7 @@
 #include <pcl/pcl/common/io.h>
 #include <pcl/pcl/octree/octree_pointcloud.h>
 #include "entropy_range_coder.h"
+#include "entropy_rans_coder.h"
 #include "color_coding.h"
 #include "point_coding.h"
 
@@ -158,6 +159,17 @@ namespace pcl
 
         }
 
+        /** \brief Get the entropy coding backend of the selected compression profile.
+          * \note Manually configured compression uses static range coding. The decoder detects the backend of each frame.
+          */
+        inline entropyCoding_Method_e
+        getEntropyCodingMethod () const
+        {
+          if (selectedProfile_ != MANUAL_CONFIGURATION)
+            return (compressionProfiles_[selectedProfile_].entropyCodingMethod);
+          return (STATIC_RANGE_CODING);
+        }
+
         /** \brief Provide a pointer to the output data set.
           * \param cloud_arg: the boost shared pointer to a PointCloud message
           */
@@ -209,8 +221,9 @@ namespace pcl
 
         /** \brief Synchronize to frame header
           * \param compressedTreeDataIn_arg: binary input stream
+          * \return entropy coding backend of the frame, given by its header identifier
           */
-        void
+        entropyCoding_Method_e
         syncToHeader (std::istream& compressedTreeDataIn_arg);
 
         /** \brief Apply entropy encoding to encoded information and output to binary stream
@@ -225,6 +238,20 @@ namespace pcl
         void
         entropyDecoding (std::istream& compressedTreeDataIn_arg);
 
+        /** \brief Apply interleaved rANS encoding to all information vectors of a frame. The vectors are coded into
+          * a single frame buffer which is written to the binary stream at once.
+          * \param compressedTreeDataOut_arg: binary output stream
+          */
+        void
+        ransEntropyEncoding (std::ostream& compressedTreeDataOut_arg);
+
+        /** \brief Interleaved rANS decoding of a frame buffer from the input stream to information vectors
+          * \param compressedTreeDataIn_arg: binary input stream
+          * \return false if the frame buffer is truncated or one of its blocks is corrupt
+          */
+        bool
+        ransEntropyDecoding (std::istream& compressedTreeDataIn_arg);
+
         /** \brief Encode leaf node information during serialization
           * \param leaf_arg: reference to new leaf node
           * \param key_arg: octree key of new leaf node
@@ -284,6 +311,9 @@ namespace pcl
         // frame header identifier
         static const char* frameHeaderIdentifier_;
 
+        // frame header identifier of interleaved rANS coded frames
+        static const char* ransFrameHeaderIdentifier_;
+
         const compression_Profiles_e selectedProfile_;
         const double pointResolution_;
         const double octreeResolution_;
@@ -294,6 +324,9 @@ namespace pcl
     // define frame header initialization
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT>
       const char* PointCloudCompression<PointT, LeafT, BranchT, OctreeT>::frameHeaderIdentifier_ = "<PCL-COMPRESSED>";
+
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT>
+      const char* PointCloudCompression<PointT, LeafT, BranchT, OctreeT>::ransFrameHeaderIdentifier_ = "<PCL-RANS-COMPRESSED>";
   }
 
 }
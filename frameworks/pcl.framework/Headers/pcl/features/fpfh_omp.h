@@ -65,6 +65,10 @@ namespace pcl
     *     doesn't have finite 3D coordinates. Therefore, any point that contains
     *     NaN data on x, y, or z, will have its FPFH feature property set to NaN.
     *
+    * \note The neighborhoods found while collecting the SPFH points are kept in a compressed sparse row (CSR)
+    * buffer and reused by both passes, so every neighborhood is searched exactly once. The SPFH signatures are
+    * stored row-wise in one contiguous float array.
+    *
     * \author Radu B. Rusu
     * \ingroup features
     */
@@ -75,6 +79,7 @@ namespace pcl
       using Feature<PointInT, PointOutT>::feature_name_;
       using Feature<PointInT, PointOutT>::getClassName;
       using Feature<PointInT, PointOutT>::indices_;
+      using Feature<PointInT, PointOutT>::fake_indices_;
       using Feature<PointInT, PointOutT>::k_;
       using Feature<PointInT, PointOutT>::search_parameter_;
       using Feature<PointInT, PointOutT>::input_;
@@ -84,8 +89,10 @@ namespace pcl
       using FPFHEstimation<PointInT, PointNT, PointOutT>::hist_f2_;
       using FPFHEstimation<PointInT, PointNT, PointOutT>::hist_f3_;
       using FPFHEstimation<PointInT, PointNT, PointOutT>::weightPointSPFHSignature;
+      using FPFHEstimation<PointInT, PointNT, PointOutT>::d_pi_;
 
       typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
+      typedef typename Feature<PointInT, PointOutT>::PointCloudIn PointCloudIn;
 
       /** \brief Empty constructor. */
       FPFHEstimationOMP () : nr_bins_f1_ (11), nr_bins_f2_ (11), nr_bins_f3_ (11), threads_ (1) 
@@ -121,6 +128,38 @@ namespace pcl
       void 
       computeFeature (PointCloudOut &output);
 
+      /** \brief Search the neighborhoods of a list of points in parallel and store them in CSR form: the
+        * neighbors of indices[i] occupy the range [offsets[i], offsets[i + 1]) of nn_indices and nn_dists.
+        * \param[in] cloud the cloud holding the query points
+        * \param[in] indices the indices of the query points in cloud
+        * \param[out] offsets the start of every neighborhood, followed by the total number of neighbors
+        * \param[out] nn_indices the concatenated neighbor indices into the search surface
+        * \param[out] nn_dists the concatenated squared neighbor distances
+        */
+      void
+      computeNeighborhoods (const PointCloudIn &cloud, const std::vector<int> &indices,
+                            std::vector<int> &offsets, std::vector<int> &nn_indices, std::vector<float> &nn_dists);
+
+      /** \brief Estimate the SPFH signature of a point into one row of the contiguous histogram array.
+        * \param[in] p_idx the index of the query point in the search surface
+        * \param[in] nn_indices the neighbors of p_idx
+        * \param[in] nr_neighbors the number of neighbors of p_idx
+        * \param[out] hist the row receiving the f1, f2 and f3 histograms back to back
+        */
+      void
+      computePointSPFHSignature (int p_idx, const int *nn_indices, int nr_neighbors, float *hist);
+
+      /** \brief Combine the SPFH signatures of a neighborhood into the FPFH signature of its query point.
+        * \param[in] spfh_hist the SPFH signatures, one row of nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_ floats per point
+        * \param[in] nn_rows the SPFH rows of the neighbors
+        * \param[in] nn_dists the squared distances to the neighbors
+        * \param[in] nr_neighbors the number of neighbors
+        * \param[out] fpfh_histogram the resultant FPFH signature
+        */
+      void
+      weightPointSPFHSignature (const float *spfh_hist, const int *nn_rows, const float *nn_dists, int nr_neighbors,
+                                float *fpfh_histogram);
+
     public:
       /** \brief The number of subdivisions for each angular feature interval. */
       int nr_bins_f1_, nr_bins_f2_, nr_bins_f3_;
@@ -42,103 +42,260 @@
 
 #include <pcl/pcl/features/fpfh_omp.h>
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeNeighborhoods (
+    const PointCloudIn &cloud, const std::vector<int> &indices,
+    std::vector<int> &offsets, std::vector<int> &nn_indices, std::vector<float> &nn_dists)
+{
+  // Search in blocks of consecutive points, so that every block appends to its own buffers and the
+  // results can be concatenated in order afterwards
+  const int block_size = 256;
+  const int nr_points = static_cast<int> (indices.size ());
+  const int nr_blocks = (nr_points + block_size - 1) / block_size;
+
+  std::vector<std::vector<int> > block_indices (nr_blocks);
+  std::vector<std::vector<float> > block_dists (nr_blocks);
+  std::vector<int> counts (nr_points, 0);
+
+#pragma omp parallel num_threads (threads_)
+  {
+    std::vector<int> nn_idx (k_); // \note These resizes are irrelevant for a radiusSearch ().
+    std::vector<float> nn_dst (k_);
+
+#pragma omp for schedule (dynamic, 1)
+    for (int block = 0; block < nr_blocks; ++block)
+    {
+      const int end = std::min (nr_points, (block + 1) * block_size);
+      for (int i = block * block_size; i < end; ++i)
+      {
+        if (!isFinite (cloud.points[indices[i]]))
+          continue;
+        nn_idx.resize (k_);
+        nn_dst.resize (k_);
+        const int nr_neighbors = this->searchForNeighbors (cloud, indices[i], search_parameter_, nn_idx, nn_dst);
+        if (nr_neighbors <= 0)
+          continue;
+        counts[i] = nr_neighbors;
+        block_indices[block].insert (block_indices[block].end (), nn_idx.begin (), nn_idx.begin () + nr_neighbors);
+        block_dists[block].insert (block_dists[block].end (), nn_dst.begin (), nn_dst.begin () + nr_neighbors);
+      }
+    }
+  }
+
+  offsets.resize (nr_points + 1);
+  offsets[0] = 0;
+  for (int i = 0; i < nr_points; ++i)
+    offsets[i + 1] = offsets[i] + counts[i];
+
+  nn_indices.resize (offsets[nr_points]);
+  nn_dists.resize (offsets[nr_points]);
+
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads_)
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    std::copy (block_indices[block].begin (), block_indices[block].end (), nn_indices.begin () + offsets[block * block_size]);
+    std::copy (block_dists[block].begin (), block_dists[block].end (), nn_dists.begin () + offsets[block * block_size]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computePointSPFHSignature (
+    int p_idx, const int *nn_indices, int nr_neighbors, float *hist)
+{
+  float *hist_f1 = hist;
+  float *hist_f2 = hist_f1 + nr_bins_f1_;
+  float *hist_f3 = hist_f2 + nr_bins_f2_;
+
+  // Factorization constant
+  float hist_incr = 100.0f / static_cast<float>(nr_neighbors - 1);
+
+  const Eigen::Vector4f &p = surface_->points[p_idx].getVector4fMap ();
+  const Eigen::Vector4f &n_p = normals_->points[p_idx].getNormalVector4fMap ();
+
+  float f1, f2, f3, f4;
+  for (int idx = 0; idx < nr_neighbors; ++idx)
+  {
+    // Avoid unnecessary returns
+    const int q_idx = nn_indices[idx];
+    if (p_idx == q_idx)
+      continue;
+
+    if (!pcl::computePairFeatures (p, n_p, surface_->points[q_idx].getVector4fMap (),
+                                   normals_->points[q_idx].getNormalVector4fMap (), f1, f2, f3, f4))
+      continue;
+
+    // Normalize the f1, f2, f3 features and push them in the histogram
+    int h_index = static_cast<int> (floor (nr_bins_f1_ * ((f1 + M_PI) * d_pi_)));
+    if (h_index < 0)            h_index = 0;
+    if (h_index >= nr_bins_f1_) h_index = nr_bins_f1_ - 1;
+    hist_f1[h_index] += hist_incr;
+
+    h_index = static_cast<int> (floor (nr_bins_f2_ * ((f2 + 1.0) * 0.5)));
+    if (h_index < 0)            h_index = 0;
+    if (h_index >= nr_bins_f2_) h_index = nr_bins_f2_ - 1;
+    hist_f2[h_index] += hist_incr;
+
+    h_index = static_cast<int> (floor (nr_bins_f3_ * ((f3 + 1.0) * 0.5)));
+    if (h_index < 0)            h_index = 0;
+    if (h_index >= nr_bins_f3_) h_index = nr_bins_f3_ - 1;
+    hist_f3[h_index] += hist_incr;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::weightPointSPFHSignature (
+    const float *spfh_hist, const int *nn_rows, const float *nn_dists, int nr_neighbors, float *fpfh_histogram)
+{
+  const int nr_bins_f12 = nr_bins_f1_ + nr_bins_f2_;
+  const int nr_bins = nr_bins_f12 + nr_bins_f3_;
+  double sum_f1 = 0.0, sum_f2 = 0.0, sum_f3 = 0.0;
+
+  std::fill (fpfh_histogram, fpfh_histogram + nr_bins, 0.0f);
+
+  for (int idx = 0; idx < nr_neighbors; ++idx)
+  {
+    // Minus the query point itself
+    if (nn_dists[idx] == 0)
+      continue;
+
+    // Standard weighting function used
+    const float weight = 1.0f / nn_dists[idx];
+    const float *hist = spfh_hist + static_cast<size_t> (nn_rows[idx]) * nr_bins;
+
+    // Weight the SPFH of the query point with the SPFH of its neighbors
+    for (int d = 0; d < nr_bins_f1_; ++d)
+    {
+      const float val = hist[d] * weight;
+      sum_f1 += val;
+      fpfh_histogram[d] += val;
+    }
+    for (int d = nr_bins_f1_; d < nr_bins_f12; ++d)
+    {
+      const float val = hist[d] * weight;
+      sum_f2 += val;
+      fpfh_histogram[d] += val;
+    }
+    for (int d = nr_bins_f12; d < nr_bins; ++d)
+    {
+      const float val = hist[d] * weight;
+      sum_f3 += val;
+      fpfh_histogram[d] += val;
+    }
+  }
+
+  if (sum_f1 != 0)
+    sum_f1 = 100.0 / sum_f1;           // histogram values sum up to 100
+  if (sum_f2 != 0)
+    sum_f2 = 100.0 / sum_f2;           // histogram values sum up to 100
+  if (sum_f3 != 0)
+    sum_f3 = 100.0 / sum_f3;           // histogram values sum up to 100
+
+  // Adjust final FPFH values
+  for (int d = 0; d < nr_bins_f1_; ++d)
+    fpfh_histogram[d] *= static_cast<float> (sum_f1);
+  for (int d = nr_bins_f1_; d < nr_bins_f12; ++d)
+    fpfh_histogram[d] *= static_cast<float> (sum_f2);
+  for (int d = nr_bins_f12; d < nr_bins; ++d)
+    fpfh_histogram[d] *= static_cast<float> (sum_f3);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
 {
+  // Search the neighborhoods of all query points once. They are needed by the FPFH pass and, when the
+  // queries are exactly the surface points in order, they are also the neighborhoods of the SPFH pass.
+  std::vector<int> query_offsets, query_nn_indices;
+  std::vector<float> query_nn_dists;
+  computeNeighborhoods (*input_, *indices_, query_offsets, query_nn_indices, query_nn_dists);
+
   std::vector<int> spfh_indices_vec;
-  std::vector<int> spfh_hist_lookup (surface_->points.size ());
+  std::vector<int> spfh_hist_lookup (surface_->points.size (), 0);
+
+  std::vector<int> spfh_offsets, spfh_nn_indices;
+  std::vector<float> spfh_nn_dists;
+  const std::vector<int> *offsets = &query_offsets;
+  const std::vector<int> *nn_indices = &query_nn_indices;
+
+  bool identity_indices = (surface_ == input_ && indices_->size () == surface_->points.size ());
+  if (identity_indices && !fake_indices_)
+    for (size_t idx = 0; idx < indices_->size () && identity_indices; ++idx)
+      identity_indices = ((*indices_)[idx] == static_cast<int> (idx));
 
   // Build a list of (unique) indices for which we will need to compute SPFH signatures
   // (We need an SPFH signature for every point that is a neighbor of any point in input_[indices_])
-  if (surface_ != input_ ||
-      indices_->size () != surface_->points.size ())
-  { 
-    std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-    std::vector<float> nn_dists (k_); 
-
-    std::set<int> spfh_indices_set;
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
-    {
-      int p_idx = (*indices_)[idx];
-      if (this->searchForNeighbors (p_idx, search_parameter_, nn_indices, nn_dists) == 0)
-        continue;
-      
-      spfh_indices_set.insert (nn_indices.begin (), nn_indices.end ());
-    }
-    spfh_indices_vec.resize (spfh_indices_set.size ());
-    std::copy (spfh_indices_set.begin (), spfh_indices_set.end (), spfh_indices_vec.begin ());
+  if (!identity_indices)
+  {
+    std::vector<char> is_spfh_point (surface_->points.size (), 0);
+    for (size_t i = 0; i < query_nn_indices.size (); ++i)
+      is_spfh_point[query_nn_indices[i]] = 1;
+    for (int p_idx = 0; p_idx < static_cast<int> (is_spfh_point.size ()); ++p_idx)
+      if (is_spfh_point[p_idx])
+        spfh_indices_vec.push_back (p_idx);
+
+    computeNeighborhoods (*surface_, spfh_indices_vec, spfh_offsets, spfh_nn_indices, spfh_nn_dists);
+    offsets = &spfh_offsets;
+    nn_indices = &spfh_nn_indices;
   }
   else
   {
-    // Special case: When a feature must be computed at every point, there is no need for a neighborhood search
+    // Special case: When the feature is computed at every surface point in order, there is no need for another
+    // neighborhood search
     spfh_indices_vec.resize (indices_->size ());
     for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
       spfh_indices_vec[idx] = idx;
   }
 
-  // Initialize the arrays that will store the SPFH signatures
-  size_t data_size = spfh_indices_vec.size ();
-  hist_f1_.setZero (data_size, nr_bins_f1_);
-  hist_f2_.setZero (data_size, nr_bins_f2_);
-  hist_f3_.setZero (data_size, nr_bins_f3_);
+  // Populate a lookup table for converting a point index to its corresponding row in spfh_hist
+  for (int i = 0; i < static_cast<int> (spfh_indices_vec.size ()); ++i)
+    spfh_hist_lookup[spfh_indices_vec[i]] = i;
+
+  // Initialize the array that will store the SPFH signatures
+  const int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
+  std::vector<float> spfh_hist (spfh_indices_vec.size () * nr_bins, 0.0f);
 
   // Compute SPFH signatures for every point that needs them
-  
-#pragma omp parallel for schedule (dynamic, threads_)
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
   for (int i = 0; i < static_cast<int> (spfh_indices_vec.size ()); ++i)
   {
-    // Get the next point index
-    int p_idx = spfh_indices_vec[i];
-
-    // Find the neighborhood around p_idx
-    std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-    std::vector<float> nn_dists (k_); 
-    if (this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+    const int begin = (*offsets)[i];
+    const int nr_neighbors = (*offsets)[i + 1] - begin;
+    if (nr_neighbors == 0)
       continue;
 
-    // Estimate the SPFH signature around p_idx
-    this->computePointSPFHSignature (*surface_, *normals_, p_idx, i, nn_indices, hist_f1_, hist_f2_, hist_f3_);
-
-    // Populate a lookup table for converting a point index to its corresponding row in the spfh_hist_* matrices
-    spfh_hist_lookup[p_idx] = i;
+    computePointSPFHSignature (spfh_indices_vec[i], &(*nn_indices)[begin], nr_neighbors,
+                               &spfh_hist[static_cast<size_t> (i) * nr_bins]);
   }
 
-  // Intialize the array that will store the FPFH signature
-  int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
+  // Remap the neighbor indices of the queries so that they represent rows in spfh_hist
+  // instead of indices into surface_->points
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int i = 0; i < static_cast<int> (query_nn_indices.size ()); ++i)
+    query_nn_indices[i] = spfh_hist_lookup[query_nn_indices[i]];
 
   // Iterate over the entire index vector
-#pragma omp parallel for schedule (dynamic, threads_)
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
   for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
   {
-    // Find the indices of point idx's neighbors...
-    std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-    std::vector<float> nn_dists (k_); 
-    if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-        this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+    const int begin = query_offsets[idx];
+    const int nr_neighbors = query_offsets[idx + 1] - begin;
+    if (nr_neighbors == 0)
     {
       for (int d = 0; d < nr_bins; ++d)
         output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
-  
+
       output.is_dense = false;
       continue;
     }
 
-
-    // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices 
-    // instead of indices into surface_->points
-    for (size_t i = 0; i < nn_indices.size (); ++i)
-      nn_indices[i] = spfh_hist_lookup[nn_indices[i]];
-
-    // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-    Eigen::VectorXf fpfh_histogram = Eigen::VectorXf::Zero (nr_bins);
-    weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram);
-
-    // ...and copy it into the output cloud
-    for (int d = 0; d < nr_bins; ++d)
-      output.points[idx].histogram[d] = fpfh_histogram[d];
+    // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures)
+    // directly into the output cloud
+    weightPointSPFHSignature (&spfh_hist[0], &query_nn_indices[begin], &query_nn_dists[begin], nr_neighbors,
+                              output.points[idx].histogram);
   }
-
 }
 
 #define PCL_INSTANTIATE_FPFHEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::FPFHEstimationOMP<T,NT,OutT>;
@@ -40,28 +40,128 @@
 #define PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
 #include <cstddef>
+#include <cstring>
+#include <algorithm>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename DataType, unsigned Dimension> void
 pcl::IntegralImage2D<DataType, Dimension>::setSecondOrderComputation (bool compute_second_order_integral_images)
 {
+  // the images built so far lack (or needlessly hold) the second order sums
+  if (compute_second_order_integral_images != compute_second_order_integral_images_)
+    reference_frame_valid_ = false;
   compute_second_order_integral_images_ = compute_second_order_integral_images;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename DataType, unsigned Dimension> void
-pcl::IntegralImage2D<DataType, Dimension>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
+pcl::IntegralImage2D<DataType, Dimension>::setSecondOrderFixedPoint (bool use_fixed_point, double resolution)
+{
+  // the second order images built so far are in another representation
+  if (use_fixed_point != use_fixed_point_ || (use_fixed_point && resolution != fixed_point_resolution_))
+    reference_frame_valid_ = false;
+  use_fixed_point_ = use_fixed_point;
+  fixed_point_resolution_ = resolution;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType, unsigned Dimension> void
+pcl::IntegralImage2D<DataType, Dimension>::allocateImages (unsigned width, unsigned height)
 {
-  if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
+  const size_t size = static_cast<size_t> (width + 1) * (height + 1);
+  // the stored reference frame is laid out row by row, so any change of shape invalidates it
+  if (width != width_ || height != height_)
+    reference_frame_valid_ = false;
+  width_  = width;
+  height_ = height;
+  if (first_order_integral_image_.size () != size)
   {
-    width_  = width;
-    height_ = height;
-    first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    if (compute_second_order_integral_images_)
-      second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+    first_order_integral_image_.resize (size);
+    finite_values_integral_image_.resize (size);
+    reference_frame_valid_ = false;
   }
+  if (compute_second_order_integral_images_ && !use_fixed_point_ && second_order_integral_image_.size () != size)
+    second_order_integral_image_.resize (size);
+  if (compute_second_order_integral_images_ && use_fixed_point_ && fixed_second_order_integral_image_.size () != size)
+    fixed_second_order_integral_image_.resize (size);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType, unsigned Dimension> void
+pcl::IntegralImage2D<DataType, Dimension>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
+{
+  allocateImages (width, height);
   computeIntegralImages (data, row_stride, element_stride);
+  reference_frame_valid_ = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType, unsigned Dimension> unsigned
+pcl::IntegralImage2D<DataType, Dimension>::updateInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
+{
+  allocateImages (width, height);
+  if (!reference_frame_valid_)
+  {
+    computeIntegralImages (data, row_stride, element_stride);
+    storeReferenceFrame (data, row_stride, element_stride);
+    return (height_);
+  }
+
+  // Flag the rows that changed since the reference frame
+  row_changed_.resize (height_);
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int rowIdx = 0; rowIdx < static_cast<int> (height_); ++rowIdx)
+  {
+    const DataType *row_data = data + static_cast<size_t> (rowIdx) * row_stride;
+    const InputType *reference = &reference_frame_[static_cast<size_t> (rowIdx) * width_];
+    row_changed_[rowIdx] = 0;
+    for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+    {
+      const InputType* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
+      const bool finite = pcl_isfinite (element->sum ());
+      if (finite != pcl_isfinite (reference[colIdx].sum ()) ||
+          (finite && (element->template cast<double> () - reference[colIdx].template cast<double> ()).cwiseAbs ().maxCoeff () > change_threshold_))
+      {
+        row_changed_[rowIdx] = 1;
+        break;
+      }
+    }
+  }
+
+  changed_rows_.clear ();
+  for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx)
+    if (row_changed_[rowIdx])
+      changed_rows_.push_back (rowIdx);
+
+  if (changed_rows_.empty ())
+    return (0);
+
+  if (changed_rows_.size () * 2 > height_)
+  {
+    computeIntegralImages (data, row_stride, element_stride);
+    storeReferenceFrame (data, row_stride, element_stride);
+    return (height_);
+  }
+
+  updateIntegralImages (data, row_stride, element_stride);
+  return (static_cast<unsigned> (changed_rows_.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType, unsigned Dimension> void
+pcl::IntegralImage2D<DataType, Dimension>::storeReferenceFrame (
+    const DataType *data, unsigned row_stride, unsigned element_stride)
+{
+  reference_frame_.resize (static_cast<size_t> (width_) * height_);
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int rowIdx = 0; rowIdx < static_cast<int> (height_); ++rowIdx)
+  {
+    const DataType *row_data = data + static_cast<size_t> (rowIdx) * row_stride;
+    InputType *reference = &reference_frame_[static_cast<size_t> (rowIdx) * width_];
+    for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      reference[colIdx] = *reinterpret_cast <const InputType*> (&row_data [valIdx]);
+  }
+  reference_frame_valid_ = true;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -88,6 +188,17 @@ pcl::IntegralImage2D<DataType, Dimension>::getSecondOrderSum (
   const unsigned lower_left_idx      = (start_y + height) * (width_ + 1) + start_x;
   const unsigned lower_right_idx     = lower_left_idx + width;
 
+  if (use_fixed_point_)
+  {
+    // The wrapped around unsigned sums yield the exact two's complement sum of the rectangle
+    const FixedSecondOrderType sum = fixed_second_order_integral_image_[lower_right_idx] + fixed_second_order_integral_image_[upper_left_idx] -
+                                     fixed_second_order_integral_image_[upper_right_idx] - fixed_second_order_integral_image_[lower_left_idx];
+    SecondOrderType result;
+    for (unsigned idx = 0; idx < second_order_size; ++idx)
+      result [idx] = static_cast<typename IntegralImageTypeTraits<DataType>::IntegralType> (static_cast<int> (sum [idx]) * fixed_point_resolution_);
+    return (result);
+  }
+
   return (second_order_integral_image_[lower_right_idx] + second_order_integral_image_[upper_left_idx]  -
           second_order_integral_image_[upper_right_idx] - second_order_integral_image_[lower_left_idx]  );
 }
@@ -130,6 +241,17 @@ pcl::IntegralImage2D<DataType, Dimension>::getSecondOrderSumSE (
   const unsigned lower_left_idx      = end_y * (width_ + 1) + start_x;
   const unsigned lower_right_idx     = end_y * (width_ + 1) + end_x;
 
+  if (use_fixed_point_)
+  {
+    // The wrapped around unsigned sums yield the exact two's complement sum of the rectangle
+    const FixedSecondOrderType sum = fixed_second_order_integral_image_[lower_right_idx] + fixed_second_order_integral_image_[upper_left_idx] -
+                                     fixed_second_order_integral_image_[upper_right_idx] - fixed_second_order_integral_image_[lower_left_idx];
+    SecondOrderType result;
+    for (unsigned idx = 0; idx < second_order_size; ++idx)
+      result [idx] = static_cast<typename IntegralImageTypeTraits<DataType>::IntegralType> (static_cast<int> (sum [idx]) * fixed_point_resolution_);
+    return (result);
+  }
+
   return (second_order_integral_image_[lower_right_idx] + second_order_integral_image_[upper_left_idx]  -
           second_order_integral_image_[upper_right_idx] - second_order_integral_image_[lower_left_idx]  );
 }
@@ -148,70 +270,223 @@ pcl::IntegralImage2D<DataType, Dimension>::getFiniteElementsCountSE (
           finite_values_integral_image_[upper_right_idx] - finite_values_integral_image_[lower_left_idx]  );
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType, unsigned Dimension> void
+pcl::IntegralImage2D<DataType, Dimension>::computeRowPrefixSums (
+    const DataType *row_data, unsigned element_stride, ElementType *first_order, unsigned *count,
+    SecondOrderType *second_order, FixedSecondOrderType *fixed_second_order) const
+{
+  const double fixed_point_scale = 1.0 / fixed_point_resolution_;
+
+  first_order [0].setZero ();
+  count [0] = 0;
+  if (second_order)
+    second_order [0].setZero ();
+  if (fixed_second_order)
+    fixed_second_order [0].setZero ();
+
+  for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+  {
+    first_order [colIdx + 1] = first_order [colIdx];
+    count [colIdx + 1] = count [colIdx];
+    if (second_order)
+      second_order [colIdx + 1] = second_order [colIdx];
+    if (fixed_second_order)
+      fixed_second_order [colIdx + 1] = fixed_second_order [colIdx];
+
+    const InputType* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
+    if (pcl_isfinite (element->sum ()))
+    {
+      first_order [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
+      ++(count [colIdx + 1]);
+      if (second_order)
+        for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
+          for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
+            second_order [colIdx + 1][elIdx] += (*element)[myIdx] * (*element)[mxIdx];
+      if (fixed_second_order)
+        for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
+          for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
+          {
+            const double value = (*element)[myIdx] * (*element)[mxIdx] * fixed_point_scale;
+            fixed_second_order [colIdx + 1][elIdx] += static_cast<unsigned> (static_cast<int> (value < 0.0 ? value - 0.5 : value + 0.5));
+          }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename DataType, unsigned Dimension> void
 pcl::IntegralImage2D<DataType, Dimension>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
-
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
+  const int stride = static_cast<int> (width_ + 1);
+  const bool second_order = compute_second_order_integral_images_ && !use_fixed_point_;
+  const bool fixed_second_order = compute_second_order_integral_images_ && use_fixed_point_;
+
+  memset (&first_order_integral_image_[0], 0, sizeof (ElementType) * stride);
+  memset (&finite_values_integral_image_[0], 0, sizeof (unsigned) * stride);
+  if (second_order)
+    memset (&second_order_integral_image_[0], 0, sizeof (SecondOrderType) * stride);
+  if (fixed_second_order)
+    memset (&fixed_second_order_integral_image_[0], 0, sizeof (FixedSecondOrderType) * stride);
+
+  // First pass: every row holds the prefix sums of its own elements. Rows are independent.
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int rowIdx = 0; rowIdx < static_cast<int> (height_); ++rowIdx)
+  {
+    const size_t offset = static_cast<size_t> (rowIdx + 1) * stride;
+    computeRowPrefixSums (data + static_cast<size_t> (rowIdx) * row_stride, element_stride,
+                          &first_order_integral_image_[offset], &finite_values_integral_image_[offset],
+                          second_order ? &second_order_integral_image_[offset] : NULL,
+                          fixed_second_order ? &fixed_second_order_integral_image_[offset] : NULL);
+  }
 
-  if (!compute_second_order_integral_images_)
+  // Second pass: accumulate the rows top to bottom. Columns are independent, so they are split into bands
+  // that stay in cache while walking down the image.
+  const int band_width = 64;
+  const int nr_bands = (stride + band_width - 1) / band_width;
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int band = 0; band < nr_bands; ++band)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const int begin = band * band_width;
+    const int end = std::min (stride, begin + band_width);
+    for (unsigned rowIdx = 2; rowIdx <= height_; ++rowIdx)
     {
-      current_row [0].setZero ();
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      ElementType* current_row = &first_order_integral_image_[rowIdx * stride];
+      const ElementType* previous_row = current_row - stride;
+      unsigned* count_current_row = &finite_values_integral_image_[rowIdx * stride];
+      const unsigned* count_previous_row = count_current_row - stride;
+      for (int colIdx = begin; colIdx < end; ++colIdx)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
-        if (pcl_isfinite (element->sum ()))
-        {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
-          ++(count_current_row [colIdx + 1]);
-        }
+        current_row [colIdx] += previous_row [colIdx];
+        count_current_row [colIdx] += count_previous_row [colIdx];
+      }
+      if (second_order)
+      {
+        SecondOrderType* so_current_row = &second_order_integral_image_[rowIdx * stride];
+        const SecondOrderType* so_previous_row = so_current_row - stride;
+        for (int colIdx = begin; colIdx < end; ++colIdx)
+          so_current_row [colIdx] += so_previous_row [colIdx];
+      }
+      if (fixed_second_order)
+      {
+        FixedSecondOrderType* so_current_row = &fixed_second_order_integral_image_[rowIdx * stride];
+        const FixedSecondOrderType* so_previous_row = so_current_row - stride;
+        for (int colIdx = begin; colIdx < end; ++colIdx)
+          so_current_row [colIdx] += so_previous_row [colIdx];
       }
     }
   }
-  else
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType, unsigned Dimension> void
+pcl::IntegralImage2D<DataType, Dimension>::updateIntegralImages (
+    const DataType *data, unsigned row_stride, unsigned element_stride)
+{
+  const int stride = static_cast<int> (width_ + 1);
+  const bool second_order = compute_second_order_integral_images_ && !use_fixed_point_;
+  const bool fixed_second_order = compute_second_order_integral_images_ && use_fixed_point_;
+  const int nr_changed = static_cast<int> (changed_rows_.size ());
+
+  row_buffer_.resize (static_cast<size_t> (nr_changed) * stride);
+  count_row_buffer_.resize (static_cast<size_t> (nr_changed) * stride);
+  if (second_order)
+    so_row_buffer_.resize (static_cast<size_t> (nr_changed) * stride);
+  if (fixed_second_order)
+    fixed_row_buffer_.resize (static_cast<size_t> (nr_changed) * stride);
+
+  // Prefix sums of the changed rows, which also become part of the reference frame
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int idx = 0; idx < nr_changed; ++idx)
   {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
-
-    SecondOrderType so_element;
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    const int rowIdx = changed_rows_[idx];
+    const DataType *row_data = data + static_cast<size_t> (rowIdx) * row_stride;
+    const size_t offset = static_cast<size_t> (idx) * stride;
+    computeRowPrefixSums (row_data, element_stride, &row_buffer_[offset], &count_row_buffer_[offset],
+                          second_order ? &so_row_buffer_[offset] : NULL,
+                          fixed_second_order ? &fixed_row_buffer_[offset] : NULL);
+
+    InputType *reference = &reference_frame_[static_cast<size_t> (rowIdx) * width_];
+    for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      reference[colIdx] = *reinterpret_cast <const InputType*> (&row_data [valIdx]);
+  }
+
+  // Walk down from the first changed row. A changed row is rebuilt from the row above, every other row is shifted
+  // by the accumulated difference between the new and the old integral image, which is kept per column.
+  const int band_width = 64;
+  const int nr_bands = (stride + band_width - 1) / band_width;
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int band = 0; band < nr_bands; ++band)
+  {
+    const int begin = band * band_width;
+    const int end = std::min (stride, begin + band_width);
+
+    std::vector<ElementType, Eigen::aligned_allocator<ElementType> > delta (band_width, ElementType::Zero ());
+    std::vector<unsigned> count_delta (band_width, 0);
+    std::vector<SecondOrderType, Eigen::aligned_allocator<SecondOrderType> > so_delta;
+    std::vector<FixedSecondOrderType, Eigen::aligned_allocator<FixedSecondOrderType> > fixed_delta;
+    if (second_order)
+      so_delta.resize (band_width, SecondOrderType::Zero ());
+    if (fixed_second_order)
+      fixed_delta.resize (band_width, FixedSecondOrderType::Zero ());
+
+    int next_changed = 0;
+    for (unsigned rowIdx = changed_rows_[0] + 1; rowIdx <= height_; ++rowIdx)
     {
-      current_row [0].setZero ();
-      so_current_row [0].setZero ();
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      ElementType* current_row = &first_order_integral_image_[rowIdx * stride];
+      const ElementType* previous_row = current_row - stride;
+      unsigned* count_current_row = &finite_values_integral_image_[rowIdx * stride];
+      const unsigned* count_previous_row = count_current_row - stride;
+      SecondOrderType* so_current_row = second_order ? &second_order_integral_image_[rowIdx * stride] : NULL;
+      FixedSecondOrderType* fixed_current_row = fixed_second_order ? &fixed_second_order_integral_image_[rowIdx * stride] : NULL;
+
+      if (next_changed < nr_changed && changed_rows_[next_changed] == static_cast<int> (rowIdx) - 1)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
+        const size_t offset = static_cast<size_t> (next_changed) * stride;
+        for (int colIdx = begin; colIdx < end; ++colIdx)
+        {
+          const ElementType value = previous_row [colIdx] + row_buffer_[offset + colIdx];
+          delta [colIdx - begin] = value - current_row [colIdx];
+          current_row [colIdx] = value;
 
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
-        if (pcl_isfinite (element->sum ()))
+          const unsigned count = count_previous_row [colIdx] + count_row_buffer_[offset + colIdx];
+          count_delta [colIdx - begin] = count - count_current_row [colIdx];
+          count_current_row [colIdx] = count;
+        }
+        if (so_current_row)
+        {
+          for (int colIdx = begin; colIdx < end; ++colIdx)
+          {
+            const SecondOrderType value = so_current_row [colIdx - stride] + so_row_buffer_[offset + colIdx];
+            so_delta [colIdx - begin] = value - so_current_row [colIdx];
+            so_current_row [colIdx] = value;
+          }
+        }
+        if (fixed_current_row)
+        {
+          for (int colIdx = begin; colIdx < end; ++colIdx)
+          {
+            const FixedSecondOrderType value = fixed_current_row [colIdx - stride] + fixed_row_buffer_[offset + colIdx];
+            fixed_delta [colIdx - begin] = value - fixed_current_row [colIdx];
+            fixed_current_row [colIdx] = value;
+          }
+        }
+        ++next_changed;
+      }
+      else
+      {
+        for (int colIdx = begin; colIdx < end; ++colIdx)
         {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
-          ++(count_current_row [colIdx + 1]);
-          for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
-            for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
-              so_current_row [colIdx + 1][elIdx] += (*element)[myIdx] * (*element)[mxIdx];
+          current_row [colIdx] += delta [colIdx - begin];
+          count_current_row [colIdx] += count_delta [colIdx - begin];
         }
+        if (so_current_row)
+          for (int colIdx = begin; colIdx < end; ++colIdx)
+            so_current_row [colIdx] += so_delta [colIdx - begin];
+        if (fixed_current_row)
+          for (int colIdx = begin; colIdx < end; ++colIdx)
+            fixed_current_row [colIdx] += fixed_delta [colIdx - begin];
       }
     }
   }
@@ -220,18 +495,112 @@ pcl::IntegralImage2D<DataType, Dimension>::computeIntegralImages (
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 template <typename DataType> void
-pcl::IntegralImage2D<DataType, 1>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
+pcl::IntegralImage2D<DataType, 1>::setSecondOrderFixedPoint (bool use_fixed_point, double resolution)
+{
+  // the second order images built so far are in another representation
+  if (use_fixed_point != use_fixed_point_ || (use_fixed_point && resolution != fixed_point_resolution_))
+    reference_frame_valid_ = false;
+  use_fixed_point_ = use_fixed_point;
+  fixed_point_resolution_ = resolution;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType> void
+pcl::IntegralImage2D<DataType, 1>::allocateImages (unsigned width, unsigned height)
 {
-  if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
+  const size_t size = static_cast<size_t> (width + 1) * (height + 1);
+  // the stored reference frame is laid out row by row, so any change of shape invalidates it
+  if (width != width_ || height != height_)
+    reference_frame_valid_ = false;
+  width_  = width;
+  height_ = height;
+  if (first_order_integral_image_.size () != size)
   {
-    width_  = width;
-    height_ = height;
-    first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    if (compute_second_order_integral_images_)
-      second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+    first_order_integral_image_.resize (size);
+    finite_values_integral_image_.resize (size);
+    reference_frame_valid_ = false;
   }
+  if (compute_second_order_integral_images_ && !use_fixed_point_ && second_order_integral_image_.size () != size)
+    second_order_integral_image_.resize (size);
+  if (compute_second_order_integral_images_ && use_fixed_point_ && fixed_second_order_integral_image_.size () != size)
+    fixed_second_order_integral_image_.resize (size);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType> void
+pcl::IntegralImage2D<DataType, 1>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
+{
+  allocateImages (width, height);
   computeIntegralImages (data, row_stride, element_stride);
+  reference_frame_valid_ = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType> unsigned
+pcl::IntegralImage2D<DataType, 1>::updateInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
+{
+  allocateImages (width, height);
+  if (!reference_frame_valid_)
+  {
+    computeIntegralImages (data, row_stride, element_stride);
+    storeReferenceFrame (data, row_stride, element_stride);
+    return (height_);
+  }
+
+  // Flag the rows that changed since the reference frame
+  row_changed_.resize (height_);
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int rowIdx = 0; rowIdx < static_cast<int> (height_); ++rowIdx)
+  {
+    const DataType *row_data = data + static_cast<size_t> (rowIdx) * row_stride;
+    const InputType *reference = &reference_frame_[static_cast<size_t> (rowIdx) * width_];
+    row_changed_[rowIdx] = 0;
+    for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+    {
+      const bool finite = pcl_isfinite (row_data [valIdx]);
+      if (finite != pcl_isfinite (reference[colIdx]) ||
+          (finite && std::abs (static_cast<double> (row_data [valIdx]) - static_cast<double> (reference[colIdx])) > change_threshold_))
+      {
+        row_changed_[rowIdx] = 1;
+        break;
+      }
+    }
+  }
+
+  changed_rows_.clear ();
+  for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx)
+    if (row_changed_[rowIdx])
+      changed_rows_.push_back (rowIdx);
+
+  if (changed_rows_.empty ())
+    return (0);
+
+  if (changed_rows_.size () * 2 > height_)
+  {
+    computeIntegralImages (data, row_stride, element_stride);
+    storeReferenceFrame (data, row_stride, element_stride);
+    return (height_);
+  }
+
+  updateIntegralImages (data, row_stride, element_stride);
+  return (static_cast<unsigned> (changed_rows_.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType> void
+pcl::IntegralImage2D<DataType, 1>::storeReferenceFrame (
+    const DataType *data, unsigned row_stride, unsigned element_stride)
+{
+  reference_frame_.resize (static_cast<size_t> (width_) * height_);
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int rowIdx = 0; rowIdx < static_cast<int> (height_); ++rowIdx)
+  {
+    const DataType *row_data = data + static_cast<size_t> (rowIdx) * row_stride;
+    InputType *reference = &reference_frame_[static_cast<size_t> (rowIdx) * width_];
+    for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      reference[colIdx] = row_data [valIdx];
+  }
+  reference_frame_valid_ = true;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -258,6 +627,14 @@ pcl::IntegralImage2D<DataType, 1>::getSecondOrderSum (
   const unsigned lower_left_idx      = (start_y + height) * (width_ + 1) + start_x;
   const unsigned lower_right_idx     = lower_left_idx + width;
 
+  if (use_fixed_point_)
+  {
+    // The wrapped around unsigned sums yield the exact two's complement sum of the rectangle
+    const FixedSecondOrderType sum = fixed_second_order_integral_image_[lower_right_idx] + fixed_second_order_integral_image_[upper_left_idx] -
+                                     fixed_second_order_integral_image_[upper_right_idx] - fixed_second_order_integral_image_[lower_left_idx];
+    return (static_cast<SecondOrderType> (static_cast<int> (sum) * fixed_point_resolution_));
+  }
+
   return (second_order_integral_image_[lower_right_idx] + second_order_integral_image_[upper_left_idx]  -
           second_order_integral_image_[upper_right_idx] - second_order_integral_image_[lower_left_idx]  );
 }
@@ -300,6 +677,14 @@ pcl::IntegralImage2D<DataType, 1>::getSecondOrderSumSE (
   const unsigned lower_left_idx      = end_y * (width_ + 1) + start_x;
   const unsigned lower_right_idx     = end_y * (width_ + 1) + end_x;
 
+  if (use_fixed_point_)
+  {
+    // The wrapped around unsigned sums yield the exact two's complement sum of the rectangle
+    const FixedSecondOrderType sum = fixed_second_order_integral_image_[lower_right_idx] + fixed_second_order_integral_image_[upper_left_idx] -
+                                     fixed_second_order_integral_image_[upper_right_idx] - fixed_second_order_integral_image_[lower_left_idx];
+    return (static_cast<SecondOrderType> (static_cast<int> (sum) * fixed_point_resolution_));
+  }
+
   return (second_order_integral_image_[lower_right_idx] + second_order_integral_image_[upper_left_idx]  -
           second_order_integral_image_[upper_right_idx] - second_order_integral_image_[lower_left_idx]  );
 }
@@ -318,67 +703,218 @@ pcl::IntegralImage2D<DataType, 1>::getFiniteElementsCountSE (
           finite_values_integral_image_[upper_right_idx] - finite_values_integral_image_[lower_left_idx]  );
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType> void
+pcl::IntegralImage2D<DataType, 1>::computeRowPrefixSums (
+    const DataType *row_data, unsigned element_stride, ElementType *first_order, unsigned *count,
+    SecondOrderType *second_order, FixedSecondOrderType *fixed_second_order) const
+{
+  const double fixed_point_scale = 1.0 / fixed_point_resolution_;
+
+  first_order [0] = 0;
+  count [0] = 0;
+  if (second_order)
+    second_order [0] = 0;
+  if (fixed_second_order)
+    fixed_second_order [0] = 0;
+
+  for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+  {
+    first_order [colIdx + 1] = first_order [colIdx];
+    count [colIdx + 1] = count [colIdx];
+    if (second_order)
+      second_order [colIdx + 1] = second_order [colIdx];
+    if (fixed_second_order)
+      fixed_second_order [colIdx + 1] = fixed_second_order [colIdx];
+
+    if (pcl_isfinite (row_data [valIdx]))
+    {
+      first_order [colIdx + 1] += row_data [valIdx];
+      ++(count [colIdx + 1]);
+      if (second_order)
+        second_order [colIdx + 1] += row_data [valIdx] * row_data [valIdx];
+      if (fixed_second_order)
+      {
+        const double value = row_data [valIdx] * row_data [valIdx] * fixed_point_scale;
+        fixed_second_order [colIdx + 1] += static_cast<unsigned> (static_cast<int> (value < 0.0 ? value - 0.5 : value + 0.5));
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename DataType> void
 pcl::IntegralImage2D<DataType, 1>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
-
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
+  const int stride = static_cast<int> (width_ + 1);
+  const bool second_order = compute_second_order_integral_images_ && !use_fixed_point_;
+  const bool fixed_second_order = compute_second_order_integral_images_ && use_fixed_point_;
+
+  memset (&first_order_integral_image_[0], 0, sizeof (ElementType) * stride);
+  memset (&finite_values_integral_image_[0], 0, sizeof (unsigned) * stride);
+  if (second_order)
+    memset (&second_order_integral_image_[0], 0, sizeof (SecondOrderType) * stride);
+  if (fixed_second_order)
+    memset (&fixed_second_order_integral_image_[0], 0, sizeof (FixedSecondOrderType) * stride);
+
+  // First pass: every row holds the prefix sums of its own elements. Rows are independent.
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int rowIdx = 0; rowIdx < static_cast<int> (height_); ++rowIdx)
+  {
+    const size_t offset = static_cast<size_t> (rowIdx + 1) * stride;
+    computeRowPrefixSums (data + static_cast<size_t> (rowIdx) * row_stride, element_stride,
+                          &first_order_integral_image_[offset], &finite_values_integral_image_[offset],
+                          second_order ? &second_order_integral_image_[offset] : NULL,
+                          fixed_second_order ? &fixed_second_order_integral_image_[offset] : NULL);
+  }
 
-  if (!compute_second_order_integral_images_)
+  // Second pass: accumulate the rows top to bottom. Columns are independent, so they are split into bands
+  // that stay in cache while walking down the image.
+  const int band_width = 64;
+  const int nr_bands = (stride + band_width - 1) / band_width;
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int band = 0; band < nr_bands; ++band)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const int begin = band * band_width;
+    const int end = std::min (stride, begin + band_width);
+    for (unsigned rowIdx = 2; rowIdx <= height_; ++rowIdx)
     {
-      current_row [0] = 0.0;
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      ElementType* current_row = &first_order_integral_image_[rowIdx * stride];
+      const ElementType* previous_row = current_row - stride;
+      unsigned* count_current_row = &finite_values_integral_image_[rowIdx * stride];
+      const unsigned* count_previous_row = count_current_row - stride;
+      for (int colIdx = begin; colIdx < end; ++colIdx)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (pcl_isfinite (data [valIdx]))
-        {
-          current_row [colIdx + 1] += data [valIdx];
-          ++(count_current_row [colIdx + 1]);
-        }
+        current_row [colIdx] += previous_row [colIdx];
+        count_current_row [colIdx] += count_previous_row [colIdx];
+      }
+      if (second_order)
+      {
+        SecondOrderType* so_current_row = &second_order_integral_image_[rowIdx * stride];
+        const SecondOrderType* so_previous_row = so_current_row - stride;
+        for (int colIdx = begin; colIdx < end; ++colIdx)
+          so_current_row [colIdx] += so_previous_row [colIdx];
+      }
+      if (fixed_second_order)
+      {
+        FixedSecondOrderType* so_current_row = &fixed_second_order_integral_image_[rowIdx * stride];
+        const FixedSecondOrderType* so_previous_row = so_current_row - stride;
+        for (int colIdx = begin; colIdx < end; ++colIdx)
+          so_current_row [colIdx] += so_previous_row [colIdx];
       }
     }
   }
-  else
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename DataType> void
+pcl::IntegralImage2D<DataType, 1>::updateIntegralImages (
+    const DataType *data, unsigned row_stride, unsigned element_stride)
+{
+  const int stride = static_cast<int> (width_ + 1);
+  const bool second_order = compute_second_order_integral_images_ && !use_fixed_point_;
+  const bool fixed_second_order = compute_second_order_integral_images_ && use_fixed_point_;
+  const int nr_changed = static_cast<int> (changed_rows_.size ());
+
+  row_buffer_.resize (static_cast<size_t> (nr_changed) * stride);
+  count_row_buffer_.resize (static_cast<size_t> (nr_changed) * stride);
+  if (second_order)
+    so_row_buffer_.resize (static_cast<size_t> (nr_changed) * stride);
+  if (fixed_second_order)
+    fixed_row_buffer_.resize (static_cast<size_t> (nr_changed) * stride);
+
+  // Prefix sums of the changed rows, which also become part of the reference frame
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int idx = 0; idx < nr_changed; ++idx)
   {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
-
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    const int rowIdx = changed_rows_[idx];
+    const DataType *row_data = data + static_cast<size_t> (rowIdx) * row_stride;
+    const size_t offset = static_cast<size_t> (idx) * stride;
+    computeRowPrefixSums (row_data, element_stride, &row_buffer_[offset], &count_row_buffer_[offset],
+                          second_order ? &so_row_buffer_[offset] : NULL,
+                          fixed_second_order ? &fixed_row_buffer_[offset] : NULL);
+
+    InputType *reference = &reference_frame_[static_cast<size_t> (rowIdx) * width_];
+    for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      reference[colIdx] = row_data [valIdx];
+  }
+
+  // Walk down from the first changed row. A changed row is rebuilt from the row above, every other row is shifted
+  // by the accumulated difference between the new and the old integral image, which is kept per column.
+  const int band_width = 64;
+  const int nr_bands = (stride + band_width - 1) / band_width;
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int band = 0; band < nr_bands; ++band)
+  {
+    const int begin = band * band_width;
+    const int end = std::min (stride, begin + band_width);
+
+    std::vector<ElementType> delta (band_width, 0);
+    std::vector<unsigned> count_delta (band_width, 0);
+    std::vector<SecondOrderType> so_delta (second_order ? band_width : 0, 0);
+    std::vector<FixedSecondOrderType> fixed_delta (fixed_second_order ? band_width : 0, 0);
+
+    int next_changed = 0;
+    for (unsigned rowIdx = changed_rows_[0] + 1; rowIdx <= height_; ++rowIdx)
     {
-      current_row [0] = 0.0;
-      so_current_row [0] = 0.0;
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      ElementType* current_row = &first_order_integral_image_[rowIdx * stride];
+      const ElementType* previous_row = current_row - stride;
+      unsigned* count_current_row = &finite_values_integral_image_[rowIdx * stride];
+      const unsigned* count_previous_row = count_current_row - stride;
+      SecondOrderType* so_current_row = second_order ? &second_order_integral_image_[rowIdx * stride] : NULL;
+      FixedSecondOrderType* fixed_current_row = fixed_second_order ? &fixed_second_order_integral_image_[rowIdx * stride] : NULL;
+
+      if (next_changed < nr_changed && changed_rows_[next_changed] == static_cast<int> (rowIdx) - 1)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (pcl_isfinite (data[valIdx]))
+        const size_t offset = static_cast<size_t> (next_changed) * stride;
+        for (int colIdx = begin; colIdx < end; ++colIdx)
         {
-          current_row [colIdx + 1] += data[valIdx];
-          so_current_row [colIdx + 1] += data[valIdx] * data[valIdx];
-          ++(count_current_row [colIdx + 1]);
+          const ElementType value = previous_row [colIdx] + row_buffer_[offset + colIdx];
+          delta [colIdx - begin] = value - current_row [colIdx];
+          current_row [colIdx] = value;
+
+          const unsigned count = count_previous_row [colIdx] + count_row_buffer_[offset + colIdx];
+          count_delta [colIdx - begin] = count - count_current_row [colIdx];
+          count_current_row [colIdx] = count;
+        }
+        if (so_current_row)
+        {
+          for (int colIdx = begin; colIdx < end; ++colIdx)
+          {
+            const SecondOrderType value = so_current_row [colIdx - stride] + so_row_buffer_[offset + colIdx];
+            so_delta [colIdx - begin] = value - so_current_row [colIdx];
+            so_current_row [colIdx] = value;
+          }
+        }
+        if (fixed_current_row)
+        {
+          for (int colIdx = begin; colIdx < end; ++colIdx)
+          {
+            const FixedSecondOrderType value = fixed_current_row [colIdx - stride] + fixed_row_buffer_[offset + colIdx];
+            fixed_delta [colIdx - begin] = value - fixed_current_row [colIdx];
+            fixed_current_row [colIdx] = value;
+          }
         }
+        ++next_changed;
+      }
+      else
+      {
+        for (int colIdx = begin; colIdx < end; ++colIdx)
+        {
+          current_row [colIdx] += delta [colIdx - begin];
+          count_current_row [colIdx] += count_delta [colIdx - begin];
+        }
+        if (so_current_row)
+          for (int colIdx = begin; colIdx < end; ++colIdx)
+            so_current_row [colIdx] += so_delta [colIdx - begin];
+        if (fixed_current_row)
+          for (int colIdx = begin; colIdx < end; ++colIdx)
+            fixed_current_row [colIdx] += fixed_delta [colIdx - begin];
       }
     }
   }
 }
+
 #endif    // PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
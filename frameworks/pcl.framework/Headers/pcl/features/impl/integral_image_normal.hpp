@@ -53,7 +53,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::~IntegralImageNormalEst
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initData ()
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initData (IntegralImageNormalStream *stream)
 {
   if (border_policy_ != BORDER_POLICY_IGNORE &&
       border_policy_ != BORDER_POLICY_MIRROR)
@@ -78,13 +78,58 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initData ()
   distance_map_ = NULL;
 
   if (normal_estimation_method_ == COVARIANCE_MATRIX)
-    initCovarianceMatrixMethod ();
+    initCovarianceMatrixMethod (stream);
   else if (normal_estimation_method_ == AVERAGE_3D_GRADIENT)
-    initAverage3DGradientMethod ();
+    initAverage3DGradientMethod (stream);
   else if (normal_estimation_method_ == AVERAGE_DEPTH_CHANGE)
-    initAverageDepthChangeMethod ();
+    initAverageDepthChangeMethod (stream);
   else if (normal_estimation_method_ == SIMPLE_3D_GRADIENT)
-    initSimple3DGradientMethod ();
+    initSimple3DGradientMethod (stream);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::setInputCloud (
+    const typename PointCloudIn::ConstPtr &cloud, IntegralImageNormalStream &stream)
+{
+  input_ = cloud;
+  stream.updated_rows = 0;
+  if (!cloud->isOrganized ())
+  {
+    PCL_ERROR ("[pcl::IntegralImageNormalEstimation::setInputCloud] Input dataset is not organized (height = 1).\n");
+    return;
+  }
+
+  init_covariance_matrix_ = init_average_3d_gradient_ = init_depth_change_ = false;
+
+  if (use_sensor_origin_)
+  {
+    vpx_ = input_->sensor_origin_.coeff (0);
+    vpy_ = input_->sensor_origin_.coeff (1);
+    vpz_ = input_->sensor_origin_.coeff (2);
+  }
+
+  // Update the data structure of the normal estimation method chosen
+  initData (&stream);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> template <unsigned Dimension> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::buildIntegralImage (
+    IntegralImage2D<float, Dimension> &integral_image, const float *data,
+    unsigned element_stride, unsigned row_stride, IntegralImageNormalStream *stream)
+{
+  if (stream == NULL)
+  {
+    integral_image.setSecondOrderFixedPoint (false);
+    integral_image.setInput (data, input_->width, input_->height, element_stride, row_stride);
+    return;
+  }
+
+  // The integral image keeps the frame it was last built for, the rows that did not change are left untouched
+  integral_image.setChangeThreshold (stream->change_threshold);
+  integral_image.setSecondOrderFixedPoint (stream->use_fixed_point, stream->fixed_point_resolution);
+  stream->updated_rows += integral_image.updateInput (data, input_->width, input_->height, element_stride, row_stride);
 }
 
 
@@ -102,7 +147,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::setRectSize (const int
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initSimple3DGradientMethod ()
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initSimple3DGradientMethod (IntegralImageNormalStream *stream)
 {
   // number of DataType entries per element (equal or bigger than dimensions)
   int element_stride = sizeof (PointInT) / sizeof (float);
@@ -112,7 +157,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initSimple3DGradientMet
   const float *data_ = reinterpret_cast<const float*> (&input_->points[0]);
 
   integral_image_XYZ_.setSecondOrderComputation (false);
-  integral_image_XYZ_.setInput (data_, input_->width, input_->height, element_stride, row_stride);
+  buildIntegralImage (integral_image_XYZ_, data_, element_stride, row_stride, stream);
 
   init_simple_3d_gradient_ = true;
   init_covariance_matrix_ = init_average_3d_gradient_ = init_depth_change_ = false;
@@ -120,7 +165,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initSimple3DGradientMet
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initCovarianceMatrixMethod ()
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initCovarianceMatrixMethod (IntegralImageNormalStream *stream)
 {
   // number of DataType entries per element (equal or bigger than dimensions)
   int element_stride = sizeof (PointInT) / sizeof (float);
@@ -130,7 +175,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initCovarianceMatrixMet
   const float *data_ = reinterpret_cast<const float*> (&input_->points[0]);
 
   integral_image_XYZ_.setSecondOrderComputation (true);
-  integral_image_XYZ_.setInput (data_, input_->width, input_->height, element_stride, row_stride);
+  buildIntegralImage (integral_image_XYZ_, data_, element_stride, row_stride, stream);
 
   init_covariance_matrix_ = true;
   init_average_3d_gradient_ = init_depth_change_ = init_simple_3d_gradient_ = false;
@@ -138,7 +183,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initCovarianceMatrixMet
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverage3DGradientMethod ()
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverage3DGradientMethod (IntegralImageNormalStream *stream)
 {
   size_t data_size = (input_->points.size () << 2);
   diff_x_ = new float[data_size];
@@ -150,23 +195,18 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverage3DGradientMe
   // x u x
   // l x r
   // x d x
-  const PointInT* point_up = &(input_->points [1]);
-  const PointInT* point_dn = point_up + (input_->width << 1);//&(input_->points [1 + (input_->width << 1)]);
-  const PointInT* point_lf = &(input_->points [input_->width]);
-  const PointInT* point_rg = point_lf + 2; //&(input_->points [input_->width + 2]);
-  float* diff_x_ptr = diff_x_ + ((input_->width + 1) << 2);
-  float* diff_y_ptr = diff_y_ + ((input_->width + 1) << 2);
-  unsigned diff_skip = 8; // skip last element in row and the first in the next row
-
-  for (size_t ri = 1; ri < input_->height - 1; ++ri
-                                             , point_up += input_->width
-                                             , point_dn += input_->width
-                                             , point_lf += input_->width
-                                             , point_rg += input_->width
-                                             , diff_x_ptr += diff_skip
-                                             , diff_y_ptr += diff_skip)
+  const int width = static_cast<int> (input_->width);
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int ri = 1; ri < static_cast<int> (input_->height) - 1; ++ri)
   {
-    for (size_t ci = 0; ci < input_->width - 2; ++ci, diff_x_ptr += 4, diff_y_ptr += 4)
+    const PointInT* point_up = &(input_->points [(ri - 1) * width + 1]);
+    const PointInT* point_dn = point_up + (width << 1);
+    const PointInT* point_lf = &(input_->points [ri * width]);
+    const PointInT* point_rg = point_lf + 2;
+    float* diff_x_ptr = diff_x_ + ((ri * width + 1) << 2);
+    float* diff_y_ptr = diff_y_ + ((ri * width + 1) << 2);
+
+    for (int ci = 0; ci < width - 2; ++ci, diff_x_ptr += 4, diff_y_ptr += 4)
     {
       diff_x_ptr[0] = point_rg[ci].x - point_lf[ci].x;
       diff_x_ptr[1] = point_rg[ci].y - point_lf[ci].y;
@@ -179,15 +219,15 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverage3DGradientMe
   }
 
   // Compute integral images
-  integral_image_DX_.setInput (diff_x_, input_->width, input_->height, 4, input_->width << 2);
-  integral_image_DY_.setInput (diff_y_, input_->width, input_->height, 4, input_->width << 2);
+  buildIntegralImage (integral_image_DX_, diff_x_, 4, input_->width << 2, stream);
+  buildIntegralImage (integral_image_DY_, diff_y_, 4, input_->width << 2, stream);
   init_covariance_matrix_ = init_depth_change_ = init_simple_3d_gradient_ = false;
   init_average_3d_gradient_ = true;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverageDepthChangeMethod ()
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverageDepthChangeMethod (IntegralImageNormalStream *stream)
 {
   // number of DataType entries per element (equal or bigger than dimensions)
   int element_stride = sizeof (PointInT) / sizeof (float);
@@ -197,7 +237,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverageDepthChangeM
   const float *data_ = reinterpret_cast<const float*> (&input_->points[0]);
 
   // integral image over the z - value
-  integral_image_depth_.setInput (&(data_[2]), input_->width, input_->height, element_stride, row_stride);
+  buildIntegralImage (integral_image_depth_, &(data_[2]), element_stride, row_stride, stream);
   init_depth_change_ = true;
   init_covariance_matrix_ = init_average_3d_gradient_ = init_simple_3d_gradient_ = false;
 }
@@ -240,7 +280,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
     Eigen::Vector3f eigen_vector;
     pcl::eigen33 (covariance_matrix, eigen_value, eigen_vector);
     //pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, eigen_vector);
-    pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, eigen_vector[0], eigen_vector[1], eigen_vector[2]);
+    pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, eigen_vector[0], eigen_vector[1], eigen_vector[2]);
     normal.getNormalVector3fMap () = eigen_vector;
 
     // Compute the curvature surface change
@@ -277,16 +317,16 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
 
     normal_vector /= sqrt (normal_length);
 
-    float nx = static_cast<float> (normal_vector [0]);
-    float ny = static_cast<float> (normal_vector [1]);
-    float nz = static_cast<float> (normal_vector [2]);
-
-    //pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, normal_vector);
-    pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, nx, ny, nz);
+    float nx = static_cast<float> (normal_vector [0]);
+    float ny = static_cast<float> (normal_vector [1]);
+    float nz = static_cast<float> (normal_vector [2]);
 
-    normal.normal_x = nx;
-    normal.normal_y = ny;
-    normal.normal_z = nz;
+    //pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, normal_vector);
+    pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, nx, ny, nz);
+
+    normal.normal_x = nx;
+    normal.normal_y = ny;
+    normal.normal_z = nz;
     normal.curvature = bad_point;
     return;
   }
@@ -382,12 +422,12 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
 
     normal_vector /= sqrt (normal_length);
 
-    float nx = static_cast<float> (normal_vector [0]);
-    float ny = static_cast<float> (normal_vector [1]);
-    float nz = static_cast<float> (normal_vector [2]);
+    float nx = static_cast<float> (normal_vector [0]);
+    float ny = static_cast<float> (normal_vector [1]);
+    float nz = static_cast<float> (normal_vector [2]);
 
     //pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, normal_vector);
-    pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, nx, ny, nz);
+    pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, nx, ny, nz);
     
     normal.normal_x = nx;
     normal.normal_y = ny;
@@ -566,7 +606,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
     Eigen::Vector3f eigen_vector;
     pcl::eigen33 (covariance_matrix, eigen_value, eigen_vector);
     //pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, eigen_vector);
-    pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, eigen_vector[0], eigen_vector[1], eigen_vector[2]);
+    pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, eigen_vector[0], eigen_vector[1], eigen_vector[2]);
     normal.getNormalVector3fMap () = eigen_vector;
 
     // Compute the curvature surface change
@@ -620,16 +660,16 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
 
     normal_vector /= sqrt (normal_length);
 
-    float nx = static_cast<float> (normal_vector [0]);
-    float ny = static_cast<float> (normal_vector [1]);
-    float nz = static_cast<float> (normal_vector [2]);
-
-    //pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, normal_vector);
-    pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, nx, ny, nz);
+    float nx = static_cast<float> (normal_vector [0]);
+    float ny = static_cast<float> (normal_vector [1]);
+    float nz = static_cast<float> (normal_vector [2]);
+
+    //pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, normal_vector);
+    pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, nx, ny, nz);
 
-    normal.normal_x = nx;
-    normal.normal_y = ny;
-    normal.normal_z = nz;
+    normal.normal_x = nx;
+    normal.normal_y = ny;
+    normal.normal_z = nz;
     normal.curvature = bad_point;
     return;
   }
@@ -825,12 +865,12 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
 
     //normal_vector /= sqrt (normal_length);
 
-    //float nx = static_cast<float> (normal_vector [0]);
-    //float ny = static_cast<float> (normal_vector [1]);
-    //float nz = static_cast<float> (normal_vector [2]);
+    //float nx = static_cast<float> (normal_vector [0]);
+    //float ny = static_cast<float> (normal_vector [1]);
+    //float nz = static_cast<float> (normal_vector [2]);
 
     ////pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, normal_vector);
-    //pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, nx, ny, nz);
+    //pcl::flipNormalTowardsViewpoint (input_->points[point_index], vpx_, vpy_, vpz_, nx, ny, nz);
     //
     //normal.normal_x = nx;
     //normal.normal_y = ny;
@@ -844,6 +884,222 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
   return;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalBatch (
+    const int *pos_x, const int *pos_y, const unsigned *point_index,
+    const int *rect_size, int nr_points, PointCloudOut &output)
+{
+  const float bad_point = std::numeric_limits<float>::quiet_NaN ();
+
+  // Lanes without a valid neighborhood are filled with a harmless placeholder and discarded at the end
+  bool valid[4] = {false, false, false, false};
+  Eigen::Array4f px = Eigen::Array4f::Zero (), py = px, pz = px;
+  for (int l = 0; l < nr_points; ++l)
+  {
+    const PointInT &point = input_->points[point_index[l]];
+    px[l] = point.x;
+    py[l] = point.y;
+    pz[l] = point.z;
+  }
+
+  Eigen::Array4f nx, ny, nz, curvature;
+
+  if (normal_estimation_method_ == COVARIANCE_MATRIX)
+  {
+    Eigen::Array4f s00 = Eigen::Array4f::Ones (), s01 = Eigen::Array4f::Zero (), s02 = s01;
+    Eigen::Array4f s11 = s00, s12 = s01, s22 = s00;
+    Eigen::Array4f cx = Eigen::Array4f::Zero (), cy = cx, cz = cx;
+    Eigen::Array4f count = Eigen::Array4f::Ones ();
+
+    // Gather the first and second order sums of every lane from the integral image
+    for (int l = 0; l < nr_points; ++l)
+    {
+      const int start_x = pos_x[l] - rect_size[l] / 2;
+      const int start_y = pos_y[l] - rect_size[l] / 2;
+      const unsigned nr_finite = integral_image_XYZ_.getFiniteElementsCount (start_x, start_y, rect_size[l], rect_size[l]);
+      if (nr_finite == 0)
+        continue;
+      valid[l] = true;
+      count[l] = static_cast<float> (nr_finite);
+
+      const typename IntegralImage2D<float, 3>::ElementType center =
+          integral_image_XYZ_.getFirstOrderSum (start_x, start_y, rect_size[l], rect_size[l]);
+      const typename IntegralImage2D<float, 3>::SecondOrderType so_elements =
+          integral_image_XYZ_.getSecondOrderSum (start_x, start_y, rect_size[l], rect_size[l]);
+      cx[l] = static_cast<float> (center[0]);
+      cy[l] = static_cast<float> (center[1]);
+      cz[l] = static_cast<float> (center[2]);
+      s00[l] = static_cast<float> (so_elements[0]);
+      s01[l] = static_cast<float> (so_elements[1]);
+      s02[l] = static_cast<float> (so_elements[2]);
+      s11[l] = static_cast<float> (so_elements[3]);
+      s12[l] = static_cast<float> (so_elements[4]);
+      s22[l] = static_cast<float> (so_elements[5]);
+    }
+
+    const Eigen::Array4f c00 = s00 - cx * cx / count;
+    const Eigen::Array4f c01 = s01 - cx * cy / count;
+    const Eigen::Array4f c02 = s02 - cx * cz / count;
+    const Eigen::Array4f c11 = s11 - cy * cy / count;
+    const Eigen::Array4f c12 = s12 - cy * cz / count;
+    const Eigen::Array4f c22 = s22 - cz * cz / count;
+
+    Eigen::Array4f eigen_value;
+    pcl::eigen33 (c00, c01, c02, c11, c12, c22, eigen_value, nx, ny, nz);
+
+    // Compute the curvature surface change
+    curvature = (eigen_value > Eigen::Array4f::Zero ()).select ((eigen_value / (c00 + c11 + c22)).abs (), Eigen::Array4f::Zero ());
+  }
+  else
+  {
+    Eigen::Array4f gxx = Eigen::Array4f::Zero (), gxy = gxx, gxz = gxx;
+    Eigen::Array4f gyx = gxx, gyy = gxx, gyz = gxx;
+
+    // Gather the smoothed horizontal and vertical 3D gradients of every lane
+    for (int l = 0; l < nr_points; ++l)
+    {
+      const int start_x = pos_x[l] - rect_size[l] / 2;
+      const int start_y = pos_y[l] - rect_size[l] / 2;
+      const unsigned count_x = integral_image_DX_.getFiniteElementsCount (start_x, start_y, rect_size[l], rect_size[l]);
+      const unsigned count_y = integral_image_DY_.getFiniteElementsCount (start_x, start_y, rect_size[l], rect_size[l]);
+      if (count_x == 0 || count_y == 0)
+        continue;
+      valid[l] = true;
+
+      const typename IntegralImage2D<float, 3>::ElementType gradient_x =
+          integral_image_DX_.getFirstOrderSum (start_x, start_y, rect_size[l], rect_size[l]);
+      const typename IntegralImage2D<float, 3>::ElementType gradient_y =
+          integral_image_DY_.getFirstOrderSum (start_x, start_y, rect_size[l], rect_size[l]);
+      gxx[l] = static_cast<float> (gradient_x[0]);
+      gxy[l] = static_cast<float> (gradient_x[1]);
+      gxz[l] = static_cast<float> (gradient_x[2]);
+      gyx[l] = static_cast<float> (gradient_y[0]);
+      gyy[l] = static_cast<float> (gradient_y[1]);
+      gyz[l] = static_cast<float> (gradient_y[2]);
+    }
+
+    // The normal is the cross product of the vertical and the horizontal gradient
+    nx = gyy * gxz - gyz * gxy;
+    ny = gyz * gxx - gyx * gxz;
+    nz = gyx * gxy - gyy * gxx;
+
+    const Eigen::Array4f normal_length = nx * nx + ny * ny + nz * nz;
+    Eigen::Array4f scale;
+    for (int l = 0; l < 4; ++l)
+    {
+      if (normal_length[l] == 0.0f)
+        valid[l] = false;
+      scale[l] = valid[l] ? 1.0f / std::sqrt (normal_length[l]) : 0.0f;
+    }
+    nx *= scale;
+    ny *= scale;
+    nz *= scale;
+    curvature = Eigen::Array4f::Constant (bad_point);
+  }
+
+  // Flip the normals towards the viewpoint
+  const Eigen::Array4f cos_theta = (vpx_ - px) * nx + (vpy_ - py) * ny + (vpz_ - pz) * nz;
+  const Eigen::Array4f sign = (cos_theta < Eigen::Array4f::Zero ()).select (-Eigen::Array4f::Ones (), Eigen::Array4f::Ones ());
+  nx *= sign;
+  ny *= sign;
+  nz *= sign;
+
+  for (int l = 0; l < nr_points; ++l)
+  {
+    PointOutT &normal = output.points[point_index[l]];
+    if (!valid[l])
+    {
+      normal.getNormalVector4fMap ().setConstant (bad_point);
+      normal.curvature = bad_point;
+      continue;
+    }
+    normal.normal_x = nx[l];
+    normal.normal_y = ny[l];
+    normal.normal_z = nz[l];
+    normal.curvature = curvature[l];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureTiled (
+    const float *distance_map, PointCloudOut &output)
+{
+  const float bad_point = std::numeric_limits<float>::quiet_NaN ();
+
+  if (normal_estimation_method_ == COVARIANCE_MATRIX && !init_covariance_matrix_)
+    initCovarianceMatrixMethod ();
+  else if (normal_estimation_method_ == AVERAGE_3D_GRADIENT && !init_average_3d_gradient_)
+    initAverage3DGradientMethod ();
+
+  const int width = static_cast<int> (input_->width);
+  const int border = static_cast<int> (normal_smoothing_size_);
+  const int begin_x = border, end_x = width - border;
+  const int begin_y = border, end_y = static_cast<int> (input_->height) - border;
+  if (end_x <= begin_x || end_y <= begin_y)
+    return;
+
+  // Tiles of 64 x 16 pixels keep the integral image rows touched by a tile in the L1/L2 cache
+  const int tile_width = 64, tile_height = 16;
+  const int nr_tiles_x = (end_x - begin_x + tile_width - 1) / tile_width;
+  const int nr_tiles_y = (end_y - begin_y + tile_height - 1) / tile_height;
+
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads_)
+  for (int tile = 0; tile < nr_tiles_x * nr_tiles_y; ++tile)
+  {
+    const int tile_x = begin_x + (tile % nr_tiles_x) * tile_width;
+    const int tile_y = begin_y + (tile / nr_tiles_x) * tile_height;
+    const int tile_end_x = std::min (end_x, tile_x + tile_width);
+    const int tile_end_y = std::min (end_y, tile_y + tile_height);
+
+    int pos_x[4], pos_y[4], rect_size[4];
+    unsigned point_index[4];
+    int nr_points = 0;
+
+    for (int ri = tile_y; ri < tile_end_y; ++ri)
+    {
+      for (int ci = tile_x; ci < tile_end_x; ++ci)
+      {
+        const unsigned index = ri * width + ci;
+
+        const float depth = input_->points[index].z;
+        if (!pcl_isfinite (depth))
+        {
+          output[index].getNormalVector4fMap ().setConstant (bad_point);
+          output[index].curvature = bad_point;
+          continue;
+        }
+
+        float smoothing;
+        if (use_depth_dependent_smoothing_)
+          smoothing = (std::min)(distance_map[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
+        else
+          smoothing = (std::min)(distance_map[index], normal_smoothing_size_);
+
+        if (smoothing <= 2.0f)
+        {
+          output[index].getNormalVector4fMap ().setConstant (bad_point);
+          output[index].curvature = bad_point;
+          continue;
+        }
+
+        pos_x[nr_points] = ci;
+        pos_y[nr_points] = ri;
+        point_index[nr_points] = index;
+        rect_size[nr_points] = static_cast<int> (smoothing);
+        if (++nr_points == 4)
+        {
+          computePointNormalBatch (pos_x, pos_y, point_index, rect_size, nr_points, output);
+          nr_points = 0;
+        }
+      }
+    }
+    if (nr_points > 0)
+      computePointNormalBatch (pos_x, pos_y, point_index, rect_size, nr_points, output);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
@@ -976,7 +1232,11 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
       }
     }
 
-    if (use_depth_dependent_smoothing_)
+    if (normal_estimation_method_ == COVARIANCE_MATRIX || normal_estimation_method_ == AVERAGE_3D_GRADIENT)
+    {
+      computeFeatureTiled (distanceMap, output);
+    }
+    else if (use_depth_dependent_smoothing_)
     {
       index = border + input_->width * border;
       unsigned skip = (border << 1);
@@ -1019,8 +1279,8 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
       {
         for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
         {
-          index = ri * input_->width + ci;
-
+          index = ri * input_->width + ci;
+
           if (!pcl_isfinite (input_->points[index].z))
           {
             output [index].getNormalVector4fMap ().setConstant (bad_point);
@@ -1095,8 +1355,8 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
         //for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
         for (unsigned ci = 0; ci < input_->width; ++ci)
         {
-          index = ri * input_->width + ci;
-
+          index = ri * input_->width + ci;
+
           if (!pcl_isfinite (input_->points[index].z))
           {
             output [index].getNormalVector4fMap ().setConstant (bad_point);
@@ -39,6 +39,121 @@
 #define PCL_FEATURES_IMPL_MULTISCALE_FEATURE_PERSISTENCE_H_
 
 #include <pcl/pcl/features/multiscale_feature_persistence.h>
+#include <pcl/pcl/search/pcl_search.h>
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+pcl::MultiscaleNeighborhoodSearch<PointT>::MultiscaleNeighborhoodSearch (const SearchPtr &search) :
+  pcl::search::Search<PointT> ("MultiscaleNeighborhoodSearch", true),
+  search_ (search),
+  query_cloud_ (),
+  max_radius_ (0),
+  point_rows_ (),
+  row_offsets_ (),
+  neighbor_indices_ (),
+  neighbor_sqr_dists_ ()
+{
+  this->input_ = search_->getInputCloud ();
+  this->indices_ = search_->getIndices ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MultiscaleNeighborhoodSearch<PointT>::setInputCloud (const PointCloudConstPtr &cloud,
+                                                          const IndicesConstPtr &indices)
+{
+  this->input_ = cloud;
+  this->indices_ = indices;
+  if (search_->getInputCloud () != cloud || search_->getIndices () != indices)
+    search_->setInputCloud (cloud, indices);
+
+  query_cloud_.reset ();
+  max_radius_ = 0;
+  point_rows_.clear ();
+  row_offsets_.clear ();
+  neighbor_indices_.clear ();
+  neighbor_sqr_dists_.clear ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MultiscaleNeighborhoodSearch<PointT>::computeNeighborhoods (const PointCloudConstPtr &cloud,
+                                                                 const IndicesConstPtr &indices,
+                                                                 double max_radius, unsigned int threads)
+{
+  query_cloud_ = cloud;
+  max_radius_ = max_radius;
+
+  int nr_rows = static_cast<int> (indices ? indices->size () : cloud->points.size ());
+  point_rows_.assign (cloud->points.size (), -1);
+  row_offsets_.resize (nr_rows + 1);
+
+  // Search every query point once, at the largest radius
+  std::vector<std::vector<int> > row_indices (nr_rows);
+  std::vector<std::vector<float> > row_sqr_dists (nr_rows);
+#pragma omp parallel for schedule (dynamic, 64) num_threads (threads)
+  for (int row = 0; row < nr_rows; ++row)
+  {
+    int index = indices ? (*indices)[row] : row;
+    if (!isFinite (cloud->points[index]))
+      continue;
+    search_->radiusSearch (cloud->points[index], max_radius, row_indices[row], row_sqr_dists[row], 0);
+
+    // The search method may return its neighbors in any order
+    const std::vector<float> &dists = row_sqr_dists[row];
+    for (size_t i = 1; i < dists.size (); ++i)
+    {
+      if (dists[i] < dists[i - 1])
+      {
+        this->sortResults (row_indices[row], row_sqr_dists[row]);
+        break;
+      }
+    }
+  }
+
+  // Concatenate the rows
+  row_offsets_[0] = 0;
+  for (int row = 0; row < nr_rows; ++row)
+  {
+    row_offsets_[row + 1] = row_offsets_[row] + static_cast<int> (row_indices[row].size ());
+    point_rows_[indices ? (*indices)[row] : row] = row;
+  }
+  neighbor_indices_.resize (row_offsets_[nr_rows]);
+  neighbor_sqr_dists_.resize (row_offsets_[nr_rows]);
+#pragma omp parallel for schedule (static) num_threads (threads)
+  for (int row = 0; row < nr_rows; ++row)
+  {
+    std::copy (row_indices[row].begin (), row_indices[row].end (), neighbor_indices_.begin () + row_offsets_[row]);
+    std::copy (row_sqr_dists[row].begin (), row_sqr_dists[row].end (), neighbor_sqr_dists_.begin () + row_offsets_[row]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::MultiscaleNeighborhoodSearch<PointT>::radiusSearch (const PointCloud &cloud, int index, double radius,
+                                                         std::vector<int> &k_indices,
+                                                         std::vector<float> &k_sqr_distances,
+                                                         unsigned int max_nn) const
+{
+  if (&cloud != query_cloud_.get () || radius > max_radius_ || point_rows_[index] < 0)
+    return (search_->radiusSearch (cloud.points[index], radius, k_indices, k_sqr_distances, max_nn));
+
+  int row = point_rows_[index];
+  std::vector<float>::const_iterator begin = neighbor_sqr_dists_.begin () + row_offsets_[row];
+  std::vector<float>::const_iterator end = neighbor_sqr_dists_.begin () + row_offsets_[row + 1];
+  if (radius < max_radius_)
+    end = std::upper_bound (begin, end, static_cast<float> (radius * radius));
+
+  int nr_neighbors = static_cast<int> (end - begin);
+  if (max_nn > 0 && nr_neighbors > static_cast<int> (max_nn))
+    nr_neighbors = static_cast<int> (max_nn);
+
+  k_indices.assign (neighbor_indices_.begin () + row_offsets_[row],
+                    neighbor_indices_.begin () + row_offsets_[row] + nr_neighbors);
+  k_sqr_distances.assign (begin, begin + nr_neighbors);
+  return (nr_neighbors);
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointFeature>
@@ -111,17 +226,111 @@ pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::computeFeaturesAtA
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointFeature> void
+pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::computeFeaturesAtAllScales (const std::vector<FeatureEstimatorPtr> &feature_estimators,
+                                                                                          unsigned int nr_threads,
+                                                                                          bool share_neighborhoods,
+                                                                                          std::vector<std::vector<double> > &feature_sums)
+{
+  int nr_scales = static_cast<int> (scale_values_.size ());
+  int nr_dimensions = feature_representation_->getNumberOfDimensions ();
+  features_at_scale_.resize (nr_scales);
+  features_at_scale_vectorized_.resize (nr_scales);
+  feature_sums.resize (nr_scales);
+
+  std::vector<FeatureEstimatorPtr> estimators (1, feature_estimator_);
+  estimators.insert (estimators.end (), feature_estimators.begin (), feature_estimators.end ());
+  int threads = static_cast<int> (std::min (static_cast<size_t> (nr_threads), estimators.size ()));
+
+  // Search the neighborhoods once at the largest scale, and let every estimator slice them
+  std::vector<SearchPtr> estimator_trees (estimators.size ());
+  if (share_neighborhoods)
+  {
+    typename pcl::PointCloud<PointSource>::ConstPtr cloud = feature_estimator_->getInputCloud ();
+    typename pcl::PointCloud<PointSource>::ConstPtr surface = feature_estimator_->getSearchSurface ();
+    if (!surface)
+      surface = cloud;
+
+    SearchPtr tree = feature_estimator_->getSearchMethod ();
+    if (!tree)
+    {
+      if (surface->isOrganized () && cloud->isOrganized ())
+        tree.reset (new pcl::search::OrganizedNeighbor<PointSource> ());
+      else
+        tree.reset (new pcl::search::KdTree<PointSource> (false));
+    }
+    if (tree->getInputCloud () != surface)
+      tree->setInputCloud (surface);
+
+    typename MultiscaleNeighborhoodSearch<PointSource>::Ptr neighborhoods (new MultiscaleNeighborhoodSearch<PointSource> (tree));
+    neighborhoods->computeNeighborhoods (cloud, feature_estimator_->getIndices (),
+                                         *std::max_element (scale_values_.begin (), scale_values_.end ()), nr_threads);
+
+    for (size_t est_i = 0; est_i < estimators.size (); ++est_i)
+    {
+      estimator_trees[est_i] = estimators[est_i]->getSearchMethod ();
+      estimators[est_i]->setSearchMethod (neighborhoods);
+    }
+  }
+
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads)
+  for (int scale_i = 0; scale_i < nr_scales; ++scale_i)
+  {
+#ifdef _OPENMP
+    int tid = omp_get_thread_num ();
+#else
+    int tid = 0;
+#endif
+    FeatureCloudPtr feature_cloud (new FeatureCloud ());
+    if (estimators[tid] == feature_estimator_)
+      computeFeatureAtScale (scale_values_[scale_i], feature_cloud);
+    else
+      computeFeatureAtScale (scale_values_[scale_i], estimators[tid], feature_cloud);
+    features_at_scale_[scale_i] = feature_cloud;
+
+    // Vectorize each feature and insert it into the vectorized feature storage, summing them up for the mean
+    std::vector<std::vector<float> > feature_cloud_vectorized (feature_cloud->points.size ());
+    std::vector<double> feature_sum (nr_dimensions, 0.0);
+    for (size_t feature_i = 0; feature_i < feature_cloud->points.size (); ++feature_i)
+    {
+      std::vector<float> feature_vectorized (nr_dimensions);
+      feature_representation_->vectorize (feature_cloud->points[feature_i], feature_vectorized);
+      for (int dim_i = 0; dim_i < nr_dimensions; ++dim_i)
+        feature_sum[dim_i] += feature_vectorized[dim_i];
+      feature_cloud_vectorized[feature_i].swap (feature_vectorized);
+    }
+    features_at_scale_vectorized_[scale_i].swap (feature_cloud_vectorized);
+    feature_sums[scale_i].swap (feature_sum);
+  }
+
+  if (share_neighborhoods)
+    for (size_t est_i = 0; est_i < estimators.size (); ++est_i)
+      estimators[est_i]->setSearchMethod (estimator_trees[est_i]);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointFeature> void
 pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::computeFeatureAtScale (float &scale,
                                                                                      FeatureCloudPtr &features)
 {
-   feature_estimator_->setRadiusSearch (scale);
-   feature_estimator_->compute (*features);
+   computeFeatureAtScale (scale, feature_estimator_, features);
 }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointFeature> void
+pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::computeFeatureAtScale (float &scale,
+                                                                                     const FeatureEstimatorPtr &feature_estimator,
+                                                                                     FeatureCloudPtr &features)
+{
+   feature_estimator->setRadiusSearch (scale);
+   feature_estimator->compute (*features);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointFeature> float
 pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::distanceBetweenFeatures (const std::vector<float> &a,
                                                                                        const std::vector<float> &b)
@@ -151,6 +360,25 @@ pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::calculateMeanFeatu
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointFeature> void
+pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::calculateMeanFeature (const std::vector<std::vector<double> > &feature_sums)
+{
+  // Combine the sums accumulated at each scale
+  std::vector<double> feature_sum (feature_representation_->getNumberOfDimensions (), 0.0);
+  float normalization_factor = 0.0f;
+  for (size_t scale_i = 0; scale_i < feature_sums.size (); ++scale_i)
+  {
+    normalization_factor += static_cast<float> (features_at_scale_vectorized_[scale_i].size ());
+    for (int dim_i = 0; dim_i < feature_representation_->getNumberOfDimensions (); ++dim_i)
+      feature_sum[dim_i] += feature_sums[scale_i][dim_i];
+  }
+
+  for (int dim_i = 0; dim_i < feature_representation_->getNumberOfDimensions (); ++dim_i)
+    mean_feature_[dim_i] = static_cast<float> (feature_sum[dim_i] / normalization_factor);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointFeature> void
 pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::extractUniqueFeatures ()
@@ -192,17 +420,30 @@ pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::extractUniqueFeatu
 template <typename PointSource, typename PointFeature> void
 pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::determinePersistentFeatures (FeatureCloud &output_features,
                                                                                            boost::shared_ptr<std::vector<int> > &output_indices)
+{
+  determinePersistentFeatures (output_features, output_indices, std::vector<FeatureEstimatorPtr> (), 1);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointFeature> void
+pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::determinePersistentFeatures (FeatureCloud &output_features,
+                                                                                           boost::shared_ptr<std::vector<int> > &output_indices,
+                                                                                           const std::vector<FeatureEstimatorPtr> &feature_estimators,
+                                                                                           unsigned int nr_threads,
+                                                                                           bool share_neighborhoods)
 {
   if (!initCompute ())
     return;
 
-  // Compute the features for all scales with the given feature estimator
+  // Compute the features for all scales with the given feature estimators
   PCL_DEBUG ("[pcl::MultiscaleFeaturePersistence::determinePersistentFeatures] Computing features ...\n");
-  computeFeaturesAtAllScales ();
+  std::vector<std::vector<double> > feature_sums;
+  computeFeaturesAtAllScales (feature_estimators, nr_threads == 0 ? 1 : nr_threads, share_neighborhoods, feature_sums);
 
   // Compute mean feature
   PCL_DEBUG ("[pcl::MultiscaleFeaturePersistence::determinePersistentFeatures] Calculating mean feature ...\n");
-  calculateMeanFeature ();
+  calculateMeanFeature (feature_sums);
 
   // Get the 'unique' features at each scale
   PCL_DEBUG ("[pcl::MultiscaleFeaturePersistence::determinePersistentFeatures] Extracting unique features ...\n");
@@ -0,0 +1,165 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_NORMAL_3D_BATCH_H_
+#define PCL_FEATURES_IMPL_NORMAL_3D_BATCH_H_
+
+#include <pcl/pcl/features/normal_3d_batch.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::NormalEstimationBatch<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  float vpx, vpy, vpz;
+  getViewPoint (vpx, vpy, vpz);
+
+  output.is_dense = true;
+
+  const int nr_points = static_cast<int> (indices_->size ());
+  const int nr_batches = (nr_points + BATCH_SIZE - 1) / BATCH_SIZE;
+
+#pragma omp parallel num_threads (threads_)
+  {
+    // Neighborhood buffers are reused by all batches of a thread
+    std::vector<int> nn_indices[BATCH_SIZE];
+    std::vector<float> nn_dists[BATCH_SIZE];
+
+#pragma omp for schedule (dynamic, 16)
+    for (int batch = 0; batch < nr_batches; ++batch)
+    {
+      const int begin = batch * BATCH_SIZE;
+      const int count = std::min (BATCH_SIZE, nr_points - begin);
+
+      // Gather the neighborhoods of all query points in the batch
+      int nr_neighbors[BATCH_SIZE] = {0};
+      int max_neighbors = 0;
+      Eigen::Array4f qx = Eigen::Array4f::Zero (), qy = Eigen::Array4f::Zero (), qz = Eigen::Array4f::Zero ();
+      for (int l = 0; l < count; ++l)
+      {
+        const int index = (*indices_)[begin + l];
+        if (!isFinite ((*input_)[index]))
+          continue;
+
+        nn_indices[l].resize (k_);
+        nn_dists[l].resize (k_);
+        nr_neighbors[l] = this->searchForNeighbors (index, search_parameter_, nn_indices[l], nn_dists[l]);
+        max_neighbors = std::max (max_neighbors, nr_neighbors[l]);
+
+        qx[l] = input_->points[index].x;
+        qy[l] = input_->points[index].y;
+        qz[l] = input_->points[index].z;
+      }
+
+      // Accumulate the first and second order moments relative to the query points, one lane per query.
+      // Lanes that ran out of neighbors read their own query point and therefore add nothing.
+      Eigen::Array4f sx = Eigen::Array4f::Zero (), sy = sx, sz = sx;
+      Eigen::Array4f sxx = sx, sxy = sx, sxz = sx, syy = sx, syz = sx, szz = sx;
+      for (int j = 0; j < max_neighbors; ++j)
+      {
+        Eigen::Array4f px = qx, py = qy, pz = qz;
+        for (int l = 0; l < count; ++l)
+        {
+          if (j >= nr_neighbors[l])
+            continue;
+          const PointInT &p = surface_->points[nn_indices[l][j]];
+          px[l] = p.x;
+          py[l] = p.y;
+          pz[l] = p.z;
+        }
+        px -= qx;
+        py -= qy;
+        pz -= qz;
+
+        sx += px;
+        sy += py;
+        sz += pz;
+        sxx += px * px;
+        sxy += px * py;
+        sxz += px * pz;
+        syy += py * py;
+        syz += py * pz;
+        szz += pz * pz;
+      }
+
+      Eigen::Array4f inv_n;
+      for (int l = 0; l < BATCH_SIZE; ++l)
+        inv_n[l] = 1.0f / static_cast<float> (std::max (nr_neighbors[l], 1));
+
+      const Eigen::Array4f mx = sx * inv_n, my = sy * inv_n, mz = sz * inv_n;
+      const Eigen::Array4f c00 = sxx * inv_n - mx * mx;
+      const Eigen::Array4f c01 = sxy * inv_n - mx * my;
+      const Eigen::Array4f c02 = sxz * inv_n - mx * mz;
+      const Eigen::Array4f c11 = syy * inv_n - my * my;
+      const Eigen::Array4f c12 = syz * inv_n - my * mz;
+      const Eigen::Array4f c22 = szz * inv_n - mz * mz;
+
+      // Solve the four plane fits at once
+      Eigen::Array4f eigen_value, nx, ny, nz;
+      pcl::eigen33 (c00, c01, c02, c11, c12, c22, eigen_value, nx, ny, nz);
+
+      // Compute the curvature surface change
+      const Eigen::Array4f eig_sum = c00 + c11 + c22;
+      const Eigen::Array4f curvature = (eig_sum != Eigen::Array4f::Zero ()).select ((eigen_value / eig_sum).abs (), Eigen::Array4f::Zero ());
+
+      // Flip the normals towards the viewpoint
+      const Eigen::Array4f cos_theta = (vpx - qx) * nx + (vpy - qy) * ny + (vpz - qz) * nz;
+      const Eigen::Array4f sign = (cos_theta < Eigen::Array4f::Zero ()).select (-Eigen::Array4f::Ones (), Eigen::Array4f::Ones ());
+      nx *= sign;
+      ny *= sign;
+      nz *= sign;
+
+      for (int l = 0; l < count; ++l)
+      {
+        PointOutT &out = output.points[begin + l];
+        if (nr_neighbors[l] == 0)
+        {
+          out.normal[0] = out.normal[1] = out.normal[2] = out.curvature = std::numeric_limits<float>::quiet_NaN ();
+          output.is_dense = false;
+          continue;
+        }
+        out.normal[0] = nx[l];
+        out.normal[1] = ny[l];
+        out.normal[2] = nz[l];
+        out.curvature = curvature[l];
+      }
+    }
+  }
+}
+
+#define PCL_INSTANTIATE_NormalEstimationBatch(T,NT) template class PCL_EXPORTS pcl::NormalEstimationBatch<T,NT>;
+
+#endif    // PCL_FEATURES_IMPL_NORMAL_3D_BATCH_H_
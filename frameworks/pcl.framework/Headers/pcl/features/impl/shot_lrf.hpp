@@ -41,17 +41,12 @@
 #include <pcl/pcl/features/shot_lrf.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-// Compute a local Reference Frame for a 3D feature; the output is stored in the "rf" matrix
-template<typename PointInT, typename PointOutT> float
-pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const int& current_point_idx, Eigen::Matrix3f &rf)
+template <typename PointInT> float
+pcl::computeSHOTLocalReferenceFrame (const pcl::PointCloud<PointInT> &surface, const Eigen::Vector4f &central_point,
+                                     const std::vector<int> &n_indices, const std::vector<float> &n_sqr_distances,
+                                     int nr_neighbors, double radius, Eigen::Matrix3f &rf)
 {
-  const Eigen::Vector4f& central_point = (*input_)[current_point_idx].getVector4fMap ();
-  std::vector<int> n_indices;
-  std::vector<float> n_sqr_distances;
-
-  this->searchForNeighbors (current_point_idx, search_parameter_, n_indices, n_sqr_distances);
-
-  Eigen::Matrix<double, Eigen::Dynamic, 4> vij (n_indices.size (), 4);
+  Eigen::Matrix<double, Eigen::Dynamic, 4> vij (nr_neighbors, 4);
 
   Eigen::Matrix3d cov_m = Eigen::Matrix3d::Zero ();
 
@@ -60,9 +55,9 @@ pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const i
 
   int valid_nn_points = 0;
 
-  for (size_t i_idx = 0; i_idx < n_indices.size (); ++i_idx)
+  for (int i_idx = 0; i_idx < nr_neighbors; ++i_idx)
   {
-    Eigen::Vector4f pt = surface_->points[n_indices[i_idx]].getVector4fMap ();
+    Eigen::Vector4f pt = surface.points[n_indices[i_idx]].getVector4fMap ();
     if (pt.head<3> () == central_point.head<3> ())
 		  continue;
 
@@ -70,7 +65,7 @@ pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const i
     vij.row (valid_nn_points) = (pt - central_point).cast<double> ();
     vij (valid_nn_points, 3) = 0;
 
-    distance = search_parameter_ - sqrt (n_sqr_distances[i_idx]);
+    distance = radius - sqrt (n_sqr_distances[i_idx]);
 
     // Multiply vij * vij'
     cov_m += distance * (vij.row (valid_nn_points).head<3> ().transpose () * vij.row (valid_nn_points).head<3> ());
@@ -160,6 +155,22 @@ pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const i
   return (0.0f);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Compute a local Reference Frame for a 3D feature; the output is stored in the "rf" matrix
+template<typename PointInT, typename PointOutT> float
+pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const int& current_point_idx, Eigen::Matrix3f &rf)
+{
+  const Eigen::Vector4f& central_point = (*input_)[current_point_idx].getVector4fMap ();
+  std::vector<int> n_indices;
+  std::vector<float> n_sqr_distances;
+
+  this->searchForNeighbors (current_point_idx, search_parameter_, n_indices, n_sqr_distances);
+
+  return (computeSHOTLocalReferenceFrame (*surface_, central_point, n_indices, n_sqr_distances,
+                                          static_cast<int> (n_indices.size ()), search_parameter_, rf));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
 {
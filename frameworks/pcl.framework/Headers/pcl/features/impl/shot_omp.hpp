@@ -40,6 +40,8 @@
 #include <pcl/pcl/features/shot_omp.h>
 #include <pcl/pcl/common/time.h>
 #include <pcl/pcl/features/shot_lrf_omp.h>
+#include <algorithm>
+#include <utility>
 
 template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> bool
 pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
@@ -59,6 +61,10 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
     return (false);
   }
 
+  // Without user given frames, the frames are estimated from the descriptor neighborhoods in computeDescriptors
+  if (frames_never_defined_)
+    return (true);
+
   // Default LRF estimation alg: SHOTLocalReferenceFrameEstimationOMP
   typename boost::shared_ptr<SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT> > lrf_estimator(new SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT>());
   lrf_estimator->setRadiusSearch (search_radius_);
@@ -154,9 +160,53 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, pcl::SHOT, PointRFT>::initCompute ()
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::compute (
+    PointCloudOut &output, double lrf_radius, SHOTLocalReferenceFrameCache<PointInT, PointRFT> *lrf_cache)
+{
+  if (!initCompute ())
+  {
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
+
+  // Copy the header
+  output.header = input_->header;
+
+  // Resize the output dataset
+  if (output.points.size () != indices_->size ())
+    output.points.resize (indices_->size ());
+  // Check if the output will be computed for all points or only a subset
+  if (indices_->size () != input_->points.size ())
+  {
+    output.width = static_cast<int> (indices_->size ());
+    output.height = 1;
+  }
+  else
+  {
+    output.width = input_->width;
+    output.height = input_->height;
+  }
+  output.is_dense = input_->is_dense;
+
+  computeDescriptors (output, lrf_radius, lrf_cache);
+
+  this->deinitCompute ();
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (PointCloudOut &output)
+{
+  computeDescriptors (output, 0.0, NULL);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeDescriptors (
+    PointCloudOut &output, double lrf_radius, SHOTLocalReferenceFrameCache<PointInT, PointRFT> *lrf_cache)
 {
 
   if (threads_ < 0)
@@ -172,61 +222,167 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
   assert(descLength_ == 352);
 
   int data_size = static_cast<int> (indices_->size ());
-  Eigen::VectorXf *shot = new Eigen::VectorXf[threads_];
 
-  for (int i = 0; i < threads_; i++)
-    shot[i].setZero (descLength_);
+  // A single radius search per keypoint serves both the local reference frame and the descriptor
+  const bool compute_frames = frames_never_defined_;
+  if (lrf_radius <= 0)
+    lrf_radius = search_radius_;
+  const double max_radius = compute_frames ? (std::max) (lrf_radius, search_radius_) : search_radius_;
+  const double lrf_sqr_radius = lrf_radius * lrf_radius;
 
-  output.is_dense = true;
-  // Iterating over the entire index vector
-  #pragma omp parallel for num_threads(threads_)
-  for (int idx = 0; idx < data_size; ++idx)
+  PointCloudLRFPtr frames;
+  typename SHOTLocalReferenceFrameCache<PointInT, PointRFT>::Entry *cache_entry = NULL;
+  if (compute_frames)
   {
-#ifdef _OPENMP
-    int tid = omp_get_thread_num ();
-#else
-    int tid = 0;
-#endif
-
-    bool lrf_is_nan = false;
-    const PointRFT& current_frame = (*frames_)[idx];
-    if (!pcl_isfinite (current_frame.rf[0]) ||
-        !pcl_isfinite (current_frame.rf[4]) ||
-        !pcl_isfinite (current_frame.rf[11]))
-    {
-      PCL_WARN ("[pcl::%s::computeFeature] The local reference frame is not valid! Aborting description of point with index %d\n",
-        getClassName ().c_str (), (*indices_)[idx]);
-      lrf_is_nan = true;
-    }
+    frames.reset (new PointCloudLRF);
+    frames->points.resize (data_size);
+    frames->width = data_size;
+    frames->height = 1;
+    frames_ = frames;
+    if (lrf_cache)
+      cache_entry = &lrf_cache->getEntry (input_, surface_, lrf_radius);
+  }
 
-    // Allocate enough space to hold the results
-    // \note This resize is irrelevant for a radiusSearch ().
-    std::vector<int> nn_indices (k_);
-    std::vector<float> nn_dists (k_);
+  output.is_dense = true;
 
-    if (!isFinite ((*input_)[(*indices_)[idx]]) || lrf_is_nan || this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices,
-                                                                                           nn_dists) == 0)
+#pragma omp parallel num_threads(threads_)
+  {
+    // Scratch space of the thread, reused for all of its keypoints
+    std::vector<int> nn_indices;
+    std::vector<float> nn_dists;
+    std::vector<int> lrf_indices;
+    std::vector<float> lrf_dists;
+    std::vector<std::pair<float, int> > sorted_neighbors;
+    std::vector<double> bin_distance_shape;
+    Eigen::VectorXf shot = Eigen::VectorXf::Zero (descLength_);
+
+    // Iterating over the entire index vector
+#pragma omp for schedule(dynamic, 16)
+    for (int idx = 0; idx < data_size; ++idx)
     {
+      const int point_index = (*indices_)[idx];
+      const bool finite = isFinite ((*input_)[point_index]);
+
+      int nr_neighbors = 0;
+      if (finite)
+        nr_neighbors = this->searchForNeighbors (point_index, max_radius, nn_indices, nn_dists);
+
+      if (compute_frames)
+      {
+        // The disambiguation of the local reference frame depends on the neighbor order, so the neighbors are
+        // sorted by distance here instead of changing the sorting setting of the caller's search object. Cached
+        // frames get the same order, which keeps the descriptors independent of the cache.
+        sorted_neighbors.resize (nr_neighbors);
+        for (int i = 0; i < nr_neighbors; ++i)
+          sorted_neighbors[i] = std::make_pair (nn_dists[i], nn_indices[i]);
+        std::sort (sorted_neighbors.begin (), sorted_neighbors.end ());
+        for (int i = 0; i < nr_neighbors; ++i)
+        {
+          nn_dists[i] = sorted_neighbors[i].first;
+          nn_indices[i] = sorted_neighbors[i].second;
+        }
+
+        PointRFT &frame = frames->points[idx];
+        if (cache_entry && cache_entry->computed[point_index])
+          frame = cache_entry->frames[point_index];
+        else
+        {
+          Eigen::Matrix3f rf;
+          if (!finite || nr_neighbors == 0)
+            rf.setConstant (std::numeric_limits<float>::quiet_NaN ());
+          else if (lrf_radius < max_radius)
+          {
+            // The frame uses the part of the neighborhood within its own radius, in search order
+            lrf_indices.clear ();
+            lrf_dists.clear ();
+            for (int i = 0; i < nr_neighbors; ++i)
+            {
+              if (nn_dists[i] <= lrf_sqr_radius)
+              {
+                lrf_indices.push_back (nn_indices[i]);
+                lrf_dists.push_back (nn_dists[i]);
+              }
+            }
+            computeSHOTLocalReferenceFrame (*surface_, (*input_)[point_index].getVector4fMap (), lrf_indices, lrf_dists,
+                                            static_cast<int> (lrf_indices.size ()), lrf_radius, rf);
+          }
+          else
+            computeSHOTLocalReferenceFrame (*surface_, (*input_)[point_index].getVector4fMap (), nn_indices, nn_dists,
+                                            nr_neighbors, lrf_radius, rf);
+
+          frame.x_axis.getNormalVector3fMap () = rf.row (0);
+          frame.y_axis.getNormalVector3fMap () = rf.row (1);
+          frame.z_axis.getNormalVector3fMap () = rf.row (2);
+          if (cache_entry)
+          {
+            cache_entry->frames[point_index] = frame;
+            cache_entry->computed[point_index] = 1;
+          }
+        }
+      }
+
+      bool lrf_is_nan = false;
+      const PointRFT& current_frame = (*frames_)[idx];
+      if (!pcl_isfinite (current_frame.rf[0]) ||
+          !pcl_isfinite (current_frame.rf[4]) ||
+          !pcl_isfinite (current_frame.rf[11]))
+      {
+        PCL_WARN ("[pcl::%s::computeFeature] The local reference frame is not valid! Aborting description of point with index %d\n",
+          getClassName ().c_str (), point_index);
+        lrf_is_nan = true;
+      }
+
+      if (!finite || lrf_is_nan || nr_neighbors == 0)
+      {
+        // Copy into the resultant cloud
+        for (int d = 0; d < descLength_; ++d)
+          output.points[idx].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
+        for (int d = 0; d < 9; ++d)
+          output.points[idx].rf[d] = std::numeric_limits<float>::quiet_NaN ();
+
+        output.is_dense = false;
+        continue;
+      }
+
+      // Restrict the neighborhood to the descriptor radius
+      if (search_radius_ < max_radius)
+      {
+        int nr_kept = 0;
+        for (int i = 0; i < nr_neighbors; ++i)
+        {
+          if (nn_dists[i] <= sqradius_)
+          {
+            nn_indices[nr_kept] = nn_indices[i];
+            nn_dists[nr_kept] = nn_dists[i];
+            ++nr_kept;
+          }
+        }
+        nn_indices.resize (nr_kept);
+        nn_dists.resize (nr_kept);
+      }
+
+      // Estimate the SHOT at each patch, as computePointSHOT does but with the scratch space of the thread
+      if (nn_indices.size () < 5)
+      {
+        PCL_WARN ("[pcl::%s::computePointSHOT] Warning! Neighborhood has less than 5 vertexes. Aborting description of point with index %d\n",
+                  getClassName ().c_str (), point_index);
+        shot.setConstant (std::numeric_limits<float>::quiet_NaN ());
+      }
+      else
+      {
+        this->createBinDistanceShape (idx, nn_indices, bin_distance_shape);
+        shot.setZero ();
+        this->interpolateSingleChannel (nn_indices, nn_dists, idx, bin_distance_shape, nr_shape_bins_, shot);
+        this->normalizeHistogram (shot, descLength_);
+      }
+
       // Copy into the resultant cloud
-      for (int d = 0; d < shot[tid].size (); ++d)
-        output.points[idx].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
+      for (int d = 0; d < shot.size (); ++d)
+        output.points[idx].descriptor[d] = shot[d];
       for (int d = 0; d < 9; ++d)
-        output.points[idx].rf[d] = std::numeric_limits<float>::quiet_NaN ();
-
-      output.is_dense = false;
-      continue;
+        output.points[idx].rf[d] = current_frame.rf[(4 * (d / 3) + (d % 3))];
     }
-
-    // Estimate the SHOT at each patch
-    this->computePointSHOT (idx, nn_indices, nn_dists, shot[tid]);
-
-    // Copy into the resultant cloud
-    for (int d = 0; d < shot[tid].size (); ++d)
-      output.points[idx].descriptor[d] = shot[tid][d];
-    for (int d = 0; d < 9; ++d)
-      output.points[idx].rf[d] = frames_->points[idx].rf[(4 * (d / 3) + (d % 3))];
   }
-  delete[] shot;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -119,7 +119,20 @@ namespace pcl
         finite_values_integral_image_ (),
         width_ (1), 
         height_ (1), 
-        compute_second_order_integral_images_ (compute_second_order_integral_images)
+        compute_second_order_integral_images_ (compute_second_order_integral_images),
+        threads_ (1),
+        fixed_second_order_integral_image_ (),
+        use_fixed_point_ (false),
+        fixed_point_resolution_ (1e-5),
+        reference_frame_ (),
+        reference_frame_valid_ (false),
+        change_threshold_ (0.0f),
+        row_changed_ (),
+        changed_rows_ (),
+        row_buffer_ (),
+        count_row_buffer_ (),
+        so_row_buffer_ (),
+        fixed_row_buffer_ ()
       {
       }
 
@@ -127,12 +140,58 @@ namespace pcl
       virtual
       ~IntegralImage2D () { }
 
+      /** \brief Set the number of threads used to build the integral images. The rows are prefix-summed in
+        * parallel first, then the rows are accumulated top to bottom in parallel column bands.
+        * \param[in] nr_threads the number of hardware threads to use
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
       /** \brief sets the computation for second order integral images on or off.
         * \param compute_second_order_integral_images
         */
       void 
       setSecondOrderComputation (bool compute_second_order_integral_images);
 
+      /** \brief Store the second order integral images as 32 bit fixed point numbers instead of IntegralType. This
+        * halves the memory used and the bandwidth needed by the second order images of float data. The sums wrap
+        * around, so the second order sum of any queried rectangle has to stay below 2^31 * resolution in magnitude.
+        * \param[in] use_fixed_point whether to use the fixed point representation
+        * \param[in] resolution the quantization step of the second order elements
+        */
+      void
+      setSecondOrderFixedPoint (bool use_fixed_point, double resolution = 1e-5);
+
+      /** \brief Set the threshold on the absolute change of an element above which updateInput considers its row
+        * as changed.
+        * \param[in] threshold the change threshold
+        */
+      inline void
+      setChangeThreshold (float threshold)
+      {
+        change_threshold_ = threshold;
+      }
+
+      /** \brief Update the integral images with the next frame of a stream. Only the rows containing an element that
+        * changed by more than the change threshold, or that became finite or non-finite, since the last frame are
+        * recomputed. The images are rebuilt from scratch if the size changed, if setInput was called in between
+        * or if more than half of the rows changed.
+        * \param[in] data the input data
+        * \param[in] width the width of the data
+        * \param[in] height the height of the data
+        * \param[in] element_stride the element stride of the data
+        * \param[in] row_stride the row stride of the data
+        * \return the number of rows that were recomputed
+        */
+      unsigned
+      updateInput (const DataType * data,
+                   unsigned width, unsigned height, unsigned element_stride, unsigned row_stride);
+
       /** \brief Set the input data to compute the integral image for
         * \param[in] data the input data
         * \param[in] width the width of the data
@@ -200,6 +259,7 @@ namespace pcl
 
     private:
       typedef Eigen::Matrix<typename IntegralImageTypeTraits<DataType>::Type, Dimension, 1> InputType;
+      typedef Eigen::Matrix<unsigned, second_order_size, 1> FixedSecondOrderType;
 
       /** \brief Compute the actual integral image data
         * \param[in] data the input data
@@ -209,6 +269,38 @@ namespace pcl
       void
       computeIntegralImages (const DataType * data, unsigned row_stride, unsigned element_stride);
 
+      /** \brief Recompute the changed rows of the integral images and propagate the difference to the rows below
+        * \param[in] data the input data
+        * \param[in] element_stride the element stride of the data
+        * \param[in] row_stride the row stride of the data
+        */
+      void
+      updateIntegralImages (const DataType * data, unsigned row_stride, unsigned element_stride);
+
+      /** \brief Compute the prefix sums of a single input row
+        * \param[in] row_data the input row
+        * \param[in] element_stride the element stride of the data
+        * \param[out] first_order the first order prefix sums (width_ + 1 elements)
+        * \param[out] count the finite element count prefix sums (width_ + 1 elements)
+        * \param[out] second_order the second order prefix sums, or NULL
+        * \param[out] fixed_second_order the fixed point second order prefix sums, or NULL
+        */
+      void
+      computeRowPrefixSums (const DataType * row_data, unsigned element_stride, ElementType *first_order,
+                            unsigned *count, SecondOrderType *second_order, FixedSecondOrderType *fixed_second_order) const;
+
+      /** \brief Allocate the images for the given size. Buffers are kept as long as the size does not change. */
+      void
+      allocateImages (unsigned width, unsigned height);
+
+      /** \brief Copy the input into the reference frame that updateInput compares against
+        * \param[in] data the input data
+        * \param[in] element_stride the element stride of the data
+        * \param[in] row_stride the row stride of the data
+        */
+      void
+      storeReferenceFrame (const DataType * data, unsigned row_stride, unsigned element_stride);
+
       std::vector<ElementType, Eigen::aligned_allocator<ElementType> > first_order_integral_image_;
       std::vector<SecondOrderType, Eigen::aligned_allocator<SecondOrderType> > second_order_integral_image_;
       std::vector<unsigned> finite_values_integral_image_;
@@ -220,6 +312,39 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief The number of threads used to build the integral images */
+      unsigned int threads_;
+
+      /** \brief The second order integral image in fixed point representation */
+      std::vector<FixedSecondOrderType, Eigen::aligned_allocator<FixedSecondOrderType> > fixed_second_order_integral_image_;
+
+      /** \brief Indicates whether the second order integral image is stored in fixed point representation */
+      bool use_fixed_point_;
+
+      /** \brief The quantization step of the fixed point second order integral image */
+      double fixed_point_resolution_;
+
+      /** \brief The frame the integral images currently represent, compared against by updateInput */
+      std::vector<InputType, Eigen::aligned_allocator<InputType> > reference_frame_;
+
+      /** \brief Indicates whether the integral images were built from reference_frame_ */
+      bool reference_frame_valid_;
+
+      /** \brief The change of an element above which its row is recomputed by updateInput */
+      float change_threshold_;
+
+      /** \brief Per row flag, set for the rows that changed since the reference frame */
+      std::vector<unsigned char> row_changed_;
+
+      /** \brief Indices of the rows that changed since the reference frame */
+      std::vector<int> changed_rows_;
+
+      /** \brief Prefix sums of the changed rows, kept across frames to avoid reallocations */
+      std::vector<ElementType, Eigen::aligned_allocator<ElementType> > row_buffer_;
+      std::vector<unsigned> count_row_buffer_;
+      std::vector<SecondOrderType, Eigen::aligned_allocator<SecondOrderType> > so_row_buffer_;
+      std::vector<FixedSecondOrderType, Eigen::aligned_allocator<FixedSecondOrderType> > fixed_row_buffer_;
    };
 
    /**
@@ -241,7 +366,20 @@ namespace pcl
         second_order_integral_image_ (),
         finite_values_integral_image_ (),
         width_ (1), height_ (1), 
-        compute_second_order_integral_images_ (compute_second_order_integral_images)
+        compute_second_order_integral_images_ (compute_second_order_integral_images),
+        threads_ (1),
+        fixed_second_order_integral_image_ (),
+        use_fixed_point_ (false),
+        fixed_point_resolution_ (1e-5),
+        reference_frame_ (),
+        reference_frame_valid_ (false),
+        change_threshold_ (0.0f),
+        row_changed_ (),
+        changed_rows_ (),
+        row_buffer_ (),
+        count_row_buffer_ (),
+        so_row_buffer_ (),
+        fixed_row_buffer_ ()
       {
       }
 
@@ -249,6 +387,52 @@ namespace pcl
       virtual
       ~IntegralImage2D () { }
 
+      /** \brief Set the number of threads used to build the integral images. The rows are prefix-summed in
+        * parallel first, then the rows are accumulated top to bottom in parallel column bands.
+        * \param[in] nr_threads the number of hardware threads to use
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+      /** \brief Store the second order integral images as 32 bit fixed point numbers instead of IntegralType. This
+        * halves the memory used and the bandwidth needed by the second order images of float data. The sums wrap
+        * around, so the second order sum of any queried rectangle has to stay below 2^31 * resolution in magnitude.
+        * \param[in] use_fixed_point whether to use the fixed point representation
+        * \param[in] resolution the quantization step of the second order elements
+        */
+      void
+      setSecondOrderFixedPoint (bool use_fixed_point, double resolution = 1e-5);
+
+      /** \brief Set the threshold on the absolute change of an element above which updateInput considers its row
+        * as changed.
+        * \param[in] threshold the change threshold
+        */
+      inline void
+      setChangeThreshold (float threshold)
+      {
+        change_threshold_ = threshold;
+      }
+
+      /** \brief Update the integral images with the next frame of a stream. Only the rows containing an element that
+        * changed by more than the change threshold, or that became finite or non-finite, since the last frame are
+        * recomputed. The images are rebuilt from scratch if the size changed, if setInput was called in between
+        * or if more than half of the rows changed.
+        * \param[in] data the input data
+        * \param[in] width the width of the data
+        * \param[in] height the height of the data
+        * \param[in] element_stride the element stride of the data
+        * \param[in] row_stride the row stride of the data
+        * \return the number of rows that were recomputed
+        */
+      unsigned
+      updateInput (const DataType * data,
+                   unsigned width, unsigned height, unsigned element_stride, unsigned row_stride);
+
       /** \brief Set the input data to compute the integral image for
         * \param[in] data the input data
         * \param[in] width the width of the data
@@ -315,7 +499,8 @@ namespace pcl
       getFiniteElementsCountSE (unsigned start_x, unsigned start_y, unsigned end_x, unsigned end_y) const;
 
   private:
-    //  typedef typename IntegralImageTypeTraits<DataType>::Type InputType;
+      typedef typename IntegralImageTypeTraits<DataType>::Type InputType;
+      typedef unsigned FixedSecondOrderType;
 
       /** \brief Compute the actual integral image data
         * \param[in] data the input data
@@ -325,6 +510,38 @@ namespace pcl
       void
       computeIntegralImages (const DataType * data, unsigned row_stride, unsigned element_stride);
 
+      /** \brief Recompute the changed rows of the integral images and propagate the difference to the rows below
+        * \param[in] data the input data
+        * \param[in] element_stride the element stride of the data
+        * \param[in] row_stride the row stride of the data
+        */
+      void
+      updateIntegralImages (const DataType * data, unsigned row_stride, unsigned element_stride);
+
+      /** \brief Compute the prefix sums of a single input row
+        * \param[in] row_data the input row
+        * \param[in] element_stride the element stride of the data
+        * \param[out] first_order the first order prefix sums (width_ + 1 elements)
+        * \param[out] count the finite element count prefix sums (width_ + 1 elements)
+        * \param[out] second_order the second order prefix sums, or NULL
+        * \param[out] fixed_second_order the fixed point second order prefix sums, or NULL
+        */
+      void
+      computeRowPrefixSums (const DataType * row_data, unsigned element_stride, ElementType *first_order,
+                            unsigned *count, SecondOrderType *second_order, FixedSecondOrderType *fixed_second_order) const;
+
+      /** \brief Allocate the images for the given size. Buffers are kept as long as the size does not change. */
+      void
+      allocateImages (unsigned width, unsigned height);
+
+      /** \brief Copy the input into the reference frame that updateInput compares against
+        * \param[in] data the input data
+        * \param[in] element_stride the element stride of the data
+        * \param[in] row_stride the row stride of the data
+        */
+      void
+      storeReferenceFrame (const DataType * data, unsigned row_stride, unsigned element_stride);
+
       std::vector<ElementType, Eigen::aligned_allocator<ElementType> > first_order_integral_image_;
       std::vector<SecondOrderType, Eigen::aligned_allocator<SecondOrderType> > second_order_integral_image_;
       std::vector<unsigned> finite_values_integral_image_;
@@ -336,6 +553,39 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief The number of threads used to build the integral images */
+      unsigned int threads_;
+
+      /** \brief The second order integral image in fixed point representation */
+      std::vector<FixedSecondOrderType, Eigen::aligned_allocator<FixedSecondOrderType> > fixed_second_order_integral_image_;
+
+      /** \brief Indicates whether the second order integral image is stored in fixed point representation */
+      bool use_fixed_point_;
+
+      /** \brief The quantization step of the fixed point second order integral image */
+      double fixed_point_resolution_;
+
+      /** \brief The frame the integral images currently represent, compared against by updateInput */
+      std::vector<InputType, Eigen::aligned_allocator<InputType> > reference_frame_;
+
+      /** \brief Indicates whether the integral images were built from reference_frame_ */
+      bool reference_frame_valid_;
+
+      /** \brief The change of an element above which its row is recomputed by updateInput */
+      float change_threshold_;
+
+      /** \brief Per row flag, set for the rows that changed since the reference frame */
+      std::vector<unsigned char> row_changed_;
+
+      /** \brief Indices of the rows that changed since the reference frame */
+      std::vector<int> changed_rows_;
+
+      /** \brief Prefix sums of the changed rows, kept across frames to avoid reallocations */
+      std::vector<ElementType, Eigen::aligned_allocator<ElementType> > row_buffer_;
+      std::vector<unsigned> count_row_buffer_;
+      std::vector<SecondOrderType, Eigen::aligned_allocator<SecondOrderType> > so_row_buffer_;
+      std::vector<FixedSecondOrderType, Eigen::aligned_allocator<FixedSecondOrderType> > fixed_row_buffer_;
    };
  }
 
@@ -48,6 +48,29 @@
 #endif
 namespace pcl
 {
+  /** \brief Settings of the streaming mode of IntegralImageNormalEstimation, owned by the caller. Handing the same
+    * object to setInputCloud with every frame of a stream of organized clouds updates the integral images of the
+    * previous frame in place, recomputing only the rows that changed, instead of rebuilding them from scratch.
+    */
+  struct IntegralImageNormalStream
+  {
+    IntegralImageNormalStream () : change_threshold (0.0f), use_fixed_point (false), fixed_point_resolution (1e-5),
+      updated_rows (0)
+    {
+    }
+
+    /** \brief The change of a coordinate above which the image row of a point is recomputed. Rows holding smaller
+      * changes keep the sums of the frame they were last computed for. */
+    float change_threshold;
+    /** \brief Whether the second order integral images of COVARIANCE_MATRIX use 32 bit fixed point numbers. */
+    bool use_fixed_point;
+    /** \brief The quantization step of the fixed point second order integral images. */
+    double fixed_point_resolution;
+    /** \brief The number of integral image rows recomputed for the last frame, summed over the images used by the
+      * normal estimation method. */
+    unsigned updated_rows;
+  };
+
   /** \brief Surface normal estimation on organized data using integral images.
     * \author Stefan Holzer
     */
@@ -116,6 +139,7 @@ namespace pcl
         , vpy_ (0.0f)
         , vpz_ (0.0f)
         , use_sensor_origin_ (true)
+        , threads_ (1)
       {
         feature_name_ = "IntegralImagesNormalEstimation";
         tree_.reset ();
@@ -132,6 +156,23 @@ namespace pcl
       void
       setRectSize (const int width, const int height);
 
+      /** \brief Set the number of threads used to build the integral images and to evaluate the normals. With
+        * BORDER_POLICY_IGNORE, the COVARIANCE_MATRIX and AVERAGE_3D_GRADIENT methods evaluate the image in tiles
+        * that are distributed over the threads, four pixels at a time in SIMD lanes.
+        * \param[in] nr_threads the number of hardware threads to use
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+        integral_image_DX_.setNumberOfThreads (nr_threads);
+        integral_image_DY_.setNumberOfThreads (nr_threads);
+        integral_image_depth_.setNumberOfThreads (nr_threads);
+        integral_image_XYZ_.setNumberOfThreads (nr_threads);
+      }
+
       /** \brief Sets the policy for handling borders.
         * \param[in] border_policy the border policy.
         */
@@ -232,6 +273,14 @@ namespace pcl
         initData ();
       }
 
+      /** \brief Provide the next frame of a stream of organized clouds. Unlike setInputCloud (cloud), the integral
+        * images built for the previous frame are updated rather than rebuilt, see IntegralImageNormalStream.
+        * \param[in] cloud the const boost shared pointer to a PointCloud message
+        * \param[in,out] stream the streaming settings, receiving the number of recomputed rows
+        */
+      void
+      setInputCloud (const typename PointCloudIn::ConstPtr &cloud, IntegralImageNormalStream &stream);
+
       /** \brief Returns a pointer to the distance map which was computed internally
         */
       inline float*
@@ -300,9 +349,32 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output);
 
-      /** \brief Initialize the data structures, based on the normal estimation method chosen. */
+      /** \brief Initialize the data structures, based on the normal estimation method chosen.
+        * \param[in,out] stream the streaming settings, or NULL to rebuild the integral images
+        */
       void
-      initData ();
+      initData (IntegralImageNormalStream *stream = NULL);
+
+      /** \brief Computes the normals inside the image border in parallel tiles, for BORDER_POLICY_IGNORE with the
+        * COVARIANCE_MATRIX or AVERAGE_3D_GRADIENT method.
+        * \param[in] distance_map the distance of every pixel to the closest depth discontinuity
+        * \param[out] output the resultant normals
+        */
+      void
+      computeFeatureTiled (const float *distance_map, PointCloudOut &output);
+
+      /** \brief Computes the normals of up to four pixels at once, one pixel per SIMD lane. Unlike
+        * computePointNormal, the rectangle size is given per pixel, so that this method can be called concurrently.
+        * \param[in] pos_x the x positions (pixel)
+        * \param[in] pos_y the y positions (pixel)
+        * \param[in] point_index the position indices of the points
+        * \param[in] rect_size the width and height of the square region used for each pixel
+        * \param[in] nr_points the number of pixels to evaluate (at most 4)
+        * \param[out] output the cloud receiving the estimated normals at point_index
+        */
+      void
+      computePointNormalBatch (const int *pos_x, const int *pos_y, const unsigned *point_index,
+                               const int *rect_size, int nr_points, PointCloudOut &output);
 
     private:
       /** \brief The normal estimation method to use. Currently, 3 implementations are provided:
@@ -375,26 +447,48 @@ namespace pcl
 
       /** whether the sensor origin of the input cloud or a user given viewpoint should be used.*/
       bool use_sensor_origin_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
       
       /** \brief This method should get called before starting the actual computation. */
       bool
       initCompute ();
 
-      /** \brief Internal initialization method for COVARIANCE_MATRIX estimation. */
+      /** \brief Internal initialization method for COVARIANCE_MATRIX estimation.
+        * \param[in,out] stream the streaming settings, or NULL to rebuild the integral images
+        */
       void
-      initCovarianceMatrixMethod ();
+      initCovarianceMatrixMethod (IntegralImageNormalStream *stream = NULL);
 
-      /** \brief Internal initialization method for AVERAGE_3D_GRADIENT estimation. */
+      /** \brief Internal initialization method for AVERAGE_3D_GRADIENT estimation.
+        * \param[in,out] stream the streaming settings, or NULL to rebuild the integral images
+        */
       void
-      initAverage3DGradientMethod ();
+      initAverage3DGradientMethod (IntegralImageNormalStream *stream = NULL);
 
-      /** \brief Internal initialization method for AVERAGE_DEPTH_CHANGE estimation. */
+      /** \brief Internal initialization method for AVERAGE_DEPTH_CHANGE estimation.
+        * \param[in,out] stream the streaming settings, or NULL to rebuild the integral images
+        */
       void
-      initAverageDepthChangeMethod ();
+      initAverageDepthChangeMethod (IntegralImageNormalStream *stream = NULL);
 
-      /** \brief Internal initialization method for SIMPLE_3D_GRADIENT estimation. */
+      /** \brief Internal initialization method for SIMPLE_3D_GRADIENT estimation.
+        * \param[in,out] stream the streaming settings, or NULL to rebuild the integral images
+        */
       void
-      initSimple3DGradientMethod ();
+      initSimple3DGradientMethod (IntegralImageNormalStream *stream = NULL);
+
+      /** \brief Build an integral image over the input cloud, or update it if a stream is given.
+        * \param[in,out] integral_image the integral image
+        * \param[in] data the first element of the input data
+        * \param[in] element_stride the element stride of the data
+        * \param[in] row_stride the row stride of the data
+        * \param[in,out] stream the streaming settings, or NULL to rebuild the integral image
+        */
+      template <unsigned Dimension> void
+      buildIntegralImage (IntegralImage2D<float, Dimension> &integral_image, const float *data,
+                          unsigned element_stride, unsigned row_stride, IntegralImageNormalStream *stream);
 
     private:
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
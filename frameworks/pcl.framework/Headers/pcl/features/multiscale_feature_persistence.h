@@ -40,12 +40,117 @@
 
 #include <pcl/pcl/pcl_base.h>
 #include <pcl/pcl/features/feature.h>
+#include <pcl/pcl/search/search.h>
 #include <pcl/pcl/point_representation.h>
 #include <pcl/pcl/common/norms.h>
 #include <list>
 
 namespace pcl
 {
+  /** \brief MultiscaleNeighborhoodSearch answers the radius searches of a feature estimator from neighborhoods that
+   * were computed once, at the largest radius of interest, by another search method.
+   *
+   * The neighborhoods of the query points are kept sorted by distance, so a radius search at a smaller radius is a
+   * prefix of the stored neighborhood and costs a binary search and a copy instead of a tree traversal. Searches
+   * for points that were not precomputed, or with a radius larger than the precomputed one, are forwarded to the
+   * underlying search method. Once computed, the neighborhoods are only read, hence the class can be shared by
+   * several feature estimators running concurrently.
+   *
+   * \note Results are always sorted by ascending distance.
+   * \ingroup features
+   */
+  template <typename PointT>
+  class MultiscaleNeighborhoodSearch : public pcl::search::Search<PointT>
+  {
+    public:
+      typedef pcl::PointCloud<PointT> PointCloud;
+      typedef typename PointCloud::ConstPtr PointCloudConstPtr;
+      typedef typename pcl::search::Search<PointT>::Ptr SearchPtr;
+      typedef typename pcl::search::Search<PointT>::IndicesConstPtr IndicesConstPtr;
+      typedef boost::shared_ptr<MultiscaleNeighborhoodSearch<PointT> > Ptr;
+      typedef boost::shared_ptr<const MultiscaleNeighborhoodSearch<PointT> > ConstPtr;
+
+      using pcl::search::Search<PointT>::radiusSearch;
+      using pcl::search::Search<PointT>::nearestKSearch;
+
+      /** \brief Constructor.
+       * \param[in] search the search method used to compute the neighborhoods and to answer all other queries
+       */
+      MultiscaleNeighborhoodSearch (const SearchPtr &search);
+
+      /** \brief Provide the cloud to search in, and drop the precomputed neighborhoods.
+       * \param[in] cloud the search surface
+       * \param[in] indices the point indices subset that is to be used from the cloud
+       */
+      virtual void
+      setInputCloud (const PointCloudConstPtr &cloud, const IndicesConstPtr &indices = IndicesConstPtr ());
+
+      /** \brief Results are always sorted, hence this is a no-op. */
+      virtual void
+      setSortedResults (bool) {}
+
+      /** \brief Compute the neighborhoods of the given query points at the maximum radius.
+       * \param[in] cloud the query cloud; radius searches on other clouds are forwarded to the search method
+       * \param[in] indices the query points in \a cloud, or NULL for all of them
+       * \param[in] max_radius the largest radius the neighborhoods can be sliced to
+       * \param[in] threads the number of OpenMP threads used for the searches
+       */
+      void
+      computeNeighborhoods (const PointCloudConstPtr &cloud, const IndicesConstPtr &indices,
+                            double max_radius, unsigned int threads = 1);
+
+      /** \brief Get the largest radius the neighborhoods were computed for. */
+      inline double
+      getMaxRadius () const { return (max_radius_); }
+
+      virtual int
+      nearestKSearch (const PointT &point, int k, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances) const
+      {
+        return (search_->nearestKSearch (point, k, k_indices, k_sqr_distances));
+      }
+
+      virtual int
+      radiusSearch (const PointT &point, double radius, std::vector<int> &k_indices,
+                    std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const
+      {
+        return (search_->radiusSearch (point, radius, k_indices, k_sqr_distances, max_nn));
+      }
+
+      /** \brief Search for all the neighbors of a point of the query cloud, slicing its precomputed neighborhood.
+       * \param[in] cloud the point cloud data
+       * \param[in] index the index in \a cloud of the query point
+       * \param[in] radius the radius of the sphere bounding all of the query point's neighbors
+       * \param[out] k_indices the resultant indices of the neighboring points
+       * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+       * \param[in] max_nn if nonzero, bounds the number of returned neighbors to the \a max_nn nearest ones
+       * \return number of neighbors found in radius
+       */
+      virtual int
+      radiusSearch (const PointCloud &cloud, int index, double radius, std::vector<int> &k_indices,
+                    std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const;
+
+    private:
+      /** \brief The search method the neighborhoods are computed with. */
+      SearchPtr search_;
+
+      /** \brief The cloud whose points' neighborhoods are precomputed. */
+      PointCloudConstPtr query_cloud_;
+
+      /** \brief The radius the neighborhoods were computed for. */
+      double max_radius_;
+
+      /** \brief The neighborhood row of each point of the query cloud, -1 if not precomputed. */
+      std::vector<int> point_rows_;
+
+      /** \brief The start of each row in neighbor_indices_ and neighbor_sqr_dists_, plus the total size. */
+      std::vector<int> row_offsets_;
+
+      /** \brief The neighborhoods, concatenated row after row and sorted by distance within a row. */
+      std::vector<int> neighbor_indices_;
+      std::vector<float> neighbor_sqr_dists_;
+  };
+
   /** \brief Generic class for extracting the persistent features from an input point cloud
    * It can be given any Feature estimator instance and will compute the features of the input
    * over a multiscale representation of the cloud and output the unique ones over those scales.
@@ -56,6 +161,10 @@ namespace pcl
    *    Proceedings of the 10th International Conference on Intelligent Autonomous Systems (IAS-10)
    *    2008, Baden-Baden, Germany
    *
+   * determinePersistentFeatures () searches the neighborhoods of the input points only once, at the largest scale,
+   * and the estimator at every scale slices them (see MultiscaleNeighborhoodSearch). Independent, identically
+   * configured estimators given to the overload taking them allow the scales to be computed concurrently.
+   *
    * \author Alexandru-Eugen Ichim
    */
   template <typename PointSource, typename PointFeature>
@@ -66,6 +175,7 @@ namespace pcl
       typedef typename pcl::PointCloud<PointFeature>::Ptr FeatureCloudPtr;
       typedef typename pcl::Feature<PointSource, PointFeature>::Ptr FeatureEstimatorPtr;
       typedef boost::shared_ptr<const pcl::PointRepresentation <PointFeature> > FeatureRepresentationConstPtr;
+      typedef typename pcl::search::Search<PointSource>::Ptr SearchPtr;
 
       using pcl::PCLBase<PointSource>::input_;
 
@@ -76,6 +186,20 @@ namespace pcl
       void
       computeFeaturesAtAllScales ();
 
+      /** \brief Method that calls computeFeatureAtScale () for each scale parameter, spreading the scales over the
+       * given estimators, and sums up the vectorized features of each scale
+       * \param feature_estimators additional estimator instances, all configured like the one given to
+       * setFeatureEstimator (); the scales are spread over at most nr_threads of the estimators
+       * \param nr_threads the number of OpenMP threads used for the neighborhood searches and the concurrent scales
+       * \param share_neighborhoods true to search the neighborhoods once at the largest scale and slice them for all scales
+       * \param feature_sums the sum of the vectorized features of each scale
+       */
+      void
+      computeFeaturesAtAllScales (const std::vector<FeatureEstimatorPtr> &feature_estimators,
+                                  unsigned int nr_threads,
+                                  bool share_neighborhoods,
+                                  std::vector<std::vector<double> > &feature_sums);
+
       /** \brief Central function that computes the persistent features
        * \param output_features a cloud containing the persistent features
        * \param output_indices vector containing the indices of the points in the input cloud
@@ -85,6 +209,23 @@ namespace pcl
       determinePersistentFeatures (FeatureCloud &output_features,
                                    boost::shared_ptr<std::vector<int> > &output_indices);
 
+      /** \brief Central function that computes the persistent features, possibly computing several scales concurrently
+       * \param output_features a cloud containing the persistent features
+       * \param output_indices vector containing the indices of the points in the input cloud
+       * that have persistent features, under a one-to-one correspondence with the output_features cloud
+       * \param feature_estimators independent estimator instances in addition to the one given to setFeatureEstimator (),
+       * all configured like it
+       * \param nr_threads the number of OpenMP threads to use (0 is treated as 1)
+       * \param share_neighborhoods true to search the neighborhoods once at the largest scale instead of at each scale
+       * with the estimator's own search method
+       */
+      void
+      determinePersistentFeatures (FeatureCloud &output_features,
+                                   boost::shared_ptr<std::vector<int> > &output_indices,
+                                   const std::vector<FeatureEstimatorPtr> &feature_estimators,
+                                   unsigned int nr_threads,
+                                   bool share_neighborhoods = true);
+
       /** \brief Method for setting the scale parameters for the algorithm
        * \param scale_values vector of scales to determine the characteristic of each scaling step
        */
@@ -149,6 +290,14 @@ namespace pcl
       computeFeatureAtScale (float &scale,
                              FeatureCloudPtr &features);
 
+      /** \brief Method to compute the features for the point cloud at the given scale with the given estimator.
+       * The main feature estimator goes through the virtual computeFeatureAtScale (scale, features) instead.
+       */
+      void
+      computeFeatureAtScale (float &scale,
+                             const FeatureEstimatorPtr &feature_estimator,
+                             FeatureCloudPtr &features);
+
 
       /** \brief Function that calculates the scalar difference between two features
        * \return the difference as a floating point type
@@ -163,6 +312,13 @@ namespace pcl
       void
       calculateMeanFeature ();
 
+      /** \brief Method that obtains the global mean feature from the sums of the features of each scale;
+       * this value is stored in the mean_feature field
+       * \param feature_sums the sum of the vectorized features of each scale
+       */
+      void
+      calculateMeanFeature (const std::vector<std::vector<double> > &feature_sums);
+
       /** \brief Selects the so-called 'unique' features from the cloud of features at each level.
        * These features are the ones that fall outside the standard deviation * alpha_
        */
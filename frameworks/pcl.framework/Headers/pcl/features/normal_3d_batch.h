@@ -0,0 +1,123 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_NORMAL_3D_BATCH_H_
+#define PCL_NORMAL_3D_BATCH_H_
+
+#include <pcl/pcl/features/normal_3d.h>
+
+namespace pcl
+{
+  /** \brief NormalEstimationBatch estimates surface normals and curvatures like \ref NormalEstimationOMP, but
+    * processes the query points in batches of four. The neighborhoods of a batch are gathered together, their
+    * covariance matrices are accumulated in the four lanes of packed Eigen arrays (SSE or NEON), and the smallest
+    * eigenpairs of the four 3x3 symmetric matrices are obtained at once with the four-lane closed-form
+    * \ref pcl::eigen33. Batches are distributed over threads using the OpenMP standard.
+    *
+    * \note The covariance is accumulated in a single pass relative to the query point, which keeps the moments
+    * small for local neighborhoods. Results agree with \ref NormalEstimationOMP up to floating point rounding.
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointOutT>
+  class NormalEstimationBatch: public NormalEstimation<PointInT, PointOutT>
+  {
+    public:
+      using NormalEstimation<PointInT, PointOutT>::feature_name_;
+      using NormalEstimation<PointInT, PointOutT>::getClassName;
+      using NormalEstimation<PointInT, PointOutT>::indices_;
+      using NormalEstimation<PointInT, PointOutT>::input_;
+      using NormalEstimation<PointInT, PointOutT>::k_;
+      using NormalEstimation<PointInT, PointOutT>::search_parameter_;
+      using NormalEstimation<PointInT, PointOutT>::surface_;
+      using NormalEstimation<PointInT, PointOutT>::getViewPoint;
+
+      typedef typename NormalEstimation<PointInT, PointOutT>::PointCloudOut PointCloudOut;
+
+      /** \brief Number of query points solved together, one per SIMD lane. */
+      static const int BATCH_SIZE = 4;
+
+    public:
+      /** \brief Empty constructor. */
+      NormalEstimationBatch () : threads_ (1)
+      {
+        feature_name_ = "NormalEstimationBatch";
+      };
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param nr_threads the number of hardware threads to use
+        */
+      NormalEstimationBatch (unsigned int nr_threads) : threads_ (1)
+      {
+        setNumberOfThreads (nr_threads);
+        feature_name_ = "NormalEstimationBatch";
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param nr_threads the number of hardware threads to use
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
+    protected:
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+    private:
+      /** \brief Estimate normals for all points given in <setInputCloud (), setIndices ()> using the surface in
+        * setSearchSurface () and the spatial locator in setSearchMethod ()
+        * \param output the resultant point cloud model dataset that contains surface normals and curvatures
+        */
+      void
+      computeFeature (PointCloudOut &output);
+
+      /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
+        * \param[out] output the output point cloud
+        */
+      void
+      computeFeatureEigen (pcl::PointCloud<Eigen::MatrixXf> &) {}
+
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+}
+
+#endif  //#ifndef PCL_NORMAL_3D_BATCH_H_
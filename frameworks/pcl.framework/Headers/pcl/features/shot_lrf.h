@@ -39,11 +39,112 @@
 #ifndef PCL_FEATURES_SHOT_LRF_H_
 #define PCL_FEATURES_SHOT_LRF_H_
 
+#include <list>
 #include <pcl/pcl/point_types.h>
 #include <pcl/pcl/features/feature.h>
 
 namespace pcl
 {
+  /** \brief Compute the disambiguated SHOT local reference frame of a point from a given neighborhood.
+    * \param[in] surface the cloud the neighbor indices refer to
+    * \param[in] central_point the point at which the local RF is computed
+    * \param[in] indices the neighbor indices, in the order returned by a sorted radius search
+    * \param[in] sqr_dists the squared distances to the neighbors
+    * \param[in] nr_neighbors the number of neighbors to use from indices and sqr_dists
+    * \param[in] radius the radius of the neighborhood
+    * \param[out] rf the reference frame, one axis per row (NaN if it could not be computed)
+    * \return 0 on success, std::numeric_limits<float>::max () otherwise
+    * \ingroup features
+    */
+  template <typename PointInT> float
+  computeSHOTLocalReferenceFrame (const pcl::PointCloud<PointInT> &surface, const Eigen::Vector4f &central_point,
+                                  const std::vector<int> &indices, const std::vector<float> &sqr_dists,
+                                  int nr_neighbors, double radius, Eigen::Matrix3f &rf);
+
+  /** \brief SHOTLocalReferenceFrameCache keeps the SHOT local reference frames computed for the points of a cloud, so
+    * that descriptors evaluated repeatedly on the same cloud (e.g. at several radii) estimate every frame only once.
+    * Entries are keyed by the input cloud, the search surface and the local reference frame radius. The clouds are
+    * identified by their pointers and kept alive by the cache, hence clouds modified in place require a call to clear ().
+    * The least recently used entry is dropped once more than the maximum number of entries exist.
+    * \note The cache must not be used by several estimators running concurrently.
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointRFT = ReferenceFrame>
+  class SHOTLocalReferenceFrameCache
+  {
+    public:
+      typedef boost::shared_ptr<SHOTLocalReferenceFrameCache<PointInT, PointRFT> > Ptr;
+      typedef boost::shared_ptr<const SHOTLocalReferenceFrameCache<PointInT, PointRFT> > ConstPtr;
+      typedef typename pcl::PointCloud<PointInT>::ConstPtr PointCloudInConstPtr;
+
+      /** \brief The local reference frames of one (cloud, surface, radius) key, indexed like the input cloud. */
+      struct Entry
+      {
+        PointCloudInConstPtr cloud;
+        PointCloudInConstPtr surface;
+        double radius;
+        std::vector<PointRFT, Eigen::aligned_allocator<PointRFT> > frames;
+        /** \brief Nonzero for the points whose frame has been computed already. */
+        std::vector<unsigned char> computed;
+      };
+
+      /** \brief Constructor.
+        * \param[in] max_entries the number of (cloud, surface, radius) keys to keep
+        */
+      SHOTLocalReferenceFrameCache (size_t max_entries = 8) : entries_ (), max_entries_ (max_entries) {}
+
+      /** \brief Get the entry for a key, creating an empty one if it does not exist yet.
+        * \param[in] cloud the input cloud
+        * \param[in] surface the search surface
+        * \param[in] radius the local reference frame radius
+        */
+      Entry&
+      getEntry (const PointCloudInConstPtr &cloud, const PointCloudInConstPtr &surface, double radius)
+      {
+        for (typename std::list<Entry>::iterator it = entries_.begin (); it != entries_.end (); ++it)
+        {
+          if (it->cloud.get () == cloud.get () && it->surface.get () == surface.get () && it->radius == radius &&
+              it->computed.size () == cloud->points.size ())
+          {
+            entries_.splice (entries_.begin (), entries_, it);
+            return (entries_.front ());
+          }
+        }
+
+        entries_.push_front (Entry ());
+        Entry &entry = entries_.front ();
+        entry.cloud = cloud;
+        entry.surface = surface;
+        entry.radius = radius;
+        entry.frames.resize (cloud->points.size ());
+        entry.computed.assign (cloud->points.size (), 0);
+        while (entries_.size () > max_entries_ && entries_.size () > 1)
+          entries_.pop_back ();
+        return (entry);
+      }
+
+      /** \brief Drop all cached frames. */
+      inline void
+      clear ()
+      {
+        entries_.clear ();
+      }
+
+      /** \brief Get the number of cached (cloud, surface, radius) keys. */
+      inline size_t
+      size () const
+      {
+        return (entries_.size ());
+      }
+
+    private:
+      /** \brief The cached entries, most recently used first. */
+      std::list<Entry> entries_;
+
+      /** \brief The maximum number of entries to keep. */
+      size_t max_entries_;
+  };
+
   /** \brief SHOTLocalReferenceFrameEstimation estimates the Local Reference Frame used in the calculation
     * of the (SHOT) descriptor.
     *
@@ -40,6 +40,7 @@
 #include <pcl/pcl/point_types.h>
 #include <pcl/pcl/features/feature.h>
 #include <pcl/pcl/features/shot.h>
+#include <pcl/pcl/features/shot_lrf.h>
 
 namespace pcl
 {
@@ -57,6 +58,12 @@ namespace pcl
     *     In Proceedings of the 18th International Conference on Image Processing (ICIP),
     *     Brussels, Belgium, September 11-14 2011.
     *
+    * When no local reference frames are given through setInputReferenceFrames (), the frames are estimated with
+    * SHOTLocalReferenceFrameEstimation from the same radius search as the descriptor, so every keypoint is
+    * searched only once. compute (output, lrf_radius, lrf_cache) estimates them at their own radius, and a caller
+    * owned SHOTLocalReferenceFrameCache keeps them for further descriptor computations on the same cloud, e.g. at
+    * other descriptor radii with a fixed local reference frame radius.
+    *
     * \author Samuele Salti
     * \ingroup features
     */
@@ -76,6 +83,7 @@ namespace pcl
       using Feature<PointInT, PointOutT>::fake_surface_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
       using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
+      using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_never_defined_;
       using SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::descLength_;
       using SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::nr_grid_sector_;
       using SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::nr_shape_bins_;
@@ -86,6 +94,8 @@ namespace pcl
 
       typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
       typedef typename Feature<PointInT, PointOutT>::PointCloudIn PointCloudIn;
+      typedef typename FeatureWithLocalReferenceFrames<PointInT, PointRFT>::PointCloudLRF PointCloudLRF;
+      typedef typename FeatureWithLocalReferenceFrames<PointInT, PointRFT>::PointCloudLRFPtr PointCloudLRFPtr;
 
       /** \brief Empty constructor. */
       SHOTEstimationOMP (unsigned int nr_threads = - 1) : SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT> (), threads_ ()
@@ -104,6 +114,19 @@ namespace pcl
         threads_ = nr_threads;
       }
 
+      using Feature<PointInT, PointOutT>::compute;
+
+      /** \brief Estimate the SHOT descriptors like compute (output). Local reference frames that are not given through
+        * setInputReferenceFrames () are estimated at their own radius, the neighborhood being searched once with the
+        * larger of this radius and the descriptor radius.
+        * \param[out] output the resultant point cloud model dataset that contains the SHOT feature estimates
+        * \param[in] lrf_radius the local reference frame radius (0 uses the descriptor radius)
+        * \param[in,out] lrf_cache the cache of local reference frames, shared with other estimators working on the
+        * same cloud (NULL disables caching)
+        */
+      void
+      compute (PointCloudOut &output, double lrf_radius, SHOTLocalReferenceFrameCache<PointInT, PointRFT> *lrf_cache = NULL);
+
     protected:
 
       /** \brief Estimate the Signatures of Histograms of OrienTations (SHOT) descriptors at a set of points given by
@@ -114,6 +137,14 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output);
 
+      /** \brief Estimate the SHOT descriptors, and the local reference frames that were not given, at the indices.
+        * \param[out] output the resultant point cloud model dataset that contains the SHOT feature estimates
+        * \param[in] lrf_radius the local reference frame radius (0 uses the descriptor radius)
+        * \param[in,out] lrf_cache the cache of local reference frames (NULL disables caching)
+        */
+      void
+      computeDescriptors (PointCloudOut &output, double lrf_radius, SHOTLocalReferenceFrameCache<PointInT, PointRFT> *lrf_cache);
+
       /** \brief This method should get called before starting the actual computation. */
       bool
       initCompute ();
@@ -0,0 +1,560 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_IO_RANS_CODER_HPP_
+#define PCL_IO_RANS_CODER_HPP_
+
+#include <pcl/pcl/compression/entropy_rans_coder.h>
+#include <vector>
+#include <string.h>
+#include <algorithm>
+
+#if defined __SSE2__
+#include <emmintrin.h>
+#elif defined __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline void
+pcl::InterleavedRansCoder::computeHistogram (const uint8_t* input_arg, std::size_t len_arg)
+{
+  std::size_t i;
+
+  memset (subHistograms_, 0, sizeof (subHistograms_));
+
+  // four independent sub-histograms avoid serializing on repeated increments of the same counter
+  for (i = 0; i + 4 <= len_arg; i += 4)
+  {
+    ++subHistograms_[0][input_arg[i]];
+    ++subHistograms_[1][input_arg[i + 1]];
+    ++subHistograms_[2][input_arg[i + 2]];
+    ++subHistograms_[3][input_arg[i + 3]];
+  }
+  for (; i < len_arg; ++i)
+    ++subHistograms_[0][input_arg[i]];
+
+  // merge sub-histograms
+#if defined __SSE2__
+  for (i = 0; i < 256; i += 4)
+  {
+    __m128i sum = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (&subHistograms_[0][i]));
+    sum = _mm_add_epi32 (sum, _mm_loadu_si128 (reinterpret_cast<const __m128i*> (&subHistograms_[1][i])));
+    sum = _mm_add_epi32 (sum, _mm_loadu_si128 (reinterpret_cast<const __m128i*> (&subHistograms_[2][i])));
+    sum = _mm_add_epi32 (sum, _mm_loadu_si128 (reinterpret_cast<const __m128i*> (&subHistograms_[3][i])));
+    _mm_storeu_si128 (reinterpret_cast<__m128i*> (&histogram_[i]), sum);
+  }
+#elif defined __ARM_NEON__
+  for (i = 0; i < 256; i += 4)
+  {
+    uint32x4_t sum = vld1q_u32 (&subHistograms_[0][i]);
+    sum = vaddq_u32 (sum, vld1q_u32 (&subHistograms_[1][i]));
+    sum = vaddq_u32 (sum, vld1q_u32 (&subHistograms_[2][i]));
+    sum = vaddq_u32 (sum, vld1q_u32 (&subHistograms_[3][i]));
+    vst1q_u32 (&histogram_[i], sum);
+  }
+#else
+  for (i = 0; i < 256; ++i)
+    histogram_[i] = subHistograms_[0][i] + subHistograms_[1][i] + subHistograms_[2][i] + subHistograms_[3][i];
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline void
+pcl::InterleavedRansCoder::normalizeFrequencies (uint32_t total_arg)
+{
+  unsigned int s;
+  uint32_t sum = 0;
+  unsigned int mostFrequent = 0;
+
+  for (s = 0; s < 256; ++s)
+  {
+    if (histogram_[s])
+    {
+      uint32_t f = static_cast<uint32_t> ((static_cast<uint64_t> (histogram_[s]) * SCALE) / total_arg);
+      freq_[s] = f ? f : 1;
+      sum += freq_[s];
+      if (histogram_[s] > histogram_[mostFrequent])
+        mostFrequent = s;
+    }
+    else
+      freq_[s] = 0;
+  }
+
+  if (sum < static_cast<uint32_t> (SCALE))
+  {
+    // assign rounding loss to the most frequent symbol
+    freq_[mostFrequent] += SCALE - sum;
+  }
+  else
+  {
+    // rare symbols were rounded up to 1; take the excess from the largest frequencies
+    uint32_t excess = sum - SCALE;
+    while (excess)
+    {
+      unsigned int largest = 0;
+      for (s = 1; s < 256; ++s)
+        if (freq_[s] > freq_[largest])
+          largest = s;
+      uint32_t d = std::min (excess, freq_[largest] - 1);
+      freq_[largest] -= d;
+      excess -= d;
+    }
+  }
+
+  sum = 0;
+  for (s = 0; s < 256; ++s)
+  {
+    start_[s] = sum;
+    sum += freq_[s];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline std::size_t
+pcl::InterleavedRansCoder::encodeBlock (const uint8_t* input_arg, std::size_t len_arg, uint8_t* output_arg,
+                                        std::size_t bufferSize_arg)
+{
+  unsigned int s;
+  uint8_t* ptr = output_arg;
+
+  if (bufferSize_arg < BLOCK_HEADER_SIZE + 1)
+    return (0);
+
+  writeUInt32 (ptr, static_cast<uint32_t> (len_arg));
+  ptr += 4;
+
+  if (!len_arg)
+  {
+    *ptr++ = BLOCK_EMPTY;
+    return (ptr - output_arg);
+  }
+
+  computeHistogram (input_arg, len_arg);
+
+  unsigned int distinctSymbols = 0;
+  for (s = 0; s < 256; ++s)
+    distinctSymbols += histogram_[s] ? 1 : 0;
+
+  if (distinctSymbols == 1)
+  {
+    *ptr++ = BLOCK_SINGLE_SYMBOL;
+    *ptr++ = input_arg[0];
+    return (ptr - output_arg);
+  }
+
+  normalizeFrequencies (static_cast<uint32_t> (len_arg));
+
+  // serialize frequency table: presence bit mask followed by 16 bit frequencies of present symbols
+  if (bufferSize_arg < BLOCK_HEADER_SIZE + 32 + 2 * distinctSymbols + 4)
+    return (0);
+
+  *ptr++ = BLOCK_RANS;
+  memset (ptr, 0, 32);
+  for (s = 0; s < 256; ++s)
+    if (freq_[s])
+      ptr[s >> 3] = static_cast<uint8_t> (ptr[s >> 3] | (1 << (s & 7)));
+  ptr += 32;
+  for (s = 0; s < 256; ++s)
+    if (freq_[s])
+    {
+      *ptr++ = static_cast<uint8_t> (freq_[s]);
+      *ptr++ = static_cast<uint8_t> (freq_[s] >> 8);
+    }
+
+  uint8_t* payloadSizePtr = ptr;
+  ptr += 4;
+  const std::size_t headerSize = ptr - output_arg;
+
+  if (bufferSize_arg < headerSize + 2 * len_arg + 4 * STATE_COUNT)
+    return (0);
+
+  // precompute reciprocal encoder symbols
+  for (s = 0; s < 256; ++s)
+  {
+    if (!freq_[s])
+      continue;
+
+    EncoderSymbol& sym = encSymbols_[s];
+    const uint32_t f = freq_[s];
+    sym.xMax = ((RANS_L >> SCALE_BITS) << 8) * f;
+    sym.cmplFreq = static_cast<uint16_t> (SCALE - f);
+    if (f < 2)
+    {
+      sym.rcpFreq = ~0u;
+      sym.rcpShift = 0;
+      sym.bias = start_[s] + SCALE - 1;
+    }
+    else
+    {
+      uint32_t shift = 0;
+      while (f > (1u << shift))
+        shift++;
+      sym.rcpFreq = static_cast<uint32_t> (((static_cast<uint64_t> (1) << (shift + 31)) + f - 1) / f);
+      sym.rcpShift = static_cast<uint16_t> (shift - 1);
+      sym.bias = start_[s];
+    }
+  }
+
+  // rANS works in reverse: encode from the last symbol to the first, writing from the buffer end downwards
+  uint8_t* const payloadEnd = output_arg + bufferSize_arg;
+  uint8_t* wptr = payloadEnd;
+  uint32_t state0 = RANS_L, state1 = RANS_L, state2 = RANS_L, state3 = RANS_L;
+
+  // trailing symbols that do not fill all states
+  std::size_t i = len_arg & ~static_cast<std::size_t> (STATE_COUNT - 1);
+  if (i + 2 < len_arg)
+    encodeSymbol (state2, wptr, encSymbols_[input_arg[i + 2]]);
+  if (i + 1 < len_arg)
+    encodeSymbol (state1, wptr, encSymbols_[input_arg[i + 1]]);
+  if (i < len_arg)
+    encodeSymbol (state0, wptr, encSymbols_[input_arg[i]]);
+  while (i > 0)
+  {
+    i -= STATE_COUNT;
+    encodeSymbol (state3, wptr, encSymbols_[input_arg[i + 3]]);
+    encodeSymbol (state2, wptr, encSymbols_[input_arg[i + 2]]);
+    encodeSymbol (state1, wptr, encSymbols_[input_arg[i + 1]]);
+    encodeSymbol (state0, wptr, encSymbols_[input_arg[i]]);
+  }
+
+  // flush states so that the decoder reads state0 first
+  wptr -= 4; writeUInt32 (wptr, state3);
+  wptr -= 4; writeUInt32 (wptr, state2);
+  wptr -= 4; writeUInt32 (wptr, state1);
+  wptr -= 4; writeUInt32 (wptr, state0);
+
+  const std::size_t payloadSize = payloadEnd - wptr;
+  memmove (ptr, wptr, payloadSize);
+  writeUInt32 (payloadSizePtr, static_cast<uint32_t> (payloadSize));
+
+  return (headerSize + payloadSize);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline std::size_t
+pcl::InterleavedRansCoder::decodeBlock (const uint8_t* input_arg, std::size_t bufferSize_arg,
+                                        std::vector<char>& output_arg)
+{
+  unsigned int s;
+  const uint8_t* ptr = input_arg;
+  const uint8_t* const bufferEnd = input_arg + bufferSize_arg;
+
+  if (bufferSize_arg < BLOCK_HEADER_SIZE)
+    return (0);
+
+  const uint32_t len = readUInt32 (ptr);
+  ptr += 4;
+  const uint8_t mode = *ptr++;
+  if (len > MAX_SYMBOL_COUNT)
+    return (0);
+
+  if (mode == BLOCK_EMPTY)
+  {
+    output_arg.clear ();
+    return (ptr - input_arg);
+  }
+
+  if (mode == BLOCK_SINGLE_SYMBOL)
+  {
+    if (ptr >= bufferEnd)
+      return (0);
+    output_arg.assign (len, static_cast<char> (*ptr++));
+    return (ptr - input_arg);
+  }
+
+  if (mode != BLOCK_RANS || bufferEnd - ptr < 32)
+    return (0);
+
+  // read frequency table
+  const uint8_t* mask = ptr;
+  ptr += 32;
+  uint32_t sum = 0;
+  for (s = 0; s < 256; ++s)
+  {
+    freq_[s] = 0;
+    if (mask[s >> 3] & (1 << (s & 7)))
+    {
+      if (bufferEnd - ptr < 2)
+        return (0);
+      freq_[s] = static_cast<uint32_t> (ptr[0]) | (static_cast<uint32_t> (ptr[1]) << 8);
+      ptr += 2;
+    }
+    // a single symbol is coded as BLOCK_SINGLE_SYMBOL, it would carry no information here
+    if (freq_[s] >= static_cast<uint32_t> (SCALE))
+      return (0);
+    start_[s] = sum;
+    sum += freq_[s];
+  }
+  if (sum != static_cast<uint32_t> (SCALE) || bufferEnd - ptr < 4)
+    return (0);
+
+  // build slot lookup table
+  for (s = 0; s < 256; ++s)
+    if (freq_[s])
+      memset (&slotSymbol_[start_[s]], static_cast<int> (s), freq_[s]);
+
+  const uint32_t payloadSize = readUInt32 (ptr);
+  ptr += 4;
+  if (payloadSize < 4 * STATE_COUNT || static_cast<std::size_t> (bufferEnd - ptr) < payloadSize)
+    return (0);
+  // every symbol costs at least log2 (SCALE / (SCALE - 1)) > 1 / SCALE bits, which bounds the symbol count
+  if (static_cast<uint64_t> (len) > static_cast<uint64_t> (payloadSize) * 8 * SCALE)
+    return (0);
+
+  const uint8_t* const payloadEnd = ptr + payloadSize;
+  uint32_t state0 = readUInt32 (ptr);
+  uint32_t state1 = readUInt32 (ptr + 4);
+  uint32_t state2 = readUInt32 (ptr + 8);
+  uint32_t state3 = readUInt32 (ptr + 12);
+  ptr += 4 * STATE_COUNT;
+
+  output_arg.resize (len);
+  char* out = len ? &output_arg[0] : 0;
+
+  std::size_t i = 0;
+  for (; i + STATE_COUNT <= len; i += STATE_COUNT)
+  {
+    out[i] = static_cast<char> (decodeSymbol (state0, ptr, payloadEnd));
+    out[i + 1] = static_cast<char> (decodeSymbol (state1, ptr, payloadEnd));
+    out[i + 2] = static_cast<char> (decodeSymbol (state2, ptr, payloadEnd));
+    out[i + 3] = static_cast<char> (decodeSymbol (state3, ptr, payloadEnd));
+  }
+  // remaining symbols in encoding order
+  if (i < len)
+    out[i] = static_cast<char> (decodeSymbol (state0, ptr, payloadEnd));
+  if (i + 1 < len)
+    out[i + 1] = static_cast<char> (decodeSymbol (state1, ptr, payloadEnd));
+  if (i + 2 < len)
+    out[i + 2] = static_cast<char> (decodeSymbol (state2, ptr, payloadEnd));
+
+  return (payloadEnd - input_arg);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline unsigned long
+pcl::InterleavedRansCoder::encodeCharVectorToBuffer (const std::vector<char>& inputByteVector_arg,
+                                                     char* outputBuffer_arg, std::size_t bufferSize_arg)
+{
+  const uint8_t* input = inputByteVector_arg.empty () ? 0 :
+                         reinterpret_cast<const uint8_t*> (&inputByteVector_arg[0]);
+  return (static_cast<unsigned long> (encodeBlock (input, inputByteVector_arg.size (),
+                                                   reinterpret_cast<uint8_t*> (outputBuffer_arg), bufferSize_arg)));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline unsigned long
+pcl::InterleavedRansCoder::decodeBufferToCharVector (const char* inputBuffer_arg, std::size_t bufferSize_arg,
+                                                     std::vector<char>& outputByteVector_arg)
+{
+  return (static_cast<unsigned long> (decodeBlock (reinterpret_cast<const uint8_t*> (inputBuffer_arg),
+                                                   bufferSize_arg, outputByteVector_arg)));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline unsigned long
+pcl::InterleavedRansCoder::encodeIntVectorToBuffer (const std::vector<unsigned int>& inputIntVector_arg,
+                                                    char* outputBuffer_arg, std::size_t bufferSize_arg)
+{
+  const std::size_t len = inputIntVector_arg.size ();
+  std::size_t i;
+  unsigned int plane;
+
+  if (bufferSize_arg < BLOCK_HEADER_SIZE)
+    return (0);
+
+  // amount of significant byte planes
+  uint32_t orValue = 0;
+  for (i = 0; i < len; ++i)
+    orValue |= inputIntVector_arg[i];
+
+  unsigned int planeCount = 0;
+  while (planeCount < 4 && (orValue >> (8 * planeCount)))
+    ++planeCount;
+
+  uint8_t* out = reinterpret_cast<uint8_t*> (outputBuffer_arg);
+  writeUInt32 (out, static_cast<uint32_t> (len));
+  out[4] = static_cast<uint8_t> (planeCount);
+  std::size_t pos = BLOCK_HEADER_SIZE;
+
+  if (planeBuffer_.size () < len)
+    planeBuffer_.resize (len);
+  uint8_t* planeData = len ? reinterpret_cast<uint8_t*> (&planeBuffer_[0]) : 0;
+
+  for (plane = 0; plane < planeCount; ++plane)
+  {
+    const unsigned int shift = 8 * plane;
+    for (i = 0; i < len; ++i)
+      planeData[i] = static_cast<uint8_t> (inputIntVector_arg[i] >> shift);
+
+    std::size_t blockSize = encodeBlock (planeData, len, out + pos, bufferSize_arg - pos);
+    if (!blockSize)
+      return (0);
+    pos += blockSize;
+  }
+
+  return (static_cast<unsigned long> (pos));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline unsigned long
+pcl::InterleavedRansCoder::decodeBufferToIntVector (const char* inputBuffer_arg, std::size_t bufferSize_arg,
+                                                    std::vector<unsigned int>& outputIntVector_arg)
+{
+  std::size_t i;
+  unsigned int plane;
+
+  if (bufferSize_arg < BLOCK_HEADER_SIZE)
+    return (0);
+
+  const uint8_t* in = reinterpret_cast<const uint8_t*> (inputBuffer_arg);
+  const uint32_t len = readUInt32 (in);
+  const unsigned int planeCount = in[4];
+  std::size_t pos = BLOCK_HEADER_SIZE;
+
+  if (planeCount > 4 || len > MAX_SYMBOL_COUNT)
+    return (0);
+
+  outputIntVector_arg.resize (len);
+  std::fill (outputIntVector_arg.begin (), outputIntVector_arg.end (), 0u);
+
+  for (plane = 0; plane < planeCount; ++plane)
+  {
+    std::size_t blockSize = decodeBlock (in + pos, bufferSize_arg - pos, planeBuffer_);
+    if (!blockSize || planeBuffer_.size () != len)
+      return (0);
+    pos += blockSize;
+    if (!len)
+      continue;
+
+    const unsigned int shift = 8 * plane;
+    const uint8_t* planeData = reinterpret_cast<const uint8_t*> (&planeBuffer_[0]);
+    for (i = 0; i < len; ++i)
+      outputIntVector_arg[i] |= static_cast<unsigned int> (planeData[i]) << shift;
+  }
+
+  return (static_cast<unsigned long> (pos));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline unsigned long
+pcl::InterleavedRansCoder::encodeCharVectorToStream (const std::vector<char>& inputByteVector_arg,
+                                                     std::ostream& outputByteStream_arg)
+{
+  const std::size_t maxSize = 4 + getMaxEncodedCharVectorSize (inputByteVector_arg.size ());
+  if (streamBuffer_.size () < maxSize)
+    streamBuffer_.resize (maxSize);
+
+  // length prefix allows the decoder to fetch the whole block with a single read
+  uint32_t blockSize = static_cast<uint32_t> (encodeCharVectorToBuffer (inputByteVector_arg, &streamBuffer_[4],
+                                                                        streamBuffer_.size () - 4));
+  writeUInt32 (reinterpret_cast<uint8_t*> (&streamBuffer_[0]), blockSize);
+  outputByteStream_arg.write (&streamBuffer_[0], blockSize + 4);
+
+  return (static_cast<unsigned long> (blockSize + 4));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline unsigned long
+pcl::InterleavedRansCoder::decodeStreamToCharVector (std::istream& inputByteStream_arg,
+                                                     std::vector<char>& outputByteVector_arg)
+{
+  uint8_t sizeBytes[4];
+  inputByteStream_arg.read (reinterpret_cast<char*> (sizeBytes), 4);
+  if (!inputByteStream_arg)
+    return (0);
+  const uint32_t blockSize = readUInt32 (sizeBytes);
+  if (blockSize > getMaxEncodedCharVectorSize (MAX_SYMBOL_COUNT))
+    return (0);
+
+  if (streamBuffer_.size () < blockSize)
+    streamBuffer_.resize (blockSize);
+  if (blockSize)
+    inputByteStream_arg.read (&streamBuffer_[0], blockSize);
+  if (!inputByteStream_arg)
+    return (0);
+
+  if (!decodeBufferToCharVector (blockSize ? &streamBuffer_[0] : 0, blockSize, outputByteVector_arg))
+    return (0);
+
+  return (static_cast<unsigned long> (blockSize + 4));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline unsigned long
+pcl::InterleavedRansCoder::encodeIntVectorToStream (const std::vector<unsigned int>& inputIntVector_arg,
+                                                    std::ostream& outputByteStream_arg)
+{
+  const std::size_t maxSize = 4 + getMaxEncodedIntVectorSize (inputIntVector_arg.size ());
+  if (streamBuffer_.size () < maxSize)
+    streamBuffer_.resize (maxSize);
+
+  uint32_t blockSize = static_cast<uint32_t> (encodeIntVectorToBuffer (inputIntVector_arg, &streamBuffer_[4],
+                                                                       streamBuffer_.size () - 4));
+  writeUInt32 (reinterpret_cast<uint8_t*> (&streamBuffer_[0]), blockSize);
+  outputByteStream_arg.write (&streamBuffer_[0], blockSize + 4);
+
+  return (static_cast<unsigned long> (blockSize + 4));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline unsigned long
+pcl::InterleavedRansCoder::decodeStreamToIntVector (std::istream& inputByteStream_arg,
+                                                    std::vector<unsigned int>& outputIntVector_arg)
+{
+  uint8_t sizeBytes[4];
+  inputByteStream_arg.read (reinterpret_cast<char*> (sizeBytes), 4);
+  if (!inputByteStream_arg)
+    return (0);
+  const uint32_t blockSize = readUInt32 (sizeBytes);
+  if (blockSize > getMaxEncodedIntVectorSize (MAX_SYMBOL_COUNT))
+    return (0);
+
+  if (streamBuffer_.size () < blockSize)
+    streamBuffer_.resize (blockSize);
+  if (blockSize)
+    inputByteStream_arg.read (&streamBuffer_[0], blockSize);
+  if (!inputByteStream_arg)
+    return (0);
+
+  if (!decodeBufferToIntVector (blockSize ? &streamBuffer_[0] : 0, blockSize, outputIntVector_arg))
+    return (0);
+
+  return (static_cast<unsigned long> (blockSize + 4));
+}
+
+#endif
@@ -40,6 +40,8 @@
 
 #include <pcl/pcl/octree/octree_pointcloud.h>
 #include <pcl/pcl/compression/entropy_range_coder.h>
+#include <pcl/pcl/compression/entropy_rans_coder.h>
+#include <pcl/pcl/io/impl/entropy_rans_coder.hpp>
 
 #include <iterator>
 #include <iostream>
@@ -176,8 +178,8 @@ namespace pcl
         PointCloudPtr &cloud_arg)
     {
 
-      // synchronize to frame header
-      syncToHeader(compressedTreeDataIn_arg);
+      // synchronize to frame header and detect the entropy coding backend of the frame
+      const entropyCoding_Method_e frameCodingMethod = syncToHeader (compressedTreeDataIn_arg);
 
       // initialize octree
       this->switchBuffers ();
@@ -200,7 +202,19 @@ namespace pcl
       this->readFrameHeader (compressedTreeDataIn_arg);
 
       // decode data vectors from stream
-      this->entropyDecoding (compressedTreeDataIn_arg);
+      if (frameCodingMethod == INTERLEAVED_RANS_CODING)
+      {
+        if (!this->ransEntropyDecoding (compressedTreeDataIn_arg))
+        {
+          PCL_ERROR ("[pcl::octree::PointCloudCompression::decodePointCloud] Dropping corrupt frame %d.\n", frameID_);
+          output_->points.clear ();
+          output_->width = 0;
+          output_->height = 1;
+          return;
+        }
+      }
+      else
+        this->entropyDecoding (compressedTreeDataIn_arg);
 
       // initialize color and point encoding
       colorCoder_.initializeDecoding ();
@@ -250,6 +264,12 @@ namespace pcl
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     PointCloudCompression<PointT, LeafT, BranchT, OctreeT>::entropyEncoding (std::ostream& compressedTreeDataOut_arg)
     {
+      if (getEntropyCodingMethod () == INTERLEAVED_RANS_CODING)
+      {
+        ransEntropyEncoding (compressedTreeDataOut_arg);
+        return;
+      }
+
       uint64_t binaryTreeDataVector_size;
       uint64_t pointAvgColorDataVector_size;
 
@@ -363,12 +383,171 @@ namespace pcl
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    PointCloudCompression<PointT, LeafT, BranchT, OctreeT>::ransEntropyEncoding (std::ostream& compressedTreeDataOut_arg)
+    {
+      std::vector<char>& pointAvgColorDataVector = colorCoder_.getAverageDataVector ();
+      std::vector<char>& pointDiffDataVector = pointCoder_.getDifferentialDataVector ();
+      std::vector<char>& pointDiffColorDataVector = colorCoder_.getDifferentialDataVector ();
+      InterleavedRansCoder ransEntropyCoder;
+      std::vector<char> ransFrameBuffer;
+      std::size_t bufferPos;
+      uint64_t frameBufferSize;
+
+      compressedPointDataLen_ = 0;
+      compressedColorDataLen_ = 0;
+
+      // reserve worst case frame size
+      std::size_t maxFrameSize = InterleavedRansCoder::getMaxEncodedCharVectorSize (binaryTreeDataVector_.size ());
+      if (cloudWithColor_)
+        maxFrameSize += InterleavedRansCoder::getMaxEncodedCharVectorSize (pointAvgColorDataVector.size ());
+      if (!doVoxelGridEnDecoding_)
+      {
+        maxFrameSize += InterleavedRansCoder::getMaxEncodedIntVectorSize (pointCountDataVector_.size ());
+        maxFrameSize += InterleavedRansCoder::getMaxEncodedCharVectorSize (pointDiffDataVector.size ());
+        if (cloudWithColor_)
+          maxFrameSize += InterleavedRansCoder::getMaxEncodedCharVectorSize (pointDiffColorDataVector.size ());
+      }
+      ransFrameBuffer.resize (maxFrameSize);
+
+      char* frameBuffer = &ransFrameBuffer[0];
+      std::size_t frameBufferCapacity = ransFrameBuffer.size ();
+      unsigned long blockSize;
+
+      // encode binary octree structure
+      blockSize = ransEntropyCoder.encodeCharVectorToBuffer (binaryTreeDataVector_, frameBuffer, frameBufferCapacity);
+      compressedPointDataLen_ += blockSize;
+      bufferPos = blockSize;
+
+      if (cloudWithColor_)
+      {
+        // encode averaged voxel color information
+        blockSize = ransEntropyCoder.encodeCharVectorToBuffer (pointAvgColorDataVector, frameBuffer + bufferPos,
+                                                               frameBufferCapacity - bufferPos);
+        compressedColorDataLen_ += blockSize;
+        bufferPos += blockSize;
+      }
+
+      if (!doVoxelGridEnDecoding_)
+      {
+        // encode amount of points per voxel
+        blockSize = ransEntropyCoder.encodeIntVectorToBuffer (pointCountDataVector_, frameBuffer + bufferPos,
+                                                              frameBufferCapacity - bufferPos);
+        compressedPointDataLen_ += blockSize;
+        bufferPos += blockSize;
+
+        // encode differential point information
+        blockSize = ransEntropyCoder.encodeCharVectorToBuffer (pointDiffDataVector, frameBuffer + bufferPos,
+                                                               frameBufferCapacity - bufferPos);
+        compressedPointDataLen_ += blockSize;
+        bufferPos += blockSize;
+
+        if (cloudWithColor_)
+        {
+          // encode differential color information
+          blockSize = ransEntropyCoder.encodeCharVectorToBuffer (pointDiffColorDataVector, frameBuffer + bufferPos,
+                                                                 frameBufferCapacity - bufferPos);
+          compressedColorDataLen_ += blockSize;
+          bufferPos += blockSize;
+        }
+      }
+
+      // write coded frame with a single stream operation
+      frameBufferSize = bufferPos;
+      compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&frameBufferSize), sizeof (frameBufferSize));
+      compressedTreeDataOut_arg.write (frameBuffer, bufferPos);
+
+      // flush output stream
+      compressedTreeDataOut_arg.flush ();
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> bool
+    PointCloudCompression<PointT, LeafT, BranchT, OctreeT>::ransEntropyDecoding (std::istream& compressedTreeDataIn_arg)
+    {
+      InterleavedRansCoder ransEntropyCoder;
+      std::vector<char> ransFrameBuffer;
+      uint64_t frameBufferSize;
+      std::size_t bufferPos;
+      unsigned long blockSize;
+
+      compressedPointDataLen_ = 0;
+      compressedColorDataLen_ = 0;
+
+      // read coded frame with a single stream operation
+      compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&frameBufferSize), sizeof (frameBufferSize));
+      // a frame holds at most two char blocks and one int block per point and color stream
+      const uint64_t maxFrameBufferSize = 4 * static_cast<uint64_t> (InterleavedRansCoder::getMaxEncodedCharVectorSize (InterleavedRansCoder::MAX_SYMBOL_COUNT))
+                                        + static_cast<uint64_t> (InterleavedRansCoder::getMaxEncodedIntVectorSize (InterleavedRansCoder::MAX_SYMBOL_COUNT));
+      if (!compressedTreeDataIn_arg || frameBufferSize > maxFrameBufferSize)
+        return (false);
+      ransFrameBuffer.resize (static_cast<std::size_t> (frameBufferSize + 1));
+      compressedTreeDataIn_arg.read (&ransFrameBuffer[0], static_cast<std::streamsize> (frameBufferSize));
+      if (!compressedTreeDataIn_arg)
+        return (false);
+
+      const char* frameBuffer = &ransFrameBuffer[0];
+      const std::size_t frameSize = static_cast<std::size_t> (frameBufferSize);
+
+      // decode binary octree structure
+      blockSize = ransEntropyCoder.decodeBufferToCharVector (frameBuffer, frameSize, binaryTreeDataVector_);
+      if (!blockSize)
+        return (false);
+      compressedPointDataLen_ += blockSize;
+      bufferPos = blockSize;
+
+      if (dataWithColor_)
+      {
+        // decode averaged voxel color information
+        blockSize = ransEntropyCoder.decodeBufferToCharVector (frameBuffer + bufferPos, frameSize - bufferPos,
+                                                               colorCoder_.getAverageDataVector ());
+        if (!blockSize)
+          return (false);
+        compressedColorDataLen_ += blockSize;
+        bufferPos += blockSize;
+      }
+
+      if (!doVoxelGridEnDecoding_)
+      {
+        // decode amount of points per voxel
+        blockSize = ransEntropyCoder.decodeBufferToIntVector (frameBuffer + bufferPos, frameSize - bufferPos,
+                                                              pointCountDataVector_);
+        if (!blockSize)
+          return (false);
+        compressedPointDataLen_ += blockSize;
+        bufferPos += blockSize;
+        pointCountDataVectorIterator_ = pointCountDataVector_.begin ();
+
+        // decode differential point information
+        blockSize = ransEntropyCoder.decodeBufferToCharVector (frameBuffer + bufferPos, frameSize - bufferPos,
+                                                               pointCoder_.getDifferentialDataVector ());
+        if (!blockSize)
+          return (false);
+        compressedPointDataLen_ += blockSize;
+        bufferPos += blockSize;
+
+        if (dataWithColor_)
+        {
+          // decode differential color information
+          blockSize = ransEntropyCoder.decodeBufferToCharVector (frameBuffer + bufferPos, frameSize - bufferPos,
+                                                                 colorCoder_.getDifferentialDataVector ());
+          if (!blockSize)
+            return (false);
+          compressedColorDataLen_ += blockSize;
+        }
+      }
+      return (true);
+    }
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     PointCloudCompression<PointT, LeafT, BranchT, OctreeT>::writeFrameHeader (std::ostream& compressedTreeDataOut_arg)
     {
-      // encode header identifier
-      compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (frameHeaderIdentifier_), strlen (frameHeaderIdentifier_));
+      // encode header identifier; rANS coded frames use their own identifier
+      const char* headerIdentifier = (getEntropyCodingMethod () == INTERLEAVED_RANS_CODING) ? ransFrameHeaderIdentifier_
+                                                                                           : frameHeaderIdentifier_;
+      compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (headerIdentifier), strlen (headerIdentifier));
       // encode point cloud header id
       compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&frameID_), sizeof (frameID_));
       // encode frame type (I/P-frame)
@@ -411,18 +590,22 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> entropyCoding_Method_e
     PointCloudCompression<PointT, LeafT, BranchT, OctreeT>::syncToHeader ( std::istream& compressedTreeDataIn_arg)
     {
-      // sync to frame header
+      // sync to frame header of either entropy coding backend
       unsigned int headerIdPos = 0;
-      while (headerIdPos < strlen (frameHeaderIdentifier_))
+      unsigned int ransHeaderIdPos = 0;
+      while ((headerIdPos < strlen (frameHeaderIdentifier_)) && (ransHeaderIdPos < strlen (ransFrameHeaderIdentifier_)))
       {
         char readChar;
         compressedTreeDataIn_arg.read (static_cast<char*> (&readChar), sizeof (readChar));
         if (readChar != frameHeaderIdentifier_[headerIdPos++])
           headerIdPos = (frameHeaderIdentifier_[0]==readChar)?1:0;
+        if (readChar != ransFrameHeaderIdentifier_[ransHeaderIdPos++])
+          ransHeaderIdPos = (ransFrameHeaderIdentifier_[0]==readChar)?1:0;
       }
+      return ((headerIdPos < strlen (frameHeaderIdentifier_)) ? INTERLEAVED_RANS_CODING : STATIC_RANGE_CODING);
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
@@ -45,6 +45,9 @@ namespace pcl
   /** \brief HarrisKeypoint3D uses the idea of 2D Harris keypoints, but instead of using image gradients, it uses
     * surface normals.
     *
+    * The neighborhood of every point is searched once and shared by the response computation and the non maxima
+    * suppression, both of which run in parallel (see setNumberOfThreads ()).
+    *
     * \author Suat Gedikli
     * \ingroup keypoints
     */
@@ -138,15 +141,20 @@ namespace pcl
       bool
       initCompute ();
       void detectKeypoints (PointCloudOut &output);
-      /** \brief gets the corner response for valid input points*/
-      void responseHarris (PointCloudOut &output) const;
-      void responseNoble (PointCloudOut &output) const;
-      void responseLowe (PointCloudOut &output) const;
-      void responseTomasi (PointCloudOut &output) const;
+      /** \brief gets the corner response for valid input points, the neighborhood of input point i is given by
+        * neighbor_indices[neighbor_offsets[i]..neighbor_offsets[i+1]).*/
+      void responseHarris (PointCloudOut &output, const std::vector<int>& neighbor_offsets, const std::vector<int>& neighbor_indices) const;
+      void responseNoble (PointCloudOut &output, const std::vector<int>& neighbor_offsets, const std::vector<int>& neighbor_indices) const;
+      void responseLowe (PointCloudOut &output, const std::vector<int>& neighbor_offsets, const std::vector<int>& neighbor_indices) const;
+      void responseTomasi (PointCloudOut &output, const std::vector<int>& neighbor_offsets, const std::vector<int>& neighbor_indices) const;
       void responseCurvature (PointCloudOut &output) const;
       void refineCorners (PointCloudOut &corners) const;
+      /** \brief searches the neighborhoods of all input points within the search radius, in parallel.*/
+      void computeNeighborhoods (std::vector<int>& neighbor_offsets, std::vector<int>& neighbor_indices) const;
       /** \brief calculates the upper triangular part of unnormalized covariance matrix over the normals given by the indices.*/
       void calculateNormalCovar (const std::vector<int>& neighbors, float* coefficients) const;
+      /** \brief calculates the upper triangular part of unnormalized covariance matrix over the normals given by the indices in [begin, end).*/
+      void calculateNormalCovar (std::vector<int>::const_iterator begin, std::vector<int>::const_iterator end, float* coefficients) const;
     private:
       float threshold_;
       bool refine_;
@@ -43,6 +43,7 @@
 #include <pcl/pcl/filters/passthrough.h>
 #include <pcl/pcl/filters/extract_indices.h>
 #include <pcl/pcl/features/normal_3d.h>
+#include <pcl/pcl/features/normal_3d_omp.h>
 #include <pcl/pcl/features/integral_image_normal.h>
 #include <pcl/pcl/common/time.h>
 #include <pcl/pcl/common/centroid.h>
@@ -95,6 +96,14 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::setNormals (boost::shared_p
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::calculateNormalCovar (const std::vector<int>& neighbors, float* coefficients) const
+{
+  calculateNormalCovar (neighbors.begin (), neighbors.end (), coefficients);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename NormalT> void
+pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::calculateNormalCovar (
+    std::vector<int>::const_iterator begin, std::vector<int>::const_iterator end, float* coefficients) const
 {
   unsigned count = 0;
   // indices        0   1   2   3   4   5   6   7
@@ -111,7 +120,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::calculateNormalCovar (const
 
   float zz = 0;
 
-  for (std::vector<int>::const_iterator iIt = neighbors.begin(); iIt != neighbors.end(); ++iIt)
+  for (std::vector<int>::const_iterator iIt = begin; iIt != end; ++iIt)
   {
     if (pcl_isfinite (normals_->points[*iIt].normal_x))
     {
@@ -153,7 +162,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::calculateNormalCovar (const
     memset (coefficients, 0, sizeof (float) * 8);
 #else
   memset (coefficients, 0, sizeof (float) * 8);
-  for (std::vector<int>::const_iterator iIt = neighbors.begin(); iIt != neighbors.end(); ++iIt)
+  for (std::vector<int>::const_iterator iIt = begin; iIt != end; ++iIt)
   {
     if (pcl_isfinite (normals_->points[*iIt].normal_x))
     {
@@ -202,7 +211,8 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::initCompute ()
     normals_->reserve (surface_->size ());
     if (input_->height == 1 ) // not organized
     {
-      pcl::NormalEstimation<PointInT, NormalT> normal_estimation;
+      pcl::NormalEstimationOMP<PointInT, NormalT> normal_estimation;
+      normal_estimation.setNumberOfThreads (threads_);
       normal_estimation.setInputCloud(surface_);
       normal_estimation.setRadiusSearch(search_radius_);
       normal_estimation.compute (*normals_);
@@ -227,22 +237,27 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 
   response->points.reserve (input_->points.size());
 
+  // search the neighborhoods once, they are shared by the response and the non maxima suppression
+  std::vector<int> neighbor_offsets, neighbor_indices;
+  if (method_ != CURVATURE || nonmax_)
+    computeNeighborhoods (neighbor_offsets, neighbor_indices);
+
   switch (method_)
   {
     case HARRIS:
-      responseHarris(*response);
+      responseHarris(*response, neighbor_offsets, neighbor_indices);
       break;
     case NOBLE:
-      responseNoble(*response);
+      responseNoble(*response, neighbor_offsets, neighbor_indices);
       break;
     case LOWE:
-      responseLowe(*response);
+      responseLowe(*response, neighbor_offsets, neighbor_indices);
       break;
     case CURVATURE:
       responseCurvature(*response);
       break;
     case TOMASI:
-      responseTomasi(*response);
+      responseTomasi(*response, neighbor_offsets, neighbor_indices);
       break;
   }
 
@@ -253,31 +268,29 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
     output.points.clear ();
     output.points.reserve (response->points.size());
 
+    // flag the maxima in parallel, then collect them in point order
+    std::vector<unsigned char> is_maxima (response->points.size (), 0);
 #if defined (HAVE_OPENMP) && (defined(_WIN32) || ((__GNUC__ > 4) && (__GNUC_MINOR__ > 2)))
-#pragma omp parallel for shared (output) num_threads(threads_)   
+#pragma omp parallel for schedule(dynamic, 256) num_threads(threads_)
 #endif
     for (int idx = 0; idx < static_cast<int> (response->points.size ()); ++idx)
     {
       if (!isFinite (response->points[idx]) || response->points[idx].intensity < threshold_)
         continue;
-		  std::vector<int> nn_indices;
-		  std::vector<float> nn_dists;
-      tree_->radiusSearch (idx, search_radius_, nn_indices, nn_dists);
-      bool is_maxima = true;
-      for (std::vector<int>::const_iterator iIt = nn_indices.begin(); iIt != nn_indices.end(); ++iIt)
+      is_maxima[idx] = 1;
+      for (std::vector<int>::const_iterator iIt = neighbor_indices.begin () + neighbor_offsets[idx];
+           iIt != neighbor_indices.begin () + neighbor_offsets[idx + 1]; ++iIt)
       {
         if (response->points[idx].intensity < response->points[*iIt].intensity)
         {
-          is_maxima = false;
+          is_maxima[idx] = 0;
           break;
         }
       }
-      if (is_maxima)
-#if defined (HAVE_OPENMP) && (defined(_WIN32) || ((__GNUC__ > 4) && (__GNUC_MINOR__ > 2)))        
-#pragma omp critical
-#endif
-        output.points.push_back (response->points[idx]);
     }
+    for (size_t idx = 0; idx < response->points.size (); ++idx)
+      if (is_maxima[idx])
+        output.points.push_back (response->points[idx]);
 
     if (refine_)
       refineCorners (output);
@@ -292,12 +305,58 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT, typename NormalT> void
-pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseHarris (PointCloudOut &output) const
+pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::computeNeighborhoods (std::vector<int>& neighbor_offsets, std::vector<int>& neighbor_indices) const
+{
+  // the points are split into one contiguous block per thread, the blocks are concatenated in order afterwards
+  const int nr_points = static_cast<int> (input_->size ());
+  const int nr_blocks = (std::max) (threads_, 1);
+  std::vector<std::vector<int> > block_indices (nr_blocks);
+  neighbor_offsets.resize (nr_points + 1);
+  neighbor_offsets[0] = 0;
+
+#if defined (HAVE_OPENMP) && (defined(_WIN32) || ((__GNUC__ > 4) && (__GNUC_MINOR__ > 2)))
+#pragma omp parallel for schedule(static, 1) num_threads(threads_)
+#endif
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    std::vector<int> nn_indices;
+    std::vector<float> nn_dists;
+    const int end = static_cast<int> (static_cast<int64_t> (nr_points) * (block + 1) / nr_blocks);
+    for (int pIdx = static_cast<int> (static_cast<int64_t> (nr_points) * block / nr_blocks); pIdx < end; ++pIdx)
+    {
+      // the offsets hold the neighborhood sizes until the blocks are concatenated
+      neighbor_offsets[pIdx + 1] = 0;
+      if (!isFinite (input_->points[pIdx]))
+        continue;
+      tree_->radiusSearch (input_->points[pIdx], search_radius_, nn_indices, nn_dists);
+      block_indices[block].insert (block_indices[block].end (), nn_indices.begin (), nn_indices.end ());
+      neighbor_offsets[pIdx + 1] = static_cast<int> (nn_indices.size ());
+    }
+  }
+
+  for (int pIdx = 0; pIdx < nr_points; ++pIdx)
+    neighbor_offsets[pIdx + 1] += neighbor_offsets[pIdx];
+
+  neighbor_indices.resize (neighbor_offsets[nr_points]);
+#if defined (HAVE_OPENMP) && (defined(_WIN32) || ((__GNUC__ > 4) && (__GNUC_MINOR__ > 2)))
+#pragma omp parallel for schedule(static, 1) num_threads(threads_)
+#endif
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    const int begin = static_cast<int> (static_cast<int64_t> (nr_points) * block / nr_blocks);
+    std::copy (block_indices[block].begin (), block_indices[block].end (), neighbor_indices.begin () + neighbor_offsets[begin]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename NormalT> void
+pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseHarris (PointCloudOut &output, const std::vector<int>& neighbor_offsets,
+                                                                     const std::vector<int>& neighbor_indices) const
 {
   PCL_ALIGN (16) float covar [8];
   output.resize (input_->size ());
 #if defined (HAVE_OPENMP) && (defined(_WIN32) || ((__GNUC__ > 4) && (__GNUC_MINOR__ > 2)))
-  #pragma omp parallel for shared (output) private (covar) num_threads(threads_)
+#pragma omp parallel for schedule(dynamic, 256) shared (output) private (covar) num_threads(threads_)
 #endif
   for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
   {
@@ -305,10 +364,8 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseHarris (PointCloudO
     output [pIdx].intensity = 0.0; //std::numeric_limits<float>::quiet_NaN ();
     if (isFinite (pointIn))
     {
-			std::vector<int> nn_indices;
-			std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateNormalCovar (nn_indices, covar);
+      calculateNormalCovar (neighbor_indices.begin () + neighbor_offsets[pIdx],
+                            neighbor_indices.begin () + neighbor_offsets[pIdx + 1], covar);
 
       float trace = covar [0] + covar [5] + covar [7];
       if (trace != 0)
@@ -331,12 +388,13 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseHarris (PointCloudO
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT, typename NormalT> void
-pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseNoble (PointCloudOut &output) const
+pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseNoble (PointCloudOut &output, const std::vector<int>& neighbor_offsets,
+                                                                    const std::vector<int>& neighbor_indices) const
 {
   PCL_ALIGN (16) float covar [8];
   output.resize (input_->size ());
 #if defined (HAVE_OPENMP) && (defined(_WIN32) || ((__GNUC__ > 4) && (__GNUC_MINOR__ > 2)))
-  #pragma omp parallel for shared (output) private (covar) num_threads(threads_)
+#pragma omp parallel for schedule(dynamic, 256) shared (output) private (covar) num_threads(threads_)
 #endif
   for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
   {
@@ -344,10 +402,8 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseNoble (PointCloudOu
     output [pIdx].intensity = 0.0;
     if (isFinite (pointIn))
     {
-			std::vector<int> nn_indices;
-			std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateNormalCovar (nn_indices, covar);
+      calculateNormalCovar (neighbor_indices.begin () + neighbor_offsets[pIdx],
+                            neighbor_indices.begin () + neighbor_offsets[pIdx + 1], covar);
       float trace = covar [0] + covar [5] + covar [7];
       if (trace != 0)
       {
@@ -369,12 +425,13 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseNoble (PointCloudOu
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT, typename NormalT> void
-pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseLowe (PointCloudOut &output) const
+pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseLowe (PointCloudOut &output, const std::vector<int>& neighbor_offsets,
+                                                                   const std::vector<int>& neighbor_indices) const
 {
   PCL_ALIGN (16) float covar [8];
   output.resize (input_->size ());
 #if defined (HAVE_OPENMP) && (defined(_WIN32) || ((__GNUC__ > 4) && (__GNUC_MINOR__ > 2)))
-  #pragma omp parallel for shared (output) private (covar) num_threads(threads_)
+#pragma omp parallel for schedule(dynamic, 256) shared (output) private (covar) num_threads(threads_)
 #endif
   for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
   {
@@ -382,10 +439,8 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseLowe (PointCloudOut
     output [pIdx].intensity = 0.0;
     if (isFinite (pointIn))
     {
-			std::vector<int> nn_indices;
-			std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateNormalCovar (nn_indices, covar);
+      calculateNormalCovar (neighbor_indices.begin () + neighbor_offsets[pIdx],
+                            neighbor_indices.begin () + neighbor_offsets[pIdx + 1], covar);
       float trace = covar [0] + covar [5] + covar [7];
       if (trace != 0)
       {
@@ -425,13 +480,14 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseCurvature (PointClo
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT, typename NormalT> void
-pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudOut &output) const
+pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudOut &output, const std::vector<int>& neighbor_offsets,
+                                                                     const std::vector<int>& neighbor_indices) const
 {
   PCL_ALIGN (16) float covar [8];
   Eigen::Matrix3f covariance_matrix;
   output.resize (input_->size ());
 #if defined (HAVE_OPENMP) && (defined(_WIN32) || ((__GNUC__ > 4) && (__GNUC_MINOR__ > 2)))
-  #pragma omp parallel for shared (output) private (covar, covariance_matrix) num_threads(threads_)
+#pragma omp parallel for schedule(dynamic, 256) shared (output) private (covar, covariance_matrix) num_threads(threads_)
 #endif
   for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
   {
@@ -439,10 +495,8 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudO
     output [pIdx].intensity = 0.0;
     if (isFinite (pointIn))
     {
-			std::vector<int> nn_indices;
-			std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateNormalCovar (nn_indices, covar);
+      calculateNormalCovar (neighbor_indices.begin () + neighbor_offsets[pIdx],
+                            neighbor_indices.begin () + neighbor_offsets[pIdx + 1], covar);
       float trace = covar [0] + covar [5] + covar [7];
       if (trace != 0)
       {
@@ -477,7 +531,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::refineCorners (PointCloudOu
   float diff;
   const unsigned max_iterations = 10;
 #if defined (HAVE_OPENMP) && (defined(_WIN32) || ((__GNUC__ > 4) && (__GNUC_MINOR__ > 2)))
-  #pragma omp parallel for shared (corners) private (nnT, NNT, NNTInv, NNTp, diff) num_threads(threads_)
+#pragma omp parallel for shared (corners) private (nnT, NNT, NNTInv, NNTp, diff) num_threads(threads_)
 #endif
   for (int cIdx = 0; cIdx < static_cast<int> (corners.size ()); ++cIdx)
   {
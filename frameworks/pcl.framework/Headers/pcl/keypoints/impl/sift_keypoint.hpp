@@ -40,7 +40,7 @@
 
 #include <pcl/pcl/keypoints/sift_keypoint.h>
 #include <pcl/pcl/common/io.h>
-#include <pcl/pcl/filters/voxel_grid.h>
+#include <algorithm>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void 
@@ -93,9 +93,36 @@ pcl::SIFTKeypoint<PointInT, PointOutT>::initCompute ()
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::SIFTKeypoint<PointInT, PointOutT>::compute (PointCloudOut &output, unsigned int nr_threads)
+{
+  if (!initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::compute] initCompute failed!\n", name_.c_str ());
+    return;
+  }
+
+  // Perform the actual computation
+  detectKeypoints (output, nr_threads == 0 ? 1 : nr_threads);
+
+  this->deinitCompute ();
+
+  // Reset the surface
+  if (input_ == surface_)
+    surface_.reset ();
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void 
 pcl::SIFTKeypoint<PointInT, PointOutT>::detectKeypoints (PointCloudOut &output)
+{
+  detectKeypoints (output, 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void 
+pcl::SIFTKeypoint<PointInT, PointOutT>::detectKeypoints (PointCloudOut &output, unsigned int nr_threads)
 {
   if (surface_ != input_)
   {
@@ -111,32 +138,44 @@ pcl::SIFTKeypoint<PointInT, PointOutT>::detectKeypoints (PointCloudOut &output)
   // Make sure the output cloud is empty
   output.points.clear ();
 
-  // Create a local copy of the input cloud that will be resized for each octave
-  boost::shared_ptr<pcl::PointCloud<PointInT> > cloud (new pcl::PointCloud<PointInT> (*input_));
+  // ---[ RGB special case
+  std::vector<sensor_msgs::PointField> fields;
+  int rgba_offset = pcl::getFieldIndex (*input_, "rgb", fields);
+  if (rgba_offset == -1)
+    rgba_offset = pcl::getFieldIndex (*input_, "rgba", fields);
+  if (rgba_offset >= 0)
+    rgba_offset = fields[rgba_offset].offset;
+
+  // The voxels of the previous and the current octave. Only the first octave is voxelized from the input cloud, the 
+  // following ones merge the voxels of their parent octave
+  detail::SIFTOctaveVoxels voxels[2];
 
-  VoxelGrid<PointInT> voxel_grid;
   // Search for keypoints at each octave
   float scale = min_scale_;
   for (int i_octave = 0; i_octave < nr_octaves_; ++i_octave)
   {
     // Downsample the point cloud
-    const float s = 1.0f * scale; // note: this can be adjusted
-    voxel_grid.setLeafSize (s, s, s);
-    voxel_grid.setInputCloud (cloud);
-    boost::shared_ptr<pcl::PointCloud<PointInT> > temp (new pcl::PointCloud<PointInT>);    
-    voxel_grid.filter (*temp);
-    cloud = temp;
+    detail::SIFTOctaveVoxels &octave_voxels = voxels[i_octave % 2];
+    if (i_octave == 0)
+    {
+      const float s = 1.0f * scale; // note: this can be adjusted
+      voxelizeInput (s, rgba_offset, octave_voxels);
+    }
+    else
+      mergeVoxels (voxels[(i_octave - 1) % 2], octave_voxels);
+    boost::shared_ptr<pcl::PointCloud<PointInT> > cloud (new pcl::PointCloud<PointInT>);
+    computeVoxelCentroids (octave_voxels, rgba_offset, *cloud);
 
     // Make sure the downsampled cloud still has enough points
     const size_t min_nr_points = 25;
     if (cloud->points.size () < min_nr_points)
       break;
 
-    // Update the KdTree with the downsampled points
+    // Update the KdTree with the downsampled points, it serves the searches of all the scales of the octave
     tree_->setInputCloud (cloud);
 
     // Detect keypoints for the current scale
-    detectKeypointsForOctave (*cloud, *tree_, scale, nr_scales_per_octave_, output);
+    detectKeypointsForOctave (*cloud, *tree_, scale, nr_scales_per_octave_, output, nr_threads);
 
     // Increase the scale by another octave
     scale *= 2;
@@ -147,11 +186,144 @@ pcl::SIFTKeypoint<PointInT, PointOutT>::detectKeypoints (PointCloudOut &output)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void 
+pcl::SIFTKeypoint<PointInT, PointOutT>::voxelizeInput (float leaf_size, int rgba_offset, detail::SIFTOctaveVoxels &voxels)
+{
+  typedef typename pcl::traits::fieldList<PointInT>::type FieldList;
+
+  const float inverse_leaf_size = 1.0f / leaf_size;
+
+  // Sort the finite points by grid cell, points of the same cell keep their order
+  std::vector<detail::SIFTVoxelCell> point_cells;
+  point_cells.reserve (input_->points.size ());
+  for (int cp = 0; cp < static_cast<int> (input_->points.size ()); ++cp)
+  {
+    const PointInT &point = input_->points[cp];
+    if (!input_->is_dense)
+      // Check if the point is invalid
+      if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+        continue;
+
+    point_cells.push_back (detail::SIFTVoxelCell (static_cast<int> (floor (point.x * inverse_leaf_size)),
+                                      static_cast<int> (floor (point.y * inverse_leaf_size)),
+                                      static_cast<int> (floor (point.z * inverse_leaf_size)), cp));
+  }
+  std::sort (point_cells.begin (), point_cells.end ());
+
+  int nr_voxels = 0;
+  for (size_t i = 0; i < point_cells.size (); ++i)
+    if (i == 0 || !point_cells[i].sameCell (point_cells[i - 1]))
+      ++nr_voxels;
+
+  int centroid_size = boost::mpl::size<FieldList>::value;
+  if (rgba_offset >= 0)
+    centroid_size += 3;
+
+  voxels.cells.clear ();
+  voxels.cells.reserve (nr_voxels);
+  voxels.counts.assign (nr_voxels, 0);
+  voxels.sums.setZero (centroid_size, nr_voxels);
+
+  Eigen::VectorXf temporary = Eigen::VectorXf::Zero (centroid_size);
+  int voxel = -1;
+  for (size_t i = 0; i < point_cells.size (); ++i)
+  {
+    if (i == 0 || !point_cells[i].sameCell (point_cells[i - 1]))
+    {
+      voxels.cells.push_back (detail::SIFTVoxelCell (point_cells[i].x, point_cells[i].y, point_cells[i].z, ++voxel));
+    }
+
+    const PointInT &point = input_->points[point_cells[i].index];
+    // ---[ RGB special case
+    if (rgba_offset >= 0)
+    {
+      // Fill r/g/b data, assuming that the order is BGRA
+      pcl::RGB rgb;
+      memcpy (&rgb, reinterpret_cast<const char*> (&point) + rgba_offset, sizeof (RGB));
+      temporary[centroid_size-3] = rgb.r;
+      temporary[centroid_size-2] = rgb.g;
+      temporary[centroid_size-1] = rgb.b;
+    }
+    pcl::for_each_type<FieldList> (NdCopyPointEigenFunctor<PointInT> (point, temporary));
+    voxels.sums.col (voxel) += temporary;
+    ++voxels.counts[voxel];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void 
+pcl::SIFTKeypoint<PointInT, PointOutT>::mergeVoxels (const detail::SIFTOctaveVoxels &parent, detail::SIFTOctaveVoxels &voxels)
+{
+  // Halving the (floored) cell coordinates of the parent octave gives the cell of twice the size containing them
+  std::vector<detail::SIFTVoxelCell> parent_cells;
+  parent_cells.reserve (parent.cells.size ());
+  for (int i = 0; i < static_cast<int> (parent.cells.size ()); ++i)
+  {
+    const detail::SIFTVoxelCell &cell = parent.cells[i];
+    parent_cells.push_back (detail::SIFTVoxelCell (cell.x >= 0 ? cell.x / 2 : (cell.x - 1) / 2,
+                                       cell.y >= 0 ? cell.y / 2 : (cell.y - 1) / 2,
+                                       cell.z >= 0 ? cell.z / 2 : (cell.z - 1) / 2, i));
+  }
+  std::sort (parent_cells.begin (), parent_cells.end ());
+
+  int nr_voxels = 0;
+  for (size_t i = 0; i < parent_cells.size (); ++i)
+    if (i == 0 || !parent_cells[i].sameCell (parent_cells[i - 1]))
+      ++nr_voxels;
+
+  voxels.cells.clear ();
+  voxels.cells.reserve (nr_voxels);
+  voxels.counts.assign (nr_voxels, 0);
+  voxels.sums.setZero (parent.sums.rows (), nr_voxels);
+
+  int voxel = -1;
+  for (size_t i = 0; i < parent_cells.size (); ++i)
+  {
+    if (i == 0 || !parent_cells[i].sameCell (parent_cells[i - 1]))
+    {
+      voxels.cells.push_back (detail::SIFTVoxelCell (parent_cells[i].x, parent_cells[i].y, parent_cells[i].z, ++voxel));
+    }
+    voxels.sums.col (voxel) += parent.sums.col (parent_cells[i].index);
+    voxels.counts[voxel] += parent.counts[parent_cells[i].index];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void 
+pcl::SIFTKeypoint<PointInT, PointOutT>::computeVoxelCentroids (
+    const detail::SIFTOctaveVoxels &voxels, int rgba_offset, PointCloudIn &output)
+{
+  typedef typename pcl::traits::fieldList<PointInT>::type FieldList;
+
+  const int nr_voxels = static_cast<int> (voxels.counts.size ());
+  const int centroid_size = static_cast<int> (voxels.sums.rows ());
+  output.points.resize (nr_voxels);
+  output.width = static_cast<uint32_t> (nr_voxels);
+  output.height = 1;                    // downsampling breaks the organized structure
+  output.is_dense = true;               // we filter out invalid points
+
+  Eigen::VectorXf centroid (centroid_size);
+  for (int i = 0; i < nr_voxels; ++i)
+  {
+    centroid = voxels.sums.col (i) / static_cast<float> (voxels.counts[i]);
+    pcl::for_each_type<FieldList> (pcl::NdCopyEigenPointFunctor<PointInT> (centroid, output.points[i]));
+    // ---[ RGB special case
+    if (rgba_offset >= 0) 
+    {
+      // pack r/g/b into rgb
+      float r = centroid[centroid_size-3], g = centroid[centroid_size-2], b = centroid[centroid_size-1];
+      int rgb = (static_cast<int> (r) << 16) | (static_cast<int> (g) << 8) | static_cast<int> (b);
+      memcpy (reinterpret_cast<char*> (&output.points[i]) + rgba_offset, &rgb, sizeof (float));
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void 
 pcl::SIFTKeypoint<PointInT, PointOutT>::detectKeypointsForOctave (
     const PointCloudIn &input, KdTree &tree, float base_scale, int nr_scales_per_octave, 
-    PointCloudOut &output)
+    PointCloudOut &output, unsigned int nr_threads)
 {
   // Compute the difference of Gaussians (DoG) scale space
   std::vector<float> scales (nr_scales_per_octave + 3);
@@ -160,11 +332,11 @@ pcl::SIFTKeypoint<PointInT, PointOutT>::detectKeypointsForOctave (
     scales[i_scale] = base_scale * powf (2.0f, (1.0f * static_cast<float> (i_scale) - 1.0f) / static_cast<float> (nr_scales_per_octave));
   }
   Eigen::MatrixXf diff_of_gauss;
-  computeScaleSpace (input, tree, scales, diff_of_gauss);
+  computeScaleSpace (input, tree, scales, diff_of_gauss, nr_threads);
 
   // Find extrema in the DoG scale space
   std::vector<int> extrema_indices, extrema_scales;
-  findScaleSpaceExtrema (input, tree, diff_of_gauss, extrema_indices, extrema_scales);
+  findScaleSpaceExtrema (input, tree, diff_of_gauss, extrema_indices, extrema_scales, nr_threads);
 
   output.points.reserve (output.points.size () + extrema_indices.size ());
   // Save scale?
@@ -206,49 +378,66 @@ pcl::SIFTKeypoint<PointInT, PointOutT>::detectKeypointsForOctave (
 template <typename PointInT, typename PointOutT> 
 void pcl::SIFTKeypoint<PointInT, PointOutT>::computeScaleSpace (
     const PointCloudIn &input, KdTree &tree, const std::vector<float> &scales, 
-    Eigen::MatrixXf &diff_of_gauss)
+    Eigen::MatrixXf &diff_of_gauss, unsigned int nr_threads)
 {
   diff_of_gauss.resize (input.size (), scales.size () - 1);
 
   // For efficiency, we will only filter over points within 3 standard deviations 
   const float max_radius = 3.0f * scales.back ();
 
-  for (int i_point = 0; i_point < static_cast<int> (input.size ()); ++i_point)
+  std::vector<float> sigma_sqrs (scales.size ());
+  for (size_t i_scale = 0; i_scale < scales.size (); ++i_scale)
+    sigma_sqrs[i_scale] = powf (scales[i_scale], 2.0f);
+
+  // All the scales of a point share one neighborhood, so the points are processed in parallel, each of them 
+  // computing its whole scale space
+  const int nr_points = static_cast<int> (input.size ());
+#pragma omp parallel num_threads(nr_threads)
   {
     std::vector<int> nn_indices;
     std::vector<float> nn_dist;
-    tree.radiusSearch (i_point, max_radius, nn_indices, nn_dist); // *
-    // * note: at this stage of the algorithm, we must find all points within a radius defined by the maximum scale, 
-    //   regardless of the configurable search method specified by the user, so we directly employ tree.radiusSearch 
-    //   here instead of using searchForNeighbors.
-
-    // For each scale, compute the Gaussian "filter response" at the current point
-    float filter_response = 0.0f;
-    float previous_filter_response;
-    for (size_t i_scale = 0; i_scale < scales.size (); ++i_scale)
+    std::vector<float> nn_values;
+
+#pragma omp for schedule(dynamic, 64)
+    for (int i_point = 0; i_point < nr_points; ++i_point)
     {
-      float sigma_sqr = powf (scales[i_scale], 2.0f);
+      tree.radiusSearch (i_point, max_radius, nn_indices, nn_dist); // *
+      // * note: at this stage of the algorithm, we must find all points within a radius defined by the maximum scale, 
+      //   regardless of the configurable search method specified by the user, so we directly employ tree.radiusSearch 
+      //   here instead of using searchForNeighbors.
 
-      float numerator = 0.0f;
-      float denominator = 0.0f;
+      nn_values.resize (nn_indices.size ());
       for (size_t i_neighbor = 0; i_neighbor < nn_indices.size (); ++i_neighbor)
+        nn_values[i_neighbor] = getFieldValue_ (input.points[nn_indices[i_neighbor]]);
+
+      // For each scale, compute the Gaussian "filter response" at the current point
+      float filter_response = 0.0f;
+      float previous_filter_response;
+      for (size_t i_scale = 0; i_scale < scales.size (); ++i_scale)
       {
-        const float &value = getFieldValue_ (input.points[nn_indices[i_neighbor]]);
-        const float &dist_sqr = nn_dist[i_neighbor];
-        if (dist_sqr <= 9*sigma_sqr)
+        const float sigma_sqr = sigma_sqrs[i_scale];
+
+        float numerator = 0.0f;
+        float denominator = 0.0f;
+        for (size_t i_neighbor = 0; i_neighbor < nn_indices.size (); ++i_neighbor)
         {
-          float w = expf (-0.5f * dist_sqr / sigma_sqr);
-          numerator += value * w;
-          denominator += w;
+          const float &value = nn_values[i_neighbor];
+          const float &dist_sqr = nn_dist[i_neighbor];
+          if (dist_sqr <= 9*sigma_sqr)
+          {
+            float w = expf (-0.5f * dist_sqr / sigma_sqr);
+            numerator += value * w;
+            denominator += w;
+          }
+          else break; // i.e. if dist > 3 standard deviations, then terminate early
         }
-        else break; // i.e. if dist > 3 standard deviations, then terminate early
-      }
-      previous_filter_response = filter_response;
-      filter_response = numerator / denominator;
+        previous_filter_response = filter_response;
+        filter_response = numerator / denominator;
 
-      // Compute the difference between adjacent scales
-      if (i_scale > 0)
-        diff_of_gauss (i_point, i_scale - 1) = filter_response - previous_filter_response;
+        // Compute the difference between adjacent scales
+        if (i_scale > 0)
+          diff_of_gauss (i_point, i_scale - 1) = filter_response - previous_filter_response;
+      }
     }
   }
 }
@@ -257,62 +446,80 @@ void pcl::SIFTKeypoint<PointInT, PointOutT>::computeScaleSpace (
 template <typename PointInT, typename PointOutT> void 
 pcl::SIFTKeypoint<PointInT, PointOutT>::findScaleSpaceExtrema (
     const PointCloudIn &input, KdTree &tree, const Eigen::MatrixXf &diff_of_gauss, 
-    std::vector<int> &extrema_indices, std::vector<int> &extrema_scales)
+    std::vector<int> &extrema_indices, std::vector<int> &extrema_scales, unsigned int nr_threads)
 {
   const int k = 25;
-  std::vector<int> nn_indices (k);
-  std::vector<float> nn_dist (k);
-
+  const int nr_points = static_cast<int> (input.size ());
   const int nr_scales = static_cast<int> (diff_of_gauss.cols ());
-  std::vector<float> min_val (nr_scales), max_val (nr_scales);
 
-  for (int i_point = 0; i_point < static_cast<int> (input.size ()); ++i_point)
+  // Flag the extrema of every point and scale in parallel, then collect them in point order
+  std::vector<unsigned char> is_extremum (static_cast<size_t> (nr_points) * nr_scales, 0);
+
+#pragma omp parallel num_threads(nr_threads)
   {
-    // Define the local neighborhood around the current point
-    const size_t nr_nn = tree.nearestKSearch (i_point, k, nn_indices, nn_dist); //*
-    // * note: the neighborhood for finding local extrema is best defined as a small fixed-k neighborhood, regardless of
-    //   the configurable search method specified by the user, so we directly employ tree.nearestKSearch here instead 
-    //   of using searchForNeighbors
-
-    // At each scale, find the extreme values of the DoG within the current neighborhood
-    for (int i_scale = 0; i_scale < nr_scales; ++i_scale)
+    std::vector<int> nn_indices (k);
+    std::vector<float> nn_dist (k);
+    std::vector<float> min_val (nr_scales), max_val (nr_scales);
+
+#pragma omp for schedule(dynamic, 64)
+    for (int i_point = 0; i_point < nr_points; ++i_point)
     {
-      min_val[i_scale] = std::numeric_limits<float>::max ();
-      max_val[i_scale] = -std::numeric_limits<float>::max ();
+      // Define the local neighborhood around the current point
+      const size_t nr_nn = tree.nearestKSearch (i_point, k, nn_indices, nn_dist); //*
+      // * note: the neighborhood for finding local extrema is best defined as a small fixed-k neighborhood, regardless of
+      //   the configurable search method specified by the user, so we directly employ tree.nearestKSearch here instead 
+      //   of using searchForNeighbors
+
+      // At each scale, find the extreme values of the DoG within the current neighborhood
+      for (int i_scale = 0; i_scale < nr_scales; ++i_scale)
+      {
+        min_val[i_scale] = std::numeric_limits<float>::max ();
+        max_val[i_scale] = -std::numeric_limits<float>::max ();
+
+        for (size_t i_neighbor = 0; i_neighbor < nr_nn; ++i_neighbor)
+        {
+          const float &d = diff_of_gauss (nn_indices[i_neighbor], i_scale);
 
-      for (size_t i_neighbor = 0; i_neighbor < nr_nn; ++i_neighbor)
+          min_val[i_scale] = (std::min) (min_val[i_scale], d);
+          max_val[i_scale] = (std::max) (max_val[i_scale], d);
+        }
+      }
+
+      // If the current point is an extreme value with high enough contrast, flag it as a keypoint 
+      for (int i_scale = 1; i_scale < nr_scales - 1; ++i_scale)
       {
-        const float &d = diff_of_gauss (nn_indices[i_neighbor], i_scale);
+        const float &val = diff_of_gauss (i_point, i_scale);
 
-        min_val[i_scale] = (std::min) (min_val[i_scale], d);
-        max_val[i_scale] = (std::max) (max_val[i_scale], d);
+        // Does the point have sufficient contrast?
+        if (fabs (val) >= min_contrast_)
+        {
+          // Is it a local minimum?
+          if ((val == min_val[i_scale]) && 
+              (val <  min_val[i_scale - 1]) && 
+              (val <  min_val[i_scale + 1]))
+          {
+            is_extremum[static_cast<size_t> (i_point) * nr_scales + i_scale] = 1;
+          }
+          // Is it a local maximum?
+          else if ((val == max_val[i_scale]) && 
+                   (val >  max_val[i_scale - 1]) && 
+                   (val >  max_val[i_scale + 1]))
+          {
+            is_extremum[static_cast<size_t> (i_point) * nr_scales + i_scale] = 1;
+          }
+        }
       }
     }
+  }
 
-    // If the current point is an extreme value with high enough contrast, add it as a keypoint 
+  for (int i_point = 0; i_point < nr_points; ++i_point)
+  {
     for (int i_scale = 1; i_scale < nr_scales - 1; ++i_scale)
     {
-      const float &val = diff_of_gauss (i_point, i_scale);
-
-      // Does the point have sufficient contrast?
-      if (fabs (val) >= min_contrast_)
+      if (is_extremum[static_cast<size_t> (i_point) * nr_scales + i_scale])
       {
-        // Is it a local minimum?
-        if ((val == min_val[i_scale]) && 
-            (val <  min_val[i_scale - 1]) && 
-            (val <  min_val[i_scale + 1]))
-        {
-          extrema_indices.push_back (i_point);
-          extrema_scales.push_back (i_scale);
-        }
-        // Is it a local maximum?
-        else if ((val == max_val[i_scale]) && 
-                 (val >  max_val[i_scale - 1]) && 
-                 (val >  max_val[i_scale + 1]))
-        {
-          extrema_indices.push_back (i_point);
-          extrema_scales.push_back (i_scale);
-        }
+        extrema_indices.push_back (i_point);
+        extrema_scales.push_back (i_scale);
       }
     }
   }
@@ -41,10 +41,39 @@
 #include <pcl/pcl/common/common.h>
 #include <pcl/pcl/keypoints/uniform_sampling.h>
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::UniformSampling<PointInT>::compute (PointCloudOut &output, unsigned int nr_threads)
+{
+  if (!this->initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::compute] initCompute failed!\n", getClassName ().c_str ());
+    return;
+  }
+
+  // Perform the actual computation
+  detectKeypoints (output, nr_threads);
+
+  this->deinitCompute ();
+
+  // Reset the surface
+  if (input_ == this->surface_)
+    this->surface_.reset ();
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::UniformSampling<PointInT>::detectKeypoints (PointCloudOut &output)
 {
+  detectKeypoints (output, 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::UniformSampling<PointInT>::detectKeypoints (PointCloudOut &output, unsigned int nr_threads)
+{
+  const int threads = nr_threads == 0 ? 1 : static_cast<int> (nr_threads);
+
   // Has the input dataset been set already?
   if (!input_)
   {
@@ -75,50 +104,112 @@ pcl::UniformSampling<PointInT>::detectKeypoints (PointCloudOut &output)
 
   // Clear the leaves
   leaves_.clear ();
+  std::vector<boost::unordered_map<size_t, Leaf> > leaves (nr_shards_);
 
   // Set up the division multiplier
   divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
 
-  // First pass: build a set of leaves with the point index closest to the leaf center
-  for (size_t cp = 0; cp < indices_->size (); ++cp)
-  {
-    if (!input_->is_dense)
-      // Check if the point is invalid
-      if (!pcl_isfinite (input_->points[(*indices_)[cp]].x) || 
-          !pcl_isfinite (input_->points[(*indices_)[cp]].y) || 
-          !pcl_isfinite (input_->points[(*indices_)[cp]].z))
-        continue;
+  // The points are split into one block per thread, each block counting its points per shard
+  const int nr_points = static_cast<int> (indices_->size ());
+  const int nr_blocks = threads;
+  std::vector<int> point_leaves (nr_points, -1);
+  std::vector<int> block_counts (nr_blocks * nr_shards_, 0);
 
-    Eigen::Vector4i ijk = Eigen::Vector4i::Zero ();
-    ijk[0] = static_cast<int> (floor (input_->points[(*indices_)[cp]].x * inverse_leaf_size_[0]));
-    ijk[1] = static_cast<int> (floor (input_->points[(*indices_)[cp]].y * inverse_leaf_size_[1]));
-    ijk[2] = static_cast<int> (floor (input_->points[(*indices_)[cp]].z * inverse_leaf_size_[2]));
+  // First pass: compute the leaf index of every valid point
+#pragma omp parallel for schedule(static, 1) num_threads(threads)
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    int *counts = &block_counts[block * nr_shards_];
+    const int end = static_cast<int> (static_cast<int64_t> (nr_points) * (block + 1) / nr_blocks);
+    for (int cp = static_cast<int> (static_cast<int64_t> (nr_points) * block / nr_blocks); cp < end; ++cp)
+    {
+      const PointInT &point = input_->points[(*indices_)[cp]];
+      if (!input_->is_dense)
+        // Check if the point is invalid
+        if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+          continue;
+
+      Eigen::Vector4i ijk = Eigen::Vector4i::Zero ();
+      ijk[0] = static_cast<int> (floor (point.x * inverse_leaf_size_[0]));
+      ijk[1] = static_cast<int> (floor (point.y * inverse_leaf_size_[1]));
+      ijk[2] = static_cast<int> (floor (point.z * inverse_leaf_size_[2]));
+
+      // Compute the leaf index
+      point_leaves[cp] = (ijk - min_b_).dot (divb_mul_);
+      ++counts[getShard (point_leaves[cp])];
+    }
+  }
 
-    // Compute the leaf index
-    int idx = (ijk - min_b_).dot (divb_mul_);
-    Leaf& leaf = leaves_[idx];
-    // First time we initialize the index
-    if (leaf.idx == -1)
+  // Compute where the points of every (shard, block) pair start, so that the points of a shard keep their order
+  std::vector<int> shard_offsets (nr_shards_ + 1, 0);
+  for (int shard = 0, offset = 0; shard < nr_shards_; ++shard)
+  {
+    shard_offsets[shard] = offset;
+    for (int block = 0; block < nr_blocks; ++block)
     {
-      leaf.idx = (*indices_)[cp];
-      continue;
+      const int count = block_counts[block * nr_shards_ + shard];
+      block_counts[block * nr_shards_ + shard] = offset;
+      offset += count;
     }
+    shard_offsets[shard + 1] = offset;
+  }
+
+  // Second pass: bucket the points by shard
+  std::vector<int> shard_points (shard_offsets[nr_shards_]);
+#pragma omp parallel for schedule(static, 1) num_threads(threads)
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    int *offsets = &block_counts[block * nr_shards_];
+    const int end = static_cast<int> (static_cast<int64_t> (nr_points) * (block + 1) / nr_blocks);
+    for (int cp = static_cast<int> (static_cast<int64_t> (nr_points) * block / nr_blocks); cp < end; ++cp)
+      if (point_leaves[cp] != -1)
+        shard_points[offsets[getShard (point_leaves[cp])]++] = cp;
+  }
+
+  // Third pass: build every shard with the point index closest to the leaf center, one thread per shard
+#pragma omp parallel for schedule(dynamic, 4) num_threads(threads)
+  for (int shard = 0; shard < nr_shards_; ++shard)
+  {
+    boost::unordered_map<size_t, Leaf> &shard_leaves = leaves[shard];
+    for (int i = shard_offsets[shard]; i < shard_offsets[shard + 1]; ++i)
+    {
+      const int cp = shard_points[i];
+      Leaf& leaf = shard_leaves[point_leaves[cp]];
+      // First time we initialize the index
+      if (leaf.idx == -1)
+      {
+        leaf.idx = (*indices_)[cp];
+        continue;
+      }
 
-    // Check to see if this point is closer to the leaf center than the previous one we saved
-    float diff_cur   = (input_->points[(*indices_)[cp]].getVector4fMap () - ijk.cast<float> ()).squaredNorm ();
-    float diff_prev  = (input_->points[leaf.idx].getVector4fMap ()        - ijk.cast<float> ()).squaredNorm ();
+      Eigen::Vector4i ijk = Eigen::Vector4i::Zero ();
+      ijk[0] = static_cast<int> (floor (input_->points[(*indices_)[cp]].x * inverse_leaf_size_[0]));
+      ijk[1] = static_cast<int> (floor (input_->points[(*indices_)[cp]].y * inverse_leaf_size_[1]));
+      ijk[2] = static_cast<int> (floor (input_->points[(*indices_)[cp]].z * inverse_leaf_size_[2]));
 
-    // If current point is closer, copy its index instead
-    if (diff_cur < diff_prev)
-      leaf.idx = (*indices_)[cp];
+      // Check to see if this point is closer to the leaf center than the previous one we saved
+      float diff_cur   = (input_->points[(*indices_)[cp]].getVector4fMap () - ijk.cast<float> ()).squaredNorm ();
+      float diff_prev  = (input_->points[leaf.idx].getVector4fMap ()        - ijk.cast<float> ()).squaredNorm ();
+
+      // If current point is closer, copy its index instead
+      if (diff_cur < diff_prev)
+        leaf.idx = (*indices_)[cp];
+    }
   }
 
-  // Second pass: go over all leaves and copy data
-  output.points.resize (leaves_.size ());
-  int cp = 0;
+  // Fourth pass: go over all leaves and copy data
+  std::vector<int> leaf_offsets (nr_shards_ + 1, 0);
+  for (int shard = 0; shard < nr_shards_; ++shard)
+    leaf_offsets[shard + 1] = leaf_offsets[shard] + static_cast<int> (leaves[shard].size ());
+  output.points.resize (leaf_offsets[nr_shards_]);
 
-  for (typename boost::unordered_map<size_t, Leaf>::const_iterator it = leaves_.begin (); it != leaves_.end (); ++it)
-    output.points[cp++] = it->second.idx;
+#pragma omp parallel for schedule(dynamic, 4) num_threads(threads)
+  for (int shard = 0; shard < nr_shards_; ++shard)
+  {
+    int cp = leaf_offsets[shard];
+    for (typename boost::unordered_map<size_t, Leaf>::const_iterator it = leaves[shard].begin (); it != leaves[shard].end (); ++it)
+      output.points[cp++] = it->second.idx;
+  }
   output.width = static_cast<uint32_t> (output.points.size ());
 }
 
@@ -0,0 +1,133 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2010, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef PCL_NARF_KEYPOINT_CACHE_H_
+#define PCL_NARF_KEYPOINT_CACHE_H_
+
+#include <pcl/pcl/range_image/range_image.h>
+#include <pcl/pcl/features/range_image_border_extractor.h>
+#include <pcl/pcl/keypoints/narf_keypoint.h>
+#include <cstring>
+
+namespace pcl {
+
+/** \brief @b NarfKeypointCache owns a RangeImageBorderExtractor and a NarfKeypoint working on it, so that the
+  * surface structure, border scores and surface changes are computed once per range image and shared by the
+  * keypoint detection and any other user of the border extractor.
+  *
+  * The range image is identified by its point buffer, its size and a checksum of its ranges. The getters compare
+  * them with the ones seen last and erase the data of the border extractor and the keypoint detector when the
+  * image was refilled, e.g. with RangeImage::updateFromPointCloud (). The checksum costs one pass over the ranges
+  * per getter call, which is small against the border extraction.
+  * \ingroup keypoints
+  */
+class NarfKeypointCache
+{
+  public:
+    // =====CONSTRUCTOR & DESTRUCTOR=====
+    NarfKeypointCache () : border_extractor_ (), narf_keypoint_ (&border_extractor_), range_image_ (NULL),
+                           points_ (NULL), width_ (0), height_ (0), checksum_ (0) {}
+    
+    // =====PUBLIC METHODS=====
+    //! Set the range image both the border extractor and the keypoint detector work on
+    void
+      setRangeImage (const RangeImage* range_image)
+    {
+      narf_keypoint_.setRangeImage (range_image);
+      range_image_ = range_image;
+      getFingerprint (points_, width_, height_, checksum_);
+    }
+    
+    //! Get the shared border extractor, after erasing its data if the range image was refilled
+    RangeImageBorderExtractor&
+      getBorderExtractor () { update (); return (border_extractor_); }
+    
+    //! Get the keypoint detector, after erasing its data if the range image was refilled
+    NarfKeypoint&
+      getNarfKeypoint () { update (); return (narf_keypoint_); }
+    
+    /** Erase the data of the border extractor and the keypoint detector if the range image changed since the
+     *  last call. \return true if the data was erased */
+    bool
+      update ()
+    {
+      const PointWithRange* points;
+      uint32_t width, height, checksum;
+      getFingerprint (points, width, height, checksum);
+      if (points == points_ && width == width_ && height == height_ && checksum == checksum_)
+        return (false);
+      narf_keypoint_.clearData ();
+      border_extractor_.clearData ();
+      points_ = points;  width_ = width;  height_ = height;  checksum_ = checksum;
+      return (true);
+    }
+    
+  protected:
+    // =====PROTECTED METHODS=====
+    //! Identify the current content of the range image by its point buffer, its size and an FNV-1a hash of the ranges
+    void
+      getFingerprint (const PointWithRange*& points, uint32_t& width, uint32_t& height, uint32_t& checksum) const
+    {
+      points = NULL;  width = height = 0;  checksum = 2166136261u;
+      if (range_image_ == NULL || range_image_->points.empty ())
+        return;
+      points = &range_image_->points[0];
+      width = range_image_->width;  height = range_image_->height;
+      for (size_t i = 0; i < range_image_->points.size (); ++i)
+      {
+        uint32_t bits;
+        memcpy (&bits, &range_image_->points[i].range, sizeof (bits));
+        checksum = (checksum ^ bits) * 16777619u;
+      }
+    }
+    
+    // =====PROTECTED MEMBER VARIABLES=====
+    RangeImageBorderExtractor border_extractor_;
+    NarfKeypoint narf_keypoint_;
+    const RangeImage* range_image_;
+    const PointWithRange* points_;
+    uint32_t width_, height_, checksum_;
+    
+  private:
+    // The keypoint detector points to the border extractor member, so the cache can not be copied
+    NarfKeypointCache (const NarfKeypointCache&);
+    NarfKeypointCache&
+      operator= (const NarfKeypointCache&);
+};
+
+}  // end namespace pcl
+
+#endif  //#ifndef PCL_NARF_KEYPOINT_CACHE_H_
@@ -77,6 +77,53 @@ namespace pcl
     }
   };
 
+  namespace detail
+  {
+    /** \brief The grid cell of a voxel, ordered by z, then y, then x, like the voxels of VoxelGrid. */
+    struct SIFTVoxelCell
+    {
+      SIFTVoxelCell (int x_arg, int y_arg, int z_arg, int index_arg) : x (x_arg), y (y_arg), z (z_arg), index (index_arg) {}
+
+      bool
+      operator < (const SIFTVoxelCell &other) const
+      {
+        if (z != other.z)
+          return (z < other.z);
+        if (y != other.y)
+          return (y < other.y);
+        if (x != other.x)
+          return (x < other.x);
+        return (index < other.index);
+      }
+
+      bool
+      sameCell (const SIFTVoxelCell &other) const
+      {
+        return (x == other.x && y == other.y && z == other.z);
+      }
+
+      int x, y, z;
+      /** \brief The point (or parent voxel) accumulated into the cell. */
+      int index;
+    };
+
+    /** \brief The voxel accumulation of one octave. Since the leaf size doubles from one octave to the next, every
+      * voxel of an octave is the union of a 2x2x2 block of voxels of the previous one, hence the next octave is 
+      * obtained by merging the sums below instead of voxelizing a cloud again.
+      */
+    struct SIFTOctaveVoxels
+    {
+      SIFTOctaveVoxels () : cells (), sums (), counts () {}
+
+      /** \brief The grid cell of every voxel, in ascending order. */
+      std::vector<SIFTVoxelCell> cells;
+      /** \brief The sums of the fields of the points falling into every voxel, one column per voxel. */
+      Eigen::MatrixXf sums;
+      /** \brief The number of points falling into every voxel. */
+      std::vector<int> counts;
+    };
+  } // namespace detail
+
   /** \brief @b SIFTKeypoint detects the Scale Invariant Feature Transform
     * keypoints for a given point cloud dataset containing points and intensity.
     * This implementation adapts the original algorithm from images to point
@@ -127,6 +174,16 @@ namespace pcl
       void 
       setMinimumContrast (float min_contrast);
 
+      using Keypoint<PointInT, PointOutT>::compute;
+
+      /** \brief Detect the SIFT keypoints like compute (output), computing the scale space of every octave on
+        * several threads.
+        * \param output the resultant cloud of keypoints
+        * \param nr_threads the number of hardware threads to use (0 is treated as 1)
+        */
+      void
+      compute (PointCloudOut &output, unsigned int nr_threads);
+
     protected:
       bool
       initCompute ();
@@ -138,29 +195,62 @@ namespace pcl
       void 
       detectKeypoints (PointCloudOut &output);
 
+      /** \brief Detect the SIFT keypoints for a set of points given in setInputCloud () using the spatial locator in 
+        * setSearchMethod ().
+        * \param output the resultant cloud of keypoints
+        * \param nr_threads the number of hardware threads to use
+        */
+      void 
+      detectKeypoints (PointCloudOut &output, unsigned int nr_threads);
+
     private:
+      /** \brief Accumulate the points given in setInputCloud () into a voxel grid.
+        * \param leaf_size the voxel edge length
+        * \param rgba_offset the offset of the rgb/rgba field in PointInT, or -1 if there is none
+        * \param voxels the resultant voxel accumulation
+        */
+      void
+      voxelizeInput (float leaf_size, int rgba_offset, detail::SIFTOctaveVoxels &voxels);
+
+      /** \brief Merge the voxels of an octave into the voxels of the next octave, which have twice the edge length.
+        * \param parent the voxel accumulation of the previous octave
+        * \param voxels the resultant voxel accumulation
+        */
+      void
+      mergeVoxels (const detail::SIFTOctaveVoxels &parent, detail::SIFTOctaveVoxels &voxels);
+
+      /** \brief Compute the downsampled cloud of an octave, with one centroid per voxel.
+        * \param voxels the voxel accumulation of the octave
+        * \param rgba_offset the offset of the rgb/rgba field in PointInT, or -1 if there is none
+        * \param output the resultant downsampled cloud
+        */
+      void
+      computeVoxelCentroids (const detail::SIFTOctaveVoxels &voxels, int rgba_offset, PointCloudIn &output);
+
       /** \brief Detect the SIFT keypoints for a given point cloud for a single octave.
         * \param input the point cloud to detect keypoints in
         * \param tree a k-D tree of the points in \a input
         * \param base_scale the first (smallest) scale in the octave
         * \param nr_scales_per_octave the number of scales to to compute
         * \param output the resultant point cloud containing the SIFT keypoints
+        * \param nr_threads the number of hardware threads to use
         */
       void 
       detectKeypointsForOctave (const PointCloudIn &input, KdTree &tree, 
                                 float base_scale, int nr_scales_per_octave, 
-                                PointCloudOut &output);
+                                PointCloudOut &output, unsigned int nr_threads);
 
       /** \brief Compute the difference-of-Gaussian (DoG) scale space for the given input and scales
         * \param input the point cloud for which the DoG scale space will be computed
         * \param tree a k-D tree of the points in \a input
         * \param scales a vector containing the scales over which to compute the DoG scale space
         * \param diff_of_gauss the resultant DoG scale space (in a number-of-points by number-of-scales matrix)
+        * \param nr_threads the number of hardware threads to use
         */
       void 
       computeScaleSpace (const PointCloudIn &input, KdTree &tree, 
                          const std::vector<float> &scales, 
-                         Eigen::MatrixXf &diff_of_gauss);
+                         Eigen::MatrixXf &diff_of_gauss, unsigned int nr_threads);
 
       /** \brief Find the local minima and maxima in the provided difference-of-Gaussian (DoG) scale space
         * \param input the input point cloud 
@@ -168,11 +258,13 @@ namespace pcl
         * \param diff_of_gauss the DoG scale space (in a number-of-points by number-of-scales matrix)
         * \param extrema_indices the resultant vector containing the point indices of each keypoint
         * \param extrema_scales the resultant vector containing the scale indices of each keypoint
+        * \param nr_threads the number of hardware threads to use
         */
       void 
       findScaleSpaceExtrema (const PointCloudIn &input, KdTree &tree, 
                              const Eigen::MatrixXf &diff_of_gauss,
-                             std::vector<int> &extrema_indices, std::vector<int> &extrema_scales);
+                             std::vector<int> &extrema_indices, std::vector<int> &extrema_scales,
+                             unsigned int nr_threads);
 
 
       /** \brief The standard deviation of the smallest scale in the scale space.*/
@@ -54,6 +54,10 @@ namespace pcl
     * a bit slower than approximating them with the center of the voxel, but it
     * represents the underlying surface more accurately.
     *
+    * compute (output, nr_threads) keeps the leaves in a fixed number of hash map shards, selected by the leaf index.
+    * The points are bucketed by shard in parallel and every shard is then filled by a single thread, so no locking
+    * is required and the result does not depend on the number of threads.
+    *
     * \author Radu Bogdan Rusu
     * \ingroup keypoints
     */
@@ -104,6 +108,15 @@ namespace pcl
         search_radius_ = radius;
       }
 
+      using Keypoint<PointInT, int>::compute;
+
+      /** \brief Downsample the input cloud, distributing the work over several threads.
+        * \param output the resultant indices of the sampled points
+        * \param nr_threads the number of hardware threads to use (0 is treated as 1)
+        */
+      void
+      compute (PointCloudOut &output, unsigned int nr_threads);
+
     protected:
       /** \brief Simple structure to hold an nD centroid and the number of points in a leaf. */
       struct Leaf
@@ -112,6 +125,18 @@ namespace pcl
         int idx;
       };
 
+      /** \brief The number of hash map shards the leaves are distributed over. */
+      static const int nr_shards_ = 256;
+
+      /** \brief Get the hash map shard holding a leaf.
+        * \param idx the leaf index
+        */
+      static inline int
+      getShard (int idx)
+      {
+        return (static_cast<int> ((static_cast<uint32_t> (idx) * 2654435761u) >> 24));
+      }
+
       /** \brief The 3D grid leaves. */
       boost::unordered_map<size_t, Leaf> leaves_;
 
@@ -129,6 +154,14 @@ namespace pcl
         */
       void 
       detectKeypoints (PointCloudOut &output);
+
+      /** \brief Downsample a Point Cloud using a voxelized grid approach, with the leaves split into nr_shards_ shards
+        * by getShard () and filled in parallel.
+        * \param output the resultant point cloud message
+        * \param nr_threads the number of hardware threads to use
+        */
+      void 
+      detectKeypoints (PointCloudOut &output, unsigned int nr_threads);
   };
 }
 
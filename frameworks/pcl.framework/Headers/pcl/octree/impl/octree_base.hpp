@@ -189,6 +189,89 @@ namespace pcl
 
     }
 
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeBase<DataT, LeafT, BranchT>::reorderBreadthFirst ()
+    {
+      std::vector<BranchNode*> branchQueue;
+      std::size_t leafCount = 0;
+
+      // count the nodes to be moved; the root node stays in place
+      branchQueue.push_back (rootNode_);
+      for (std::size_t queueIdx = 0; queueIdx < branchQueue.size (); ++queueIdx)
+      {
+        for (unsigned char childIdx = 0; childIdx < 8; ++childIdx)
+        {
+          OctreeNode* childNode = branchQueue[queueIdx]->getChildPtr (childIdx);
+          if (!childNode)
+            continue;
+
+          if (childNode->getNodeType () == BRANCH_NODE)
+            branchQueue.push_back (static_cast<BranchNode*> (childNode));
+          else
+            ++leafCount;
+        }
+      }
+
+      // the next pops return consecutive nodes of one slab per node type
+      branchNodePool_.reserveSlab (branchQueue.size () - 1);
+      leafNodePool_.reserveSlab (leafCount);
+
+      std::vector<BranchNode*> oldBranches;
+      std::vector<LeafNode*> oldLeafs;
+      oldBranches.reserve (branchQueue.size () - 1);
+      oldLeafs.reserve (leafCount);
+
+      branchQueue.resize (1);
+      for (std::size_t queueIdx = 0; queueIdx < branchQueue.size (); ++queueIdx)
+      {
+        BranchNode* branch = branchQueue[queueIdx];
+
+        for (unsigned char childIdx = 0; childIdx < 8; ++childIdx)
+        {
+          OctreeNode* childNode = branch->getChildPtr (childIdx);
+          if (!childNode)
+            continue;
+
+          switch (childNode->getNodeType ())
+          {
+            case BRANCH_NODE:
+            {
+              BranchNode* oldBranch = static_cast<BranchNode*> (childNode);
+              BranchNode* newBranch = branchNodePool_.popNode ();
+
+              newBranch->shallowCopy (*oldBranch);
+              oldBranches.push_back (oldBranch);
+
+              (*branch)[childIdx] = newBranch;
+              branchQueue.push_back (newBranch);
+              break;
+            }
+            case LEAF_NODE:
+            {
+              LeafNode* oldLeaf = static_cast<LeafNode*> (childNode);
+              LeafNode* newLeaf = leafNodePool_.popNode ();
+
+              static_cast<LeafT&> (*newLeaf) = static_cast<const LeafT&> (*oldLeaf);
+              oldLeafs.push_back (oldLeaf);
+
+              (*branch)[childIdx] = newLeaf;
+              break;
+            }
+            default:
+              break;
+          }
+        }
+      }
+
+      // all previous nodes are unused now - release their memory
+      for (std::size_t i = 0; i < oldBranches.size (); ++i)
+        branchNodePool_.pushNode (oldBranches[i]);
+      for (std::size_t i = 0; i < oldLeafs.size (); ++i)
+        leafNodePool_.pushNode (oldLeafs[i]);
+      poolCleanUp ();
+    }
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename DataT, typename LeafT, typename BranchT> void
     OctreeBase<DataT, LeafT, BranchT>::serializeTree (std::vector<char>& binaryTreeOut_arg)
@@ -295,6 +378,100 @@ namespace pcl
 
     }
 
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT> void
+    OctreeBase<DataT, LeafT, BranchT>::addDataBatch (const std::vector<OctreeKey>& keys_arg,
+                                                     const std::vector<DataT>& data_arg)
+    {
+      assert (keys_arg.size () == data_arg.size ());
+
+      if (maxObjsPerLeaf_)
+      {
+        // leaf nodes of dynamic depth octrees may have to be expanded
+        for (std::size_t i = 0; i < keys_arg.size (); ++i)
+          addData (keys_arg[i], data_arg[i]);
+        return;
+      }
+
+      unsigned int treeDepth = 0;
+      for (unsigned int depthMask = depthMask_; depthMask; depthMask >>= 1)
+        ++treeDepth;
+
+      // branch nodes from root to the previous leaf
+      std::vector<BranchNode*> branchPath (treeDepth + 1);
+      unsigned int pathDepth = 0;
+
+      branchPath[0] = rootNode_;
+
+      for (std::size_t i = 0; i < keys_arg.size (); ++i)
+      {
+        const OctreeKey& key = keys_arg[i];
+        const DataT& data = data_arg[i];
+
+        // find deepest branch shared with previous key
+        unsigned int depth = 0;
+        unsigned int depthMask = depthMask_;
+        if (i)
+        {
+          const OctreeKey& prevKey = keys_arg[i - 1];
+          const unsigned int keyDiff = (key.x ^ prevKey.x) | (key.y ^ prevKey.y) | (key.z ^ prevKey.z);
+
+          while ((depth < pathDepth) && !(keyDiff & depthMask))
+          {
+            ++depth;
+            depthMask >>= 1;
+          }
+        }
+
+        // add data to branch node containers of the shared path
+        for (unsigned int d = 0; d < depth; ++d)
+          branchPath[d]->setData (data);
+
+        BranchNode* branch = branchPath[depth];
+
+        // descend to leaf node level
+        while (depthMask > 1)
+        {
+          unsigned char childIdx = key.getChildIdxWithDepthMask (depthMask);
+          BranchNode* childBranch;
+
+          branch->setData (data);
+
+          OctreeNode* childNode = (*branch)[childIdx];
+          if (!childNode)
+          {
+            createBranchChild (*branch, childIdx, childBranch);
+            branchCount_++;
+          }
+          else
+            childBranch = static_cast<BranchNode*> (childNode);
+
+          branchPath[++depth] = childBranch;
+          branch = childBranch;
+          depthMask >>= 1;
+        }
+        pathDepth = depth;
+
+        // add data to leaf
+        unsigned char childIdx = key.getChildIdxWithDepthMask (depthMask);
+        LeafNode* childLeaf;
+
+        branch->setData (data);
+
+        OctreeNode* childNode = (*branch)[childIdx];
+        if (!childNode)
+        {
+          createLeafChild (*branch, childIdx, childLeaf);
+          leafCount_++;
+        }
+        else
+          childLeaf = static_cast<LeafNode*> (childNode);
+
+        childLeaf->setData (data);
+        objectCount_++;
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename DataT, typename LeafT, typename BranchT> void OctreeBase<
         DataT, LeafT, BranchT>::addDataToLeafRecursive (
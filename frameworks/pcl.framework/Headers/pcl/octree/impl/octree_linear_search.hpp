@@ -0,0 +1,475 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OCTREE_LINEAR_SEARCH_IMPL_H_
+#define PCL_OCTREE_LINEAR_SEARCH_IMPL_H_
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include <pcl/pcl/common/common.h>
+#include <assert.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinearSearch<PointT>::deleteTree ()
+{
+  nodes_.clear ();
+  points_.clear ();
+  pointIndices_.clear ();
+  treeDepth_ = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinearSearch<PointT>::addPointsFromInputCloud ()
+{
+  assert (input_);
+
+  deleteTree ();
+
+  const std::size_t pointCount = indices_ ? indices_->size () : input_->points.size ();
+
+  // collect valid points and their bounding box
+  std::vector<std::pair<boost::uint64_t, int> > codes;
+  codes.reserve (pointCount);
+
+  Eigen::Array4f minPt, maxPt;
+  minPt.setConstant (std::numeric_limits<float>::max ());
+  maxPt.setConstant (-std::numeric_limits<float>::max ());
+
+  for (std::size_t i = 0; i < pointCount; ++i)
+  {
+    const int pointIdx = indices_ ? (*indices_)[i] : static_cast<int> (i);
+    const PointT& point = input_->points[pointIdx];
+
+    if (!isFinite (point))
+      continue;
+
+    Eigen::Array4f pt (point.x, point.y, point.z, 0.0f);
+    minPt = minPt.min (pt);
+    maxPt = maxPt.max (pt);
+
+    codes.push_back (std::make_pair (boost::uint64_t (0), pointIdx));
+  }
+
+  if (codes.empty ())
+    return;
+
+  // find depth so that the bounding box fits into the octree
+  minX_ = minPt[0];
+  minY_ = minPt[1];
+  minZ_ = minPt[2];
+
+  const double maxExtent = (maxPt - minPt).maxCoeff ();
+  const unsigned int maxVoxelIdx = static_cast<unsigned int> (std::min (std::floor (maxExtent / resolution_),
+                                                                        static_cast<double> ((1u << MAX_TREE_DEPTH) - 1)));
+
+  treeDepth_ = 0;
+  while ((treeDepth_ < MAX_TREE_DEPTH) && ((1u << treeDepth_) <= maxVoxelIdx + 1))
+    ++treeDepth_;
+
+  // points beyond the maximum tree depth are clamped into the outermost voxels
+  for (std::size_t i = 0; i < codes.size (); ++i)
+  {
+    PointT point = input_->points[codes[i].second];
+    clampToTree (point);
+    genMortonCode (point, codes[i].first);
+  }
+
+  std::sort (codes.begin (), codes.end ());
+
+  // store points in Morton order
+  points_.resize (codes.size ());
+  pointIndices_.resize (codes.size ());
+  for (std::size_t i = 0; i < codes.size (); ++i)
+  {
+    const PointT& point = input_->points[codes[i].second];
+    points_[i] = Eigen::Array4f (point.x, point.y, point.z, 0.0f);
+    pointIndices_[i] = codes[i].second;
+  }
+
+  // create nodes in breadth-first order - children of a node are split at their octant bits
+  std::vector<unsigned char> nodeDepth;
+
+  LinearNode rootNode;
+  rootNode.pointBegin = 0;
+  rootNode.pointEnd = static_cast<boost::uint32_t> (codes.size ());
+  rootNode.childBegin = 0;
+  rootNode.childCount = 0;
+  rootNode.octant = 0;
+  nodes_.push_back (rootNode);
+  nodeDepth.push_back (0);
+
+  for (std::size_t nodeIdx = 0; nodeIdx < nodes_.size (); ++nodeIdx)
+  {
+    const unsigned int depth = nodeDepth[nodeIdx];
+    if (depth == treeDepth_)
+      continue;
+
+    const OctantCompare compare (3 * (treeDepth_ - 1 - depth));
+    const boost::uint32_t pointEnd = nodes_[nodeIdx].pointEnd;
+    boost::uint32_t pointBegin = nodes_[nodeIdx].pointBegin;
+
+    nodes_[nodeIdx].childBegin = static_cast<boost::uint32_t> (nodes_.size ());
+
+    while (pointBegin < pointEnd)
+    {
+      const unsigned int octant = static_cast<unsigned int> ((codes[pointBegin].first >> compare.shift) & 7);
+      const boost::uint32_t childEnd = static_cast<boost::uint32_t> (
+          std::upper_bound (codes.begin () + pointBegin, codes.begin () + pointEnd, octant, compare) - codes.begin ());
+
+      LinearNode childNode;
+      childNode.pointBegin = pointBegin;
+      childNode.pointEnd = childEnd;
+      childNode.childBegin = 0;
+      childNode.childCount = 0;
+      childNode.octant = static_cast<unsigned char> (octant);
+      nodes_.push_back (childNode);
+      nodeDepth.push_back (static_cast<unsigned char> (depth + 1));
+
+      ++nodes_[nodeIdx].childCount;
+      pointBegin = childEnd;
+    }
+  }
+
+  // compute tight bounding boxes bottom-up; children are always stored behind their parent
+  for (std::size_t nodeIdx = nodes_.size (); nodeIdx-- > 0;)
+  {
+    LinearNode& node = nodes_[nodeIdx];
+
+    node.minPt.setConstant (std::numeric_limits<float>::max ());
+    node.maxPt.setConstant (-std::numeric_limits<float>::max ());
+
+    if (node.childCount)
+    {
+      for (boost::uint32_t i = node.childBegin; i < node.childBegin + node.childCount; ++i)
+      {
+        node.minPt = node.minPt.min (nodes_[i].minPt);
+        node.maxPt = node.maxPt.max (nodes_[i].maxPt);
+      }
+    }
+    else
+    {
+      for (boost::uint32_t i = node.pointBegin; i < node.pointEnd; ++i)
+      {
+        node.minPt = node.minPt.min (points_[i]);
+        node.maxPt = node.maxPt.max (points_[i]);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::octree::OctreePointCloudLinearSearch<PointT>::voxelSearch (const PointT& point,
+                                                                std::vector<int>& pointIdx_data) const
+{
+  assert (isFinite (point) && "Invalid (NaN, Inf) point coordinates given to voxelSearch!");
+
+  if (nodes_.empty ())
+    return (false);
+
+  // address the voxel the same way the points were indexed
+  PointT clampedPoint = point;
+  clampToTree (clampedPoint);
+
+  boost::uint64_t code;
+  if (!genMortonCode (clampedPoint, code))
+    return (false);
+
+  // descend along the octants of the Morton code
+  boost::uint32_t nodeIdx = 0;
+  for (unsigned int depth = 0; depth < treeDepth_; ++depth)
+  {
+    const unsigned char octant = static_cast<unsigned char> ((code >> (3 * (treeDepth_ - 1 - depth))) & 7);
+    const LinearNode& node = nodes_[nodeIdx];
+
+    boost::uint32_t childIdx = node.childBegin;
+    const boost::uint32_t childEnd = node.childBegin + node.childCount;
+    while ((childIdx < childEnd) && (nodes_[childIdx].octant != octant))
+      ++childIdx;
+
+    if (childIdx == childEnd)
+      return (false);
+
+    nodeIdx = childIdx;
+  }
+
+  const LinearNode& leaf = nodes_[nodeIdx];
+  pointIdx_data.insert (pointIdx_data.end (), pointIndices_.begin () + leaf.pointBegin,
+                        pointIndices_.begin () + leaf.pointEnd);
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinearSearch<PointT>::nearestKSearch (const PointT &p_q, int k,
+                                                                   std::vector<int> &k_indices,
+                                                                   std::vector<float> &k_sqr_distances) const
+{
+  assert (isFinite (p_q) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+
+  if ((k < 1) || nodes_.empty ())
+    return (0);
+
+  const Eigen::Array4f query (p_q.x, p_q.y, p_q.z, 0.0f);
+  const std::size_t maxResults = std::min (static_cast<std::size_t> (k), points_.size ());
+
+  // max-heap of the current point candidates
+  std::vector<std::pair<float, boost::uint32_t> > candidates;
+  candidates.reserve (maxResults + 1);
+  float worstDistance = std::numeric_limits<float>::max ();
+
+  // traversal stack - every level adds at most 7 siblings
+  boost::uint32_t nodeStack[8 * MAX_TREE_DEPTH + 8];
+  float distanceStack[8 * MAX_TREE_DEPTH + 8];
+  int stackSize = 0;
+
+  nodeStack[stackSize] = 0;
+  distanceStack[stackSize++] = boxSqrDistance (query, nodes_[0]);
+
+  while (stackSize)
+  {
+    --stackSize;
+    if (distanceStack[stackSize] > worstDistance)
+      continue;
+
+    const LinearNode& node = nodes_[nodeStack[stackSize]];
+
+    if (!node.childCount)
+    {
+      for (boost::uint32_t i = node.pointBegin; i < node.pointEnd; ++i)
+      {
+        const float distance = (points_[i] - query).square ().sum ();
+        if (candidates.size () < maxResults)
+        {
+          candidates.push_back (std::make_pair (distance, i));
+          std::push_heap (candidates.begin (), candidates.end ());
+        }
+        else if (distance < candidates.front ().first)
+        {
+          std::pop_heap (candidates.begin (), candidates.end ());
+          candidates.back () = std::make_pair (distance, i);
+          std::push_heap (candidates.begin (), candidates.end ());
+        }
+        else
+          continue;
+
+        if (candidates.size () == maxResults)
+          worstDistance = candidates.front ().first;
+      }
+      continue;
+    }
+
+    // push children farthest first so that the closest child is visited next
+    std::pair<float, boost::uint32_t> children[8];
+    int childCount = 0;
+    for (boost::uint32_t i = node.childBegin; i < node.childBegin + node.childCount; ++i)
+    {
+      const float distance = boxSqrDistance (query, nodes_[i]);
+      if (distance <= worstDistance)
+        children[childCount++] = std::make_pair (distance, i);
+    }
+    std::sort (children, children + childCount);
+
+    while (childCount--)
+    {
+      nodeStack[stackSize] = children[childCount].second;
+      distanceStack[stackSize++] = children[childCount].first;
+    }
+  }
+
+  std::sort_heap (candidates.begin (), candidates.end ());
+
+  k_indices.resize (candidates.size ());
+  k_sqr_distances.resize (candidates.size ());
+  for (std::size_t i = 0; i < candidates.size (); ++i)
+  {
+    k_indices[i] = pointIndices_[candidates[i].second];
+    k_sqr_distances[i] = candidates[i].first;
+  }
+
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinearSearch<PointT>::nearestKSearch (const PointCloud &cloud,
+                                                                   const std::vector<int> &indices, int k,
+                                                                   std::vector<std::vector<int> > &k_indices,
+                                                                   std::vector<std::vector<float> > &k_sqr_distances) const
+{
+  k_indices.resize (indices.size ());
+  k_sqr_distances.resize (indices.size ());
+
+  int queryCount = static_cast<int> (indices.size ());
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 64) num_threads (threads_)
+#endif
+  for (int i = 0; i < queryCount; ++i)
+    nearestKSearch (cloud.points[indices[i]], k, k_indices[i], k_sqr_distances[i]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinearSearch<PointT>::radiusSearch (const PointT &p_q, const double radius,
+                                                                 std::vector<int> &k_indices,
+                                                                 std::vector<float> &k_sqr_distances,
+                                                                 unsigned int max_nn) const
+{
+  assert (isFinite (p_q) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+
+  if (nodes_.empty ())
+    return (0);
+
+  const Eigen::Array4f query (p_q.x, p_q.y, p_q.z, 0.0f);
+  const float sqrRadius = static_cast<float> (radius * radius);
+  const std::size_t maxResults = max_nn ? max_nn : points_.size ();
+
+  boost::uint32_t nodeStack[8 * MAX_TREE_DEPTH + 8];
+  int stackSize = 0;
+
+  nodeStack[stackSize++] = 0;
+
+  while (stackSize && (k_indices.size () < maxResults))
+  {
+    const LinearNode& node = nodes_[nodeStack[--stackSize]];
+
+    if (boxSqrDistance (query, node) > sqrRadius)
+      continue;
+
+    if (!node.childCount || (boxMaxSqrDistance (query, node) <= sqrRadius))
+    {
+      // leaf node or node fully within search radius
+      for (boost::uint32_t i = node.pointBegin; (i < node.pointEnd) && (k_indices.size () < maxResults); ++i)
+      {
+        const float distance = (points_[i] - query).square ().sum ();
+        if (distance <= sqrRadius)
+        {
+          k_indices.push_back (pointIndices_[i]);
+          k_sqr_distances.push_back (distance);
+        }
+      }
+      continue;
+    }
+
+    for (boost::uint32_t i = node.childBegin + node.childCount; i-- > node.childBegin;)
+      nodeStack[stackSize++] = i;
+  }
+
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinearSearch<PointT>::radiusSearch (const PointCloud &cloud,
+                                                                 const std::vector<int> &indices, const double radius,
+                                                                 std::vector<std::vector<int> > &k_indices,
+                                                                 std::vector<std::vector<float> > &k_sqr_distances,
+                                                                 unsigned int max_nn) const
+{
+  k_indices.resize (indices.size ());
+  k_sqr_distances.resize (indices.size ());
+
+  int queryCount = static_cast<int> (indices.size ());
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 64) num_threads (threads_)
+#endif
+  for (int i = 0; i < queryCount; ++i)
+    radiusSearch (cloud.points[indices[i]], radius, k_indices[i], k_sqr_distances[i], max_nn);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinearSearch<PointT>::boxSearch (const Eigen::Vector3f &min_pt,
+                                                              const Eigen::Vector3f &max_pt,
+                                                              std::vector<int> &k_indices) const
+{
+  k_indices.clear ();
+
+  if (nodes_.empty ())
+    return (0);
+
+  const Eigen::Array4f boxMin (min_pt[0], min_pt[1], min_pt[2], 0.0f);
+  const Eigen::Array4f boxMax (max_pt[0], max_pt[1], max_pt[2], 0.0f);
+
+  boost::uint32_t nodeStack[8 * MAX_TREE_DEPTH + 8];
+  int stackSize = 0;
+
+  nodeStack[stackSize++] = 0;
+
+  while (stackSize)
+  {
+    const LinearNode& node = nodes_[nodeStack[--stackSize]];
+
+    // skip nodes outside of search area
+    if (((node.maxPt < boxMin).any ()) || ((node.minPt > boxMax).any ()))
+      continue;
+
+    if (((node.minPt >= boxMin).all ()) && ((node.maxPt <= boxMax).all ()))
+    {
+      // node fully within search area
+      k_indices.insert (k_indices.end (), pointIndices_.begin () + node.pointBegin,
+                        pointIndices_.begin () + node.pointEnd);
+      continue;
+    }
+
+    if (!node.childCount)
+    {
+      for (boost::uint32_t i = node.pointBegin; i < node.pointEnd; ++i)
+        if (((points_[i] >= boxMin).all ()) && ((points_[i] <= boxMax).all ()))
+          k_indices.push_back (pointIndices_[i]);
+      continue;
+    }
+
+    for (boost::uint32_t i = node.childBegin + node.childCount; i-- > node.childBegin;)
+      nodeStack[stackSize++] = i;
+  }
+
+  return (static_cast<int> (k_indices.size ()));
+}
+
+#endif    // PCL_OCTREE_LINEAR_SEARCH_IMPL_H_
@@ -64,33 +64,98 @@ pcl::octree::OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::~OctreePointClou
 template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
 pcl::octree::OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::addPointsFromInputCloud ()
 {
-  size_t i;
+  addPointsFromInputCloud (1);
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+pcl::octree::OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::addPointsFromInputCloud (unsigned int nr_threads)
+{
   assert (this->leafCount_==0);
+
+  const unsigned int threads = nr_threads == 0 ? 1 : nr_threads;
+
+  // collect valid points
+  std::vector<int> pointIndices;
   if (indices_)
   {
+    pointIndices.reserve (indices_->size ());
     for (std::vector<int>::const_iterator current = indices_->begin (); current != indices_->end (); ++current)
     {
+      assert( (*current>=0) && (*current < static_cast<int> (input_->points.size ())));
       if (isFinite (input_->points[*current]))
-      {
-        assert( (*current>=0) && (*current < static_cast<int> (input_->points.size ())));
+        pointIndices.push_back (*current);
+    }
+  }
+  else
+  {
+    pointIndices.reserve (input_->points.size ());
+    for (size_t i = 0; i < input_->points.size (); i++)
+      if (isFinite (input_->points[i]))
+        pointIndices.push_back (static_cast<int> (i));
+  }
 
-        // add points to octree
-        this->addPointIdx (*current);
-      }
+  if (pointIndices.empty ())
+    return;
+
+  // first point defines the voxel grid of an empty octree
+  std::size_t firstIdx = 0;
+  if (!boundingBoxDefined_)
+    this->addPointIdx (pointIndices[firstIdx++]);
+
+  const int pointCount = static_cast<int> (pointIndices.size () - firstIdx);
+  if (!pointCount)
+    return;
+
+  // grow the bounding box in input order; the direction of every growth step depends on the point that
+  // triggers it, so this yields the same bounding box and depth as adding the points one by one
+  for (int i = 0; i < pointCount; ++i)
+    adoptBoundingBoxToPoint (input_->points[pointIndices[firstIdx + i]]);
+
+  std::vector<OctreeKey> keys (pointCount);
+  std::vector<int> data (pointCount);
+
+  if (this->octreeDepth_ <= 21)
+  {
+    // compute Morton codes in parallel and sort them
+    std::vector<std::pair<boost::uint64_t, int> > codes (pointCount);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int i = 0; i < pointCount; ++i)
+    {
+      OctreeKey key;
+      const int pointIdx = pointIndices[firstIdx + i];
+      genOctreeKeyforPoint (input_->points[pointIdx], key);
+      codes[i] = std::make_pair (key.getMortonCode (), pointIdx);
+    }
+
+    sortByMortonCode (codes, 3 * this->octreeDepth_);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int i = 0; i < pointCount; ++i)
+    {
+      data[i] = codes[i].second;
+      genOctreeKeyforPoint (input_->points[data[i]], keys[i]);
     }
   }
   else
   {
-    for (i = 0; i < input_->points.size (); i++)
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int i = 0; i < pointCount; ++i)
     {
-      if (isFinite (input_->points[i]))
-      {
-        // add points to octree
-        this->addPointIdx (static_cast<unsigned int> (i));
-      }
+      data[i] = pointIndices[firstIdx + i];
+      genOctreeKeyforPoint (input_->points[data[i]], keys[i]);
     }
   }
+
+  // build octree in a single pass
+  this->addDataBatch (keys, data);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -445,14 +510,16 @@ pcl::octree::OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::adoptBoundingBox
         childIdx = static_cast<unsigned char> (((!bUpperBoundViolationX) << 2) | ((!bUpperBoundViolationY) << 1)
             | ((!bUpperBoundViolationZ)));
 
-        BranchNode* newRootBranch;
+        BranchNode* newChildBranch;
 
-        newRootBranch = this->branchNodePool_.popNode();
+        // the root node is kept in place; its content moves into a new child branch taken from the node pool
+        newChildBranch = this->branchNodePool_.popNode();
         this->branchCount_++;
 
-        this->setBranchChildPtr (*newRootBranch, childIdx, this->rootNode_);
+        newChildBranch->shallowCopy (*this->rootNode_);
+        this->rootNode_->reset ();
 
-        this->rootNode_ = newRootBranch;
+        this->setBranchChildPtr (*this->rootNode_, childIdx, newChildBranch);
 
         octreeSideLen = static_cast<double> (1 << this->octreeDepth_) * resolution_;
 
@@ -602,6 +669,36 @@ pcl::octree::OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::getKeyBitSize ()
 
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+pcl::octree::OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::sortByMortonCode (
+    std::vector<std::pair<boost::uint64_t, int> >& codes_arg, unsigned int bitCount_arg)
+{
+  std::vector<std::pair<boost::uint64_t, int> > buffer (codes_arg.size ());
+  std::size_t histogram[256];
+
+  // sort by 8 bit digits starting with the least significant one
+  for (unsigned int shift = 0; shift < bitCount_arg; shift += 8)
+  {
+    std::fill (histogram, histogram + 256, 0);
+    for (std::size_t i = 0; i < codes_arg.size (); ++i)
+      ++histogram[(codes_arg[i].first >> shift) & 0xFF];
+
+    std::size_t offset = 0;
+    for (unsigned int digit = 0; digit < 256; ++digit)
+    {
+      std::size_t count = histogram[digit];
+      histogram[digit] = offset;
+      offset += count;
+    }
+
+    for (std::size_t i = 0; i < codes_arg.size (); ++i)
+      buffer[histogram[(codes_arg[i].first >> shift) & 0xFF]++] = codes_arg[i];
+
+    codes_arg.swap (buffer);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
 pcl::octree::OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::genOctreeKeyforPoint (const PointT& point_arg,
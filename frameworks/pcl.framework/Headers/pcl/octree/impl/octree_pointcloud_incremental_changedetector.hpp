@@ -0,0 +1,305 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef OCTREE_INCREMENTAL_CHANGEDETECTOR_HPP_
+#define OCTREE_INCREMENTAL_CHANGEDETECTOR_HPP_
+
+#include <algorithm>
+
+#include <pcl/pcl/common/common.h>
+#include <assert.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> std::size_t
+pcl::octree::OctreePointCloudIncrementalChangeDetector<PointT>::getVoxelCount () const
+{
+  std::size_t voxelCount = 0;
+  for (std::size_t i = 0; i < shards_.size (); ++i)
+    voxelCount += shards_[i].voxels.size ();
+  return (voxelCount);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudIncrementalChangeDetector<PointT>::addPointsFromInputCloud ()
+{
+  assert (input_);
+
+  ++frameStamp_;
+
+  for (std::size_t i = 0; i < shards_.size (); ++i)
+    shards_[i].removedPoints.clear ();
+
+  distributePoints (*input_, indices_.get (), false);
+
+  int shardCount = static_cast<int> (shards_.size ());
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads(threads_)
+#endif
+  for (int i = 0; i < shardCount; ++i)
+    updateShard (shards_[i], true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudIncrementalChangeDetector<PointT>::updateVoxels (const PointCloud& insertedPoints_arg,
+                                                                              const PointCloud& removedPoints_arg)
+{
+  distributePoints (insertedPoints_arg, 0, false);
+  distributePoints (removedPoints_arg, 0, true);
+
+  int shardCount = static_cast<int> (shards_.size ());
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads(threads_)
+#endif
+  for (int i = 0; i < shardCount; ++i)
+    updateShard (shards_[i], false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudIncrementalChangeDetector<PointT>::deleteVoxels ()
+{
+  shards_.clear ();
+  shards_.resize (SHARD_COUNT);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> unsigned int
+pcl::octree::OctreePointCloudIncrementalChangeDetector<PointT>::getVoxelDensityAtPoint (const PointT& point_arg) const
+{
+  boost::uint64_t code;
+  if (!genVoxelCode (point_arg, code))
+    return (0);
+
+  const VoxelMap& voxels = shards_[getShardIdx (code)].voxels;
+  typename VoxelMap::const_iterator it = voxels.find (code);
+
+  return ((it != voxels.end ()) ? it->second.pointCount : 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudIncrementalChangeDetector<PointT>::getPointIndicesFromNewVoxels (
+    std::vector<int> &indicesVector_arg, const int minPointsPerLeaf_arg) const
+{
+  indicesVector_arg.clear ();
+
+  for (std::size_t i = 0; i < shards_.size (); ++i)
+  {
+    const VoxelShard& shard = shards_[i];
+    for (std::size_t j = 0; j < shard.addedRanges.size (); ++j)
+    {
+      const std::size_t rangeBegin = shard.addedRanges[j].first;
+      const std::size_t rangeEnd = shard.addedRanges[j].second;
+
+      if (rangeEnd - rangeBegin < static_cast<std::size_t> (std::max (minPointsPerLeaf_arg, 0)))
+        continue;
+
+      for (std::size_t k = rangeBegin; k < rangeEnd; ++k)
+        indicesVector_arg.push_back (shard.insertedPoints[k].second);
+    }
+  }
+
+  return (static_cast<int> (indicesVector_arg.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudIncrementalChangeDetector<PointT>::getChangedVoxelCenters (
+    VoxelChangeType type_arg, AlignedPointTVector &voxelCenterList_arg) const
+{
+  voxelCenterList_arg.clear ();
+
+  for (std::size_t i = 0; i < shards_.size (); ++i)
+  {
+    const std::vector<boost::uint64_t>& changes = shards_[i].changes[type_arg];
+    for (std::size_t j = 0; j < changes.size (); ++j)
+    {
+      PointT center;
+      genVoxelCenter (changes[j], center);
+      voxelCenterList_arg.push_back (center);
+    }
+  }
+
+  return (static_cast<int> (voxelCenterList_arg.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudIncrementalChangeDetector<PointT>::distributePoints (const PointCloud& cloud_arg,
+                                                                                  const std::vector<int>* indices_arg,
+                                                                                  bool removedPoints_arg)
+{
+  const int pointCount = static_cast<int> (indices_arg ? indices_arg->size () : cloud_arg.points.size ());
+
+  // compute voxel codes in parallel
+  std::vector<VoxelPoint> voxelPoints (pointCount);
+  std::vector<unsigned char> shardIndices (pointCount);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads_)
+#endif
+  for (int i = 0; i < pointCount; ++i)
+  {
+    const int pointIdx = indices_arg ? (*indices_arg)[i] : i;
+    boost::uint64_t code;
+
+    voxelPoints[i].second = pointIdx;
+    if (genVoxelCode (cloud_arg.points[pointIdx], code))
+    {
+      voxelPoints[i].first = code;
+      shardIndices[i] = static_cast<unsigned char> (getShardIdx (code));
+    }
+    else
+      shardIndices[i] = SHARD_COUNT;
+  }
+
+  // assign points to shards
+  for (std::size_t i = 0; i < shards_.size (); ++i)
+  {
+    std::vector<VoxelPoint>& points = removedPoints_arg ? shards_[i].removedPoints : shards_[i].insertedPoints;
+    points.clear ();
+  }
+
+  for (int i = 0; i < pointCount; ++i)
+  {
+    if (shardIndices[i] == SHARD_COUNT)
+      continue;
+
+    VoxelShard& shard = shards_[shardIndices[i]];
+    (removedPoints_arg ? shard.removedPoints : shard.insertedPoints).push_back (voxelPoints[i]);
+  }
+
+  // sort points of every shard by voxel
+  int shardCount = static_cast<int> (shards_.size ());
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads(threads_)
+#endif
+  for (int i = 0; i < shardCount; ++i)
+  {
+    std::vector<VoxelPoint>& points = removedPoints_arg ? shards_[i].removedPoints : shards_[i].insertedPoints;
+    std::sort (points.begin (), points.end ());
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudIncrementalChangeDetector<PointT>::updateShard (VoxelShard& shard_arg, bool replace_arg)
+{
+  const std::vector<VoxelPoint>& insertedPoints = shard_arg.insertedPoints;
+  const std::vector<VoxelPoint>& removedPoints = shard_arg.removedPoints;
+
+  for (int i = 0; i < 3; ++i)
+    shard_arg.changes[i].clear ();
+  shard_arg.addedRanges.clear ();
+
+  std::size_t insertIdx = 0;
+  std::size_t removeIdx = 0;
+
+  // merge inserted and removed points voxel by voxel
+  while ((insertIdx < insertedPoints.size ()) || (removeIdx < removedPoints.size ()))
+  {
+    boost::uint64_t code;
+    if (insertIdx == insertedPoints.size ())
+      code = removedPoints[removeIdx].first;
+    else if (removeIdx == removedPoints.size ())
+      code = insertedPoints[insertIdx].first;
+    else
+      code = std::min (insertedPoints[insertIdx].first, removedPoints[removeIdx].first);
+
+    const std::size_t insertBegin = insertIdx;
+    while ((insertIdx < insertedPoints.size ()) && (insertedPoints[insertIdx].first == code))
+      ++insertIdx;
+
+    const std::size_t removeBegin = removeIdx;
+    while ((removeIdx < removedPoints.size ()) && (removedPoints[removeIdx].first == code))
+      ++removeIdx;
+
+    const unsigned int insertCount = static_cast<unsigned int> (insertIdx - insertBegin);
+    const unsigned int removeCount = static_cast<unsigned int> (removeIdx - removeBegin);
+
+    typename VoxelMap::iterator it = shard_arg.voxels.find (code);
+    const unsigned int oldCount = (it != shard_arg.voxels.end ()) ? it->second.pointCount : 0;
+
+    unsigned int newCount;
+    if (replace_arg)
+      newCount = insertCount;
+    else
+      newCount = oldCount + insertCount - std::min (removeCount, oldCount + insertCount);
+
+    if (!newCount)
+    {
+      if (oldCount)
+      {
+        shard_arg.changes[REMOVED_VOXEL].push_back (code);
+        shard_arg.voxels.erase (it);
+      }
+      continue;
+    }
+
+    if (!oldCount)
+    {
+      shard_arg.changes[ADDED_VOXEL].push_back (code);
+      shard_arg.addedRanges.push_back (std::make_pair (insertBegin, insertIdx));
+      it = shard_arg.voxels.insert (std::make_pair (code, VoxelEntry ())).first;
+    }
+    else if (!replace_arg || (newCount != oldCount))
+      shard_arg.changes[MODIFIED_VOXEL].push_back (code);
+
+    it->second.pointCount = newCount;
+    it->second.frameStamp = frameStamp_;
+  }
+
+  if (replace_arg)
+  {
+    // voxels that are not part of the current frame have been removed
+    typename VoxelMap::iterator it = shard_arg.voxels.begin ();
+    while (it != shard_arg.voxels.end ())
+    {
+      if (it->second.frameStamp != frameStamp_)
+      {
+        shard_arg.changes[REMOVED_VOXEL].push_back (it->first);
+        it = shard_arg.voxels.erase (it);
+      }
+      else
+        ++it;
+    }
+  }
+}
+
+#endif
@@ -50,8 +50,10 @@
 #include <pcl/pcl/octree/octree_pointcloud_singlepoint.h>
 #include <pcl/pcl/octree/octree_pointcloud_pointvector.h>
 #include <pcl/pcl/octree/octree_pointcloud_changedetector.h>
+#include <pcl/pcl/octree/octree_pointcloud_incremental_changedetector.h>
 #include <pcl/pcl/octree/octree_pointcloud_voxelcentroid.h>
 
 #include <pcl/pcl/octree/octree_search.h>
+#include <pcl/pcl/octree/octree_linear_search.h>
 
 #endif
@@ -153,6 +153,15 @@ namespace pcl
           ContainerT::reset ();
         }
 
+        /** \brief Take over container and child pointers of both buffers of another branch node without copying its subtree
+         *  \param source_arg: branch node to copy from
+         * */
+        inline void shallowCopy (const BufferedBranchNode& source_arg)
+        {
+          ContainerT::operator= (source_arg);
+          memcpy (&childNodeArray_[0][0], &source_arg.childNodeArray_[0][0], sizeof(OctreeNode*) * 8 * 2);
+        }
+
       protected:
         int preBuf;
         OctreeNode* childNodeArray_[2][8];
@@ -437,6 +446,22 @@ namespace pcl
           }
         }
 
+        /** \brief Add a batch of DataT objects to the leaf nodes at their octree keys.
+         *  \note Keys should be sorted by their Morton code (see OctreeKey::getMortonCode) so that consecutive
+         *  insertions touch the same branch nodes.
+         *  \param keys_arg: octree keys addressing leaf nodes.
+         *  \param data_arg: DataT objects to be added.
+         * */
+        inline void
+        addDataBatch (const std::vector<OctreeKey>& keys_arg, const std::vector<DataT>& data_arg)
+        {
+          assert (keys_arg.size () == data_arg.size ());
+
+          // leafs have to be created through the buffer management of createLeaf
+          for (std::size_t i = 0; i < keys_arg.size (); ++i)
+            addData (keys_arg[i], data_arg[i]);
+        }
+
         /** \brief Find leaf node
          *  \param key_arg: octree key addressing a leaf node.
          *  \return pointer to leaf node. If leaf node is not found, this pointer returns 0.
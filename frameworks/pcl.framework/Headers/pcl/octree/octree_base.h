@@ -221,6 +221,14 @@ namespace pcl
         void
         deleteTree ( bool freeMemory_arg = true );
 
+        /** \brief Relocate all octree nodes into contiguous memory in breadth-first order.
+         *  \note Nodes that are close to each other in the tree become close in memory, which improves cache
+         *  locality of subsequent searches and traversals. Call it once the octree is built.
+         *  \note Invalidates all iterators and pointers to octree nodes.
+         * */
+        void
+        reorderBreadthFirst ();
+
         /** \brief Serialize octree into a binary output vector describing its branch node structure.
          *  \param binaryTreeOut_arg: reference to output vector for writing binary tree structure.
          * */
@@ -293,6 +301,16 @@ namespace pcl
           addDataToLeafRecursive (key_arg, depthMask_,data_arg, rootNode_);
         }
 
+        /** \brief Add a batch of DataT objects to the leaf nodes at their octree keys.
+         *  \note The branch nodes from the root to the previous leaf are cached, so every insertion only descends
+         *  from the deepest branch that is shared with the previous key. Keys should be sorted by their Morton
+         *  code (see OctreeKey::getMortonCode) to maximize the shared paths.
+         *  \param keys_arg: octree keys addressing leaf nodes.
+         *  \param data_arg: DataT objects to be added.
+         * */
+        void
+        addDataBatch (const std::vector<OctreeKey>& keys_arg, const std::vector<DataT>& data_arg);
+
         /** \brief Find leaf node
          *  \param key_arg: octree key addressing a leaf node.
          *  \return pointer to leaf node. If leaf node is not found, this pointer returns 0.
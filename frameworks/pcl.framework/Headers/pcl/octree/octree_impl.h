@@ -46,5 +46,7 @@
 #include <pcl/pcl/octree/impl/octree_pointcloud.hpp>
 #include <pcl/pcl/octree/impl/octree_iterator.hpp>
 #include <pcl/pcl/octree/impl/octree_search.hpp>
+#include <pcl/pcl/octree/impl/octree_linear_search.hpp>
+#include <pcl/pcl/octree/impl/octree_pointcloud_incremental_changedetector.hpp>
 
 #endif
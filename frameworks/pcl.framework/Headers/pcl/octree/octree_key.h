@@ -38,6 +38,8 @@
 #ifndef OCTREE_KEY_H
 #define OCTREE_KEY_H
 
+#include <boost/cstdint.hpp>
+
 namespace pcl
 {
   namespace octree
@@ -130,11 +132,38 @@ namespace pcl
                                          |  (!!(this->z & depthMask)));
       }
 
+      /** \brief get Morton code (z-order) of the key. Child node indices are interleaved in the same bit order as
+       *  returned by getChildIdxWithDepthMask, so sorting keys by their Morton code groups them by octree branches.
+       *  \note Only the lower 21 bits of each index are used (octree depth <= 21).
+       *  \return 63 bit Morton code
+       * */
+      inline boost::uint64_t
+      getMortonCode () const
+      {
+        return ((spreadBits (this->x) << 2) | (spreadBits (this->y) << 1) | spreadBits (this->z));
+      }
+
       // Indices addressing a voxel at (X, Y, Z)
       unsigned int x;
       unsigned int y;
       unsigned int z;
 
+    protected:
+      /** \brief Interleave the lower 21 bits of an index with two zero bits each
+       *  \param[in] index_arg key index
+       *  \return spread bits
+       * */
+      static inline boost::uint64_t
+      spreadBits (unsigned int index_arg)
+      {
+        boost::uint64_t value = index_arg & 0x1FFFFF;
+        value = (value | (value << 32)) & 0x1F00000000FFFFULL;
+        value = (value | (value << 16)) & 0x1F0000FF0000FFULL;
+        value = (value | (value << 8)) & 0x100F00F00F00F00FULL;
+        value = (value | (value << 4)) & 0x10C30C30C30C30C3ULL;
+        value = (value | (value << 2)) & 0x1249249249249249ULL;
+        return (value);
+      }
     };
   }
 }
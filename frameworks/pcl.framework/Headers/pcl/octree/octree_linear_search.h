@@ -0,0 +1,410 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OCTREE_LINEAR_SEARCH_H_
+#define PCL_OCTREE_LINEAR_SEARCH_H_
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/cstdint.hpp>
+
+#include <pcl/pcl/point_cloud.h>
+#include <pcl/pcl/point_types.h>
+
+#include "octree_key.h"
+
+namespace pcl
+{
+  namespace octree
+  {
+    /** \brief @b Linearized octree pointcloud search class
+      * \note Immutable, pointer-free alternative to OctreePointCloudSearch for read-mostly point clouds.
+      * \note Points are sorted by the Morton code of their voxel. Every octree node covers a contiguous range of the
+      * sorted points and stores its children contiguously in a single node array, so that all searches run as
+      * iterative stack traversals without any per-node allocations or pointers.
+      * \note Nodes store the tight bounding box of their points, which is tested with SIMD instructions (through
+      * Eigen::Array4f) during the traversal.
+      * \note The tree is built once by addPointsFromInputCloud (); it has to be rebuilt if the input cloud changes.
+      * \note typename: PointT: type of point used in pointcloud
+      * \ingroup octree
+      */
+    template<typename PointT>
+    class OctreePointCloudLinearSearch
+    {
+      public:
+        // public typedefs
+        typedef boost::shared_ptr<std::vector<int> > IndicesPtr;
+        typedef boost::shared_ptr<const std::vector<int> > IndicesConstPtr;
+
+        typedef pcl::PointCloud<PointT> PointCloud;
+        typedef boost::shared_ptr<PointCloud> PointCloudPtr;
+        typedef boost::shared_ptr<const PointCloud> PointCloudConstPtr;
+
+        typedef boost::shared_ptr<OctreePointCloudLinearSearch<PointT> > Ptr;
+        typedef boost::shared_ptr<const OctreePointCloudLinearSearch<PointT> > ConstPtr;
+
+        /** \brief Constructor.
+          * \param[in] resolution octree resolution at lowest octree level
+          */
+        OctreePointCloudLinearSearch (const double resolution) :
+          input_ (), indices_ (), resolution_ (resolution), treeDepth_ (0), minX_ (0), minY_ (0), minZ_ (0),
+          nodes_ (), points_ (), pointIndices_ (), threads_ (1)
+        {
+          assert (resolution > 0.0f);
+        }
+
+        /** \brief Empty class deconstructor. */
+        virtual
+        ~OctreePointCloudLinearSearch ()
+        {
+        }
+
+        /** \brief Provide a pointer to the input data set.
+          * \param[in] cloud_arg the const boost shared pointer to a PointCloud message
+          * \param[in] indices_arg the point indices subset that is to be used from \a cloud - if 0 the whole point cloud is used
+          */
+        inline void
+        setInputCloud (const PointCloudConstPtr &cloud_arg, const IndicesConstPtr &indices_arg = IndicesConstPtr ())
+        {
+          input_ = cloud_arg;
+          indices_ = indices_arg;
+        }
+
+        /** \brief Get a pointer to the input point cloud dataset. */
+        inline PointCloudConstPtr
+        getInputCloud () const
+        {
+          return (input_);
+        }
+
+        /** \brief Get a pointer to the vector of indices used. */
+        inline IndicesConstPtr const
+        getIndices () const
+        {
+          return (indices_);
+        }
+
+        /** \brief Set the number of threads used by the batch search methods.
+          * \param[in] nr_threads the number of hardware threads to use
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads)
+        {
+          if (nr_threads == 0)
+            nr_threads = 1;
+          threads_ = nr_threads;
+        }
+
+        /** \brief Get octree voxel resolution. */
+        inline double
+        getResolution () const
+        {
+          return (resolution_);
+        }
+
+        /** \brief Get the depth of the octree. */
+        inline unsigned int
+        getTreeDepth () const
+        {
+          return (treeDepth_);
+        }
+
+        /** \brief Get the amount of nodes in the octree. */
+        inline std::size_t
+        getNodeCount () const
+        {
+          return (nodes_.size ());
+        }
+
+        /** \brief Get the amount of points stored in the octree. */
+        inline std::size_t
+        getPointCount () const
+        {
+          return (pointIndices_.size ());
+        }
+
+        /** \brief Build the linearized octree from the points of the input point cloud. Points with invalid
+          * (NaN, Inf) coordinates are ignored.
+          */
+        void
+        addPointsFromInputCloud ();
+
+        /** \brief Delete the octree structure. */
+        void
+        deleteTree ();
+
+        /** \brief Search for neighbors within a voxel at given point
+          * \param[in] point point addressing a leaf node voxel
+          * \param[out] pointIdx_data the resultant indices of the neighboring voxel points
+          * \return "true" if leaf node exist; "false" otherwise
+          */
+        bool
+        voxelSearch (const PointT& point, std::vector<int>& pointIdx_data) const;
+
+        /** \brief Search for k-nearest neighbors at given query point.
+          * \param[in] p_q the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &p_q, int k, std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Search for k-nearest neighbors at query point
+          * \param[in] index index representing the query point in the dataset given by \a setInputCloud.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        inline int
+        nearestKSearch (int index, int k, std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances) const
+        {
+          return (nearestKSearch (input_->points[index], k, k_indices, k_sqr_distances));
+        }
+
+        /** \brief Search for k-nearest neighbors for a set of query points using multiple threads.
+          * \param[in] cloud the point cloud data containing the query points
+          * \param[in] indices the indices in \a cloud representing the query points
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points for every query point
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points for every query point
+          */
+        void
+        nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                        std::vector<std::vector<int> > &k_indices,
+                        std::vector<std::vector<float> > &k_sqr_distances) const;
+
+        /** \brief Search for all neighbors of query point that are within a given radius.
+          * \param[in] p_q the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT &p_q, const double radius, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const;
+
+        /** \brief Search for all neighbors of query point that are within a given radius.
+          * \param[in] index index representing the query point in the dataset given by \a setInputCloud.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        inline int
+        radiusSearch (int index, const double radius, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const
+        {
+          return (radiusSearch (input_->points[index], radius, k_indices, k_sqr_distances, max_nn));
+        }
+
+        /** \brief Search for all neighbors within a given radius for a set of query points using multiple threads.
+          * \param[in] cloud the point cloud data containing the query points
+          * \param[in] indices the indices in \a cloud representing the query points
+          * \param[in] radius the radius of the sphere bounding all neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points for every query point
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points for every query point
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          */
+        void
+        radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, const double radius,
+                      std::vector<std::vector<int> > &k_indices,
+                      std::vector<std::vector<float> > &k_sqr_distances, unsigned int max_nn = 0) const;
+
+        /** \brief Search for points within rectangular search area
+          * \param[in] min_pt lower corner of search area
+          * \param[in] max_pt upper corner of search area
+          * \param[out] k_indices the resultant point indices
+          * \return number of points found within search area
+          */
+        int
+        boxSearch (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt, std::vector<int> &k_indices) const;
+
+      protected:
+        /** \brief @b Node of the linearized octree
+          * \note Covers the sorted points [pointBegin, pointEnd). Children are stored at
+          * [childBegin, childBegin + childCount) in the node array. Leaf nodes have no children.
+          */
+        struct LinearNode
+        {
+          /** \brief Lower corner of the bounding box of all points in this node (w = 0). */
+          Eigen::Array4f minPt;
+
+          /** \brief Upper corner of the bounding box of all points in this node (w = 0). */
+          Eigen::Array4f maxPt;
+
+          /** \brief First point of this node in the sorted point arrays. */
+          boost::uint32_t pointBegin;
+
+          /** \brief End of the point range of this node in the sorted point arrays. */
+          boost::uint32_t pointEnd;
+
+          /** \brief Index of the first child node in the node array. */
+          boost::uint32_t childBegin;
+
+          /** \brief Amount of child nodes. */
+          unsigned char childCount;
+
+          /** \brief Octant of this node within its parent node. */
+          unsigned char octant;
+
+          EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        };
+
+        /** \brief Comparator for the sorted Morton codes of a node selecting its child octant */
+        struct OctantCompare
+        {
+          OctantCompare (unsigned int shift_arg) : shift (shift_arg)
+          {
+          }
+
+          inline bool
+          operator () (unsigned int octant_arg, const std::pair<boost::uint64_t, int>& code_arg) const
+          {
+            return (octant_arg < ((code_arg.first >> shift) & 7));
+          }
+
+          unsigned int shift;
+        };
+
+        /** \brief Maximum depth of the linearized octree (3 * 21 bits of Morton code) */
+        enum
+        {
+          MAX_TREE_DEPTH = 21
+        };
+
+        /** \brief Generate the Morton code of the voxel containing a point. The child index bit order matches the
+          * octree keys of OctreeBase (x, y, z).
+          * \param[in] point_arg point
+          * \param[out] code_arg Morton code
+          * \return "true" if the point lies within the bounding box of the octree
+          */
+        inline bool
+        genMortonCode (const PointT& point_arg, boost::uint64_t& code_arg) const
+        {
+          const double maxIdx = static_cast<double> ((1u << treeDepth_) - 1);
+          const double x = std::floor ((point_arg.x - minX_) / resolution_);
+          const double y = std::floor ((point_arg.y - minY_) / resolution_);
+          const double z = std::floor ((point_arg.z - minZ_) / resolution_);
+
+          if ((x < 0) || (y < 0) || (z < 0) || (x > maxIdx) || (y > maxIdx) || (z > maxIdx))
+            return (false);
+
+          code_arg = OctreeKey (static_cast<unsigned int> (x), static_cast<unsigned int> (y),
+                                static_cast<unsigned int> (z)).getMortonCode ();
+          return (true);
+        }
+
+        /** \brief Clamp a point into the outermost voxels of the octree. This only has an effect when the extent of
+          * the point cloud exceeds the maximum tree depth; it is applied to both the indexed and the query points.
+          * \param[in,out] point_arg point
+          */
+        inline void
+        clampToTree (PointT& point_arg) const
+        {
+          if (treeDepth_ < MAX_TREE_DEPTH)
+            return;
+
+          const float maxCoord = static_cast<float> (((1u << treeDepth_) - 0.5) * resolution_);
+          point_arg.x = std::min (point_arg.x, static_cast<float> (minX_ + maxCoord));
+          point_arg.y = std::min (point_arg.y, static_cast<float> (minY_ + maxCoord));
+          point_arg.z = std::min (point_arg.z, static_cast<float> (minZ_ + maxCoord));
+        }
+
+        /** \brief Squared distance between a query point and the bounding box of a node (0 if inside)
+          * \param[in] query_arg query point (w = 0)
+          * \param[in] node_arg octree node
+          */
+        static inline float
+        boxSqrDistance (const Eigen::Array4f& query_arg, const LinearNode& node_arg)
+        {
+          return ((node_arg.minPt - query_arg).max (query_arg - node_arg.maxPt).max (Eigen::Array4f::Zero ()).square ().sum ());
+        }
+
+        /** \brief Squared distance between a query point and the farthest corner of the bounding box of a node
+          * \param[in] query_arg query point (w = 0)
+          * \param[in] node_arg octree node
+          */
+        static inline float
+        boxMaxSqrDistance (const Eigen::Array4f& query_arg, const LinearNode& node_arg)
+        {
+          return ((node_arg.minPt - query_arg).abs ().max ((node_arg.maxPt - query_arg).abs ()).square ().sum ());
+        }
+
+        /** \brief Pointer to input point cloud dataset. */
+        PointCloudConstPtr input_;
+
+        /** \brief A pointer to the vector of point indices to use. */
+        IndicesConstPtr indices_;
+
+        /** \brief Octree resolution. */
+        double resolution_;
+
+        /** \brief Octree depth. */
+        unsigned int treeDepth_;
+
+        /** \brief Octree bounding box origin. */
+        double minX_;
+        double minY_;
+        double minZ_;
+
+        /** \brief Octree nodes in breadth-first order; the root node is at index 0. */
+        std::vector<LinearNode, Eigen::aligned_allocator<LinearNode> > nodes_;
+
+        /** \brief Point coordinates (w = 0) sorted by Morton code. */
+        std::vector<Eigen::Array4f, Eigen::aligned_allocator<Eigen::Array4f> > points_;
+
+        /** \brief Indices into the input cloud of the sorted points. */
+        std::vector<int> pointIndices_;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+    };
+  }
+}
+
+#define PCL_INSTANTIATE_OctreePointCloudLinearSearch(T) template class PCL_EXPORTS pcl::octree::OctreePointCloudLinearSearch<T>;
+
+#endif    // PCL_OCTREE_LINEAR_SEARCH_H_
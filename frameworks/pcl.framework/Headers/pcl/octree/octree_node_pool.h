@@ -39,6 +39,8 @@
 #define OCTREE_NODE_POOL_H
 
 #include <vector>
+#include <new>
+#include <typeinfo>
 
 #include <pcl/pcl/pcl_macros.h>
 
@@ -52,6 +54,9 @@ namespace pcl
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     /** \brief @b Octree node pool
      * \note Used to reduce memory allocation and class instantiation events when generating octrees at high rate
+     * \note New nodes are constructed in contiguous slabs (arenas) instead of being allocated individually. Slab nodes
+     * \note are tagged by their dynamic type, so nodes that were not created by the pool (e.g. by deepCopy ()) may
+     * \note still be pushed; they are deleted individually.
      * \author Julius Kammerl (julius@kammerl.de)
      */
     template<typename NodeT>
@@ -81,7 +86,7 @@ namespace pcl
           nodePool_.push_back (node_arg);
         }
 
-        /** \brief Pop node from pool - Allocates new nodes if pool is empty
+        /** \brief Pop node from pool - Allocates a new slab of nodes if pool is empty
         *  \return Pointer to octree node
         *  */
         inline NodeT*
@@ -93,35 +98,86 @@ namespace pcl
           if (!nodePool_.size ())
           {
             // leaf pool is empty
-            // we need to create a new octree leaf class
-            newLeafNode = new NodeT ();
-          }
-          else
-          {
-            // reuse leaf node from branch pool
-            newLeafNode = nodePool_.back ();
-            nodePool_.pop_back ();
-            newLeafNode->reset ();
+            // we need to create a new slab of octree nodes
+            allocateSlab (SLAB_SIZE);
           }
 
+          // reuse leaf node from branch pool
+          newLeafNode = nodePool_.back ();
+          nodePool_.pop_back ();
+          newLeafNode->reset ();
+
           return newLeafNode;
         }
 
+        /** \brief Make the next nodeCount_arg calls to popNode return consecutive nodes of a single slab
+        *  \param nodeCount_arg: amount of nodes
+        *  */
+        void
+        reserveSlab (std::size_t nodeCount_arg)
+        {
+          if (nodeCount_arg)
+            allocateSlab (nodeCount_arg);
+        }
 
         /** \brief Delete all nodes in pool
+        *  \note Every node of a slab has to be returned to the pool before its memory can be released.
         *  */
         void
         deletePool ()
         {
+          vector<void*> slabs;
+
           // delete all branch instances from branch pool
           while (!nodePool_.empty ())
           {
-            delete (nodePool_.back ());
+            NodeT* node = nodePool_.back ();
             nodePool_.pop_back ();
+
+            if (typeid (*node) == typeid (SlabNode<true>))
+            {
+              // the first node of a slab owns its memory
+              slabs.push_back (node);
+              node->~NodeT ();
+            }
+            else if (typeid (*node) == typeid (SlabNode<false>))
+              node->~NodeT ();
+            else
+              delete (node);
           }
+
+          for (std::size_t i = 0; i < slabs.size (); ++i)
+            ::operator delete (slabs[i]);
         }
 
       protected:
+        /** \brief Node constructed in a slab. The first node of every slab is flagged by slabBegin_arg. */
+        template<bool slabBegin_arg>
+          class SlabNode : public NodeT
+          {
+          };
+
+        /** \brief Construct a contiguous slab of nodes and push them so that they are popped in memory order
+        *  \param nodeCount_arg: amount of nodes
+        *  */
+        void
+        allocateSlab (std::size_t nodeCount_arg)
+        {
+          NodeT* slab = static_cast<NodeT*> (::operator new (sizeof (NodeT) * nodeCount_arg));
+
+          new (slab) SlabNode<true> ();
+          for (std::size_t i = 1; i < nodeCount_arg; ++i)
+            new (slab + i) SlabNode<false> ();
+
+          for (std::size_t i = nodeCount_arg; i-- > 0;)
+            nodePool_.push_back (slab + i);
+        }
+
+        enum
+        {
+          SLAB_SIZE = 128
+        };
+
         vector<NodeT*> nodePool_;
       };
 
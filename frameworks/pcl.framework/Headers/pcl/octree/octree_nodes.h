@@ -214,6 +214,16 @@ namespace pcl
           ContainerT::reset ();
         }
 
+        /** \brief Take over container and child pointers of another branch node without copying its subtree
+         *  \param source_arg: branch node to copy from
+         * */
+        inline void
+        shallowCopy (const OctreeBranchNode& source_arg)
+        {
+          ContainerT::operator= (source_arg);
+          memcpy (childNodeArray_, source_arg.childNodeArray_, sizeof(childNodeArray_));
+        }
+
         /** \brief Access operator.
          *  \param childIdx_arg: index to child node
          *  \return OctreeNode pointer
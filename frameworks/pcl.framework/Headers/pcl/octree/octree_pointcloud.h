@@ -203,10 +203,20 @@ namespace pcl
           return this->octreeDepth_;
         }
 
-        /** \brief Add points from input point cloud to octree. */
+        /** \brief Add points from input point cloud to octree.
+         * \note Points are added in bulk: the bounding box is grown point by point exactly as addPointIdx would, then
+         * the octree keys are computed, radix-sorted in Morton order and the octree is built in a single pass over the
+         * sorted keys. The resulting octree is the same as the one built by adding the points one by one.
+         */
         void
         addPointsFromInputCloud ();
 
+        /** \brief Add points from input point cloud to octree, computing the octree keys with several threads.
+         * \param[in] nr_threads the number of hardware threads to use (0 is treated as 1)
+         */
+        void
+        addPointsFromInputCloud (unsigned int nr_threads);
+
         /** \brief Add point at given index from input point cloud to octree. Index will be also added to indices vector.
          * \param[in] pointIdx_arg index of point to be added
          * \param[in] indices_arg pointer to indices vector of the dataset (given by \a setInputCloud)
@@ -427,6 +437,13 @@ namespace pcl
         void
         getKeyBitSize ();
 
+        /** \brief Stable LSD radix sort of (Morton code, point index) pairs
+         * \param[in,out] codes_arg pairs to be sorted by Morton code
+         * \param[in] bitCount_arg amount of valid lower bits of the Morton codes
+         */
+        static void
+        sortByMortonCode (std::vector<std::pair<boost::uint64_t, int> >& codes_arg, unsigned int bitCount_arg);
+
         /** \brief Grow the bounding box/octree until point fits
          * \param[in] pointIdx_arg point that should be within bounding box;
          */
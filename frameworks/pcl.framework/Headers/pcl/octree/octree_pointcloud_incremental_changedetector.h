@@ -0,0 +1,349 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef OCTREE_INCREMENTAL_CHANGEDETECTOR_H
+#define OCTREE_INCREMENTAL_CHANGEDETECTOR_H
+
+#include <vector>
+#include <utility>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <pcl/pcl/point_cloud.h>
+#include <pcl/pcl/point_types.h>
+
+namespace pcl
+{
+  namespace octree
+  {
+
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /** \brief @b Incremental pointcloud change detector class
+     *  \note Keeps a persistent voxel hash map with the point counts of all occupied voxels. Every update reports the
+     *  \note added, removed and modified voxels as deltas instead of rebuilding and comparing two octree buffers.
+     *  \note Voxels are hashed into shards which are updated in parallel.
+     *  \note addPointsFromInputCloud () replaces the voxel map by the content of a new frame, whereas updateVoxels ()
+     *  \note only applies point insertions and removals, so that mostly static scenes pay only for what changed.
+     *  \note typename: PointT: type of point used in pointcloud
+     *  \ingroup octree
+     */
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT>
+    class OctreePointCloudIncrementalChangeDetector
+    {
+      public:
+        typedef boost::shared_ptr<std::vector<int> > IndicesPtr;
+        typedef boost::shared_ptr<const std::vector<int> > IndicesConstPtr;
+
+        typedef pcl::PointCloud<PointT> PointCloud;
+        typedef boost::shared_ptr<PointCloud> PointCloudPtr;
+        typedef boost::shared_ptr<const PointCloud> PointCloudConstPtr;
+
+        typedef boost::shared_ptr<OctreePointCloudIncrementalChangeDetector<PointT> > Ptr;
+        typedef boost::shared_ptr<const OctreePointCloudIncrementalChangeDetector<PointT> > ConstPtr;
+
+        // Eigen aligned allocator
+        typedef std::vector<PointT, Eigen::aligned_allocator<PointT> > AlignedPointTVector;
+
+        /** \brief Constructor.
+         *  \param resolution_arg:  voxel resolution
+         * */
+        OctreePointCloudIncrementalChangeDetector (const double resolution_arg) :
+          input_ (), indices_ (), resolution_ (resolution_arg), frameStamp_ (0), shards_ (SHARD_COUNT), threads_ (1)
+        {
+          assert (resolution_arg > 0.0f);
+        }
+
+        /** \brief Empty class deconstructor. */
+        virtual ~OctreePointCloudIncrementalChangeDetector ()
+        {
+        }
+
+        /** \brief Provide a pointer to the input data set.
+         * \param[in] cloud_arg the const boost shared pointer to a PointCloud message
+         * \param[in] indices_arg the point indices subset that is to be used from \a cloud - if 0 the whole point cloud is used
+         */
+        inline void setInputCloud (const PointCloudConstPtr &cloud_arg,
+            const IndicesConstPtr &indices_arg = IndicesConstPtr ())
+        {
+          input_ = cloud_arg;
+          indices_ = indices_arg;
+        }
+
+        /** \brief Get a pointer to the input point cloud dataset. */
+        inline PointCloudConstPtr getInputCloud () const
+        {
+          return (input_);
+        }
+
+        /** \brief Set the number of threads used for updating the voxel map.
+         * \param[in] nr_threads the number of hardware threads to use
+         */
+        inline void setNumberOfThreads (unsigned int nr_threads)
+        {
+          if (nr_threads == 0)
+            nr_threads = 1;
+          threads_ = nr_threads;
+        }
+
+        /** \brief Get voxel resolution. */
+        inline double getResolution () const
+        {
+          return (resolution_);
+        }
+
+        /** \brief Get the amount of occupied voxels. */
+        std::size_t
+        getVoxelCount () const;
+
+        /** \brief Replace the voxel map by the points of the input cloud and record the changes to the previous frame. */
+        void
+        addPointsFromInputCloud ();
+
+        /** \brief Insert and remove points from the voxel map and record the resulting changes.
+         *  \note Removed points have to be given with the coordinates they were inserted with.
+         *  \param insertedPoints_arg: points to be added to the voxel map
+         *  \param removedPoints_arg: points to be removed from the voxel map
+         * */
+        void
+        updateVoxels (const PointCloud& insertedPoints_arg, const PointCloud& removedPoints_arg);
+
+        /** \brief Remove all voxels without recording changes. */
+        void
+        deleteVoxels ();
+
+        /** \brief Get the point count of the voxel at a given point.
+         *  \param point_arg: point addressing a voxel
+         *  \return amount of points in voxel; 0 if voxel is not occupied
+         * */
+        unsigned int
+        getVoxelDensityAtPoint (const PointT& point_arg) const;
+
+        /** \brief Get the centers of all voxels that became occupied during the last update.
+         *  \param voxelCenterList_arg: results are written to this vector of PointT elements
+         *  \return number of voxels
+         * */
+        inline int
+        getAddedVoxelCenters (AlignedPointTVector &voxelCenterList_arg) const
+        {
+          return (getChangedVoxelCenters (ADDED_VOXEL, voxelCenterList_arg));
+        }
+
+        /** \brief Get the centers of all voxels that became empty during the last update.
+         *  \param voxelCenterList_arg: results are written to this vector of PointT elements
+         *  \return number of voxels
+         * */
+        inline int
+        getRemovedVoxelCenters (AlignedPointTVector &voxelCenterList_arg) const
+        {
+          return (getChangedVoxelCenters (REMOVED_VOXEL, voxelCenterList_arg));
+        }
+
+        /** \brief Get the centers of all voxels that stayed occupied but whose points changed during the last update.
+         *  \param voxelCenterList_arg: results are written to this vector of PointT elements
+         *  \return number of voxels
+         * */
+        inline int
+        getModifiedVoxelCenters (AlignedPointTVector &voxelCenterList_arg) const
+        {
+          return (getChangedVoxelCenters (MODIFIED_VOXEL, voxelCenterList_arg));
+        }
+
+        /** \brief Get indices of all points that fall into voxels which became occupied during the last update.
+         * \note Indices refer to the input cloud (addPointsFromInputCloud) or to the inserted points (updateVoxels).
+         * \param indicesVector_arg: results are written to this vector of int indices
+         * \param minPointsPerLeaf_arg: minimum amount of new points required within a voxel to become serialized.
+         * \return number of point indices
+         */
+        int
+        getPointIndicesFromNewVoxels (std::vector<int> &indicesVector_arg, const int minPointsPerLeaf_arg = 0) const;
+
+      protected:
+        /** \brief Type of a voxel change */
+        enum VoxelChangeType
+        {
+          ADDED_VOXEL = 0, REMOVED_VOXEL = 1, MODIFIED_VOXEL = 2
+        };
+
+        /** \brief Voxel map entry */
+        struct VoxelEntry
+        {
+          VoxelEntry () : pointCount (0), frameStamp (0)
+          {
+          }
+
+          /** \brief Amount of points within voxel. */
+          unsigned int pointCount;
+
+          /** \brief Last frame update that contained this voxel. */
+          unsigned int frameStamp;
+        };
+
+        typedef boost::unordered_map<boost::uint64_t, VoxelEntry> VoxelMap;
+        typedef std::pair<boost::uint64_t, int> VoxelPoint;
+
+        /** \brief Part of the voxel map that is updated by a single thread */
+        struct VoxelShard
+        {
+          /** \brief Occupied voxels. */
+          VoxelMap voxels;
+
+          /** \brief Inserted points of last update sorted by voxel code. */
+          std::vector<VoxelPoint> insertedPoints;
+
+          /** \brief Removed points of last update sorted by voxel code. */
+          std::vector<VoxelPoint> removedPoints;
+
+          /** \brief Voxel codes of the changes of last update, indexed by VoxelChangeType. */
+          std::vector<boost::uint64_t> changes[3];
+
+          /** \brief Ranges of inserted points within voxels that were added by last update. */
+          std::vector<std::pair<std::size_t, std::size_t> > addedRanges;
+        };
+
+        enum
+        {
+          SHARD_COUNT = 64,
+          VOXEL_CODE_BITS = 21,
+          VOXEL_CODE_OFFSET = 1 << (VOXEL_CODE_BITS - 1)
+        };
+
+        /** \brief Generate voxel code for point
+         *  \param point_arg: point
+         *  \param code_arg: resulting voxel code
+         *  \return "true" if point is valid and within the addressable voxel range
+         * */
+        inline bool
+        genVoxelCode (const PointT& point_arg, boost::uint64_t& code_arg) const
+        {
+          if (!isFinite (point_arg))
+            return (false);
+
+          const double maxIdx = static_cast<double> ((1 << VOXEL_CODE_BITS) - 1);
+          const double x = std::floor (point_arg.x / resolution_) + VOXEL_CODE_OFFSET;
+          const double y = std::floor (point_arg.y / resolution_) + VOXEL_CODE_OFFSET;
+          const double z = std::floor (point_arg.z / resolution_) + VOXEL_CODE_OFFSET;
+
+          if ((x < 0) || (y < 0) || (z < 0) || (x > maxIdx) || (y > maxIdx) || (z > maxIdx))
+            return (false);
+
+          code_arg = (static_cast<boost::uint64_t> (x) << (2 * VOXEL_CODE_BITS))
+                   | (static_cast<boost::uint64_t> (y) << VOXEL_CODE_BITS)
+                   |  static_cast<boost::uint64_t> (z);
+          return (true);
+        }
+
+        /** \brief Generate voxel center from voxel code
+         *  \param code_arg: voxel code
+         *  \param point_arg: voxel center
+         * */
+        inline void
+        genVoxelCenter (boost::uint64_t code_arg, PointT& point_arg) const
+        {
+          const boost::uint64_t mask = (1 << VOXEL_CODE_BITS) - 1;
+          const int x = static_cast<int> ((code_arg >> (2 * VOXEL_CODE_BITS)) & mask) - VOXEL_CODE_OFFSET;
+          const int y = static_cast<int> ((code_arg >> VOXEL_CODE_BITS) & mask) - VOXEL_CODE_OFFSET;
+          const int z = static_cast<int> (code_arg & mask) - VOXEL_CODE_OFFSET;
+
+          point_arg.x = static_cast<float> ((x + 0.5) * resolution_);
+          point_arg.y = static_cast<float> ((y + 0.5) * resolution_);
+          point_arg.z = static_cast<float> ((z + 0.5) * resolution_);
+        }
+
+        /** \brief Select the shard of a voxel
+         *  \param code_arg: voxel code
+         *  \return shard index
+         * */
+        static inline unsigned int
+        getShardIdx (boost::uint64_t code_arg)
+        {
+          // mix all coordinate bits into the shard index
+          code_arg ^= code_arg >> 29;
+          code_arg *= 0xBF58476D1CE4E5B9ULL;
+          code_arg ^= code_arg >> 32;
+          return (static_cast<unsigned int> (code_arg & (SHARD_COUNT - 1)));
+        }
+
+        /** \brief Compute voxel codes of points in parallel, distribute them to the shards and sort them
+         *  \param cloud_arg: point cloud
+         *  \param indices_arg: indices of points in cloud_arg; if 0 all points are used
+         *  \param removedPoints_arg: if "true", points are assigned to the removed point lists of the shards
+         * */
+        void
+        distributePoints (const PointCloud& cloud_arg, const std::vector<int>* indices_arg, bool removedPoints_arg);
+
+        /** \brief Apply the sorted points of a shard to its voxels and record the changes
+         *  \param shard_arg: shard to be updated
+         *  \param replace_arg: if "true", voxels that do not contain any inserted point are removed (frame update)
+         * */
+        void
+        updateShard (VoxelShard& shard_arg, bool replace_arg);
+
+        /** \brief Collect voxel centers of all changes of a type
+         *  \param type_arg: type of change
+         *  \param voxelCenterList_arg: results are written to this vector of PointT elements
+         *  \return number of voxels
+         * */
+        int
+        getChangedVoxelCenters (VoxelChangeType type_arg, AlignedPointTVector &voxelCenterList_arg) const;
+
+        /** \brief Pointer to input point cloud dataset. */
+        PointCloudConstPtr input_;
+
+        /** \brief A pointer to the vector of point indices to use. */
+        IndicesConstPtr indices_;
+
+        /** \brief Voxel resolution. */
+        double resolution_;
+
+        /** \brief Counter of frame updates. */
+        unsigned int frameStamp_;
+
+        /** \brief Voxel map shards. */
+        std::vector<VoxelShard> shards_;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+    };
+  }
+}
+
+#define PCL_INSTANTIATE_OctreePointCloudIncrementalChangeDetector(T) template class PCL_EXPORTS pcl::octree::OctreePointCloudIncrementalChangeDetector<T>;
+
+#endif
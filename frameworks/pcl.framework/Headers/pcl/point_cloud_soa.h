@@ -0,0 +1,409 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#ifndef PCL_POINT_CLOUD_SOA_H_
+#define PCL_POINT_CLOUD_SOA_H_
+
+#include <pcl/pcl/point_cloud.h>
+#include <pcl/pcl/point_types.h>
+#include <boost/mpl/find.hpp>
+#include <boost/mpl/size.hpp>
+#include <cstring>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief PointCloudSoA stores the points of a PointCloud<PointT> as a structure of arrays: every field registered
+    * for \a PointT (x, y, z, rgb, normal_x, curvature, ...) lives in its own channel, so that kernels which only touch
+    * a few fields do not pull whole points through the cache.
+    *
+    * A field with several components (e.g. a histogram) is stored component by component. Every component starts on a
+    * 16 byte boundary and is padded to a whole number of 16 byte blocks, so that it can be processed four floats at a
+    * time with packed Eigen arrays (SSE or NEON). The contents of the padding are unspecified.
+    *
+    * Channels are accessed through their field tag, e.g. getChannel<pcl::fields::x> () or getChannelMap<pcl::fields::x> ().
+    * Conversions from and to PointCloud<PointT> go through the point_traits field registration.
+    *
+    * \ingroup common
+    */
+  template <typename PointT>
+  class PointCloudSoA
+  {
+    public:
+      typedef typename traits::fieldList<PointT>::type FieldList;
+      typedef std::vector<unsigned char, Eigen::aligned_allocator<unsigned char> > ChannelBuffer;
+
+      typedef boost::shared_ptr<PointCloudSoA<PointT> > Ptr;
+      typedef boost::shared_ptr<const PointCloudSoA<PointT> > ConstPtr;
+
+      /** \brief The scalar type of the channel of a field. */
+      template <typename Tag>
+      struct ChannelType
+      {
+        typedef typename traits::datatype<PointT, Tag>::decomposed::type type;
+      };
+
+      /** \brief Default constructor. Creates an empty cloud. */
+      PointCloudSoA ()
+        : header (), width (0), height (0), is_dense (true)
+        , sensor_origin_ (Eigen::Vector4f::Zero ()), sensor_orientation_ (Eigen::Quaternionf::Identity ())
+        , size_ (0), channels_ (boost::mpl::size<FieldList>::value)
+      {
+      }
+
+      /** \brief Create a cloud with the points of an array of structures cloud.
+        * \param[in] cloud the cloud to copy
+        */
+      explicit PointCloudSoA (const PointCloud<PointT> &cloud)
+        : header (), width (0), height (0), is_dense (true)
+        , sensor_origin_ (Eigen::Vector4f::Zero ()), sensor_orientation_ (Eigen::Quaternionf::Identity ())
+        , size_ (0), channels_ (boost::mpl::size<FieldList>::value)
+      {
+        fromPointCloud (cloud);
+      }
+
+      /** \brief The number of points. */
+      inline size_t
+      size () const { return (size_); }
+
+      /** \brief True if the cloud has no points. */
+      inline bool
+      empty () const { return (size_ == 0); }
+
+      /** \brief True if the cloud is organized (height > 1). */
+      inline bool
+      isOrganized () const { return (height > 1); }
+
+      /** \brief Resize the cloud to \a n points, keeping the values of the first points. The cloud becomes
+        * unorganized, with width set to \a n.
+        * \param[in] n the new number of points
+        */
+      void
+      resize (size_t n)
+      {
+        if (n != size_)
+        {
+          std::vector<ChannelBuffer> channels (channels_.size ());
+          for_each_type<FieldList> (ResizeChannel (channels_, channels, size_, n));
+          channels_.swap (channels);
+          size_ = n;
+        }
+        width = static_cast<uint32_t> (n);
+        height = 1;
+      }
+
+      /** \brief Remove all points. */
+      inline void
+      clear ()
+      {
+        resize (0);
+      }
+
+      /** \brief Get the number of elements between two components of the channel of a field. The length of a
+        * component including its padding.
+        */
+      template <typename Tag> inline size_t
+      getChannelStride () const
+      {
+        return (getStride<typename ChannelType<Tag>::type> (size_));
+      }
+
+      /** \brief Get a pointer to one component of the channel of a field.
+        * \param[in] component the component of a multi-valued field
+        */
+      template <typename Tag> inline typename ChannelType<Tag>::type*
+      getChannel (unsigned int component = 0)
+      {
+        typedef typename ChannelType<Tag>::type T;
+        ChannelBuffer &channel = channels_[getChannelIndex<Tag> ()];
+        return (channel.empty () ? NULL : reinterpret_cast<T*> (&channel[0]) + component * getChannelStride<Tag> ());
+      }
+
+      /** \brief Get a pointer to one component of the channel of a field.
+        * \param[in] component the component of a multi-valued field
+        */
+      template <typename Tag> inline const typename ChannelType<Tag>::type*
+      getChannel (unsigned int component = 0) const
+      {
+        typedef typename ChannelType<Tag>::type T;
+        const ChannelBuffer &channel = channels_[getChannelIndex<Tag> ()];
+        return (channel.empty () ? NULL : reinterpret_cast<const T*> (&channel[0]) + component * getChannelStride<Tag> ());
+      }
+
+      /** \brief Get an aligned Eigen column view of one component of the channel of a field, without the padding.
+        * \param[in] component the component of a multi-valued field
+        */
+      template <typename Tag> inline Eigen::Map<Eigen::Array<typename ChannelType<Tag>::type, Eigen::Dynamic, 1>, Eigen::Aligned>
+      getChannelMap (unsigned int component = 0)
+      {
+        return (Eigen::Map<Eigen::Array<typename ChannelType<Tag>::type, Eigen::Dynamic, 1>, Eigen::Aligned>
+                (getChannel<Tag> (component), size_));
+      }
+
+      /** \brief Get an aligned Eigen column view of one component of the channel of a field, without the padding.
+        * \param[in] component the component of a multi-valued field
+        */
+      template <typename Tag> inline Eigen::Map<const Eigen::Array<typename ChannelType<Tag>::type, Eigen::Dynamic, 1>, Eigen::Aligned>
+      getChannelMap (unsigned int component = 0) const
+      {
+        return (Eigen::Map<const Eigen::Array<typename ChannelType<Tag>::type, Eigen::Dynamic, 1>, Eigen::Aligned>
+                (getChannel<Tag> (component), size_));
+      }
+
+      /** \brief Shortcuts for the coordinate channels of point types with x, y and z fields. */
+      inline float* getX () { return (getChannel<fields::x> ()); }
+      inline float* getY () { return (getChannel<fields::y> ()); }
+      inline float* getZ () { return (getChannel<fields::z> ()); }
+      inline const float* getX () const { return (getChannel<fields::x> ()); }
+      inline const float* getY () const { return (getChannel<fields::y> ()); }
+      inline const float* getZ () const { return (getChannel<fields::z> ()); }
+
+      /** \brief Gather the fields of one point.
+        * \param[in] index the index of the point
+        * \param[out] point the point
+        */
+      inline void
+      getPoint (size_t index, PointT &point) const
+      {
+        for_each_type<FieldList> (PointToStruct (*this, index, point));
+      }
+
+      /** \brief Scatter the fields of one point.
+        * \param[in] index the index of the point
+        * \param[in] point the point
+        */
+      inline void
+      setPoint (size_t index, const PointT &point)
+      {
+        for_each_type<FieldList> (PointFromStruct (*this, index, point));
+      }
+
+      /** \brief Replace the points and the properties of the cloud with those of an array of structures cloud.
+        * \param[in] cloud the cloud to copy
+        */
+      void
+      fromPointCloud (const PointCloud<PointT> &cloud)
+      {
+        resize (cloud.points.size ());
+        header = cloud.header;
+        width = cloud.width;
+        height = cloud.height;
+        is_dense = cloud.is_dense;
+        sensor_origin_ = cloud.sensor_origin_;
+        sensor_orientation_ = cloud.sensor_orientation_;
+        for_each_type<FieldList> (ChannelFromPoints (*this, cloud));
+      }
+
+      /** \brief Write the points and the properties of the cloud to an array of structures cloud.
+        * \param[out] cloud the resultant cloud
+        */
+      void
+      toPointCloud (PointCloud<PointT> &cloud) const
+      {
+        cloud.points.resize (size_);
+        cloud.header = header;
+        cloud.width = width;
+        cloud.height = height;
+        cloud.is_dense = is_dense;
+        cloud.sensor_origin_ = sensor_origin_;
+        cloud.sensor_orientation_ = sensor_orientation_;
+        for_each_type<FieldList> (ChannelToPoints (*this, cloud));
+      }
+
+      /** \brief The point cloud header. */
+      std_msgs::Header header;
+
+      /** \brief The point cloud width (if organized as an image-structure). */
+      uint32_t width;
+
+      /** \brief The point cloud height (if organized as an image-structure). */
+      uint32_t height;
+
+      /** \brief True if no points are invalid (e.g., have NaN or Inf values). */
+      bool is_dense;
+
+      /** \brief Sensor acquisition pose (origin/translation). */
+      Eigen::Vector4f sensor_origin_;
+
+      /** \brief Sensor acquisition pose (rotation). */
+      Eigen::Quaternionf sensor_orientation_;
+
+    protected:
+      /** \brief Get the position of a field in the field list of \a PointT. */
+      template <typename Tag> static inline size_t
+      getChannelIndex ()
+      {
+        return (boost::mpl::find<FieldList, Tag>::type::pos::value);
+      }
+
+      /** \brief Get the length of a component of \a n values of type T, rounded up to a whole number of 16 byte blocks. */
+      template <typename T> static inline size_t
+      getStride (size_t n)
+      {
+        const size_t block = sizeof (T) < 16 ? 16 / sizeof (T) : 1;
+        return ((n + block - 1) / block * block);
+      }
+
+      /** \brief The byte address of a component of a field within a point. */
+      template <typename Tag> static inline const unsigned char*
+      getFieldAddress (const PointT &point, unsigned int component)
+      {
+        return (reinterpret_cast<const unsigned char*> (&point) + traits::offset<PointT, Tag>::value +
+                component * sizeof (typename ChannelType<Tag>::type));
+      }
+
+      /** \brief The byte address of a component of a field within a point. */
+      template <typename Tag> static inline unsigned char*
+      getFieldAddress (PointT &point, unsigned int component)
+      {
+        return (reinterpret_cast<unsigned char*> (&point) + traits::offset<PointT, Tag>::value +
+                component * sizeof (typename ChannelType<Tag>::type));
+      }
+
+      struct ResizeChannel
+      {
+        ResizeChannel (const std::vector<ChannelBuffer> &old_channels, std::vector<ChannelBuffer> &channels,
+                       size_t old_size, size_t size)
+          : old_channels_ (old_channels), channels_ (channels), old_size_ (old_size), size_ (size) {}
+
+        template <typename Tag> inline void
+        operator () ()
+        {
+          typedef typename ChannelType<Tag>::type T;
+          const size_t count = traits::datatype<PointT, Tag>::size;
+          const size_t old_stride = getStride<T> (old_size_), stride = getStride<T> (size_);
+          const size_t keep = std::min (old_size_, size_) * sizeof (T);
+          const ChannelBuffer &old_channel = old_channels_[getChannelIndex<Tag> ()];
+          ChannelBuffer &channel = channels_[getChannelIndex<Tag> ()];
+          channel.resize (count * stride * sizeof (T));
+          for (size_t c = 0; keep > 0 && c < count; ++c)
+            memcpy (&channel[c * stride * sizeof (T)], &old_channel[c * old_stride * sizeof (T)], keep);
+        }
+
+        const std::vector<ChannelBuffer> &old_channels_;
+        std::vector<ChannelBuffer> &channels_;
+        size_t old_size_, size_;
+      };
+
+      struct ChannelFromPoints
+      {
+        ChannelFromPoints (PointCloudSoA &soa, const PointCloud<PointT> &cloud) : soa_ (soa), cloud_ (cloud) {}
+
+        template <typename Tag> inline void
+        operator () ()
+        {
+          typedef typename ChannelType<Tag>::type T;
+          for (unsigned int c = 0; c < traits::datatype<PointT, Tag>::size; ++c)
+          {
+            T* channel = soa_.template getChannel<Tag> (c);
+            for (size_t i = 0; i < cloud_.points.size (); ++i)
+              memcpy (&channel[i], getFieldAddress<Tag> (cloud_.points[i], c), sizeof (T));
+          }
+        }
+
+        PointCloudSoA &soa_;
+        const PointCloud<PointT> &cloud_;
+      };
+
+      struct ChannelToPoints
+      {
+        ChannelToPoints (const PointCloudSoA &soa, PointCloud<PointT> &cloud) : soa_ (soa), cloud_ (cloud) {}
+
+        template <typename Tag> inline void
+        operator () ()
+        {
+          typedef typename ChannelType<Tag>::type T;
+          for (unsigned int c = 0; c < traits::datatype<PointT, Tag>::size; ++c)
+          {
+            const T* channel = soa_.template getChannel<Tag> (c);
+            for (size_t i = 0; i < cloud_.points.size (); ++i)
+              memcpy (getFieldAddress<Tag> (cloud_.points[i], c), &channel[i], sizeof (T));
+          }
+        }
+
+        const PointCloudSoA &soa_;
+        PointCloud<PointT> &cloud_;
+      };
+
+      struct PointToStruct
+      {
+        PointToStruct (const PointCloudSoA &soa, size_t index, PointT &point) : soa_ (soa), index_ (index), point_ (point) {}
+
+        template <typename Tag> inline void
+        operator () ()
+        {
+          for (unsigned int c = 0; c < traits::datatype<PointT, Tag>::size; ++c)
+            memcpy (getFieldAddress<Tag> (point_, c), soa_.template getChannel<Tag> (c) + index_, sizeof (typename ChannelType<Tag>::type));
+        }
+
+        const PointCloudSoA &soa_;
+        size_t index_;
+        PointT &point_;
+      };
+
+      struct PointFromStruct
+      {
+        PointFromStruct (PointCloudSoA &soa, size_t index, const PointT &point) : soa_ (soa), index_ (index), point_ (point) {}
+
+        template <typename Tag> inline void
+        operator () ()
+        {
+          for (unsigned int c = 0; c < traits::datatype<PointT, Tag>::size; ++c)
+            memcpy (soa_.template getChannel<Tag> (c) + index_, getFieldAddress<Tag> (point_, c),
+                    sizeof (typename ChannelType<Tag>::type));
+        }
+
+        PointCloudSoA &soa_;
+        size_t index_;
+        const PointT &point_;
+      };
+
+      /** \brief The number of points. */
+      size_t size_;
+
+      /** \brief One buffer per field, in the order of the field list. */
+      std::vector<ChannelBuffer> channels_;
+
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+}
+
+#endif  //#ifndef PCL_POINT_CLOUD_SOA_H_
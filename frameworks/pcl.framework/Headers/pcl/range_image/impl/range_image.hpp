@@ -219,6 +219,31 @@ RangeImage::createFromPointCloudWithViewpoints (const PointCloudTypeWithViewpoin
                         sensor_pose, coordinate_frame, noise_level, min_range, border_size);
 }
 
+/////////////////////////////////////////////////////////////////////////
+template <typename PointCloudType> void
+RangeImage::updateFromPointCloud (const PointCloudType& point_cloud, float noise_level, float min_range)
+{
+  std::fill (points.begin (), points.end (), unobserved_point);
+  
+  int top=height, right=-1, bottom=-1, left=width;
+  doZBuffer (point_cloud, noise_level, min_range, top, right, bottom, left);
+  
+  recalculate3DPointPositions ();
+}
+
+/////////////////////////////////////////////////////////////////////////
+template <typename PointCloudType> void
+RangeImage::updateFromPointCloud (const PointCloudType& point_cloud, RangeImageProjectionTable& projection_table,
+                                  float noise_level, float min_range)
+{
+  std::fill (points.begin (), points.end (), unobserved_point);
+  
+  int top=height, right=-1, bottom=-1, left=width;
+  doZBuffer (point_cloud, noise_level, min_range, top, right, bottom, left);
+  
+  recalculate3DPointPositions (projection_table);
+}
+
 /////////////////////////////////////////////////////////////////////////
 template <typename PointCloudType> void 
 RangeImage::doZBuffer (const PointCloudType& point_cloud, float noise_level, float min_range, int& top, int& right, int& bottom, int& left)
@@ -226,102 +251,200 @@ RangeImage::doZBuffer (const PointCloudType& point_cloud, float noise_level, flo
   typedef typename PointCloudType::PointType PointType2;
   const typename pcl::PointCloud<PointType2>::VectorType &points2 = point_cloud.points;
   
-  unsigned int size = width*height;
-  int* counters = new int[size];
-  ERASE_ARRAY (counters, size);
+  int no_of_points = static_cast<int> (points2.size ()),
+      image_width  = static_cast<int> (width),
+      image_height = static_cast<int> (height);
   
-  top=height; right=-1; bottom=-1; left=width;
-  
-  float x_real, y_real, range_of_current_point;
-  int x, y;
-  for (typename pcl::PointCloud<PointType2>::VectorType::const_iterator it=points2.begin (); it!=points2.end (); ++it)
+  // Project all points into the image, marking the ones that do not fall into it with row -1
+  std::vector<float> x_reals (no_of_points), y_reals (no_of_points), ranges (no_of_points);
+  std::vector<int> rows (no_of_points);
+# pragma omp parallel for schedule (static) num_threads (max_no_of_threads)
+  for (int point_idx = 0; point_idx < no_of_points; ++point_idx)
   {
-    if (!isFinite (*it))  // Check for NAN etc
+    rows[point_idx] = -1;
+    if (!isFinite (points2[point_idx]))  // Check for NAN etc
       continue;
-    Vector3fMapConst current_point = it->getVector3fMap ();
+    Vector3fMapConst current_point = points2[point_idx].getVector3fMap ();
     
-    this->getImagePoint (current_point, x_real, y_real, range_of_current_point);
-    this->real2DToInt2D (x_real, y_real, x, y);
+    int x, y;
+    this->getImagePoint (current_point, x_reals[point_idx], y_reals[point_idx], ranges[point_idx]);
+    this->real2DToInt2D (x_reals[point_idx], y_reals[point_idx], x, y);
     
-    if (range_of_current_point < min_range|| !isInImage (x, y))
+    if (ranges[point_idx] < min_range || !isInImage (x, y))
       continue;
-    //std::cout << " ("<<current_point[0]<<", "<<current_point[1]<<", "<<current_point[2]<<") falls into pixel "<<x<<","<<y<<".\n";
-    
-    // Do some minor interpolation by checking the three closest neighbors to the point, that are not filled yet.
-    int floor_x = pcl_lrint (floor (x_real)), floor_y = pcl_lrint (floor (y_real)),
-        ceil_x  = pcl_lrint (ceil (x_real)),  ceil_y  = pcl_lrint (ceil (y_real));
-    
-    int neighbor_x[4], neighbor_y[4];
-    neighbor_x[0]=floor_x; neighbor_y[0]=floor_y;
-    neighbor_x[1]=floor_x; neighbor_y[1]=ceil_y;
-    neighbor_x[2]=ceil_x;  neighbor_y[2]=floor_y;
-    neighbor_x[3]=ceil_x;  neighbor_y[3]=ceil_y;
-    //std::cout << x_real<<","<<y_real<<": ";
+    rows[point_idx] = y;
+  }
+  
+  // Sort the points by image row, keeping their order within a row
+  std::vector<int> row_offsets (image_height+2, 0);
+  for (int point_idx = 0; point_idx < no_of_points; ++point_idx)
+    if (rows[point_idx] >= 0)
+      ++row_offsets[rows[point_idx]+2];
+  for (int y = 0; y < image_height; ++y)
+    row_offsets[y+2] += row_offsets[y+1];
+  std::vector<int> sorted_points (row_offsets[image_height+1]);
+  for (int point_idx = 0; point_idx < no_of_points; ++point_idx)
+    if (rows[point_idx] >= 0)
+      sorted_points[row_offsets[rows[point_idx]+1]++] = point_idx;
+  
+  // The image is integrated in bands of rows. A pixel only depends on the points falling into it, in the order they
+  // are given, and on the minimum range of the points it neighbors, so every band only has to look at the points of
+  // its rows and of the two rows adjacent to it, and the result is the same as integrating the points one by one.
+  const int band_height = 8;
+  int no_of_bands = (image_height + band_height - 1) / band_height;
+  std::vector<int> counters (width*height, 0);
+  std::vector<float> neighbor_ranges (width*height, std::numeric_limits<float>::infinity ());
+  std::vector<int> band_bounds (4*no_of_bands);
+  
+# pragma omp parallel for schedule (dynamic, 1) num_threads (max_no_of_threads)
+  for (int band = 0; band < no_of_bands; ++band)
+  {
+    int band_top = band*band_height, band_bottom = (std::min) (band_top+band_height, image_height) - 1;
+    int b_top=image_height, b_right=-1, b_bottom=-1, b_left=image_width;
     
-    for (int i=0; i<4; ++i)
+    int first = row_offsets[(std::max) (band_top-1, 0)],
+        last  = row_offsets[(std::min) (band_bottom+1, image_height-1) + 1];
+    for (int sorted_idx = first; sorted_idx < last; ++sorted_idx)
     {
-      int n_x=neighbor_x[i], n_y=neighbor_y[i];
-      //std::cout << n_x<<","<<n_y<<" ";
-      if (n_x==x && n_y==y)
-        continue;
-      if (isInImage (n_x, n_y))
+      int point_idx = sorted_points[sorted_idx];
+      float x_real = x_reals[point_idx], y_real = y_reals[point_idx], range_of_current_point = ranges[point_idx];
+      int x, y;
+      this->real2DToInt2D (x_real, y_real, x, y);
+      
+      // Do some minor interpolation by checking the three closest neighbors to the point, that are not filled yet.
+      int floor_x = pcl_lrint (floor (x_real)), floor_y = pcl_lrint (floor (y_real)),
+          ceil_x  = pcl_lrint (ceil (x_real)),  ceil_y  = pcl_lrint (ceil (y_real));
+      
+      int neighbor_x[4], neighbor_y[4];
+      neighbor_x[0]=floor_x; neighbor_y[0]=floor_y;
+      neighbor_x[1]=floor_x; neighbor_y[1]=ceil_y;
+      neighbor_x[2]=ceil_x;  neighbor_y[2]=floor_y;
+      neighbor_x[3]=ceil_x;  neighbor_y[3]=ceil_y;
+      
+      for (int i=0; i<4; ++i)
       {
-        int neighbor_array_pos = n_y*width + n_x;
-        if (counters[neighbor_array_pos]==0)
+        int n_x=neighbor_x[i], n_y=neighbor_y[i];
+        if (n_x==x && n_y==y)
+          continue;
+        if (n_y >= band_top && n_y <= band_bottom && isInImage (n_x, n_y))
         {
-          float& neighbor_range = points[neighbor_array_pos].range;
-          neighbor_range = (pcl_isinf (neighbor_range) ? range_of_current_point : (std::min) (neighbor_range, range_of_current_point));
-          top= (std::min) (top, n_y); right= (std::max) (right, n_x); bottom= (std::max) (bottom, n_y); left= (std::min) (left, n_x);
+          float& neighbor_range = neighbor_ranges[n_y*width + n_x];
+          neighbor_range = (std::min) (neighbor_range, range_of_current_point);
+          b_top= (std::min) (b_top, n_y); b_right= (std::max) (b_right, n_x); b_bottom= (std::max) (b_bottom, n_y); b_left= (std::min) (b_left, n_x);
         }
       }
-    }
-    //std::cout <<std::endl;
-    
-    // The point itself
-    int arrayPos = y*width + x;
-    float& range_at_image_point = points[arrayPos].range;
-    int& counter = counters[arrayPos];
-    bool addCurrentPoint=false, replace_with_current_point=false;
-    
-    if (counter==0)
-    {
-      replace_with_current_point = true;
-    }
-    else
-    {
-      if (range_of_current_point < range_at_image_point-noise_level)
+      
+      if (y < band_top || y > band_bottom)
+        continue;
+      
+      // The point itself
+      int arrayPos = y*width + x;
+      float& range_at_image_point = points[arrayPos].range;
+      int& counter = counters[arrayPos];
+      bool addCurrentPoint=false, replace_with_current_point=false;
+      
+      if (counter==0)
       {
         replace_with_current_point = true;
       }
-      else if (fabs (range_of_current_point-range_at_image_point)<=noise_level)
+      else
+      {
+        if (range_of_current_point < range_at_image_point-noise_level)
+        {
+          replace_with_current_point = true;
+        }
+        else if (fabs (range_of_current_point-range_at_image_point)<=noise_level)
+        {
+          addCurrentPoint = true;
+        }
+      }
+      
+      if (replace_with_current_point)
+      {
+        counter = 1;
+        range_at_image_point = range_of_current_point;
+        b_top= (std::min) (b_top, y); b_right= (std::max) (b_right, x); b_bottom= (std::max) (b_bottom, y); b_left= (std::min) (b_left, x);
+      }
+      else if (addCurrentPoint)
       {
-        addCurrentPoint = true;
+        ++counter;
+        range_at_image_point += (range_of_current_point-range_at_image_point)/counter;
       }
     }
     
-    if (replace_with_current_point)
+    // Pixels no point fell into take the minimum range of the points next to them
+    for (int arrayPos = band_top*image_width; arrayPos < (band_bottom+1)*image_width; ++arrayPos)
     {
-      counter = 1;
-      range_at_image_point = range_of_current_point;
-      top= (std::min) (top, y); right= (std::max) (right, x); bottom= (std::max) (bottom, y); left= (std::min) (left, x);
-      //std::cout << "Adding point "<<x<<","<<y<<"\n";
+      if (counters[arrayPos]!=0 || pcl_isinf (neighbor_ranges[arrayPos]))
+        continue;
+      float& range_at_image_point = points[arrayPos].range;
+      range_at_image_point = (pcl_isinf (range_at_image_point) ? neighbor_ranges[arrayPos] : (std::min) (range_at_image_point, neighbor_ranges[arrayPos]));
     }
-    else if (addCurrentPoint)
+    
+    band_bounds[4*band]   = b_top;    band_bounds[4*band+1] = b_right;
+    band_bounds[4*band+2] = b_bottom; band_bounds[4*band+3] = b_left;
+  }
+  
+  top=height; right=-1; bottom=-1; left=width;
+  for (int band = 0; band < no_of_bands; ++band)
+  {
+    top    = (std::min) (top,    band_bounds[4*band]);   right = (std::max) (right, band_bounds[4*band+1]);
+    bottom = (std::max) (bottom, band_bounds[4*band+2]); left  = (std::min) (left,  band_bounds[4*band+3]);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////
+void
+RangeImage::updateProjectionTable (RangeImageProjectionTable& table) const
+{
+  int shift_x = image_offset_x_ - table.image_offset_x, shift_y = image_offset_y_ - table.image_offset_y;
+  if (!table.rays.empty () &&
+      table.angular_resolution_x == angular_resolution_x_ && table.angular_resolution_y == angular_resolution_y_ &&
+      table.to_world_system.matrix () == to_world_system_.matrix () &&
+      shift_x >= 0 && shift_x + static_cast<int> (width)  <= table.width &&
+      shift_y >= 0 && shift_y + static_cast<int> (height) <= table.height)
+    return;
+  
+  table.angular_resolution_x = angular_resolution_x_;  table.angular_resolution_y = angular_resolution_y_;
+  table.image_offset_x = image_offset_x_;  table.image_offset_y = image_offset_y_;
+  table.width = static_cast<int> (width);  table.height = static_cast<int> (height);
+  table.to_world_system = to_world_system_;
+  table.origin = to_world_system_.translation ();
+  table.rays.resize (width*height);
+  
+  int table_width = table.width, table_height = table.height;
+# pragma omp parallel for schedule (static) num_threads (max_no_of_threads)
+  for (int y = 0; y < table_height; ++y)
+  {
+    for (int x = 0; x < table_width; ++x)
     {
-      ++counter;
-      range_at_image_point += (range_of_current_point-range_at_image_point)/counter;
+      Eigen::Vector3f point;
+      calculate3DPoint (static_cast<float> (x), static_cast<float> (y), 1.0f, point);
+      table.rays[y*table_width + x] = point - table.origin;
     }
   }
-  
-  delete[] counters;
 }
 
 /////////////////////////////////////////////////////////////////////////
-void 
-RangeImage::getImagePoint (float x, float y, float z, float& image_x, float& image_y, float& range) const 
+void
+RangeImage::recalculate3DPointPositions (RangeImageProjectionTable& table)
 {
-  Eigen::Vector3f point (x, y, z);
-  getImagePoint (point, image_x, image_y, range);
+  updateProjectionTable (table);
+  
+  int shift_x = image_offset_x_ - table.image_offset_x, shift_y = image_offset_y_ - table.image_offset_y,
+      image_width = static_cast<int> (width), image_height = static_cast<int> (height);
+  
+# pragma omp parallel for schedule (static) num_threads (max_no_of_threads)
+  for (int y = 0; y < image_height; ++y)
+  {
+    const Eigen::Vector3f* rays = &table.rays[(y+shift_y)*table.width + shift_x];
+    for (int x = 0; x < image_width; ++x)
+    {
+      PointWithRange& point = points[y*image_width + x];
+      if (!pcl_isinf (point.range))
+        point.getVector3fMap () = table.origin + point.range * rays[x];
+    }
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////
@@ -47,6 +47,27 @@
 
 namespace pcl
 {
+  /** \brief The viewing rays of the pixels of a range image geometry, so that the 3D point of a pixel is
+    * origin + range * ray instead of requiring trigonometric functions for every pixel and frame.
+    * The table is owned by the caller and passed to RangeImage::updateFromPointCloud (). It is recomputed
+    * whenever the angular resolution or the sensor pose change or the image does not lie inside of it.
+    * \ingroup range_image
+    */
+  struct RangeImageProjectionTable
+  {
+    RangeImageProjectionTable () : angular_resolution_x (0.0f), angular_resolution_y (0.0f),
+                                   image_offset_x (0), image_offset_y (0), width (0), height (0),
+                                   to_world_system (Eigen::Affine3f::Identity ()), origin (Eigen::Vector3f::Zero ()),
+                                   rays () {}
+    float angular_resolution_x, angular_resolution_y;
+    int image_offset_x, image_offset_y, width, height;
+    Eigen::Affine3f to_world_system;
+    Eigen::Vector3f origin;
+    std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > rays;
+    
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+  
   /** \brief RangeImage is derived from pcl/PointCloud and provides functionalities with focus on situations where
     *  a 3D scene was captured from a specific view point. 
     * \author Bastian Steder
@@ -297,6 +318,44 @@ namespace pcl
                    RangeImage::CoordinateFrame coordinate_frame=CAMERA_FRAME, float angle_width=pcl::deg2rad (360.0f),
                    float angle_height=pcl::deg2rad (180.0f));
       
+      /** \brief Refill the range image from a new point cloud, keeping its size, angular resolution and sensor pose.
+        * Meant for sensors delivering one cloud per frame with a fixed geometry, e.g. a 360 degree lidar: the image is
+        * neither reallocated nor cropped.
+        * \param point_cloud the input point cloud
+        * \param noise_level the distance in meters inside of which the z-buffer will not use the minimum, but the
+        *                    mean of the points (see doZBuffer ())
+        * \param min_range the minimum visible range
+        * \note The image has to be created with one of the create... methods first.
+        */
+      template <typename PointCloudType> void
+      updateFromPointCloud (const PointCloudType& point_cloud, float noise_level=0.0f, float min_range=0.0f);
+      
+      /** \brief Same as updateFromPointCloud (point_cloud, noise_level, min_range), but the 3D points are recalculated
+        * from the viewing rays in projection_table, which are only computed for the first frame.
+        * \param point_cloud the input point cloud
+        * \param projection_table the viewing rays of the image, kept by the caller from frame to frame
+        * \param noise_level the distance in meters inside of which the z-buffer will not use the minimum, but the
+        *                    mean of the points (see doZBuffer ())
+        * \param min_range the minimum visible range
+        */
+      template <typename PointCloudType> void
+      updateFromPointCloud (const PointCloudType& point_cloud, RangeImageProjectionTable& projection_table,
+                            float noise_level=0.0f, float min_range=0.0f);
+      
+      /** \brief Compute the viewing rays of the current image geometry, unless the ones in projection_table cover it
+        * already.
+        * \param projection_table the table to update
+        */
+      inline void
+      updateProjectionTable (RangeImageProjectionTable& projection_table) const;
+      
+      /** \brief Recalculate all 3D point positions from their range and the viewing rays in projection_table, like
+        * recalculate3DPointPositions (), using up to max_no_of_threads OpenMP threads.
+        * \param projection_table the viewing rays of the image, updated first if they do not cover it
+        */
+      inline void
+      recalculate3DPointPositions (RangeImageProjectionTable& projection_table);
+      
       /** \brief Integrate the given point cloud into the current range image using a z-buffer
         * \param point_cloud the input point cloud
         * \param noise_level - The distance in meters inside of which the z-buffer will not use the minimum,
@@ -308,6 +367,8 @@ namespace pcl
         * \param bottom returns the maximum y pixel position in the image where a point was added
         * \param top returns the minimum y position in the image where a point was added
         * \param left   returns the minimum x pixel position in the image where a point was added
+        * \note The points are projected and integrated with up to max_no_of_threads OpenMP threads; the result
+        *       does not depend on the number of threads.
         */
       template <typename PointCloudType> void
       doZBuffer (const PointCloudType& point_cloud, float noise_level,
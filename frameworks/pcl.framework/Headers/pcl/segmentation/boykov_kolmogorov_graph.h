@@ -0,0 +1,291 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id:$
+ *
+ */
+
+#ifndef PCL_BOYKOV_KOLMOGOROV_GRAPH_H_
+#define PCL_BOYKOV_KOLMOGOROV_GRAPH_H_
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+#include <deque>
+
+namespace pcl
+{
+  /** \brief
+    * This class implements a flow network between a source and a sink whose maximum flow (and minimum cut)
+    * is found with the augmenting paths algorithm of Boykov and Kolmogorov described in the article
+    * "An Experimental Comparison of Min-Cut/Max-Flow Algorithms for Energy Minimization in Vision".
+    * The arcs are kept in one flat array grouped by their tail node, every arc storing its head, its reverse arc
+    * and its residual capacity. The capacities to the source and to the sink are folded into one signed residual per node.
+    *
+    * The flow and the search trees of a solve are kept. If only terminal capacities are changed afterwards, the next
+    * solve starts from them instead of from zero flow, as described in the article "Dynamic Graph Cuts for Efficient
+    * Inference in Markov Random Fields" by Kohli and Torr. Adding edges or changing their capacities discards the flow.
+    */
+  template <typename CapacityT>
+  class BoykovKolmogorovGraph
+  {
+    public:
+
+      typedef boost::shared_ptr<BoykovKolmogorovGraph<CapacityT> > Ptr;
+      typedef boost::shared_ptr<const BoykovKolmogorovGraph<CapacityT> > ConstPtr;
+
+    public:
+
+      /** \brief Constructor that creates an empty graph. */
+      BoykovKolmogorovGraph ();
+
+      /** \brief Removes all the edges and creates the given number of nodes with zero terminal capacities.
+        * \param[in] number_of_nodes number of nodes in the graph, the source and the sink are not counted
+        */
+      void
+      reset (int number_of_nodes);
+
+      /** \brief Returns the number of nodes in the graph. */
+      int
+      getNumberOfNodes () const;
+
+      /** \brief Returns the number of edges that were added to the graph. */
+      int
+      getNumberOfEdges () const;
+
+      /** \brief Adds an edge between two nodes and returns its index.
+        * \param[in] source first node of the edge
+        * \param[in] target second node of the edge
+        * \param[in] capacity capacity from source to target
+        * \param[in] reverse_capacity capacity from target to source
+        */
+      int
+      addEdge (int source, int target, CapacityT capacity, CapacityT reverse_capacity);
+
+      /** \brief Changes the capacities of the edge. This discards the flow that was found by the previous solve.
+        * \param[in] edge index of the edge that was returned by addEdge()
+        * \param[in] capacity new capacity from source to target
+        * \param[in] reverse_capacity new capacity from target to source
+        */
+      void
+      setEdgeCapacities (int edge, CapacityT capacity, CapacityT reverse_capacity);
+
+      /** \brief Returns the first node of the edge. */
+      int
+      getEdgeSource (int edge) const;
+
+      /** \brief Returns the second node of the edge. */
+      int
+      getEdgeTarget (int edge) const;
+
+      /** \brief Sets the capacities of the edges that connect the node with the source and with the sink.
+        * The flow that was found by the previous solve is kept.
+        * \param[in] node index of the node
+        * \param[in] source_capacity capacity of the (source, node) edge
+        * \param[in] sink_capacity capacity of the (node, sink) edge
+        */
+      void
+      setTerminalCapacities (int node, CapacityT source_capacity, CapacityT sink_capacity);
+
+      /** \brief Returns the capacity of the (source, node) edge. */
+      CapacityT
+      getSourceCapacity (int node) const;
+
+      /** \brief Returns the capacity of the (node, sink) edge. */
+      CapacityT
+      getSinkCapacity (int node) const;
+
+      /** \brief Finds the maximum flow and returns its value. */
+      CapacityT
+      solve ();
+
+      /** \brief Returns the value of the flow that was found by the last solve. */
+      CapacityT
+      getMaxFlow () const;
+
+      /** \brief Returns true if the node is reachable from the source in the residual network of the last solve,
+        * in other words if it lies on the source side of the minimum cut.
+        * \param[in] node index of the node
+        */
+      bool
+      inSourceSegment (int node) const;
+
+    protected:
+
+      /** \brief Marks that the node has no parent. */
+      static const int NO_PARENT = -1;
+
+      /** \brief Marks that the parent of the node is the source or the sink. */
+      static const int TERMINAL = -2;
+
+      /** \brief Marks that the node has lost its parent during the augmentation. */
+      static const int ORPHAN = -3;
+
+      /** \brief Arc of the residual network. */
+      struct Arc
+      {
+        /** \brief Node that the arc points to. */
+        int head;
+        /** \brief Index of the reverse arc. */
+        int sister;
+        /** \brief Residual capacity of the arc. */
+        CapacityT residual;
+      };
+
+      /** \brief Node of the residual network together with its place in the search trees. */
+      struct Node
+      {
+        /** \brief Arc from the node to its parent in the search tree, or NO_PARENT, TERMINAL, ORPHAN. */
+        int parent;
+        /** \brief Next node in the active list, the node itself if it is the last one and -1 if it is not in the list. */
+        int next;
+        /** \brief Time when the distance to the terminal was computed. */
+        int timestamp;
+        /** \brief Distance to the terminal along the search tree. */
+        int distance;
+        /** \brief Residual capacity to the source if positive, to the sink if negative. */
+        CapacityT residual;
+        /** \brief Signalizes if the node belongs to the sink tree. */
+        bool is_sink;
+        /** \brief Signalizes if the terminal capacities of the node changed after the last solve. */
+        bool is_marked;
+      };
+
+      /** \brief Edge as it was added by the user. */
+      struct Edge
+      {
+        int source;
+        int target;
+        CapacityT capacity;
+        CapacityT reverse_capacity;
+      };
+
+      /** \brief This method groups the arcs of the added edges by their tail nodes. */
+      void
+      buildArcs ();
+
+      /** \brief This method sets the residual capacities to the capacities, in other words resets the flow to zero. */
+      void
+      initializeFlow ();
+
+      /** \brief This method makes every node with nonzero terminal residual a root of the search trees. */
+      void
+      initializeTrees ();
+
+      /** \brief This method repairs the search trees of the previous solve around the marked nodes. */
+      void
+      reuseTrees ();
+
+      /** \brief This method grows the search trees and augments along the paths between them until none is left. */
+      void
+      findMaxFlow ();
+
+      /** \brief This method adds the node to the end of the active list unless it is already there. */
+      void
+      setActive (int node);
+
+      /** \brief This method returns the next active node that belongs to a search tree, or -1 if there is none. */
+      int
+      nextActive ();
+
+      /** \brief This method pushes the bottleneck capacity along the path that goes through the given arc.
+        * \param[in] middle_arc arc from the source tree to the sink tree
+        */
+      void
+      augment (int middle_arc);
+
+      /** \brief This method makes the node an orphan that is processed before the others. */
+      void
+      setOrphanFront (int node);
+
+      /** \brief This method makes the node an orphan that is processed after the others. */
+      void
+      setOrphanRear (int node);
+
+      /** \brief This method processes the orphans until there are none left. */
+      void
+      adoptOrphans ();
+
+      /** \brief This method looks for a new parent of the orphan in the source tree, or frees it if there is none. */
+      void
+      processSourceOrphan (int node);
+
+      /** \brief This method looks for a new parent of the orphan in the sink tree, or frees it if there is none. */
+      void
+      processSinkOrphan (int node);
+
+    protected:
+
+      /** \brief Stores the nodes of the graph. */
+      std::vector<Node> nodes_;
+
+      /** \brief Stores the arcs of the graph, the arcs of node i occupy [arc_offsets_[i], arc_offsets_[i + 1]). */
+      std::vector<Arc> arcs_;
+
+      /** \brief Stores the index of the first arc of every node. */
+      std::vector<int> arc_offsets_;
+
+      /** \brief Stores the edges that were added to the graph. */
+      std::vector<Edge> edges_;
+
+      /** \brief Stores the index of the (source, target) arc of every edge. */
+      std::vector<int> edge_arcs_;
+
+      /** \brief Stores the capacities of the (source, node) edges. */
+      std::vector<CapacityT> source_capacities_;
+
+      /** \brief Stores the capacities of the (node, sink) edges. */
+      std::vector<CapacityT> sink_capacities_;
+
+      /** \brief First and last nodes of the two active lists. */
+      int queue_first_[2];
+      int queue_last_[2];
+
+      /** \brief Stores the orphans. */
+      std::deque<int> orphans_;
+
+      /** \brief Counter used for the timestamps of the nodes. */
+      int time_;
+
+      /** \brief Stores the value of the flow. */
+      CapacityT flow_;
+
+      /** \brief Signalizes if the arcs correspond to the added edges. */
+      bool arcs_are_valid_;
+
+      /** \brief Signalizes if the residual network and the search trees hold the result of the previous solve. */
+      bool flow_is_valid_;
+  };
+}
+
+#endif
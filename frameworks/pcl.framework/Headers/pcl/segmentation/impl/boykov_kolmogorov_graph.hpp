@@ -0,0 +1,723 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id:$
+ *
+ */
+
+#ifndef PCL_SEGMENTATION_BOYKOV_KOLMOGOROV_GRAPH_HPP_
+#define PCL_SEGMENTATION_BOYKOV_KOLMOGOROV_GRAPH_HPP_
+
+#include <pcl/pcl/segmentation/boykov_kolmogorov_graph.h>
+#include <algorithm>
+#include <limits>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT>
+pcl::BoykovKolmogorovGraph<CapacityT>::BoykovKolmogorovGraph () :
+  nodes_ (0),
+  arcs_ (0),
+  arc_offsets_ (0),
+  edges_ (0),
+  edge_arcs_ (0),
+  source_capacities_ (0),
+  sink_capacities_ (0),
+  orphans_ (),
+  time_ (0),
+  flow_ (0),
+  arcs_are_valid_ (false),
+  flow_is_valid_ (false)
+{
+  queue_first_[0] = queue_first_[1] = -1;
+  queue_last_[0] = queue_last_[1] = -1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::reset (int number_of_nodes)
+{
+  nodes_.clear ();
+  nodes_.resize (number_of_nodes);
+  arcs_.clear ();
+  arc_offsets_.clear ();
+  edges_.clear ();
+  edge_arcs_.clear ();
+  source_capacities_.clear ();
+  source_capacities_.resize (number_of_nodes, 0);
+  sink_capacities_.clear ();
+  sink_capacities_.resize (number_of_nodes, 0);
+  orphans_.clear ();
+  flow_ = 0;
+  arcs_are_valid_ = false;
+  flow_is_valid_ = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> int
+pcl::BoykovKolmogorovGraph<CapacityT>::getNumberOfNodes () const
+{
+  return (static_cast<int> (nodes_.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> int
+pcl::BoykovKolmogorovGraph<CapacityT>::getNumberOfEdges () const
+{
+  return (static_cast<int> (edges_.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> int
+pcl::BoykovKolmogorovGraph<CapacityT>::addEdge (int source, int target, CapacityT capacity, CapacityT reverse_capacity)
+{
+  Edge edge;
+  edge.source = source;
+  edge.target = target;
+  edge.capacity = capacity;
+  edge.reverse_capacity = reverse_capacity;
+  edges_.push_back (edge);
+
+  arcs_are_valid_ = false;
+  flow_is_valid_ = false;
+
+  return (static_cast<int> (edges_.size ()) - 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::setEdgeCapacities (int edge, CapacityT capacity, CapacityT reverse_capacity)
+{
+  edges_[edge].capacity = capacity;
+  edges_[edge].reverse_capacity = reverse_capacity;
+  flow_is_valid_ = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> int
+pcl::BoykovKolmogorovGraph<CapacityT>::getEdgeSource (int edge) const
+{
+  return (edges_[edge].source);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> int
+pcl::BoykovKolmogorovGraph<CapacityT>::getEdgeTarget (int edge) const
+{
+  return (edges_[edge].target);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::setTerminalCapacities (int node, CapacityT source_capacity, CapacityT sink_capacity)
+{
+  CapacityT delta_source = source_capacity - source_capacities_[node];
+  CapacityT delta_sink = sink_capacity - sink_capacities_[node];
+  source_capacities_[node] = source_capacity;
+  sink_capacities_[node] = sink_capacity;
+
+  if (!flow_is_valid_ || (delta_source == 0 && delta_sink == 0))
+    return;
+
+  //The flow through the node may exceed its new terminal capacities. Increasing both of them by the same amount
+  //keeps the minimum cut and makes the flow feasible again, the amount is simply added to the flow value
+  Node& current = nodes_[node];
+  if (current.residual > 0)
+    delta_source += current.residual;
+  else
+    delta_sink -= current.residual;
+  flow_ += std::min (delta_source, delta_sink);
+  current.residual = delta_source - delta_sink;
+
+  //Put the node into the list of the nodes that must be repaired before the next solve
+  if (current.next < 0)
+  {
+    if (queue_last_[1] >= 0)
+      nodes_[queue_last_[1]].next = node;
+    else
+      queue_first_[1] = node;
+    queue_last_[1] = node;
+    current.next = node;
+  }
+  current.is_marked = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> CapacityT
+pcl::BoykovKolmogorovGraph<CapacityT>::getSourceCapacity (int node) const
+{
+  return (source_capacities_[node]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> CapacityT
+pcl::BoykovKolmogorovGraph<CapacityT>::getSinkCapacity (int node) const
+{
+  return (sink_capacities_[node]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> CapacityT
+pcl::BoykovKolmogorovGraph<CapacityT>::getMaxFlow () const
+{
+  return (flow_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> bool
+pcl::BoykovKolmogorovGraph<CapacityT>::inSourceSegment (int node) const
+{
+  return (nodes_[node].parent != NO_PARENT && !nodes_[node].is_sink);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> CapacityT
+pcl::BoykovKolmogorovGraph<CapacityT>::solve ()
+{
+  if (!arcs_are_valid_)
+  {
+    buildArcs ();
+    arcs_are_valid_ = true;
+    flow_is_valid_ = false;
+  }
+
+  if (flow_is_valid_)
+    reuseTrees ();
+  else
+  {
+    initializeFlow ();
+    initializeTrees ();
+  }
+
+  findMaxFlow ();
+  flow_is_valid_ = true;
+
+  return (flow_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::buildArcs ()
+{
+  int number_of_nodes = static_cast<int> (nodes_.size ());
+  int number_of_edges = static_cast<int> (edges_.size ());
+
+  arc_offsets_.clear ();
+  arc_offsets_.resize (number_of_nodes + 1, 0);
+  for (int i_edge = 0; i_edge < number_of_edges; i_edge++)
+  {
+    arc_offsets_[edges_[i_edge].source + 1]++;
+    arc_offsets_[edges_[i_edge].target + 1]++;
+  }
+  for (int i_node = 0; i_node < number_of_nodes; i_node++)
+    arc_offsets_[i_node + 1] += arc_offsets_[i_node];
+
+  arcs_.clear ();
+  arcs_.resize (2 * number_of_edges);
+  edge_arcs_.clear ();
+  edge_arcs_.resize (number_of_edges);
+  std::vector<int> fill (arc_offsets_.begin (), arc_offsets_.end () - 1);
+  for (int i_edge = 0; i_edge < number_of_edges; i_edge++)
+  {
+    int arc = fill[edges_[i_edge].source]++;
+    int reverse_arc = fill[edges_[i_edge].target]++;
+    arcs_[arc].head = edges_[i_edge].target;
+    arcs_[arc].sister = reverse_arc;
+    arcs_[reverse_arc].head = edges_[i_edge].source;
+    arcs_[reverse_arc].sister = arc;
+    edge_arcs_[i_edge] = arc;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::initializeFlow ()
+{
+  for (size_t i_edge = 0; i_edge < edges_.size (); i_edge++)
+  {
+    Arc& arc = arcs_[edge_arcs_[i_edge]];
+    arc.residual = edges_[i_edge].capacity;
+    arcs_[arc.sister].residual = edges_[i_edge].reverse_capacity;
+  }
+
+  //The part of the capacity that is common for the source and the sink edges goes straight through the node
+  flow_ = 0;
+  for (size_t i_node = 0; i_node < nodes_.size (); i_node++)
+  {
+    flow_ += std::min (source_capacities_[i_node], sink_capacities_[i_node]);
+    nodes_[i_node].residual = source_capacities_[i_node] - sink_capacities_[i_node];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::initializeTrees ()
+{
+  queue_first_[0] = queue_first_[1] = -1;
+  queue_last_[0] = queue_last_[1] = -1;
+  orphans_.clear ();
+  time_ = 0;
+
+  int number_of_nodes = static_cast<int> (nodes_.size ());
+  for (int i_node = 0; i_node < number_of_nodes; i_node++)
+  {
+    Node& node = nodes_[i_node];
+    node.next = -1;
+    node.is_marked = false;
+    node.timestamp = time_;
+    node.distance = 1;
+    node.is_sink = node.residual < 0;
+    if (node.residual != 0)
+    {
+      node.parent = TERMINAL;
+      setActive (i_node);
+    }
+    else
+      node.parent = NO_PARENT;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::reuseTrees ()
+{
+  int marked = queue_first_[1];
+  queue_first_[0] = queue_first_[1] = -1;
+  queue_last_[0] = queue_last_[1] = -1;
+  orphans_.clear ();
+  time_++;
+
+  while (marked >= 0)
+  {
+    int i_node = marked;
+    Node& node = nodes_[i_node];
+    marked = node.next == i_node ? -1 : node.next;
+    node.next = -1;
+    node.is_marked = false;
+    setActive (i_node);
+
+    if (node.residual == 0)
+    {
+      if (node.parent != NO_PARENT)
+        setOrphanRear (i_node);
+      continue;
+    }
+
+    //The node becomes a root of the tree of the terminal it has residual capacity to. If it moves to the other tree
+    //then its children lose their parent and its neighbours from the other tree may now reach it
+    bool is_sink = node.residual < 0;
+    if (node.parent == NO_PARENT || node.is_sink != is_sink)
+    {
+      node.is_sink = is_sink;
+      for (int i_arc = arc_offsets_[i_node]; i_arc < arc_offsets_[i_node + 1]; i_arc++)
+      {
+        const Arc& arc = arcs_[i_arc];
+        Node& neighbour = nodes_[arc.head];
+        if (neighbour.is_marked)
+          continue;
+        if (neighbour.parent == arc.sister)
+          setOrphanRear (arc.head);
+        CapacityT residual = is_sink ? arcs_[arc.sister].residual : arc.residual;
+        if (neighbour.parent != NO_PARENT && neighbour.is_sink != is_sink && residual > 0)
+          setActive (arc.head);
+      }
+    }
+    node.parent = TERMINAL;
+    node.timestamp = time_;
+    node.distance = 1;
+  }
+
+  adoptOrphans ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::findMaxFlow ()
+{
+  int current_node = -1;
+  while (true)
+  {
+    //Keep growing from the node that gave the last augmenting path, it is likely to give more of them
+    int i_node = current_node;
+    if (i_node >= 0)
+    {
+      nodes_[i_node].next = -1;
+      if (nodes_[i_node].parent == NO_PARENT)
+        i_node = -1;
+    }
+    if (i_node < 0)
+    {
+      i_node = nextActive ();
+      if (i_node < 0)
+        break;
+    }
+
+    //Look for an arc that joins the two trees, adding the free neighbours to the tree of the node on the way
+    Node& node = nodes_[i_node];
+    int middle_arc = -1;
+    for (int i_arc = arc_offsets_[i_node]; i_arc < arc_offsets_[i_node + 1]; i_arc++)
+    {
+      const Arc& arc = arcs_[i_arc];
+      CapacityT residual = node.is_sink ? arcs_[arc.sister].residual : arc.residual;
+      if (residual <= 0)
+        continue;
+
+      Node& neighbour = nodes_[arc.head];
+      if (neighbour.parent == NO_PARENT)
+      {
+        neighbour.is_sink = node.is_sink;
+        neighbour.parent = arc.sister;
+        neighbour.timestamp = node.timestamp;
+        neighbour.distance = node.distance + 1;
+        setActive (arc.head);
+      }
+      else if (neighbour.is_sink != node.is_sink)
+      {
+        middle_arc = node.is_sink ? arc.sister : i_arc;
+        break;
+      }
+      else if (neighbour.timestamp <= node.timestamp && neighbour.distance > node.distance)
+      {
+        //Shorten the path of the neighbour to the terminal
+        neighbour.parent = arc.sister;
+        neighbour.timestamp = node.timestamp;
+        neighbour.distance = node.distance + 1;
+      }
+    }
+
+    time_++;
+
+    if (middle_arc >= 0)
+    {
+      node.next = i_node;
+      current_node = i_node;
+      augment (middle_arc);
+      adoptOrphans ();
+    }
+    else
+      current_node = -1;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::setActive (int node)
+{
+  if (nodes_[node].next >= 0)
+    return;
+
+  if (queue_last_[1] >= 0)
+    nodes_[queue_last_[1]].next = node;
+  else
+    queue_first_[1] = node;
+  queue_last_[1] = node;
+  nodes_[node].next = node;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> int
+pcl::BoykovKolmogorovGraph<CapacityT>::nextActive ()
+{
+  while (true)
+  {
+    int node = queue_first_[0];
+    if (node < 0)
+    {
+      queue_first_[0] = node = queue_first_[1];
+      queue_last_[0] = queue_last_[1];
+      queue_first_[1] = queue_last_[1] = -1;
+      if (node < 0)
+        return (-1);
+    }
+
+    if (nodes_[node].next == node)
+      queue_first_[0] = queue_last_[0] = -1;
+    else
+      queue_first_[0] = nodes_[node].next;
+    nodes_[node].next = -1;
+
+    //Nodes that became free after they were activated are skipped
+    if (nodes_[node].parent != NO_PARENT)
+      return (node);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::augment (int middle_arc)
+{
+  //Find the bottleneck capacity along the path
+  CapacityT bottleneck = arcs_[middle_arc].residual;
+  int i_node = arcs_[arcs_[middle_arc].sister].head;
+  for (int arc = nodes_[i_node].parent; arc != TERMINAL; arc = nodes_[i_node].parent)
+  {
+    bottleneck = std::min (bottleneck, arcs_[arcs_[arc].sister].residual);
+    i_node = arcs_[arc].head;
+  }
+  bottleneck = std::min (bottleneck, nodes_[i_node].residual);
+
+  i_node = arcs_[middle_arc].head;
+  for (int arc = nodes_[i_node].parent; arc != TERMINAL; arc = nodes_[i_node].parent)
+  {
+    bottleneck = std::min (bottleneck, arcs_[arc].residual);
+    i_node = arcs_[arc].head;
+  }
+  bottleneck = std::min (bottleneck, -nodes_[i_node].residual);
+
+  //Push the flow, the nodes whose arcs to the parent become saturated turn into orphans
+  arcs_[arcs_[middle_arc].sister].residual += bottleneck;
+  arcs_[middle_arc].residual -= bottleneck;
+
+  i_node = arcs_[arcs_[middle_arc].sister].head;
+  for (int arc = nodes_[i_node].parent; arc != TERMINAL; arc = nodes_[i_node].parent)
+  {
+    arcs_[arc].residual += bottleneck;
+    arcs_[arcs_[arc].sister].residual -= bottleneck;
+    if (arcs_[arcs_[arc].sister].residual == 0)
+      setOrphanFront (i_node);
+    i_node = arcs_[arc].head;
+  }
+  nodes_[i_node].residual -= bottleneck;
+  if (nodes_[i_node].residual == 0)
+    setOrphanFront (i_node);
+
+  i_node = arcs_[middle_arc].head;
+  for (int arc = nodes_[i_node].parent; arc != TERMINAL; arc = nodes_[i_node].parent)
+  {
+    arcs_[arcs_[arc].sister].residual += bottleneck;
+    arcs_[arc].residual -= bottleneck;
+    if (arcs_[arc].residual == 0)
+      setOrphanFront (i_node);
+    i_node = arcs_[arc].head;
+  }
+  nodes_[i_node].residual += bottleneck;
+  if (nodes_[i_node].residual == 0)
+    setOrphanFront (i_node);
+
+  flow_ += bottleneck;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::setOrphanFront (int node)
+{
+  nodes_[node].parent = ORPHAN;
+  orphans_.push_front (node);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::setOrphanRear (int node)
+{
+  nodes_[node].parent = ORPHAN;
+  orphans_.push_back (node);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::adoptOrphans ()
+{
+  while (!orphans_.empty ())
+  {
+    int node = orphans_.front ();
+    orphans_.pop_front ();
+    if (nodes_[node].is_sink)
+      processSinkOrphan (node);
+    else
+      processSourceOrphan (node);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::processSourceOrphan (int node)
+{
+  const int infinite_distance = std::numeric_limits<int>::max ();
+  int min_arc = -1;
+  int min_distance = infinite_distance;
+
+  //Among the neighbours that are still connected to the source choose the one closest to it
+  for (int i_arc = arc_offsets_[node]; i_arc < arc_offsets_[node + 1]; i_arc++)
+  {
+    if (arcs_[arcs_[i_arc].sister].residual <= 0)
+      continue;
+    int neighbour = arcs_[i_arc].head;
+    if (nodes_[neighbour].is_sink || nodes_[neighbour].parent == NO_PARENT)
+      continue;
+
+    int distance = 0;
+    while (true)
+    {
+      if (nodes_[neighbour].timestamp == time_)
+      {
+        distance += nodes_[neighbour].distance;
+        break;
+      }
+      int arc = nodes_[neighbour].parent;
+      distance++;
+      if (arc == TERMINAL)
+      {
+        nodes_[neighbour].timestamp = time_;
+        nodes_[neighbour].distance = 1;
+        break;
+      }
+      if (arc == ORPHAN)
+      {
+        distance = infinite_distance;
+        break;
+      }
+      neighbour = arcs_[arc].head;
+    }
+
+    if (distance < infinite_distance)
+    {
+      if (distance < min_distance)
+      {
+        min_arc = i_arc;
+        min_distance = distance;
+      }
+      //Remember the distances along the path for the following searches
+      for (neighbour = arcs_[i_arc].head; nodes_[neighbour].timestamp != time_; neighbour = arcs_[nodes_[neighbour].parent].head)
+      {
+        nodes_[neighbour].timestamp = time_;
+        nodes_[neighbour].distance = distance--;
+      }
+    }
+  }
+
+  if (min_arc >= 0)
+  {
+    nodes_[node].parent = min_arc;
+    nodes_[node].timestamp = time_;
+    nodes_[node].distance = min_distance + 1;
+    return;
+  }
+
+  //No parent was found, the node becomes free and so do its children
+  nodes_[node].parent = NO_PARENT;
+  for (int i_arc = arc_offsets_[node]; i_arc < arc_offsets_[node + 1]; i_arc++)
+  {
+    int neighbour = arcs_[i_arc].head;
+    int arc = nodes_[neighbour].parent;
+    if (nodes_[neighbour].is_sink || arc == NO_PARENT)
+      continue;
+    if (arcs_[arcs_[i_arc].sister].residual > 0)
+      setActive (neighbour);
+    if (arc != TERMINAL && arc != ORPHAN && arcs_[arc].head == node)
+      setOrphanRear (neighbour);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename CapacityT> void
+pcl::BoykovKolmogorovGraph<CapacityT>::processSinkOrphan (int node)
+{
+  const int infinite_distance = std::numeric_limits<int>::max ();
+  int min_arc = -1;
+  int min_distance = infinite_distance;
+
+  //Among the neighbours that are still connected to the sink choose the one closest to it
+  for (int i_arc = arc_offsets_[node]; i_arc < arc_offsets_[node + 1]; i_arc++)
+  {
+    if (arcs_[i_arc].residual <= 0)
+      continue;
+    int neighbour = arcs_[i_arc].head;
+    if (!nodes_[neighbour].is_sink || nodes_[neighbour].parent == NO_PARENT)
+      continue;
+
+    int distance = 0;
+    while (true)
+    {
+      if (nodes_[neighbour].timestamp == time_)
+      {
+        distance += nodes_[neighbour].distance;
+        break;
+      }
+      int arc = nodes_[neighbour].parent;
+      distance++;
+      if (arc == TERMINAL)
+      {
+        nodes_[neighbour].timestamp = time_;
+        nodes_[neighbour].distance = 1;
+        break;
+      }
+      if (arc == ORPHAN)
+      {
+        distance = infinite_distance;
+        break;
+      }
+      neighbour = arcs_[arc].head;
+    }
+
+    if (distance < infinite_distance)
+    {
+      if (distance < min_distance)
+      {
+        min_arc = i_arc;
+        min_distance = distance;
+      }
+      //Remember the distances along the path for the following searches
+      for (neighbour = arcs_[i_arc].head; nodes_[neighbour].timestamp != time_; neighbour = arcs_[nodes_[neighbour].parent].head)
+      {
+        nodes_[neighbour].timestamp = time_;
+        nodes_[neighbour].distance = distance--;
+      }
+    }
+  }
+
+  if (min_arc >= 0)
+  {
+    nodes_[node].parent = min_arc;
+    nodes_[node].timestamp = time_;
+    nodes_[node].distance = min_distance + 1;
+    return;
+  }
+
+  //No parent was found, the node becomes free and so do its children
+  nodes_[node].parent = NO_PARENT;
+  for (int i_arc = arc_offsets_[node]; i_arc < arc_offsets_[node + 1]; i_arc++)
+  {
+    int neighbour = arcs_[i_arc].head;
+    int arc = nodes_[neighbour].parent;
+    if (!nodes_[neighbour].is_sink || arc == NO_PARENT)
+      continue;
+    if (arcs_[i_arc].residual > 0)
+      setActive (neighbour);
+    if (arc != TERMINAL && arc != ORPHAN && arcs_[arc].head == node)
+      setOrphanRear (neighbour);
+  }
+}
+
+#define PCL_INSTANTIATE_BoykovKolmogorovGraph(T) template class pcl::BoykovKolmogorovGraph<T>;
+
+#endif    // PCL_SEGMENTATION_BOYKOV_KOLMOGOROV_GRAPH_HPP_
@@ -42,7 +42,8 @@
 #include <pcl/pcl/segmentation/min_cut_segmentation.h>
 #include <pcl/pcl/search/search.h>
 #include <pcl/pcl/search/kdtree.h>
-#include <boost/graph/boykov_kolmogorov_max_flow.hpp>
+#include <pcl/pcl/segmentation/impl/boykov_kolmogorov_graph.hpp>
+#include <boost/graph/lookup_edge.hpp>
 #include <stdlib.h>
 #include <cmath>
 
@@ -317,12 +318,12 @@ pcl::MinCutSegmentation<PointT>::segmentPoints ()
     binary_potentials_are_valid_ = true;
   }
 
-  IndexMap index_map = boost::get (boost::vertex_index, *graph_);
-  ResidualCapacityMap residual_capacity = boost::get (boost::edge_residual_capacity, *graph_);
+  pcl::BoykovKolmogorovGraph<double> flow_graph;
+  buildFlowGraph (flow_graph);
 
-  max_flow_ = boost::boykov_kolmogorov_max_flow (*graph_, source_, sink_);
+  max_flow_ = flow_graph.solve ();
 
-  assembleLabels (residual_capacity);
+  assembleLabels (flow_graph);
 
   return (success);
 }
@@ -562,15 +563,42 @@ pcl::MinCutSegmentation<PointT>::recalculateBinaryPotentials ()
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::MinCutSegmentation<PointT>::assembleLabels (ResidualCapacityMap& residual_capacity)
+pcl::MinCutSegmentation<PointT>::buildFlowGraph (pcl::BoykovKolmogorovGraph<double>& flow_graph) const
+{
+  flow_graph.reset (number_of_points_);
+
+  OutEdgeIterator edge_iter;
+  OutEdgeIterator edge_end;
+  std::vector<double> source_weights (number_of_points_, 0.0);
+  for (boost::tie (edge_iter, edge_end) = boost::out_edges (source_, *graph_); edge_iter != edge_end; edge_iter++)
+    source_weights[static_cast<int> (boost::target (*edge_iter, *graph_))] = (*capacity_)[*edge_iter];
+
+  for (int i_point = 0; i_point < number_of_points_; i_point++)
+  {
+    double sink_weight = 0.0;
+    for (boost::tie (edge_iter, edge_end) = boost::out_edges (vertices_[i_point], *graph_); edge_iter != edge_end; edge_iter++)
+    {
+      VertexDescriptor target_vertex = boost::target (*edge_iter, *graph_);
+      if (target_vertex == sink_)
+        sink_weight = (*capacity_)[*edge_iter];
+      //Skip the edge back to the source and the reverse fictitious edges, none of them has capacity
+      else if (target_vertex != source_ && (*capacity_)[*edge_iter] != 0.0)
+        flow_graph.addEdge (i_point, static_cast<int> (target_vertex), (*capacity_)[*edge_iter], 0.0);
+    }
+    flow_graph.setTerminalCapacities (i_point, source_weights[i_point], sink_weight);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MinCutSegmentation<PointT>::assembleLabels (const pcl::BoykovKolmogorovGraph<double>& flow_graph)
 {
   labels_.clear ();
   labels_.resize (number_of_points_, 0);
 
-  OutEdgeIterator edge_iter, edge_end;
-  for ( boost::tie (edge_iter, edge_end) = boost::out_edges (source_, *graph_); edge_iter != edge_end; edge_iter++ )
-    if (residual_capacity[*edge_iter] > epsilon_)
-      labels_[edge_iter->m_target] = 1;
+  for (int i_point = 0; i_point < number_of_points_; i_point++)
+    if (flow_graph.inSourceSegment (i_point))
+      labels_[i_point] = 1;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -41,6 +41,8 @@
 #define PCL_SEGMENTATION_IMPL_ORGANIZED_CONNECTED_COMPONENT_SEGMENTATION_H_
 
 #include <pcl/pcl/segmentation/organized_connected_component_segmentation.h>
+#include <algorithm>
+#include <limits>
 
 /**
  *  Directions: 1 2 3
@@ -113,98 +115,157 @@ pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::findLabeledRegion
   } while ( curr_idx != start_idx);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointLT> void
+pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::compareRow (int row_start, int offset, int first_column, const std::vector<unsigned char>& valid, std::vector<unsigned char>& results) const
+{
+  int width = static_cast<int> (input_->width);
+  results.assign (width, 0);
+
+  // The comparator is never asked about invalid points
+  for (int colIdx = first_column; colIdx < width; ++colIdx)
+    if (valid[row_start + colIdx])
+      results[colIdx] = compare_->compare (row_start + colIdx, row_start + colIdx - offset);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointLT> void
+pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::labelStrip (unsigned first_row, unsigned end_row, const std::vector<unsigned char>& valid,
+                                                                        pcl::PointCloud<PointLT>& labels, std::vector<unsigned>& runs) const
+{
+  unsigned invalid_label = std::numeric_limits<unsigned>::max ();
+  int width = static_cast<int> (input_->width);
+  std::vector<unsigned char> left_similar;
+  std::vector<unsigned char> up_similar;
+
+  runs.clear ();
+  for (unsigned rowIdx = first_row; rowIdx < end_row; ++rowIdx)
+  {
+    int current_row = static_cast<int> (rowIdx) * width;
+    compareRow (current_row, 1, 1, valid, left_similar);
+    if (rowIdx > first_row)
+      compareRow (current_row, width, 0, valid, up_similar);
+
+    for (int colIdx = 0; colIdx < width; ++colIdx)
+    {
+      if (!valid[current_row + colIdx])
+        continue;
+
+      unsigned& label = labels[current_row + colIdx].label;
+      if (left_similar[colIdx])
+        label = labels[current_row + colIdx - 1].label;
+
+      if (rowIdx > first_row && up_similar[colIdx])
+      {
+        unsigned up_label = labels[current_row + colIdx - width].label;
+        if (label == invalid_label)
+          label = up_label;
+        else if (up_label != invalid_label)
+        {
+          unsigned root1 = findRoot (runs, label);
+          unsigned root2 = findRoot (runs, up_label);
+
+          if (root1 < root2)
+            runs[root2] = root1;
+          else
+            runs[root1] = root2;
+        }
+      }
+
+      if (label == invalid_label)
+      {
+        label = static_cast<unsigned> (runs.size ());
+        runs.push_back (label);
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename PointLT> void
 pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices) const
 {
-  std::vector<unsigned> run_ids;
+  segment (labels, label_indices, 1);
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointLT> void
+pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices,
+                                                                     unsigned int nr_threads) const
+{
+  unsigned int threads = nr_threads == 0 ? 1 : nr_threads;
   unsigned invalid_label = std::numeric_limits<unsigned>::max ();
   pcl::Label invalid_pt;
   invalid_pt.label = std::numeric_limits<unsigned>::max ();
+  labels.points.clear ();
   labels.points.resize (input_->points.size (), invalid_pt);
   labels.width = input_->width;
   labels.height = input_->height;
-  unsigned int clust_id = 0;
-  
-  //First pixel
-  if (pcl_isfinite (input_->points[0].x))
-  {
-    labels[0].label = clust_id++;
-    run_ids.push_back (labels[0].label );
-  }   
+  label_indices.clear ();
+  if (input_->points.empty ())
+    return;
 
-  // First row
-  for (int colIdx = 1; colIdx < static_cast<int> (input_->width); ++colIdx)
+  // Only the finite points, and only those in indices_ if indices were given, are labeled
+  int nr_points = static_cast<int> (input_->points.size ());
+  std::vector<unsigned char> valid (nr_points, 0);
+  if (indices_ && !fake_indices_)
   {
-    if (!pcl_isfinite (input_->points[colIdx].x))
-      continue;
-    else if (compare_->compare (colIdx, colIdx - 1 ))
-    {
-      labels[colIdx].label = labels[colIdx - 1].label;
-    }
-    else
-    {
-      labels[colIdx].label = clust_id++;
-      run_ids.push_back (labels[colIdx].label );
-    }
+    for (size_t i = 0; i < indices_->size (); ++i)
+      valid[(*indices_)[i]] = pcl_isfinite (input_->points[(*indices_)[i]].x);
   }
-  
-  // Everything else
-  unsigned int current_row = input_->width;
-  unsigned int previous_row = 0;
-  for (size_t rowIdx = 1; rowIdx < input_->height; ++rowIdx, previous_row = current_row, current_row += input_->width)
+  else
+  {
+#pragma omp parallel for schedule(static) num_threads(threads)
+    for (int idx = 0; idx < nr_points; ++idx)
+      valid[idx] = pcl_isfinite (input_->points[idx].x);
+  }
+
+  int width = static_cast<int> (input_->width);
+  int nr_strips = static_cast<int> (std::min (threads, input_->height));
+  std::vector<unsigned> strip_rows (nr_strips + 1);
+  for (int strip = 0; strip <= nr_strips; ++strip)
+    strip_rows[strip] = input_->height * strip / nr_strips;
+
+  // Label every strip on its own
+  std::vector<std::vector<unsigned> > strip_runs (nr_strips);
+#pragma omp parallel for schedule(static, 1) num_threads(threads)
+  for (int strip = 0; strip < nr_strips; ++strip)
+    labelStrip (strip_rows[strip], strip_rows[strip + 1], valid, labels, strip_runs[strip]);
+
+  // Number the labels of the strips one after another. Labels are created in raster order, so the root of every
+  // component is still the label of its first point, just as with a single strip
+  std::vector<unsigned> strip_offsets (nr_strips + 1, 0);
+  for (int strip = 0; strip < nr_strips; ++strip)
+    strip_offsets[strip + 1] = strip_offsets[strip] + static_cast<unsigned> (strip_runs[strip].size ());
+
+  std::vector<unsigned> run_ids (strip_offsets[nr_strips]);
+  for (int strip = 0; strip < nr_strips; ++strip)
+    for (size_t runIdx = 0; runIdx < strip_runs[strip].size (); ++runIdx)
+      run_ids[strip_offsets[strip] + runIdx] = strip_runs[strip][runIdx] + strip_offsets[strip];
+
+  // Join the first row of every strip with the last row of the strip above it
+  std::vector<unsigned char> up_similar;
+  for (int strip = 1; strip < nr_strips; ++strip)
   {
-    // First pixel
-    if (pcl_isfinite (input_->points[current_row].x))
+    int current_row = static_cast<int> (strip_rows[strip]) * width;
+    compareRow (current_row, width, 0, valid, up_similar);
+    for (int colIdx = 0; colIdx < width; ++colIdx)
     {
-      if (compare_->compare (current_row, previous_row))
-      {
-        labels[current_row].label = labels[previous_row].label;
-      }
+      unsigned up_label = labels[current_row + colIdx - width].label;
+      if (!up_similar[colIdx] || up_label == invalid_label)
+        continue;
+
+      unsigned root1 = findRoot (run_ids, labels[current_row + colIdx].label + strip_offsets[strip]);
+      unsigned root2 = findRoot (run_ids, up_label + strip_offsets[strip - 1]);
+
+      if (root1 < root2)
+        run_ids[root2] = root1;
       else
-      {
-        labels[current_row].label = clust_id++;
-        run_ids.push_back (labels[current_row].label);
-      }
-    }
-    
-    // Rest of row
-    for (int colIdx = 1; colIdx < static_cast<int> (input_->width); ++colIdx)
-    {
-      if (pcl_isfinite (input_->points[current_row + colIdx].x))
-      {
-        if (compare_->compare (current_row + colIdx, current_row + colIdx - 1))
-        {
-          labels[current_row + colIdx].label = labels[current_row + colIdx - 1].label;
-        }
-        if (compare_->compare (current_row + colIdx, previous_row + colIdx) )
-        {
-          if (labels[current_row + colIdx].label == invalid_label)
-            labels[current_row + colIdx].label = labels[previous_row + colIdx].label;
-          else
-          {
-            unsigned root1 = findRoot (run_ids, labels[current_row + colIdx].label);
-            unsigned root2 = findRoot (run_ids, labels[previous_row + colIdx].label);
-            
-            if (root1 < root2)
-              run_ids[root2] = root1;
-            else
-              run_ids[root1] = root2;
-          }
-        }
-        
-        if (labels[current_row + colIdx].label == invalid_label)
-        {
-          labels[current_row + colIdx].label = clust_id++;
-          run_ids.push_back (labels[current_row + colIdx].label);
-        }
-        
-      }
+        run_ids[root1] = root2;
     }
   }
-  
-  std::vector<unsigned> map (clust_id);
+
+  std::vector<unsigned> map (run_ids.size ());
   unsigned max_id = 0;
   for (unsigned runIdx = 0; runIdx < run_ids.size (); ++runIdx)
   {
@@ -215,14 +276,27 @@ pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::Poi
       map [runIdx] = map [findRoot (run_ids, runIdx)];
   }
 
+#pragma omp parallel for schedule(static, 1) num_threads(threads)
+  for (int strip = 0; strip < nr_strips; ++strip)
+  {
+    int end_idx = static_cast<int> (strip_rows[strip + 1]) * width;
+    for (int idx = static_cast<int> (strip_rows[strip]) * width; idx < end_idx; ++idx)
+      if (labels[idx].label != invalid_label)
+        labels[idx].label = map[labels[idx].label + strip_offsets[strip]];
+  }
+
+  std::vector<unsigned> label_sizes (max_id + 1, 0);
+  for (unsigned idx = 0; idx < input_->points.size (); idx++)
+    if (labels[idx].label != invalid_label)
+      ++label_sizes[labels[idx].label];
+
   label_indices.resize (max_id + 1);
+  for (unsigned label = 0; label <= max_id; ++label)
+    label_indices[label].indices.reserve (label_sizes[label]);
   for (unsigned idx = 0; idx < input_->points.size (); idx++)
   {
     if (labels[idx].label != invalid_label)
-    {
-      labels[idx].label = map[labels[idx].label];
       label_indices[labels[idx].label].indices.push_back (idx);
-    }
   }
 }
 
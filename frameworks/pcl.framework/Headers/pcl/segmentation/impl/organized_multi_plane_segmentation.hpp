@@ -45,6 +45,8 @@
 #include <pcl/pcl/common/centroid.h>
 #include <pcl/pcl/common/eigen.h>
 #include <boost/make_shared.hpp>
+#include <algorithm>
+#include <limits>
 
 ///////////////////////////////////////////////////////////////
 Eigen::Vector3f linePlaneIntersection (Eigen::Vector3f& p1, Eigen::Vector3f& p2, Eigen::Vector3f& norm, Eigen::Vector3f& p3)
@@ -93,10 +95,155 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segment (std::ve
                                                                          std::vector <Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> >& covariances,
                                                                          pcl::PointCloud<PointLT>& labels,
                                                                          std::vector<pcl::PointIndices>& label_indices)
+{
+  std::vector<PlanarRegion<PointT> > prior_regions;
+  segment (prior_regions, model_coefficients, inlier_indices, centroids, covariances, labels, label_indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointNT, typename PointLT> void
+pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::findPriorInliers (const std::vector<PlanarRegion<PointT> >& prior_regions,
+                                                                                  std::vector<int>& prior_labels,
+                                                                                  unsigned int nr_threads) const
+{
+  int nr_priors = static_cast<int> (prior_regions.size ());
+  Eigen::Matrix3Xf prior_normals (3, nr_priors), prior_u (3, nr_priors), prior_v (3, nr_priors);
+  Eigen::VectorXf prior_d (nr_priors);
+  // In-plane boxes of every prior as min u, max u, min v, max v: the extent of its contour, and its core of one
+  // standard deviation of its inliers around the centroid
+  Eigen::Matrix4Xf prior_extent (4, nr_priors), prior_core (4, nr_priors);
+  for (int k = 0; k < nr_priors; ++k)
+  {
+    Eigen::Vector4f coefficients = prior_regions[k].getCoefficients ();
+    coefficients /= coefficients.head<3> ().norm ();
+    Eigen::Vector3f normal = coefficients.head<3> ();
+    Eigen::Vector3f u = normal.unitOrthogonal ();
+    Eigen::Vector3f v = normal.cross (u);
+    prior_normals.col (k) = normal;
+    prior_u.col (k) = u;
+    prior_v.col (k) = v;
+    prior_d[k] = coefficients[3];
+
+    Eigen::Vector3f centroid = prior_regions[k].getCentroid ();
+    Eigen::Matrix3f covariance = prior_regions[k].getCovariance ();
+    float sigma_u = sqrtf (fabsf (u.dot (covariance * u)));
+    float sigma_v = sqrtf (fabsf (v.dot (covariance * v)));
+    prior_core.col (k) << u.dot (centroid) - sigma_u, u.dot (centroid) + sigma_u,
+                          v.dot (centroid) - sigma_v, v.dot (centroid) + sigma_v;
+
+    const typename pcl::PointCloud<PointT>::VectorType &contour = prior_regions[k].getContour ();
+    if (contour.empty ())
+    {
+      prior_extent.col (k) << -std::numeric_limits<float>::max (), std::numeric_limits<float>::max (),
+                              -std::numeric_limits<float>::max (), std::numeric_limits<float>::max ();
+      continue;
+    }
+    Eigen::Vector4f extent (std::numeric_limits<float>::max (), -std::numeric_limits<float>::max (),
+                            std::numeric_limits<float>::max (), -std::numeric_limits<float>::max ());
+    for (size_t j = 0; j < contour.size (); ++j)
+    {
+      Eigen::Vector3f point = contour[j].getVector3fMap ();
+      float pu = u.dot (point), pv = v.dot (point);
+      extent[0] = std::min (extent[0], pu);
+      extent[1] = std::max (extent[1], pu);
+      extent[2] = std::min (extent[2], pv);
+      extent[3] = std::max (extent[3], pv);
+    }
+    // Allow the plane to move and grow by a tenth of its size between frames
+    float margin_u = 0.1f * (extent[1] - extent[0]) + static_cast<float> (distance_threshold_);
+    float margin_v = 0.1f * (extent[3] - extent[2]) + static_cast<float> (distance_threshold_);
+    prior_extent.col (k) << extent[0] - margin_u, extent[1] + margin_u, extent[2] - margin_v, extent[3] + margin_v;
+  }
+
+  float cos_threshold = cosf (static_cast<float> (angular_threshold_));
+  float distance_threshold = static_cast<float> (distance_threshold_);
+  int nr_points = static_cast<int> (input_->points.size ());
+  prior_labels.resize (nr_points);
+
+  // Invalid points and normals give NaN, which fails every test
+#pragma omp parallel for schedule(static) num_threads(nr_threads)
+  for (int i = 0; i < nr_points; ++i)
+  {
+    Eigen::Vector3f point = input_->points[i].getVector3fMap ();
+    Eigen::Vector3f normal = normals_->points[i].getNormalVector3fMap ();
+    float best_distance = distance_threshold * point[2] * point[2];
+    int best_prior = -1;
+    for (int k = 0; k < nr_priors; ++k)
+    {
+      float distance = fabsf (prior_normals.col (k).dot (point) + prior_d[k]);
+      if (distance >= best_distance || fabsf (prior_normals.col (k).dot (normal)) <= cos_threshold)
+        continue;
+      // Coplanar surfaces elsewhere in the scene are not part of the prior
+      float pu = prior_u.col (k).dot (point);
+      float pv = prior_v.col (k).dot (point);
+      if (pu < prior_extent (0, k) || pu > prior_extent (1, k) || pv < prior_extent (2, k) || pv > prior_extent (3, k))
+        continue;
+      best_distance = distance;
+      best_prior = k;
+    }
+    prior_labels[i] = best_prior;
+  }
+
+  // Coplanar surfaces next to a prior pass the tests above as well. Keep only the connected parts of the inliers of
+  // every prior that reach into its core.
+  int width = static_cast<int> (input_->width);
+  std::vector<unsigned char> visited (nr_points, 0);
+  std::vector<int> component;
+  for (int i = 0; i < nr_points; ++i)
+  {
+    int k = prior_labels[i];
+    if (k < 0 || visited[i])
+      continue;
+
+    component.assign (1, i);
+    visited[i] = 1;
+    bool in_core = false;
+    for (size_t j = 0; j < component.size (); ++j)
+    {
+      int idx = component[j];
+      if (!in_core)
+      {
+        Eigen::Vector3f point = input_->points[idx].getVector3fMap ();
+        float pu = prior_u.col (k).dot (point);
+        float pv = prior_v.col (k).dot (point);
+        in_core = pu >= prior_core (0, k) && pu <= prior_core (1, k) && pv >= prior_core (2, k) && pv <= prior_core (3, k);
+      }
+
+      int x = idx % width;
+      int neighbors[4] = { x > 0 ? idx - 1 : -1, x < width - 1 ? idx + 1 : -1, idx - width, idx + width };
+      for (int n = 0; n < 4; ++n)
+      {
+        int neighbor = neighbors[n];
+        if (neighbor >= 0 && neighbor < nr_points && !visited[neighbor] && prior_labels[neighbor] == k)
+        {
+          visited[neighbor] = 1;
+          component.push_back (neighbor);
+        }
+      }
+    }
+
+    if (!in_core)
+      for (size_t j = 0; j < component.size (); ++j)
+        prior_labels[component[j]] = -1;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointNT, typename PointLT> void
+pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segment (const std::vector<PlanarRegion<PointT> >& prior_regions,
+                                                                         std::vector<ModelCoefficients>& model_coefficients, 
+                                                                         std::vector<PointIndices>& inlier_indices,
+                                                                         std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> >& centroids,
+                                                                         std::vector <Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> >& covariances,
+                                                                         pcl::PointCloud<PointLT>& labels,
+                                                                         std::vector<pcl::PointIndices>& label_indices,
+                                                                         unsigned int nr_threads)
 {
   if (!initCompute ())
     return;
 
+  unsigned int threads = nr_threads == 0 ? 1 : nr_threads;
+
   // Check that we got the same number of points and normals
   if (static_cast<int> (normals_->points.size ()) != static_cast<int> (input_->points.size ()))
   {
@@ -116,8 +263,10 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segment (std::ve
 
   // Calculate range part of planes' hessian normal form
   std::vector<float> plane_d (input_->points.size ());
-  
-  for (unsigned int i = 0; i < input_->size (); ++i)
+  int nr_points = static_cast<int> (input_->points.size ());
+
+#pragma omp parallel for schedule(static) num_threads(threads)
+  for (int i = 0; i < nr_points; ++i)
     plane_d[i] = input_->points[i].getVector3fMap ().dot (normals_->points[i].getNormalVector3fMap ());
   
   // Make a comparator
@@ -128,19 +277,100 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segment (std::ve
   compare_->setAngularThreshold (static_cast<float> (angular_threshold_));
   compare_->setDistanceThreshold (static_cast<float> (distance_threshold_), true);
 
-  // Set up the output
-  OrganizedConnectedComponentSegmentation<PointT,pcl::Label> connected_component (compare_);
-  connected_component.setInputCloud (input_);
-  connected_component.segment (labels, label_indices);
-
   Eigen::Vector4f clust_centroid = Eigen::Vector4f::Zero ();
   Eigen::Vector4f vp = Eigen::Vector4f::Zero ();
   Eigen::Matrix3f clust_cov;
   pcl::ModelCoefficients model;
   model.values.resize (4);
 
-  // Fit Planes to each cluster
-  for (size_t i = 0; i < label_indices.size (); i++)
+  // Refit every prior that still explains enough points. The planes keep the orientation of their priors
+  int nr_priors = static_cast<int> (prior_regions.size ());
+  std::vector<int> prior_labels;
+  std::vector<int> prior_to_label (nr_priors, -1);
+  std::vector<pcl::PointIndices> prior_indices (nr_priors);
+  std::vector<pcl::PointIndices> tracked_indices;
+  if (nr_priors > 0)
+  {
+    findPriorInliers (prior_regions, prior_labels, threads);
+    for (int i = 0; i < nr_points; ++i)
+      if (prior_labels[i] >= 0)
+        prior_indices[prior_labels[i]].indices.push_back (i);
+
+    for (int k = 0; k < nr_priors; ++k)
+    {
+      if (static_cast<unsigned> (prior_indices[k].indices.size ()) <= min_inliers_)
+        continue;
+
+      pcl::computeMeanAndCovarianceMatrix (*input_, prior_indices[k].indices, clust_cov, clust_centroid);
+      Eigen::Vector4f plane_params;
+
+      EIGEN_ALIGN16 Eigen::Vector3f::Scalar eigen_value;
+      EIGEN_ALIGN16 Eigen::Vector3f eigen_vector;
+      pcl::eigen33 (clust_cov, eigen_value, eigen_vector);
+      if (eigen_vector.dot (prior_regions[k].getCoefficients ().template head<3> ()) < 0)
+        eigen_vector *= -1;
+      plane_params[0] = eigen_vector[0];
+      plane_params[1] = eigen_vector[1];
+      plane_params[2] = eigen_vector[2];
+      plane_params[3] = 0;
+      plane_params[3] = -1 * plane_params.dot (clust_centroid);
+
+      float curvature;
+      float eig_sum = clust_cov.coeff (0) + clust_cov.coeff (4) + clust_cov.coeff (8);
+      if (eig_sum != 0)
+        curvature = fabsf (eigen_value / eig_sum);
+      else
+        curvature = 0;
+
+      if (curvature < maximum_curvature_)
+      {
+        model.values[0] = plane_params[0];
+        model.values[1] = plane_params[1];
+        model.values[2] = plane_params[2];
+        model.values[3] = plane_params[3];
+        model_coefficients.push_back (model);
+        inlier_indices.push_back (prior_indices[k]);
+        centroids.push_back (clust_centroid);
+        covariances.push_back (clust_cov);
+        prior_to_label[k] = static_cast<int> (tracked_indices.size ());
+        tracked_indices.push_back (prior_indices[k]);
+      }
+    }
+  }
+
+  // Set up the output
+  OrganizedConnectedComponentSegmentation<PointT,pcl::Label> connected_component (compare_);
+  connected_component.setInputCloud (input_);
+  if (nr_priors > 0)
+  {
+    // Only the points that no kept prior explains are segmented from scratch
+    IndicesPtr unexplained (new std::vector<int>);
+    unexplained->reserve (nr_points);
+    for (int i = 0; i < nr_points; ++i)
+      if (prior_labels[i] < 0 || prior_to_label[prior_labels[i]] < 0)
+        unexplained->push_back (i);
+    connected_component.setIndices (unexplained);
+  }
+  connected_component.segment (labels, label_indices, threads);
+
+  // The tracked planes take the first labels, the new components follow them
+  unsigned nr_tracked = static_cast<unsigned> (tracked_indices.size ());
+  if (nr_priors > 0)
+  {
+    unsigned invalid_label = std::numeric_limits<unsigned>::max ();
+#pragma omp parallel for schedule(static) num_threads(threads)
+    for (int i = 0; i < nr_points; ++i)
+    {
+      if (labels[i].label != invalid_label)
+        labels[i].label += nr_tracked;
+      else if (prior_labels[i] >= 0 && prior_to_label[prior_labels[i]] >= 0)
+        labels[i].label = static_cast<unsigned> (prior_to_label[prior_labels[i]]);
+    }
+    label_indices.insert (label_indices.begin (), tracked_indices.begin (), tracked_indices.end ());
+  }
+
+  // Fit Planes to each new cluster
+  for (size_t i = nr_tracked; i < label_indices.size (); i++)
   {
     if (static_cast<unsigned> (label_indices[i].indices.size ()) > min_inliers_)
     {
@@ -229,6 +459,16 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segment (std::ve
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename PointNT, typename PointLT> void
 pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segmentAndRefine (std::vector<PlanarRegion<PointT> >& regions)
+{
+  std::vector<PlanarRegion<PointT> > prior_regions;
+  segmentAndRefine (prior_regions, regions);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointNT, typename PointLT> void
+pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segmentAndRefine (const std::vector<PlanarRegion<PointT> >& prior_regions,
+                                                                                  std::vector<PlanarRegion<PointT> >& regions,
+                                                                                  unsigned int nr_threads)
 {
   std::vector<ModelCoefficients> model_coefficients;
   std::vector<PointIndices> inlier_indices;  
@@ -238,7 +478,7 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segmentAndRefine
   pcl::PointCloud<PointT> boundary_cloud;
   std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > centroids;
   std::vector <Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> > covariances;
-  segment (model_coefficients, inlier_indices, centroids, covariances, *labels, label_indices);
+  segment (prior_regions, model_coefficients, inlier_indices, centroids, covariances, *labels, label_indices, nr_threads);
   refine (model_coefficients, inlier_indices, centroids, covariances, labels, label_indices);
   regions.resize (model_coefficients.size ());
   boundary_indices.resize (model_coefficients.size ());
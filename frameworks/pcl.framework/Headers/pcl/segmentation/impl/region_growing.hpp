@@ -48,6 +48,8 @@
 #include <pcl/pcl/point_types.h>
 
 #include <queue>
+#include <limits>
+#include <algorithm>
 #include <list>
 #include <cmath>
 #include <time.h>
@@ -436,6 +438,33 @@ pcl::RegionGrowing<PointT>::segmentPoints ()
   return (number_of_segments_);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> unsigned int
+pcl::RegionGrowing<PointT>::segmentPoints (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  number_of_segments_ = 0;
+
+  segments_.clear ();
+  point_labels_.clear ();
+  num_pts_in_segment_.clear ();
+  point_neighbours_.clear ();
+
+  bool segmentation_is_possible = prepareForSegmentation ();
+  if ( !segmentation_is_possible )
+    return (number_of_segments_);
+
+  std::vector<int> neighbours;
+  std::vector<int> offsets;
+  searchPointNeighbours (neighbours, offsets, nr_threads);
+  number_of_segments_ = applySmoothRegionGrowingAlgorithm (neighbours, offsets, nr_threads);
+  assembleRegions ();
+
+  return (number_of_segments_);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::RegionGrowing<PointT>::prepareForSegmentation ()
@@ -483,26 +512,7 @@ pcl::RegionGrowing<PointT>::applySmoothRegionGrowingAlgorithm ()
   point_labels_.resize (num_of_pts, -1);
 
   std::vector< std::pair<float, int> > point_residual;
-  std::pair<float, int> pair;
-  point_residual.resize (num_of_pts, pair);
-
-  if (normal_flag_ == true)
-  {
-    for (int i_point = 0; i_point < num_of_pts; i_point++)
-    {
-      point_residual[i_point].first = normals_->points[i_point].curvature;
-      point_residual[i_point].second = i_point;
-    }
-    std::sort (point_residual.begin (), point_residual.end (), comparePair);
-  }
-  else
-  {
-    for (int i_point = 0; i_point < num_of_pts; i_point++)
-    {
-      point_residual[i_point].first = 0;
-      point_residual[i_point].second = i_point;
-    }
-  }
+  sortSeeds (point_residual);
   int seed_counter = 0;
   int seed = point_residual[seed_counter].second;
 
@@ -530,6 +540,118 @@ pcl::RegionGrowing<PointT>::applySmoothRegionGrowingAlgorithm ()
   return (number_of_segments);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> unsigned int
+pcl::RegionGrowing<PointT>::applySmoothRegionGrowingAlgorithm (const std::vector<int> &neighbours, const std::vector<int> &offsets, unsigned int nr_threads)
+{
+  int num_of_pts = static_cast<int> (cloud_for_segmentation_->points.size ());
+  point_labels_.resize (num_of_pts, -1);
+
+  std::vector< std::pair<float, int> > point_residual;
+  sortSeeds (point_residual);
+
+  // Grow the next unsegmented seeds in batches. The regions of a batch are committed in seed order up to the first
+  // one that conflicts with a previous region, which is then grown again in the next batch
+  const int max_batch_size = 64 * static_cast<int> (nr_threads);
+  int batch_size = static_cast<int> (nr_threads);
+  std::vector<int> claims (num_of_pts, std::numeric_limits<int>::max ());
+  std::vector<int> batch_seeds, batch_positions;
+  std::vector<std::vector<int> > batch_regions;
+  std::vector<unsigned char> batch_complete;
+
+  int number_of_segments = 0;
+  int seed_counter = 0;
+  while (true)
+  {
+    batch_seeds.clear ();
+    batch_positions.clear ();
+    for (int i_seed = seed_counter; i_seed < num_of_pts && static_cast<int> (batch_seeds.size ()) < batch_size; i_seed++)
+    {
+      int index = point_residual[i_seed].second;
+      if (point_labels_[index] == -1)
+      {
+        batch_seeds.push_back (index);
+        batch_positions.push_back (i_seed);
+      }
+    }
+    if (batch_seeds.empty ())
+      break;
+
+    const int batch_number = static_cast<int> (batch_seeds.size ());
+    batch_regions.resize (batch_number);
+    batch_complete.assign (batch_number, 0);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_threads)
+    for (int i_batch = 0; i_batch < batch_number; i_batch++)
+    {
+      batch_regions[i_batch].clear ();
+      batch_complete[i_batch] = growRegionConcurrently (batch_seeds[i_batch], i_batch, neighbours, offsets, claims, batch_regions[i_batch]);
+    }
+
+    // commit the regions whose points all still belong to them
+    int accepted = 0;
+    while (accepted < batch_number && batch_complete[accepted])
+    {
+      const std::vector<int> &region = batch_regions[accepted];
+      bool conflict = false;
+      for (size_t i_point = 0; i_point < region.size () && !conflict; i_point++)
+        conflict = (claims[region[i_point]] != accepted);
+      if (conflict)
+        break;
+
+      for (size_t i_point = 0; i_point < region.size (); i_point++)
+        point_labels_[region[i_point]] = number_of_segments;
+      num_pts_in_segment_.push_back (static_cast<int> (region.size ()));
+      number_of_segments++;
+      accepted++;
+    }
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_threads)
+    for (int i_batch = 0; i_batch < batch_number; i_batch++)
+      for (size_t i_point = 0; i_point < batch_regions[i_batch].size (); i_point++)
+        claims[batch_regions[i_batch][i_point]] = std::numeric_limits<int>::max ();
+
+    if (accepted == batch_number)
+    {
+      seed_counter = batch_positions.back () + 1;
+      batch_size = (std::min) (2 * batch_size, max_batch_size);
+    }
+    else
+    {
+      seed_counter = batch_positions[accepted];
+      batch_size = (std::max) (static_cast<int> (nr_threads), accepted);
+    }
+  }
+
+  return (number_of_segments);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::RegionGrowing<PointT>::sortSeeds (std::vector< std::pair<float, int> > &point_residual) const
+{
+  int num_of_pts = static_cast<int> (cloud_for_segmentation_->points.size ());
+  std::pair<float, int> pair;
+  point_residual.resize (num_of_pts, pair);
+
+  if (normal_flag_ == true)
+  {
+    for (int i_point = 0; i_point < num_of_pts; i_point++)
+    {
+      point_residual[i_point].first = normals_->points[i_point].curvature;
+      point_residual[i_point].second = i_point;
+    }
+    std::sort (point_residual.begin (), point_residual.end (), comparePair);
+  }
+  else
+  {
+    for (int i_point = 0; i_point < num_of_pts; i_point++)
+    {
+      point_residual[i_point].first = 0;
+      point_residual[i_point].second = i_point;
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> int
 pcl::RegionGrowing<PointT>::growRegion (int initial_seed, int segment_number)
@@ -580,6 +702,59 @@ pcl::RegionGrowing<PointT>::growRegion (int initial_seed, int segment_number)
   return (num_pts_in_segment);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::RegionGrowing<PointT>::growRegionConcurrently (int initial_seed, int rank, const std::vector<int> &neighbours, const std::vector<int> &offsets,
+                                                    std::vector<int> &claims, std::vector<int> &region) const
+{
+  // claims only ever decrease, a point is taken over from higher ranks with a compare-and-swap
+  int claim = claims[initial_seed];
+  while (claim > rank && !__sync_bool_compare_and_swap (&claims[initial_seed], claim, rank))
+    claim = claims[initial_seed];
+  if (claim < rank)
+    return (false);
+  region.push_back (initial_seed);
+
+  std::queue<int> seeds;
+  seeds.push (initial_seed);
+
+  while (!seeds.empty ())
+  {
+    int curr_seed;
+    curr_seed = seeds.front ();
+    seeds.pop ();
+
+    for (int i_nghbr = offsets[curr_seed]; i_nghbr < offsets[curr_seed + 1]; i_nghbr++)
+    {
+      int index = neighbours[i_nghbr];
+      if (point_labels_[index] != -1)
+        continue;
+
+      claim = claims[index];
+      if (claim == rank)
+        continue;
+      if (claim < rank)
+        return (false);
+
+      bool is_a_seed = false;
+      bool belongs_to_segment = validatePoint (initial_seed, curr_seed, index, is_a_seed);
+      if (belongs_to_segment == false)
+        continue;
+
+      while (claim > rank && !__sync_bool_compare_and_swap (&claims[index], claim, rank))
+        claim = claims[index];
+      if (claim < rank)
+        return (false);
+      region.push_back (index);
+
+      if (is_a_seed)
+        seeds.push (index);
+    }// next neighbour
+  }// next seed
+
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::RegionGrowing<PointT>::validatePoint (int initial_seed, int point, int nghbr, bool& is_a_seed) const
@@ -669,6 +844,49 @@ pcl::RegionGrowing<PointT>::findPointNeighbours ()
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::RegionGrowing<PointT>::searchPointNeighbours (std::vector<int> &neighbours, std::vector<int> &offsets, unsigned int nr_threads) const
+{
+  int point_number = static_cast<int> (cloud_for_segmentation_->points.size ());
+
+  // every thread searches a contiguous block of points, the blocks are concatenated in order afterwards
+  const int block_number = static_cast<int> (nr_threads);
+  std::vector<std::vector<int> > block_neighbours (block_number);
+  offsets.resize (point_number + 1);
+  offsets[0] = 0;
+
+#pragma omp parallel for schedule(static, 1) num_threads(nr_threads)
+  for (int i_block = 0; i_block < block_number; i_block++)
+  {
+    std::vector<int> point_neighbours;
+    std::vector<float> distances;
+    const int begin = static_cast<int> (static_cast<int64_t> (point_number) * i_block / block_number);
+    const int end = static_cast<int> (static_cast<int64_t> (point_number) * (i_block + 1) / block_number);
+    block_neighbours[i_block].reserve (static_cast<size_t> (end - begin) * neighbour_number_);
+    for (int i_point = begin; i_point < end; i_point++)
+    {
+      point_neighbours.clear ();
+      search_->nearestKSearch (i_point, neighbour_number_, point_neighbours, distances);
+      // the offsets hold the numbers of neighbours until the blocks are concatenated
+      offsets[i_point + 1] = static_cast<int> (point_neighbours.size ());
+      block_neighbours[i_block].insert (block_neighbours[i_block].end (), point_neighbours.begin (), point_neighbours.end ());
+    }
+  }
+
+  for (int i_point = 0; i_point < point_number; i_point++)
+    offsets[i_point + 1] += offsets[i_point];
+
+  neighbours.resize (offsets[point_number]);
+#pragma omp parallel for schedule(static, 1) num_threads(nr_threads)
+  for (int i_block = 0; i_block < block_number; i_block++)
+  {
+    const int begin = static_cast<int> (static_cast<int64_t> (point_number) * i_block / block_number);
+    std::copy (block_neighbours[i_block].begin (), block_neighbours[i_block].end (), neighbours.begin () + offsets[begin]);
+    std::vector<int> ().swap (block_neighbours[i_block]);
+  }
+}
+
 #define PCL_INSTANTIATE_RegionGrowing(T) template class pcl::RegionGrowing<T>;
 
 #endif    // PCL_SEGMENTATION_REGION_GROWING_HPP_
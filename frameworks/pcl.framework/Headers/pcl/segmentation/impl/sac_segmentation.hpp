@@ -39,6 +39,7 @@
 #define PCL_SEGMENTATION_IMPL_SAC_SEGMENTATION_H_
 
 #include <pcl/pcl/segmentation/sac_segmentation.h>
+#include <algorithm>
 
 // Sample Consensus methods
 #include <pcl/pcl/sample_consensus/sac.h>
@@ -124,6 +125,273 @@ pcl::SACSegmentation<PointT>::segment (PointIndices &inliers, ModelCoefficients
   deinitCompute ();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SACSegmentation<PointT>::segment (unsigned max_models, unsigned min_inliers,
+                                       std::vector<PointIndices> &inliers, std::vector<ModelCoefficients> &model_coefficients)
+{
+  inliers.clear ();
+  model_coefficients.clear ();
+
+  if (!initCompute ())
+    return;
+
+  // Initialize the Sample Consensus model and set its parameters
+  if (!initSACModel (model_type_))
+  {
+    PCL_ERROR ("[pcl::%s::segment] Error initializing the SAC model!\n", getClassName ().c_str ());
+    deinitCompute ();
+    return;
+  }
+
+  if (model_type_ == SACMODEL_PLANE && method_type_ == SAC_RANSAC && samples_radius_ <= 0.)
+  {
+    segmentPlanes (max_models, min_inliers, inliers, model_coefficients);
+    deinitCompute ();
+    return;
+  }
+
+  // Initialize the Sample Consensus method and set its parameters
+  initSAC (method_type_);
+
+  // The model searches the remaining indices, which shrink in place as models are found
+  boost::shared_ptr<std::vector<int> > remaining (new std::vector<int> (*indices_));
+  std::vector<unsigned char> is_inlier (input_->points.size (), 0);
+  while ((max_models == 0 || model_coefficients.size () < max_models) &&
+         remaining->size () >= model_->getSampleSize () && remaining->size () >= min_inliers)
+  {
+    model_->setIndices (remaining);
+    if (!sac_->computeModel (0))
+      break;
+
+    PointIndices model_inliers;
+    ModelCoefficients coefficients;
+    model_inliers.header = coefficients.header = input_->header;
+    sac_->getInliers (model_inliers.indices);
+
+    Eigen::VectorXf coeff;
+    sac_->getModelCoefficients (coeff);
+
+    // If the user needs optimized coefficients
+    if (optimize_coefficients_)
+    {
+      Eigen::VectorXf coeff_refined;
+      model_->optimizeModelCoefficients (model_inliers.indices, coeff, coeff_refined);
+      coeff = coeff_refined;
+      // Refine inliers
+      model_->selectWithinDistance (coeff, threshold_, model_inliers.indices);
+    }
+
+    if (model_inliers.indices.empty () || model_inliers.indices.size () < min_inliers)
+      break;
+
+    coefficients.values.resize (coeff.size ());
+    memcpy (&coefficients.values[0], &coeff[0], coeff.size () * sizeof (float));
+
+    for (size_t i = 0; i < model_inliers.indices.size (); ++i)
+      is_inlier[model_inliers.indices[i]] = 1;
+    size_t nr_remaining = 0;
+    for (size_t i = 0; i < remaining->size (); ++i)
+      if (!is_inlier[(*remaining)[i]])
+        (*remaining)[nr_remaining++] = (*remaining)[i];
+    remaining->resize (nr_remaining);
+
+    inliers.push_back (model_inliers);
+    model_coefficients.push_back (coefficients);
+  }
+
+  deinitCompute ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::SACSegmentation<PointT>::selectPlaneInliers (const std::vector<float> &x, const std::vector<float> &y, const std::vector<float> &z,
+                                                  int nr_points, const float *coefficients, float threshold, std::vector<int> *selection)
+{
+  const float a = coefficients[0], b = coefficients[1], c = coefficients[2], d = coefficients[3];
+  int nr_p = 0;
+  if (!selection)
+  {
+    for (int i = 0; i < nr_points; ++i)
+      nr_p += fabsf (a * x[i] + b * y[i] + c * z[i] + d) < threshold;
+    return (nr_p);
+  }
+
+  selection->clear ();
+  for (int i = 0; i < nr_points; ++i)
+    if (fabsf (a * x[i] + b * y[i] + c * z[i] + d) < threshold)
+      selection->push_back (i);
+  return (static_cast<int> (selection->size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SACSegmentation<PointT>::segmentPlanes (unsigned max_models, unsigned min_inliers,
+                                             std::vector<PointIndices> &inliers, std::vector<ModelCoefficients> &model_coefficients)
+{
+  // Copy the finite points into a structure of arrays. The points that are not inliers of a plane yet are kept at the
+  // front, in the order of the indices
+  std::vector<float> x, y, z;
+  std::vector<int> point_indices;
+  x.reserve (indices_->size ()); y.reserve (indices_->size ()); z.reserve (indices_->size ());
+  point_indices.reserve (indices_->size ());
+  for (size_t i = 0; i < indices_->size (); ++i)
+  {
+    const PointT &pt = input_->points[(*indices_)[i]];
+    if (!pcl_isfinite (pt.x) || !pcl_isfinite (pt.y) || !pcl_isfinite (pt.z))
+      continue;
+    x.push_back (pt.x); y.push_back (pt.y); z.push_back (pt.z);
+    point_indices.push_back ((*indices_)[i]);
+  }
+  int nr_remaining = static_cast<int> (point_indices.size ());
+
+  std::vector<unsigned char> removed (input_->points.size (), 0);
+  std::vector<PlaneHypothesis> hypotheses;
+  std::vector<int> selection;
+  boost::mt19937 rng (12345u);
+  const float threshold = static_cast<float> (threshold_);
+  const int max_hypotheses = max_iterations_ + 1;
+  const unsigned max_skip = max_iterations_ * 10;
+
+  while ((max_models == 0 || model_coefficients.size () < max_models) &&
+         nr_remaining >= 3 && nr_remaining >= static_cast<int> (min_inliers))
+  {
+    int best = -1;
+    int n_best_inliers_count = -INT_MAX;
+    double k = 1.0;
+
+    // A hypothesis of an earlier plane whose samples are all left is still a valid sample of the remaining points. Its
+    // count can only have dropped, so the hypotheses are rescored in order of their old counts, until an old count
+    // cannot beat the best one anymore. The others still count as iterations
+    std::stable_sort (hypotheses.begin (), hypotheses.end (), compareHypotheses);
+    int nr_hypotheses = 0;
+    for (size_t h = 0; h < hypotheses.size () && nr_hypotheses < max_hypotheses; ++h)
+    {
+      PlaneHypothesis hypothesis = hypotheses[h];
+      if (removed[hypothesis.samples[0]] || removed[hypothesis.samples[1]] || removed[hypothesis.samples[2]])
+        continue;
+      if (hypothesis.count > n_best_inliers_count)
+      {
+        hypothesis.count = selectPlaneInliers (x, y, z, nr_remaining, hypothesis.coefficients, threshold, NULL);
+        if (hypothesis.count > n_best_inliers_count)
+        {
+          n_best_inliers_count = hypothesis.count;
+          best = nr_hypotheses;
+        }
+      }
+      hypotheses[nr_hypotheses++] = hypothesis;
+    }
+    hypotheses.resize (nr_hypotheses);
+    int iterations = nr_hypotheses;
+
+    unsigned skipped_count = 0;
+    while (true)
+    {
+      // Compute the k parameter (k=log(z)/log(1-w^n))
+      if (best >= 0)
+      {
+        double w = static_cast<double> (n_best_inliers_count) / static_cast<double> (nr_remaining);
+        double p_no_outliers = 1.0 - pow (w, 3.0);
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1.0 - probability_) / log (p_no_outliers);
+      }
+      if (iterations >= k || iterations > max_iterations_ || skipped_count >= max_skip)
+        break;
+
+      // Draw three different points among the remaining ones
+      int s0 = static_cast<int> (rng () % nr_remaining);
+      int s1 = static_cast<int> (rng () % nr_remaining);
+      int s2 = static_cast<int> (rng () % nr_remaining);
+      if (s0 == s1 || s0 == s2 || s1 == s2)
+        continue;
+
+      Eigen::Array3f p0 (x[s0], y[s0], z[s0]);
+      Eigen::Array3f p1p0 = Eigen::Array3f (x[s1], y[s1], z[s1]) - p0;
+      Eigen::Array3f p2p0 = Eigen::Array3f (x[s2], y[s2], z[s2]) - p0;
+
+      // Avoid some crashes by checking for collinearity here
+      Eigen::Array3f dy1dy2 = p1p0 / p2p0;
+      if ( (dy1dy2[0] == dy1dy2[1]) && (dy1dy2[2] == dy1dy2[1]) )
+      {
+        ++skipped_count;
+        continue;
+      }
+
+      Eigen::Vector3f normal = p1p0.matrix ().cross (p2p0.matrix ()).normalized ();
+      PlaneHypothesis hypothesis;
+      hypothesis.samples[0] = point_indices[s0];
+      hypothesis.samples[1] = point_indices[s1];
+      hypothesis.samples[2] = point_indices[s2];
+      hypothesis.coefficients[0] = normal[0];
+      hypothesis.coefficients[1] = normal[1];
+      hypothesis.coefficients[2] = normal[2];
+      hypothesis.coefficients[3] = -1 * normal.dot (p0.matrix ());
+      hypothesis.count = selectPlaneInliers (x, y, z, nr_remaining, hypothesis.coefficients, threshold, NULL);
+      hypotheses.push_back (hypothesis);
+
+      // Better match ?
+      if (hypothesis.count > n_best_inliers_count)
+      {
+        n_best_inliers_count = hypothesis.count;
+        best = static_cast<int> (hypotheses.size ()) - 1;
+      }
+      ++iterations;
+    }
+
+    if (best < 0)
+      break;
+
+    Eigen::VectorXf coeff (4);
+    for (int i = 0; i < 4; ++i)
+      coeff[i] = hypotheses[best].coefficients[i];
+    selectPlaneInliers (x, y, z, nr_remaining, hypotheses[best].coefficients, threshold, &selection);
+
+    // If the user needs optimized coefficients
+    if (optimize_coefficients_)
+    {
+      std::vector<int> selected_indices (selection.size ());
+      for (size_t i = 0; i < selection.size (); ++i)
+        selected_indices[i] = point_indices[selection[i]];
+      Eigen::VectorXf coeff_refined;
+      model_->optimizeModelCoefficients (selected_indices, coeff, coeff_refined);
+      coeff = coeff_refined;
+      // Refine inliers
+      float refined[4] = {coeff[0], coeff[1], coeff[2], coeff[3]};
+      selectPlaneInliers (x, y, z, nr_remaining, refined, threshold, &selection);
+    }
+
+    if (selection.empty () || selection.size () < min_inliers)
+      break;
+
+    PointIndices model_inliers;
+    ModelCoefficients coefficients;
+    model_inliers.header = coefficients.header = input_->header;
+    model_inliers.indices.resize (selection.size ());
+    for (size_t i = 0; i < selection.size (); ++i)
+    {
+      model_inliers.indices[i] = point_indices[selection[i]];
+      removed[model_inliers.indices[i]] = 1;
+    }
+    coefficients.values.resize (4);
+    memcpy (&coefficients.values[0], &coeff[0], 4 * sizeof (float));
+    inliers.push_back (model_inliers);
+    model_coefficients.push_back (coefficients);
+
+    // Move the points that are left to the front
+    int nr_left = 0;
+    for (int i = 0; i < nr_remaining; ++i)
+    {
+      if (removed[point_indices[i]])
+        continue;
+      x[nr_left] = x[i]; y[nr_left] = y[i]; z[nr_left] = z[i];
+      point_indices[nr_left] = point_indices[i];
+      ++nr_left;
+    }
+    nr_remaining = nr_left;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::SACSegmentation<PointT>::initSACModel (const int model_type)
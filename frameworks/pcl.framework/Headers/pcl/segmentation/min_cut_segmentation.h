@@ -42,6 +42,7 @@
 #include <pcl/pcl/point_cloud.h>
 #include <pcl/pcl/point_types.h>
 #include <pcl/pcl/search/search.h>
+#include <pcl/pcl/segmentation/boykov_kolmogorov_graph.h>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/shared_ptr.hpp>
 #include <string>
@@ -53,6 +54,7 @@ namespace pcl
     * This class implements the segmentation algorithm based on minimal cut of the graph.
     * Description can be found in the article
     * "Min-Cut Based Segmentation of Point Clouds"
+    * The maximum flow is found on a flat copy of the graph, see BoykovKolmogorovGraph.
     * \author: Aleksey Golovinskiy (mine_all_mine@bk.ru) and Thomas Funkhouser.
     */
   template <typename PointT>
@@ -258,11 +260,18 @@ namespace pcl
       bool
       recalculateBinaryPotentials ();
 
+      /** \brief This method copies the capacities of the graph to the flat graph that is used for finding the maximum flow.
+        * \param[out] flow_graph graph whose node i corresponds to the i-th point of the cloud
+        */
+      void
+      buildFlowGraph (pcl::BoykovKolmogorovGraph<double>& flow_graph) const;
+
       /** \brief This method analyzes the residual network and assigns a label to every point in the cloud.
-        * \param[in] residual_capacity residual network that was obtained during the segmentation
+        * Points that are reachable from the source belong to the object.
+        * \param[in] flow_graph graph whose maximum flow was found during the segmentation
         */
       void
-      assembleLabels (ResidualCapacityMap& residual_capacity);
+      assembleLabels (const pcl::BoykovKolmogorovGraph<double>& flow_graph);
 
     protected:
 
@@ -53,6 +53,13 @@ namespace pcl
     * id, along with a vector of PointIndices corresponding to each component.
     * See OrganizedMultiPlaneSegmentation for an example application.
     *
+    * The rows are split into one strip per thread (see the nr_threads argument of segment ()). Every strip is labeled on its own,
+    * comparing a whole row with its left and upper neighbors at once; the strips are then joined along their border
+    * rows and the labels are renumbered in a final pass. The result does not depend on the number of threads.
+    *
+    * If indices are given through setIndices (), only those points are labeled; all other points are treated like
+    * invalid ones and receive no label.
+    *
     * \author Alex Trevor, Suat Gedikli
     */
   template <typename PointT, typename PointLT>
@@ -60,6 +67,7 @@ namespace pcl
   {
     using PCLBase<PointT>::input_;
     using PCLBase<PointT>::indices_;
+    using PCLBase<PointT>::fake_indices_;
     using PCLBase<PointT>::initCompute;
     using PCLBase<PointT>::deinitCompute;
 
@@ -109,6 +117,15 @@ namespace pcl
         */
       void
       segment (pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices) const;
+
+      /** \brief Perform the connected component segmentation with several threads.
+        * \param[out] labels a PointCloud of labels: each connected component will have a unique id.
+        * \param[out] label_indices a vector of PointIndices corresponding to each label / component id.
+        * \param[in] nr_threads the number of hardware threads to use (0 is treated as 1)
+        */
+      void
+      segment (pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices,
+               unsigned int nr_threads) const;
       
       /** \brief Find the boundary points / contour of a connected component
         * \param[in] start_idx the first (lowest) index of the connected component for which a boundary shoudl be returned
@@ -121,7 +138,29 @@ namespace pcl
 
     protected:
       ComparatorConstPtr compare_;
-      
+
+      /** \brief Label the rows [first_row, end_row) on their own, as if the first one was the top of the image.
+        * \param[in] first_row the first row of the strip
+        * \param[in] end_row the row after the last row of the strip
+        * \param[in] valid nonzero for every point that has to be labeled
+        * \param[out] labels the labels, numbered from 0 within the strip
+        * \param[out] runs the union-find parent of every label of the strip
+        */
+      void
+      labelStrip (unsigned first_row, unsigned end_row, const std::vector<unsigned char>& valid,
+                  pcl::PointCloud<PointLT>& labels, std::vector<unsigned>& runs) const;
+
+      /** \brief Compare the valid points of a row with the points at the same columns in another row.
+        * \param[in] row_start the index of the first point of the row
+        * \param[in] offset the index difference to the points they are compared with
+        * \param[in] first_column the first column to compare
+        * \param[in] valid nonzero for every point that has to be labeled
+        * \param[out] results the comparison result for every column, zero for invalid points
+        */
+      void
+      compareRow (int row_start, int offset, int first_column, const std::vector<unsigned char>& valid,
+                  std::vector<unsigned char>& results) const;
+
       inline unsigned
       findRoot (const std::vector<unsigned>& runs, unsigned index) const
       {
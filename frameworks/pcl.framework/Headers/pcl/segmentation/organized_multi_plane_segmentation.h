@@ -228,6 +228,34 @@ namespace pcl
                pcl::PointCloud<PointLT>& labels, 
                std::vector<pcl::PointIndices>& label_indices);
 
+      /** \brief Segmentation of all planes in a point cloud given by setInputCloud(), using the planes found in a previous
+        * frame as priors. All points are first tested against all prior planes at once: a point is explained by a prior if
+        * its distance to the plane is below the distance threshold (scaled by the squared depth), its normal is within
+        * the angular threshold of the plane normal and it lies within the extent of the prior, the bounding box of its
+        * contour in the plane grown by a tenth of its size. Of these points, only the connected parts that reach into
+        * the core of the prior (one standard deviation around its centroid) are kept. Every prior that explains more than min_inliers points is refit to them
+        * and kept, in the order of prior_regions and ahead of the new planes. Only the points that are not explained by a
+        * kept prior go through the connected component segmentation.
+        * \param[in] prior_regions the planar regions found in the previous frame
+        * \param[out] model_coefficients a vector of model_coefficients for each plane found in the input cloud
+        * \param[out] inlier_indices a vector of inliers for each detected plane
+        * \param[out] centroids a vector of centroids for each plane
+        * \param[out] covariances a vector of covariance matricies for the inliers of each plane
+        * \param[out] labels a point cloud for the connected component labels of each pixel
+        * \param[out] label_indices a vector of PointIndices for each labeled component
+        * \param[in] nr_threads the number of hardware threads used for the plane equations, the prior test and the
+        * connected component labeling (0 is treated as 1); pass no priors to use several threads on a single frame
+        */
+      void
+      segment (const std::vector<PlanarRegion<PointT> >& prior_regions,
+               std::vector<ModelCoefficients>& model_coefficients, 
+               std::vector<PointIndices>& inlier_indices,
+               std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> >& centroids,
+               std::vector <Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> >& covariances,
+               pcl::PointCloud<PointLT>& labels, 
+               std::vector<pcl::PointIndices>& label_indices,
+               unsigned int nr_threads = 1);
+
       /** \brief Segmentation of all planes in a point cloud given by setInputCloud(), setIndices()
         * \param[out] model_coefficients a vector of model_coefficients for each plane found in the input cloud
         * \param[out] inlier_indices a vector of inliers for each detected plane
@@ -248,6 +276,18 @@ namespace pcl
       void
       segmentAndRefine (std::vector<PlanarRegion<PointT> >& regions);
 
+      /** \brief Perform a segmentation that uses the regions of the previous frame as priors, see segment (), as well as
+        * an additional refinement step. Feeding the regions of every frame to the next one tracks the planes of a sequence
+        * without rediscovering them from scratch.
+        * \param[in] prior_regions the regions found in the previous frame
+        * \param[out] regions A list of regions generated by segmentation and refinement.
+        * \param[in] nr_threads the number of hardware threads used by the segmentation (0 is treated as 1)
+        */
+      void
+      segmentAndRefine (const std::vector<PlanarRegion<PointT> >& prior_regions,
+                        std::vector<PlanarRegion<PointT> >& regions,
+                        unsigned int nr_threads = 1);
+
       /** \brief Perform a segmentation, as well as additional refinement step.  Returns intermediate data structures for use in
         * subsequent processing.
         * \param[out] regions A vector of PlanarRegions generated by segmentation
@@ -283,6 +323,18 @@ namespace pcl
 
     protected:
 
+      /** \brief Find the prior plane that explains every point of the input cloud best. The priors are packed into one
+        * table of normals, distances and in-plane bounding boxes that every point is tested against. The inliers of
+        * every prior are then split into connected parts and the parts that do not reach into its core are dropped, so
+        * that coplanar surfaces next to a prior are left to the connected component segmentation.
+        * \param[in] prior_regions the planar regions found in the previous frame
+        * \param[out] prior_labels the index of the prior for every point, -1 if no prior explains it
+        * \param[in] nr_threads the number of hardware threads used for the point tests
+        */
+      void
+      findPriorInliers (const std::vector<PlanarRegion<PointT> >& prior_regions, std::vector<int>& prior_labels,
+                        unsigned int nr_threads) const;
+
       /** \brief A pointer to the input normals */
       PointCloudNConstPtr normals_;
 
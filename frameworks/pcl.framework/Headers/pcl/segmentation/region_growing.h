@@ -55,6 +55,11 @@ namespace pcl
     * "Segmentation of point clouds using smoothness constraint"
     * by T. Rabbania, F. A. van den Heuvelb, G. Vosselmanc.
     * In addition to residual test, the possibility to test curvature is added.
+    *
+    * segmentPoints (nr_threads) runs the neighbour search and the growing on several threads. The neighbours are then
+    * kept in one flat array for the duration of the call. Batches of seeds grow concurrently and claim their points
+    * atomically, so that the seed that comes first in curvature order wins. A batch is committed up to its first
+    * conflicting region, hence the segments are the same as the ones of segmentPoints ().
     */
   template <typename PointT>
   class PCL_EXPORTS RegionGrowing
@@ -168,6 +173,13 @@ namespace pcl
       virtual unsigned int
       segmentPoints ();
 
+      /** \brief This method launches the segmentation algorithm on several threads. It only uses the
+        * smoothness based growing of this class, the neighbours are not stored in point_neighbours_.
+        * \param[in] nr_threads the number of hardware threads to use (0 is treated as 1)
+        */
+      unsigned int
+      segmentPoints (unsigned int nr_threads);
+
       /** \brief This destructor destroys the cloud, normals and search method used for
         * finding KNN. In other words it frees memory.
         */
@@ -227,6 +239,20 @@ namespace pcl
       unsigned int
       applySmoothRegionGrowingAlgorithm ();
 
+      /** \brief This function grows the regions like applySmoothRegionGrowingAlgorithm (), concurrently.
+        * \param[in] neighbours the neighbours of all points, as filled by searchPointNeighbours ()
+        * \param[in] offsets tells where the neighbours of each point start in neighbours, with one extra end entry
+        * \param[in] nr_threads the number of hardware threads to use
+        */
+      unsigned int
+      applySmoothRegionGrowingAlgorithm (const std::vector<int> &neighbours, const std::vector<int> &offsets, unsigned int nr_threads);
+
+      /** \brief This function fills the indices of the points, sorted by the order in which they serve as seeds.
+        * \param[out] point_residual the curvature of each point together with its index
+        */
+      void
+      sortSeeds (std::vector< std::pair<float, int> > &point_residual) const;
+
       /** \brief This method grows a segment for the given seed point. And returns the number of its points.
         * \param[in] initial_seed index of the point that will serve as the seed point
         * \param[in] segment_number indicates which number this segment will have
@@ -234,6 +260,21 @@ namespace pcl
       int
       growRegion (int initial_seed, int segment_number);
 
+      /** \brief This method grows a segment for the given seed point concurrently with the other seeds of a batch.
+        * A point belongs to the batch member with the lowest rank that reaches it. The growing stops as soon as
+        * a point taken by a lower rank is met, since the segment can not be committed then.
+        * \param[in] initial_seed index of the point that will serve as the seed point
+        * \param[in] rank the rank of the seed within the batch
+        * \param[in] neighbours the neighbours of all points
+        * \param[in] offsets tells where the neighbours of each point start in neighbours
+        * \param[in,out] claims the rank of the batch member each point belongs to, or INT_MAX for no member
+        * \param[out] region the points claimed by this seed
+        * \return false if the growing was stopped by a conflict with a lower rank
+        */
+      bool
+      growRegionConcurrently (int initial_seed, int rank, const std::vector<int> &neighbours, const std::vector<int> &offsets,
+                              std::vector<int> &claims, std::vector<int> &region) const;
+
       /** \brief This function is checking if the point with index 'nghbr' belongs to the segment.
         * If so, then it returns true. It also checks if this point can serve as the seed.
         * \param[in] initial_seed index of the initial point that was passed to the growRegion() function
@@ -254,6 +295,15 @@ namespace pcl
       virtual void
       findPointNeighbours ();
 
+      /** \brief This method finds the KNN of every point, in parallel, and stores them in one flat array.
+        * The neighbours of point i are stored at [offsets[i], offsets[i + 1]).
+        * \param[out] neighbours the neighbours of all points
+        * \param[out] offsets tells where the neighbours of each point start in neighbours, with one extra end entry
+        * \param[in] nr_threads the number of hardware threads to use
+        */
+      void
+      searchPointNeighbours (std::vector<int> &neighbours, std::vector<int> &offsets, unsigned int nr_threads) const;
+
     protected:
 
       /** \brief If set to true then normal/smoothness test will be done during segmentation. */
@@ -229,13 +229,72 @@ namespace pcl
       virtual void 
       segment (PointIndices &inliers, ModelCoefficients &model_coefficients);
 
+      /** \brief Sequential segmentation of several models in a PointCloud given by <setInputCloud (), setIndices ()>.
+        * Every model is searched among the points that are not inliers of the models found before it, until max_models
+        * models are found or a model has fewer than min_inliers inliers. Set at least one of the two, otherwise the
+        * extraction only stops once no model is left in the remaining points.
+        *
+        * The SAC model and method are set up once and the remaining indices are shrunk in place between models. Planes
+        * found with SAC_RANSAC take a dedicated path that keeps the remaining points in a structure-of-arrays copy and
+        * reuses the hypotheses scored for earlier planes.
+        *
+        * This method is not part of the precompiled library: include pcl/segmentation/impl/sac_segmentation.hpp
+        * where it is called.
+        * \param[in] max_models the maximum number of models, 0 for no limit
+        * \param[in] min_inliers the minimum number of inliers of every model
+        * \param[out] inliers the inliers of every model found, in the order in which they were found
+        * \param[out] model_coefficients the coefficients of every model found
+        */
+      void
+      segment (unsigned max_models, unsigned min_inliers,
+               std::vector<PointIndices> &inliers, std::vector<ModelCoefficients> &model_coefficients);
+
     protected:
+      /** \brief A plane that was fit to three sampled points, together with its number of inliers when it was last scored. */
+      struct PlaneHypothesis
+      {
+        /** \brief The indices of the sampled points in the input cloud. */
+        int samples[3];
+        /** \brief The plane coefficients. */
+        float coefficients[4];
+        /** \brief The number of inliers, an upper bound once points were removed. */
+        int count;
+      };
+
+      /** \brief Order plane hypotheses by decreasing number of inliers. */
+      static bool
+      compareHypotheses (const PlaneHypothesis &a, const PlaneHypothesis &b) { return (a.count > b.count); }
+
       /** \brief Initialize the Sample Consensus model and set its parameters.
         * \param[in] model_type the type of SAC model that is to be used
         */
       virtual bool 
       initSACModel (const int model_type);
 
+      /** \brief Extract several planes with RANSAC, see segment (). The model has to be initialized.
+        * \param[in] max_models the maximum number of planes, 0 for no limit
+        * \param[in] min_inliers the minimum number of inliers of every plane
+        * \param[out] inliers the inliers of every plane found
+        * \param[out] model_coefficients the coefficients of every plane found
+        */
+      void
+      segmentPlanes (unsigned max_models, unsigned min_inliers,
+                     std::vector<PointIndices> &inliers, std::vector<ModelCoefficients> &model_coefficients);
+
+      /** \brief Select the first nr_points points of a structure-of-arrays copy that are closer to a plane than the threshold.
+        * \param[in] x the x coordinates of the points
+        * \param[in] y the y coordinates of the points
+        * \param[in] z the z coordinates of the points
+        * \param[in] nr_points the number of points to test
+        * \param[in] coefficients the plane coefficients
+        * \param[in] threshold the distance threshold
+        * \param[out] selection the positions of the points within the threshold, not filled if NULL
+        * \return the number of points within the threshold
+        */
+      static int
+      selectPlaneInliers (const std::vector<float> &x, const std::vector<float> &y, const std::vector<float> &z,
+                          int nr_points, const float *coefficients, float threshold, std::vector<int> *selection);
+
       /** \brief Initialize the Sample Consensus method and set its parameters.
         * \param[in] method_type the type of SAC method to be used
         */
@@ -232,11 +232,12 @@ pcl::tracking::ParticleFilterTracker<PointInT, StateT>::weight ()
 {
   if (!use_normal_)
   {
+    // Transform the reference cloud by all particles in one pass over its points
+    std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f> > transforms (particles_->points.size ());
     for (size_t i = 0; i < particles_->points.size (); i++)
-    {
-      computeTransformedPointCloudWithoutNormal (particles_->points[i], *transed_reference_vector_[i]);
-    }
-    
+      transforms[i] = toEigenMatrix (particles_->points[i]);
+    pcl::transformPointCloud<PointInT> (*ref_, transforms, transed_reference_vector_);
+
     PointCloudInPtr coherence_input (new PointCloudIn);
     cropInputPointCloud (input_, *coherence_input);
     